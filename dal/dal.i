@@ -50,6 +50,7 @@
   #include "dal/lofar/Flagging.h"
   #include "dal/lofar/BF_File.h"
   #include "dal/lofar/TBB_File.h"
+  #include "dal/lofar/VirtualStokesDataset.h"
 
   #include "dal/dal_version.h"
 
@@ -73,6 +74,7 @@
 %include dal/lofar/CLA_File.h
 %include dal/lofar/Coordinates.h
 %include dal/lofar/BF_File.h
+%include dal/lofar/VirtualStokesDataset.h
 %include "dal/lofar/TBB_File.i"
 
 // -------------------------------
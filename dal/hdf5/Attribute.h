@@ -66,6 +66,18 @@ public:
    * using the type defined by this object.
    */
   virtual bool valid() const;
+
+protected:
+  /*!
+   * Returns where to stage writes if write batching is enabled (see File::setWriteBatching()),
+   * or NULL if attributes have to be written directly.
+   */
+  AttributeBatch *writeBatch() const;
+
+  //! Commits any staged attribute writes in this file, so that they can be read.
+  void commitWrites() const;
+
+  template<typename T> friend class AttributeValue;
 };
 
 #ifndef SWIG
@@ -16,8 +16,31 @@
  */
 namespace dal {
 
+inline AttributeBatch *AttributeBase::writeBatch() const
+{
+  AttributeBatch &batch = fileInfo.attributeBatch();
+
+  return batch.enabled() ? &batch : NULL;
+}
+
+inline void AttributeBase::commitWrites() const
+{
+  AttributeBatch &batch = fileInfo.attributeBatch();
+
+  if (!batch.empty())
+    batch.commit();
+}
+
 inline bool AttributeBase::exists() const
 {
+  const AttributeBatch &batch = fileInfo.attributeBatch();
+  if (!batch.empty() && batch.contains(parent, _name))
+    return true;
+
+  const int cached = parentAttributes.exists(_name);
+  if (cached >= 0)
+    return cached > 0;
+
   return H5Aexists(parent, _name.c_str()) > 0;
 }
 
@@ -27,15 +50,24 @@ inline bool AttributeBase::valid() const
 }
 
 inline void AttributeBase::remove() const {
+  parentAttributes.forget(_name);
+  commitWrites();
+
   if (H5Adelete(parent, _name.c_str()) < 0)
     throw HDF5Exception("Could not remove attribute " + _name);
 }
 
 inline size_t AttributeBase::size() const
 {
-  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to retrieve size of attribute " + _name);
+  const CachedAttribute *cached = parentAttributes.value(_name);
+  if (cached)
+    return cached->nrElements;
+
+  commitWrites();
+
+  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to retrieve size of attribute ", _name);
 
-  hid_gc_noref dataspace(H5Aget_space(attr), H5Sclose, "Could not retrieve dataspace to retrieve size of attribute " + _name);
+  hid_gc_noref dataspace(H5Aget_space(attr), H5Sclose, "Could not retrieve dataspace to retrieve size of attribute ", _name);
 
   H5S_class_t classType(H5Sget_simple_extent_type(dataspace));
   if (classType == H5S_NO_CLASS)
@@ -66,6 +98,12 @@ inline size_t AttributeBase::size() const
 
 template<typename T> AttributeValue<T>& AttributeValue<T>::operator=( const T& value )
 {
+  // a staged write creates the attribute with its final type and size, so do not query HDF5
+  if (attr.writeBatch()) {
+    attr.set(value);
+    return *this;
+  }
+
   if (!attr.exists())
     attr.create();
 
@@ -148,16 +186,32 @@ static inline bool h5stringIsVariable( hid_t datatype )
 // generic variants
 template<typename T> inline Attribute<T>& Attribute<T>::create()
 {
-  hid_gc_noref dataspace(h5scalar(), H5Sclose, "Could not create scalar dataspace for attribute " + _name);
+  parentAttributes.forget(_name);
+
+  AttributeBatch *batch = writeBatch();
+  if (batch) {
+    batch->stage(parent, _name, h5typemap<T>::attributeType(), h5typemap<T>::memoryType(), true, 1, NULL);
+    return *this;
+  }
+
+  hid_gc_noref dataspace(h5scalar(), H5Sclose, "Could not create scalar dataspace for attribute ", _name);
 
-  hid_gc_noref attr(H5Acreate2(parent, _name.c_str(), h5typemap<T>::attributeType(), dataspace, H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "Could not create attribute " + _name);
+  hid_gc_noref attr(H5Acreate2(parent, _name.c_str(), h5typemap<T>::attributeType(), dataspace, H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "Could not create attribute ", _name);
 
   return *this;
 }
 
 template<typename T> inline void Attribute<T>::set( const T &value )
 {
-  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to set attribute " + _name);
+  parentAttributes.forget(_name);
+
+  AttributeBatch *batch = writeBatch();
+  if (batch) {
+    batch->stage(parent, _name, h5typemap<T>::attributeType(), h5typemap<T>::memoryType(), true, 1, &value);
+    return;
+  }
+
+  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to set attribute ", _name);
 
   if (H5Awrite(attr, h5typemap<T>::memoryType(), &value) < 0)
     throw HDF5Exception("Could not set attribute " + _name);
@@ -167,7 +221,17 @@ template<typename T> inline T Attribute<T>::get() const
 {
   T value;
 
-  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to get attribute " + _name);
+  const CachedAttribute *cached = parentAttributes.value(_name);
+  if (cached) {
+    if (cached->nrElements != 1 || !cached->convert(h5typemap<T>::memoryType(), &value))
+      throw HDF5Exception("Could not get attribute " + _name);
+
+    return value;
+  }
+
+  commitWrites();
+
+  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to get attribute ", _name);
 
   if (H5Aread(attr, h5typemap<T>::memoryType(), &value) < 0)
     throw HDF5Exception("Could not get attribute" + _name);
@@ -194,15 +258,32 @@ template<typename T> inline bool Attribute<T>::valid() const
 
 template<typename T> inline Attribute< std::vector<T> >& Attribute< std::vector<T> >::create( size_t length )
 {
-  hid_gc_noref dataspace(h5array(length), H5Sclose, "Could not create simple dataspace to create attribute " + _name);
+  parentAttributes.forget(_name);
+
+  AttributeBatch *batch = writeBatch();
+  if (batch) {
+    batch->stage(parent, _name, h5typemap<T>::attributeType(), h5typemap<T>::memoryType(), false, length, NULL);
+    return *this;
+  }
 
-  hid_gc_noref attr(H5Acreate2(parent, _name.c_str(), h5typemap<T>::attributeType(), dataspace, H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "Could not create attribute " + _name);
+  hid_gc_noref dataspace(h5array(length), H5Sclose, "Could not create simple dataspace to create attribute ", _name);
+
+  hid_gc_noref attr(H5Acreate2(parent, _name.c_str(), h5typemap<T>::attributeType(), dataspace, H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "Could not create attribute ", _name);
 
   return *this;
 }
 
 template<typename T> inline void Attribute< std::vector<T> >::set( const std::vector<T> &value )
 {
+  parentAttributes.forget(_name);
+
+  AttributeBatch *batch = writeBatch();
+  if (batch) {
+    // the attribute is created with the right length on commit
+    batch->stage(parent, _name, h5typemap<T>::attributeType(), h5typemap<T>::memoryType(), false, value.size(), value.empty() ? NULL : &value[0]);
+    return;
+  }
+
   if (size() != value.size()) {
     // recreate the attribute to change the vector length on disk
     remove();
@@ -212,7 +293,7 @@ template<typename T> inline void Attribute< std::vector<T> >::set( const std::ve
   if (value.empty())
     return; // cannot write to a NULL dataspace
 
-  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to set attribute " + _name);
+  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to set attribute ", _name);
 
   if (H5Awrite(attr, h5typemap<T>::memoryType(), &value[0]) < 0)
     throw HDF5Exception("Could not write to attribute " + _name);
@@ -220,7 +301,19 @@ template<typename T> inline void Attribute< std::vector<T> >::set( const std::ve
 
 template<typename T> inline std::vector<T> Attribute< std::vector<T> >::get() const
 {
-  hid_gc_noref attr(H5Aopen_name(parent, _name.c_str()), H5Aclose, "Could not open to get attribute " + _name);
+  const CachedAttribute *cached = parentAttributes.value(_name);
+  if (cached) {
+    std::vector<T> value(cached->nrElements);
+
+    if (!value.empty() && !cached->convert(h5typemap<T>::memoryType(), &value[0]))
+      throw HDF5Exception("Could not get attribute " + _name);
+
+    return value;
+  }
+
+  commitWrites();
+
+  hid_gc_noref attr(H5Aopen_name(parent, _name.c_str()), H5Aclose, "Could not open to get attribute ", _name);
 
   std::vector<T> value(size());
   if (value.empty())
@@ -253,24 +346,41 @@ template<typename T> inline bool Attribute< std::vector<T> >::valid() const
 
 template<> inline Attribute<std::string>& Attribute<std::string>::create()
 {
-  hid_gc_noref dataspace(h5scalar(), H5Sclose, "Could not create scalar dataspace to create attribute " + _name);
-  hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create string datatype to create attribute " + _name);
+  parentAttributes.forget(_name);
 
-  hid_gc_noref attr(H5Acreate2(parent, _name.c_str(), datatype, dataspace, H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "Could not create attribute " + _name);
+  AttributeBatch *batch = writeBatch();
+  if (batch) {
+    batch->stageStrings(parent, _name, true, 1, NULL);
+    return *this;
+  }
+
+  hid_gc_noref dataspace(h5scalar(), H5Sclose, "Could not create scalar dataspace to create attribute ", _name);
+  hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create string datatype to create attribute ", _name);
+
+  hid_gc_noref attr(H5Acreate2(parent, _name.c_str(), datatype, dataspace, H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "Could not create attribute ", _name);
 
   return *this;
 }
 
 template<> inline void Attribute<std::string>::set( const std::string &value )
 {
+  parentAttributes.forget(_name);
+
+  AttributeBatch *batch = writeBatch();
+  if (batch) {
+    // always staged as a variable length string, so no need to check the size on disk
+    batch->stageStrings(parent, _name, true, 1, &value);
+    return;
+  }
+
   const char *cstr = value.c_str();
 
-  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to set attribute " + _name);
-  hid_gc_noref diskdatatype(H5Aget_type(attr), H5Tclose, "Could not get string datatype to set attribute " + _name);
+  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to set attribute ", _name);
+  hid_gc_noref diskdatatype(H5Aget_type(attr), H5Tclose, "Could not get string datatype to set attribute ", _name);
 
   if (h5stringIsVariable(diskdatatype)) {
     // string type on disk is variable -- just set it
-    hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create variable length string datatype to set attribute " + _name);
+    hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create variable length string datatype to set attribute ", _name);
 
     // write the attribute
     if (H5Awrite(attr, datatype, &cstr) < 0)
@@ -280,14 +390,14 @@ template<> inline void Attribute<std::string>::set( const std::string &value )
     size_t diskdatasize = H5Tget_size(diskdatatype);
     size_t requiredsize = value.size() + 1;
 
-    hid_gc_noref datatype(h5fixedStringType(requiredsize), H5Tclose, "Could not create fixed length string datatype to set attribute " + _name);
+    hid_gc_noref datatype(h5fixedStringType(requiredsize), H5Tclose, "Could not create fixed length string datatype to set attribute ", _name);
 
     if (diskdatasize < requiredsize) {
       // recreate as fixed string of the right size
       remove();
 
-      hid_gc_noref dataspace(h5scalar(), H5Sclose, "Could not create scalar dataspace to set attribute " + _name);
-      hid_gc_noref attr(H5Acreate2(parent, _name.c_str(), datatype, dataspace, H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "Could not create to set attribute " + _name);
+      hid_gc_noref dataspace(h5scalar(), H5Sclose, "Could not create scalar dataspace to set attribute ", _name);
+      hid_gc_noref attr(H5Acreate2(parent, _name.c_str(), datatype, dataspace, H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "Could not create to set attribute ", _name);
 
       // write the new attribute
       if (H5Awrite(attr, datatype, cstr) < 0)
@@ -303,18 +413,28 @@ template<> inline void Attribute<std::string>::set( const std::string &value )
 
 template<> inline std::string Attribute<std::string>::get() const
 {
+  const CachedAttribute *cached = parentAttributes.value(_name);
+  if (cached) {
+    if (!cached->isString || cached->nrElements != 1)
+      throw HDF5Exception("Could not get attribute " + _name);
+
+    return cached->strings[0];
+  }
+
+  commitWrites();
+
   // H5Aread will allocate memory for us (use free() to free)
 
   char *buf = 0;
   std::string value;
 
-  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to get attribute " + _name);
-  hid_gc_noref diskdatatype(H5Aget_type(attr), H5Tclose, "Could not get string datatype to get attribute " + _name);
+  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to get attribute ", _name);
+  hid_gc_noref diskdatatype(H5Aget_type(attr), H5Tclose, "Could not get string datatype to get attribute ", _name);
 
   if (h5stringIsVariable(diskdatatype)) {
     // string type on disk is variable -- just read it (HDF5 will allocate)
-    hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create variable length string datatype to get attribute " + _name);
-    hid_gc_noref dataspace(H5Aget_space(attr), H5Sclose, "Could not get dataspace of attribute " + _name);
+    hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create variable length string datatype to get attribute ", _name);
+    hid_gc_noref dataspace(H5Aget_space(attr), H5Sclose, "Could not get dataspace of attribute ", _name);
 
     if (H5Aread(attr, datatype, &buf) < 0)
       throw HDF5Exception("Could not get attribute " + _name);
@@ -344,7 +464,7 @@ template<> inline std::string Attribute<std::string>::get() const
     if (!buf)
       throw DALException("Could not allocate memory to get attribute " + _name);
 
-    hid_gc_noref datatype(h5fixedStringType(diskdatasize), H5Tclose, "Could not create fixed length string datatype to get attribute " + _name);
+    hid_gc_noref datatype(h5fixedStringType(diskdatasize), H5Tclose, "Could not create fixed length string datatype to get attribute ", _name);
 
     if (H5Aread(attr, datatype, buf) < 0)
       throw HDF5Exception("Could not get attribute " + _name);
@@ -360,16 +480,32 @@ template<> inline std::string Attribute<std::string>::get() const
 
 template<> inline Attribute< std::vector<std::string> >& Attribute< std::vector<std::string> >::create( size_t length )
 {
-  hid_gc_noref dataspace(h5array(length), H5Sclose, "Could not create simple dataspace to create attribute " + _name);
-  hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create string datatype to create attribute " + _name);
+  parentAttributes.forget(_name);
+
+  AttributeBatch *batch = writeBatch();
+  if (batch) {
+    batch->stageStrings(parent, _name, false, length, NULL);
+    return *this;
+  }
+
+  hid_gc_noref dataspace(h5array(length), H5Sclose, "Could not create simple dataspace to create attribute ", _name);
+  hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create string datatype to create attribute ", _name);
 
-  hid_gc_noref attr(H5Acreate2(parent, _name.c_str(), datatype, dataspace, H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "Could not create attribute " + _name);
+  hid_gc_noref attr(H5Acreate2(parent, _name.c_str(), datatype, dataspace, H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "Could not create attribute ", _name);
 
   return *this;
 }
 
 template<> inline void Attribute< std::vector<std::string> >::set( const std::vector<std::string> &value )
 {
+  parentAttributes.forget(_name);
+
+  AttributeBatch *batch = writeBatch();
+  if (batch) {
+    batch->stageStrings(parent, _name, false, value.size(), value.empty() ? NULL : &value[0]);
+    return;
+  }
+
   if (size() != value.size()) {
     // recreate the attribute to change the vector length on disk
     remove();
@@ -385,8 +521,8 @@ template<> inline void Attribute< std::vector<std::string> >::set( const std::ve
     c_strs[i] = value[i].c_str();
   }
 
-  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to set attribute " + _name);
-  hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create string datatype to set attribute " + _name);
+  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to set attribute ", _name);
+  hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create string datatype to set attribute ", _name);
 
   if (H5Awrite(attr, datatype, &c_strs[0]) < 0)
     throw HDF5Exception("Could not set attribute " + _name);
@@ -394,14 +530,25 @@ template<> inline void Attribute< std::vector<std::string> >::set( const std::ve
 
 template<> inline std::vector<std::string> Attribute< std::vector<std::string> >::get() const
 {
+  const CachedAttribute *cached = parentAttributes.value(_name);
+  if (cached) {
+    // like H5Aread below, only variable-length strings can be read
+    if (!cached->isString || (cached->nrElements > 0 && !cached->variableString))
+      throw HDF5Exception("Could not get attribute " + _name);
+
+    return cached->strings;
+  }
+
+  commitWrites();
+
   // H5Aread will allocate memory for us (use free() to free each element)
   std::vector<char *> c_strs(size(), 0);
   if (c_strs.empty())
     return std::vector<std::string>();
 
-  hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create string datatype to get attribute " + _name);
-  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to get attribute " + _name);
-  hid_gc_noref dataspace(H5Aget_space(attr), H5Sclose, "Could not get dataspace of attribute " + _name);
+  hid_gc_noref datatype(h5variableStringType(), H5Tclose, "Could not create string datatype to get attribute ", _name);
+  hid_gc_noref attr(H5Aopen(parent, _name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open to get attribute ", _name);
+  hid_gc_noref dataspace(H5Aget_space(attr), H5Sclose, "Could not get dataspace of attribute ", _name);
 
   if (H5Aread(attr, datatype, &c_strs[0]) < 0)
     throw HDF5Exception("Could not get attribute " + _name);
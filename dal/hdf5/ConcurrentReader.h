@@ -0,0 +1,120 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_CONCURRENT_READER_H
+#define DAL_CONCURRENT_READER_H
+
+#include <cstddef>
+#include <vector>
+#include <sys/types.h>
+#include "types/ExternalFileSet.h"
+#include "types/HDF5Lock.h"
+#include "exceptions/exceptions.h"
+
+namespace dal {
+
+template<typename T> class Dataset;
+
+/*!
+ * \class ConcurrentReader
+ *
+ * Reads a dataset stored in external raw files from several threads at once. The layout of
+ * the dataset is obtained from HDF5 once, after which reads go straight to pread() on cached
+ * file descriptors, without calling HDF5. This lets threads read at the aggregate bandwidth
+ * of the disks, instead of one at a time behind the HDF5 library.
+ *
+ * Copies are cheap and share the file descriptors, so each thread can use its own copy
+ * (a per-thread handle), or threads can share one.
+ *
+ * C++ example, reading all dipoles of a TBB station in parallel:
+ * \code
+ *    std::vector< ConcurrentReader<short> > readers;
+ *    {
+ *      HDF5Lock lock; // if other threads may use HDF5 already
+ *      std::vector<TBB_DipoleDataset> dipoles(station.dipoleDatasets());
+ *      for (size_t i = 0; i < dipoles.size(); i++)
+ *        readers.push_back(ConcurrentReader<short>(dipoles[i]));
+ *    }
+ *
+ *    // in thread i: no HDF5Lock needed
+ *    readers[i].get1D(0, buffer, readers[i].dims1D());
+ * \endcode
+ *
+ * Concurrent-read mode: only the constructor calls HDF5, holding the HDF5Lock. Threads that
+ * otherwise use DAL while readers are used concurrently must take the HDF5Lock around their
+ * DAL calls, unless the HDF5 library is built thread-safe.
+ *
+ * The dimensions are those at construction. Data appended to the external files later can be
+ * read by constructing a new reader. Data not written yet is read as zeros, as HDF5 does.
+ *
+ * Requires the dataset to use contiguous external storage, stored in the native format
+ * of T (see Dataset::externalFileSet()).
+ */
+template<typename T> class ConcurrentReader {
+public:
+  //! Refers to `dataset`, which can be destructed afterwards. Takes the HDF5Lock.
+  explicit ConcurrentReader( Dataset<T> &dataset );
+
+  //! Reads `files` as the raw data of a dataset with dimensions `dims`, stored in the native format of T.
+  ConcurrentReader( const std::vector<ssize_t> &dims, const ExternalFileSet &files );
+
+  //! Returns the rank of the dataset.
+  size_t ndims() const { return _dims.size(); }
+
+  //! Returns the dimension sizes of the dataset.
+  const std::vector<ssize_t> &dims() const { return _dims; }
+
+  /*!
+   * Returns the size of the 1D dataset.
+   *
+   * Requires:
+   *    ndims() == 1
+   */
+  ssize_t dims1D() const;
+
+  /*!
+   * Retrieves any matrix of data of sizes `size` from position `pos`, like Dataset::getMatrix().
+   * `buffer` must point to a memory block large enough to hold the result.
+   *
+   * Requires:
+   *    pos.size() == size.size() == ndims()
+   */
+  void getMatrix( const std::vector<size_t> &pos, T *buffer, const std::vector<size_t> &size ) const;
+
+  /*!
+   * Retrieves `len` values from position `pos` of a 1D dataset, like Dataset::get1D().
+   *
+   * Requires:
+   *    ndims() == 1
+   */
+  void get1D( size_t pos, T *outbuffer1, size_t len ) const;
+
+private:
+  std::vector<ssize_t> _dims;
+  ExternalFileSet files;
+
+  static ExternalFileSet openFiles( Dataset<T> &dataset, std::vector<ssize_t> &dims );
+};
+
+}
+
+#include "ConcurrentReader.tcc"
+
+// Dataset uses ConcurrentReader for asynchronous reads, so include it after the definition above
+#include "Dataset.h"
+
+#endif
+
@@ -0,0 +1,121 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+namespace dal {
+
+template<typename T> ExternalFileSet ConcurrentReader<T>::openFiles( Dataset<T> &dataset, std::vector<ssize_t> &dims )
+{
+  HDF5Lock lock;
+
+  dims = dataset.dims();
+  return dataset.externalFileSet();
+}
+
+template<typename T> ConcurrentReader<T>::ConcurrentReader( Dataset<T> &dataset )
+:
+  _dims(),
+  files(openFiles(dataset, _dims))
+{
+}
+
+template<typename T> ConcurrentReader<T>::ConcurrentReader( const std::vector<ssize_t> &dims, const ExternalFileSet &files )
+:
+  _dims(dims),
+  files(files)
+{
+}
+
+template<typename T> ssize_t ConcurrentReader<T>::dims1D() const
+{
+  if (ndims() != 1)
+    throw DALValueError("Cannot get size of 1D dataset for concurrent reader of a non-1D dataset");
+
+  return _dims[0];
+}
+
+template<typename T> void ConcurrentReader<T>::getMatrix( const std::vector<size_t> &pos, T *buffer, const std::vector<size_t> &size ) const
+{
+  const size_t rank = ndims();
+
+  if (pos.size() != rank)
+    throw DALValueError("getMatrix: Specified position has wrong number of dimensions for concurrent reader");
+
+  if (size.size() != rank)
+    throw DALValueError("getMatrix: Specified block size has wrong number of dimensions for concurrent reader");
+
+  size_t nelems = 1;
+  for (size_t i = 0; i < rank; i++) {
+    if (pos[i] > static_cast<size_t>(_dims[i]) || size[i] > static_cast<size_t>(_dims[i]) - pos[i])
+      throw DALIndexError("getMatrix: Cannot read beyond the end of the dataset for concurrent reader");
+
+    nelems *= size[i];
+  }
+
+  if (nelems == 0)
+    return;
+
+  /*
+   * Read in runs that are contiguous in both the dataset and the buffer:
+   * the innermost dimensions read in full, plus the (partial) dimension outside them.
+   */
+  size_t inner = rank - 1;
+  size_t run = size[inner];
+  while (inner > 0 && size[inner] == static_cast<size_t>(_dims[inner])) {
+    inner--;
+    run *= size[inner];
+  }
+
+  // strides of the dataset, in elements
+  std::vector<hsize_t> strides(rank, 1);
+  for (size_t i = rank - 1; i > 0; i--)
+    strides[i - 1] = strides[i] * _dims[i];
+
+  // iterate over the outer dimensions [0, inner)
+  std::vector<size_t> index(inner, 0);
+
+  for (;;) {
+    hsize_t offset = 0;
+    for (size_t i = 0; i < rank; i++)
+      offset += (pos[i] + (i < inner ? index[i] : 0)) * strides[i];
+
+    files.read(offset * sizeof(T), buffer, run * sizeof(T));
+    buffer += run;
+
+    // next outer index, last dimension fastest
+    size_t i = inner;
+    while (i > 0 && ++index[i - 1] == size[i - 1]) {
+      index[i - 1] = 0;
+      i--;
+    }
+
+    if (i == 0)
+      break;
+  }
+}
+
+template<typename T> void ConcurrentReader<T>::get1D( size_t pos, T *outbuffer1, size_t len ) const
+{
+  if (ndims() != 1)
+    throw DALValueError("get1D: Cannot use concurrent reader on a non-1D dataset");
+
+  const std::vector<size_t> vpos(1, pos);
+  const std::vector<size_t> vsize(1, len);
+
+  getMatrix(vpos, outbuffer1, vsize);
+}
+
+}
+
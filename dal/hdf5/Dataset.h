@@ -34,11 +34,19 @@
 #endif
 
 #include <string>
+#include <algorithm>
 #include <vector>
 #include <hdf5.h>
 #include "types/h5typemap.h"
+#include "types/ExternalFileSet.h"
+#include "types/HDF5Lock.h"
+#include "types/MemoryMap.h"
+#include "types/ObjectAccess.h"
+#include "types/transpose.h"
 #include "exceptions/exceptions.h"
 #include "Group.h"
+#include "IOExecutor.h"
+#include "ConcurrentReader.h"
 
 namespace dal {
 
@@ -93,7 +101,7 @@ template<typename T> class Dataset: public Group {
 public:
   enum Endianness { NATIVE = 0, LITTLE, BIG };
 
-  Dataset( Group &parent, const std::string &name ): Group(parent, name) {}
+  Dataset( Group &parent, const std::string &name ): Group(parent, name), shape(0), nextMemSpace(0), rawAccess(RAW_UNKNOWN) {}
 
   /*!
    * Destruct a Dataset object.
@@ -108,11 +116,15 @@ public:
    * the user, or will be created upon the first write. Note that the filename cannot be changed
    * after the dataset has been created (HDF5 1.8), so providing an absolute path will make the
    * dataset difficult to copy or move across systems. We strongly advice against absolute paths (and "../") here!
-   * Note that HDF5 1.8 has a problem accessing external files outside the current working directory.
-   * DAL works around this, but see Known Issue 1 on how the current working directory affects this.
+   * Relative external file names are resolved against the directory of the HDF5 file.
+   * HDF5 1.8 cannot do this by itself; DAL works around it, but see Known Issue 1 on how
+   * the current working directory affects this.
    *
    * If `filename' equals "", then dims == maxdims is required due to limitations of HDF5.
    *
+   * In IN_MEMORY files, `filename' is ignored: the data is stored in the in-memory file,
+   * which uses chunked storage to allow dims != maxdims.
+   *
    * `endianness` toggles the byte order of each stored data value. Typically:
    *  - NATIVE: use the endianness of the current machine
    *  - LITTLE: use little-endian: x86, x86_64, ARM
@@ -169,11 +181,64 @@ public:
    */
   void resize1D( ssize_t newlen );
 
+  /*!
+   * Re-reads the dimensions of this dataset from HDF5.
+   *
+   * The rank and dimensions are cached when the dataset is opened or created, and are shared
+   * by all Dataset objects referring to the same dataset in the same File. resize() keeps the
+   * cache up to date, but if another process (or another File object) changes the dimensions,
+   * call refreshShape() before relying on ndims(), dims() or maxdims() again.
+   */
+  void refreshShape();
+
+  /*!
+   * Discards the metadata of this dataset that HDF5 has cached, and re-reads its dimensions.
+   * In a file opened with SWMR_READ, this picks up the extent to which the writer has grown
+   * the dataset. See also DatasetFollower.
+   *
+   * HDF5 reopens the dataset to refresh it, so no other Dataset objects for it (including copies
+   * of this one) may exist at the time: a DALException is thrown if they do. Other threads are
+   * held off using HDF5Lock.
+   *
+   * With HDF5 1.8, only the dimensions are re-read, see refreshShape().
+   */
+  void refresh();
+
   /*!
    * Returns a list of the external files containing data for this dataset.
    */
   std::vector<std::string> externalFiles();
 
+  /*!
+   * Maps `len` data values starting at index `pos` into memory, and returns a read-only view on them.
+   * Indices address the dataset as a flat array in row-major order (the last dimension varies fastest).
+   * The data is read directly from the external file by the operating system (through the page cache),
+   * bypassing HDF5 type conversion and copying. The view remains valid after this Dataset object is destructed.
+   *
+   * Requires:
+   *    - externalFiles() is not empty (the dataset uses contiguous external storage)
+   *    - the data is stored in the native format of T, in particular in native byte order
+   *    - the region is stored within a single external file, and that file contains the full region
+   *    - pos + len <= total number of data values in the dataset
+   *
+   * A DALValueError is thrown if these requirements are not met; use getMatrix() or get1D() instead.
+   */
+  MappedRegion<T> mapRegion( size_t pos, size_t len );
+
+#ifndef SWIG
+  /*!
+   * Returns the external files of this dataset, to read its raw data with pread() instead of HDF5
+   * (see ConcurrentReader). Relative file names are resolved against the directory of the HDF5 file.
+   *
+   * Requires:
+   *    - externalFiles() is not empty (the dataset uses contiguous external storage)
+   *    - the data is stored in the native format of T, in particular in native byte order
+   *
+   * A DALValueError is thrown if these requirements are not met.
+   */
+  ExternalFileSet externalFileSet();
+#endif
+
   /*!
    * Retrieves any matrix of data of sizes `size` from position `pos`.
    * `buffer` must point to a memory block large enough to hold the result.
@@ -191,10 +256,75 @@ public:
    */
   void setMatrix( const std::vector<size_t> &pos, const T *buffer, const std::vector<size_t> &size );
 
+  /*!
+   * Starts retrieving a matrix of data of sizes `size` from position `pos`, like getMatrix(),
+   * on `executor`, and returns immediately. Use the returned IOFuture to wait for the data.
+   * `buffer` must remain valid until then. If the dataset is stored in external raw files
+   * in the native format of T, the data is read with pread() in parallel with other requests.
+   * Otherwise, the request is serialized with all other HDF5 calls of the executor.
+   *
+   * See IOExecutor on using DAL from the calling thread while requests are in flight.
+   *
+   * C++ example, keeping a read in flight while processing the previous block:
+   * \code
+   *    IOFuture next = dataset.getMatrixAsync(pos, buffers[0], size);
+   *    for (size_t i = 0; i < nrBlocks; i++) {
+   *      next.wait();
+   *      if (i + 1 < nrBlocks) {
+   *        pos[0] += size[0];
+   *        HDF5Lock lock;
+   *        next = dataset.getMatrixAsync(pos, buffers[(i + 1) % 2], size);
+   *      }
+   *      process(buffers[i % 2]);
+   *    }
+   * \endcode
+   *
+   * Requires:
+   *    pos.size() == size.size() == ndims()
+   */
+  IOFuture getMatrixAsync( const std::vector<size_t> &pos, T *buffer, const std::vector<size_t> &size,
+                           IOExecutor &executor = IOExecutor::global() );
+
+  /*!
+   * Starts storing a matrix of data of sizes `size` at position `pos`, like setMatrix(),
+   * on `executor`, and returns immediately. `buffer` must remain valid and unchanged until
+   * the returned IOFuture is ready. Writes are serialized with all other HDF5 calls of the executor.
+   *
+   * Requires:
+   *    pos.size() == size.size() == ndims()
+   */
+  IOFuture setMatrixAsync( const std::vector<size_t> &pos, const T *buffer, const std::vector<size_t> &size,
+                           IOExecutor &executor = IOExecutor::global() );
+
+#ifndef SWIG
+  /*!
+   * Fixed-rank variant of getMatrix(), for example:
+   * \code
+   *    const size_t pos[2] = { 10, 20 }, size[2] = { 1, 16 };
+   *    dataset.getMatrix(pos, buffer, size);
+   * \endcode
+   * Positions and sizes are kept on the stack and the dataspaces of the previous call
+   * are reused, so small, repeated reads do not allocate memory.
+   *
+   * Requires:
+   *    N == ndims()
+   */
+  template<size_t N> void getMatrix( const size_t (&pos)[N], T *buffer, const size_t (&size)[N] );
+
+  /*!
+   * Fixed-rank variant of setMatrix(), see the fixed-rank getMatrix().
+   *
+   * Requires:
+   *    N == ndims()
+   */
+  template<size_t N> void setMatrix( const size_t (&pos)[N], const T *buffer, const size_t (&size)[N] );
+#endif /* !SWIG */
+
   /*!
    * Retrieves `len` data values from a dataset starting at index `pos`.
    * `outbuffer` must point to a memory block large enough to hold `len` data values.
    * If the underlying dataset is multi-dimensional, use `dimIndex` to indicate the dimension to retrieve from.
+   * The other dimensions are read at index 0.
    *
    * \param[in] pos               index of the first data value
    * \param[out] outbuffer        1D destination array
@@ -208,10 +338,33 @@ public:
    */
   void get1D( size_t pos, T *outbuffer, size_t len, unsigned dimIndex = 0 );
 
+  /*!
+   * Starts retrieving `len` data values starting at index `pos` of the first dimension,
+   * like get1D(), on the global IOExecutor (see getMatrixAsync()). The other dimensions
+   * are read at index 0. `outbuffer` must remain valid until the returned IOFuture is ready.
+   *
+   * Not available in Python: the IOFuture does not keep the buffer alive, and Python code
+   * cannot take the HDF5Lock needed to call DAL while the request is in flight (see IOExecutor).
+   *
+   * C++ example:
+   * \code
+   *    std::vector<float> x(256);
+   *    IOFuture future = dataset.get1DAsync(0, &x[0], x.size());
+   *    // ... do other work, but call DAL only while holding the HDF5Lock
+   *    future.wait();
+   * \endcode
+   *
+   * Requires:
+   *    - pos + len <= dims()[0]
+   *    - len <= size of outbuffer
+   */
+  IOFuture get1DAsync( size_t pos, T *outbuffer, size_t len );
+
   /*!
    * Stores `len` data values from a dataset starting at index `pos`.
    * `inbuffer` must contain at least `len` data values.
    * If the underlying dataset is multi-dimensional, use `dimIndex` to indicate the dimension to store to.
+   * The other dimensions are written at index 0.
    *
    * \param[in] pos               index of the first data value
    * \param[in] inbuffer          1D source array
@@ -229,6 +382,10 @@ public:
    * Retrieves a 2D matrix of data from a 2D dataset from position `pos`.
    * `buffer` must point to a memory block large enough to hold the result.
    *
+   * The dimensions can be addressed in any order. If dim1index > dim2index, the
+   * result is transposed with respect to the order on disk. Such reads, as well as
+   * reads of thin columns, are done in blocks of whole rows which are rearranged in memory.
+   *
    * \param[in] pos               position of the first sample
    * \param[out] outbuffer2       2D destination array
    * \param[in] dim1              size of first dimension of outbuffer2; determines the number of data values to retrieve
@@ -239,7 +396,8 @@ public:
    * Requires:
    *    - ndims() >= 2
    *    - pos.size() == ndims()
-   *    - dim1index < dim2index < ndims()
+   *    - dim1index != dim2index
+   *    - dim1index, dim2index < ndims()
    */
   void get2D( const std::vector<size_t> &pos, T *outbuffer2, size_t dim1, size_t dim2, unsigned dim1index = 0, unsigned dim2index = 1 );
 
@@ -264,6 +422,8 @@ public:
    * Retrieves a 3D matrix of data from a 3D dataset from position `pos`.
    * `buffer` must point to a memory block large enough to hold the result.
    *
+   * The dimensions can be addressed in any order, see get2D().
+   *
    * \param[in] pos               position of the first sample
    * \param[out] outbuffer3       3D destination array
    * \param[in] dim1              size of first dimension of outbuffer3; determines the number of data values to retrieve
@@ -276,7 +436,8 @@ public:
    * Requires:
    *    - ndims() >= 3
    *    - pos.size() == ndims()
-   *    - dim1index < dim2index < dim3index < ndims()
+   *    - dim1index, dim2index, dim3index are distinct
+   *    - dim1index, dim2index, dim3index < ndims()
    */
   void get3D( const std::vector<size_t> &pos, T *outbuffer3, size_t dim1, size_t dim2, size_t dim3, unsigned dim1index = 0, unsigned dim2index = 1, unsigned dim3index = 2 );
 
@@ -299,6 +460,54 @@ public:
    */
   void set3D( const std::vector<size_t> &pos, const T *inbuffer3, size_t dim1, size_t dim2, size_t dim3, unsigned dim1index = 0, unsigned dim2index = 1, unsigned dim3index = 2 );
 
+  /*!
+   * Retrieves several blocks of data in a single transfer. Block i is located at
+   * position `positions[i]` and has sizes `sizes[i]`. The blocks may not overlap.
+   *
+   * The data is packed into `outbuffer` in the order in which it is stored in the dataset
+   * (row-major), not in the order of the blocks. For example, blocks that each cover all
+   * rows of a 2D dataset result in a matrix of all rows, restricted to the selected columns.
+   *
+   * Requires:
+   *    - positions.size() == sizes.size()
+   *    - positions[i].size() == sizes[i].size() == ndims()
+   *    - outbuffer can hold the sum of the block sizes
+   */
+  void gather( const std::vector< std::vector<size_t> > &positions, const std::vector< std::vector<size_t> > &sizes, T *outbuffer );
+
+  /*!
+   * Stores several blocks of data in a single transfer. See gather() for the layout of `inbuffer`.
+   */
+  void scatter( const std::vector< std::vector<size_t> > &positions, const std::vector< std::vector<size_t> > &sizes, const T *inbuffer );
+
+  /*!
+   * Retrieves the values at the given points in a single transfer. The value
+   * at `points[i]` is stored at `outbuffer[i]`.
+   *
+   * Requires:
+   *    - points[i].size() == ndims()
+   *    - outbuffer can hold points.size() values
+   */
+  void gather( const std::vector< std::vector<size_t> > &points, T *outbuffer );
+
+  /*!
+   * Stores the values at the given points in a single transfer. The value
+   * `inbuffer[i]` is stored at `points[i]`.
+   */
+  void scatter( const std::vector< std::vector<size_t> > &points, const T *inbuffer );
+
+  /*!
+   * Retrieves the values at the given indices along dimension `dimIndex` in a single transfer.
+   * The other dimensions are read at index 0, as for get1D().
+   */
+  void gather1D( const std::vector<size_t> &points, T *outbuffer, unsigned dimIndex = 0 );
+
+  /*!
+   * Stores the values at the given indices along dimension `dimIndex` in a single transfer.
+   * The other dimensions are written at index 0, as for set1D().
+   */
+  void scatter1D( const std::vector<size_t> &points, const T *inbuffer, unsigned dimIndex = 0 );
+
   /*!
    * Retrieves a single value from the dataset at position `pos`.
    *
@@ -307,6 +516,16 @@ public:
    */
   T getScalar( const std::vector<size_t> &pos );
 
+#ifndef SWIG
+  /*!
+   * Fixed-rank variant of getScalar(), see the fixed-rank getMatrix().
+   *
+   * Requires:
+   *    N == ndims()
+   */
+  template<size_t N> T getScalar( const size_t (&pos)[N] );
+#endif /* !SWIG */
+
   /*!
    * See Dataset::getScalar().
    */
@@ -320,6 +539,16 @@ public:
    */
   void setScalar( const std::vector<size_t> &pos, const T &value );
 
+#ifndef SWIG
+  /*!
+   * Fixed-rank variant of setScalar(), see the fixed-rank getMatrix().
+   *
+   * Requires:
+   *    N == ndims()
+   */
+  template<size_t N> void setScalar( const size_t (&pos)[N], const T &value );
+#endif /* !SWIG */
+
   /*!
    * See Dataset::setScalar().
    */
@@ -332,9 +561,46 @@ protected:
    */
   bool bigEndian( enum Endianness endianness ) const;
 
+  /*!
+   * Returns the cached shape of this dataset. Opens the dataset if needed.
+   */
+  const DatasetShape &cachedShape();
+
+  /*!
+   * Reads the block of sizes `size` at position `pos` (each `rank` long) into `buffer`, storing the
+   * element at pos + (i0, i1, ...) at buffer[i0 * outStrides[0] + i1 * outStrides[1] + ...].
+   *
+   * Blocks that are stored in the same order on disk and in memory, and that
+   * consist of long enough contiguous runs, are read directly. Anything else is read
+   * in blocks of rows of at most readBlockBytes, which are rearranged in memory.
+   * If the runs on disk are short, whole rows are read to avoid strided I/O.
+   */
+  void plannedRead( size_t rank, const size_t *pos, const size_t *size, T *buffer, const size_t *outStrides );
+
+  //! Maximum size of the intermediate blocks used by plannedRead().
+  static const size_t readBlockBytes = 4 * 1024 * 1024;
+
+  //! Contiguous runs on disk shorter than this are read as whole rows by plannedRead().
+  static const size_t minRunBytes = 4096;
+
   //! If the strides vector is empty, a continuous array is assumed.
   void matrixIO( const std::vector<size_t> &pos, T *buffer, const std::vector<size_t> &size, const std::vector<size_t> &strides, bool read );
 
+  /*!
+   * Variant of matrixIO() for a continuous array, with `rank` elements in `pos` and `size`.
+   * Does not allocate memory from the heap: the file and memory dataspaces are cached.
+   */
+  void rawMatrixIO( size_t rank, const size_t *pos, const size_t *size, T *buffer, bool read );
+
+  //! Transfers the union of the given blocks, packed in `buffer`.
+  void blocksIO( const std::vector< std::vector<size_t> > &positions, const std::vector< std::vector<size_t> > &sizes, T *buffer, bool read );
+
+  //! Transfers the points with coordinates `coords` (ndims() per point), packed in `buffer`.
+  void pointsIO( const std::vector<hsize_t> &coords, T *buffer, bool read );
+
+  //! Performs the actual H5Dread or H5Dwrite for the given selections.
+  void transfer( hid_t memspace, hid_t dataspace, T *buffer, bool read );
+
 
   /*!
    * Do not use this create function.
@@ -346,7 +612,53 @@ protected:
   }
 
 private:
+  //! Shape cache entry, owned by fileInfo. NULL until the dataset is opened or created.
+  DatasetShape *shape;
+
+  //! Dataspace of the dataset with the extent in fileSpaceDims, reused for selections.
+  hid_gc fileSpace;
+  std::vector<hsize_t> fileSpaceDims;
+
+  //! Recently used 1D memory dataspaces for rawMatrixIO(), replaced round-robin.
+  static const size_t nrMemSpaces = 4;
+
+  struct MemSpace {
+    hsize_t nrElements;
+    hid_gc space;
+  } memSpaces[nrMemSpaces];
+
+  size_t nextMemSpace;
+
+  //! Whether the data can be read from external files without HDF5, for getMatrixAsync().
+  enum { RAW_UNKNOWN, RAW_YES, RAW_NO } rawAccess;
+  ExternalFileSet rawFiles;
+
+  //! Returns whether the data can be read from rawFiles, finding out if needed. Requires the HDF5Lock.
+  bool rawReadable();
+
+  //! Requests for getMatrixAsync() and setMatrixAsync(), through HDF5 or from rawFiles.
+  class MatrixRequest;
+  class RawReadRequest;
+
+  //! Returns the cached dataspace of the dataset, recreating it if the dataset was resized.
+  hid_t cachedFileSpace();
+
+  //! Returns a 1D memory dataspace of `nrElements`, reusing a recent one if possible.
+  hid_t cachedMemSpace( hsize_t nrElements );
+
   virtual void open( hid_t parent, const std::string &name );
+
+  //! Points `shape` to the shared cache entry of this dataset. Requires the dataset to be open.
+  void initShape();
+
+  //! Fills the shape cache entry from HDF5. Requires initShape().
+  void readShape();
+
+  /*!
+   * Opens external file `filename` read-only. Relative names are resolved against the directory
+   * of the HDF5 file, as DAL does for HDF5 I/O (see matrixIO()). Returns the file descriptor.
+   */
+  int openExternalFile( const std::string &filename ) const;
 };
 
 }
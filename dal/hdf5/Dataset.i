@@ -55,6 +55,14 @@ DATASETTYPE(std::complex<float>, NPY_CFLOAT, size_t);
 // cannot be marshalled.
 %ignore *::getMatrix;
 %ignore *::setMatrix;
+%ignore *::getMatrixAsync;
+%ignore *::setMatrixAsync;
+%ignore *::get1DAsync;
+%ignore *::mapRegion;
+%ignore *::gather;
+%ignore *::scatter;
+%ignore *::gather1D;
+%ignore *::scatter1D;
 
 %include hdf5/Dataset.h
 
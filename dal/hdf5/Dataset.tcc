@@ -35,21 +35,47 @@ template<typename T> Dataset<T>& Dataset<T>::create( const std::vector<ssize_t>
   }
 
   // define the layout and the location of the data
-  hid_gc_noref filespace(H5Screate_simple(rank, &hdims[0], &hmaxdims[0]), H5Sclose, "Could not create simple dataspace " + _name);
+  hid_gc_noref filespace(H5Screate_simple(rank, &hdims[0], &hmaxdims[0]), H5Sclose, "Could not create simple dataspace ", _name);
 
-  hid_gc_noref dcpl(H5Pcreate(H5P_DATASET_CREATE), H5Pclose, "Could not create dataset creation property list to create dataset " + _name);
+  hid_gc_noref dcpl(H5Pcreate(H5P_DATASET_CREATE), H5Pclose, "Could not create dataset creation property list to create dataset ", _name);
 
   // avoid HDF5 chunked storage: not faster for our dense data sets and riskier integrity-wise
   H5Pset_layout(dcpl, H5D_CONTIGUOUS);
 
-  if (filename != "") {
+  if (filename != "" && fileMode() == IN_MEMORY) {
+    // External files would be written to disk, so keep the data in the in-memory file instead.
+    // HDF5 only supports growing datasets inside the file with chunked storage.
+    if (hmaxdims != hdims) {
+      // chunks of about 1 MiB, spanning all but the first dimension
+      std::vector<hsize_t> chunk(rank);
+      size_t chunkSize = sizeof(T);
+
+      for (size_t i = 1; i < rank; i++) {
+        chunk[i] = std::max<hsize_t>(1, hmaxdims[i] == H5S_UNLIMITED ? hdims[i] : hmaxdims[i]);
+        chunkSize *= chunk[i];
+      }
+
+      chunk[0] = std::max<hsize_t>(1, 1024 * 1024 / chunkSize);
+      if (hmaxdims[0] != H5S_UNLIMITED)
+        chunk[0] = std::min(chunk[0], std::max<hsize_t>(1, hmaxdims[0]));
+
+      if (H5Pset_chunk(dcpl, rank, &chunk[0]) < 0)
+        throw HDF5Exception("Could not set chunk size to create dataset " + _name);
+    }
+  } else if (filename != "") {
     if (H5Pset_external(dcpl, filename.c_str(), 0, H5F_UNLIMITED) < 0)
       throw HDF5Exception("Could not add external file to create dataset " + _name);
   }
 
   // create the dataset
   _group = hid_gc(H5Dcreate2(parent, _name.c_str(), h5typemap<T>::dataType(bigEndian(endianness)),
-                  filespace, H5P_DEFAULT, dcpl, H5P_DEFAULT), H5Dclose, "Could not create dataset " + _name);
+                  filespace, H5P_DEFAULT, dcpl, datasetAccessList()), H5Dclose, "Could not create dataset ", _name);
+
+  // we just defined the shape, so no need to query HDF5 for it
+  initShape();
+  shape->dims.swap(hdims);
+  shape->maxdims.swap(hmaxdims);
+
   initNodes();
 
   return *this;
@@ -65,36 +91,14 @@ template<typename T> Dataset<T>& Dataset<T>::create1D( ssize_t len, ssize_t maxl
 
 template<typename T> size_t Dataset<T>::ndims()
 {
-  // TODO: this routine is often used for bounds checks. However, caching
-  // ndims() might lead to concurrency issues. Maybe only cache if data
-  // is read-only or only allow access through this API?
-
-  hid_gc_noref dataspace(H5Dget_space(group()), H5Sclose, "Could not get dataspace to get number of dimensions of dataset " + _name);
-
-  int rank = H5Sget_simple_extent_ndims(dataspace);
-
-  if (rank < 0)
-    throw HDF5Exception("Could not get number of dimensions of dataset " + _name);
-
-  return rank;
+  return cachedShape().dims.size();
 }
 
 template<typename T> std::vector<ssize_t> Dataset<T>::dims()
 {
-  const size_t rank = ndims();
-  std::vector<hsize_t> dims(rank);
-  std::vector<ssize_t> result(rank);
-
-  hid_gc_noref dataspace(H5Dget_space(group()), H5Sclose, "Could not get dataspace to get number of dimensions of dataset " + _name);
-
-  if (H5Sget_simple_extent_dims(dataspace, &dims[0], NULL) < 0)
-    throw HDF5Exception("Could not get number of dimensions of dataset " + _name);
+  const DatasetShape &s = cachedShape();
 
-  for (size_t i = 0; i < rank; i++) {
-    result[i] = dims[i];
-  }
-
-  return result;
+  return std::vector<ssize_t>(s.dims.begin(), s.dims.end());
 }
 
 template<typename T> ssize_t Dataset<T>::dims1D()
@@ -104,20 +108,10 @@ template<typename T> ssize_t Dataset<T>::dims1D()
 
 template<typename T> std::vector<ssize_t> Dataset<T>::maxdims()
 {
-  const size_t rank = ndims();
-  std::vector<hsize_t> maxdims(rank);
-  std::vector<ssize_t> result(rank);
-
-  hid_gc_noref dataspace(H5Dget_space(group()), H5Sclose, "Could not get dataspace to get maximum dimensions of dataset " + _name);
-
-  if (H5Sget_simple_extent_dims(dataspace, NULL, &maxdims[0]) < 0)
-    throw HDF5Exception("Could not get maximum dimensions of dataset " + _name);
-
-  for (size_t i = 0; i < rank; i++) {
-    result[i] = maxdims[i];
-  }
+  const DatasetShape &s = cachedShape();
 
-  return result;
+  // H5S_UNLIMITED converts to -1
+  return std::vector<ssize_t>(s.maxdims.begin(), s.maxdims.end());
 }
 
 template<typename T> ssize_t Dataset<T>::maxdims1D()
@@ -139,6 +133,8 @@ template<typename T> void Dataset<T>::resize( const std::vector<ssize_t> &newdim
 
   if (H5Dset_extent(group(), &newdims_hsize_t[0]) < 0)
     throw HDF5Exception("Could not resize dataset " + _name);
+
+  shape->dims.swap(newdims_hsize_t);
 }
 
 template<typename T> void Dataset<T>::resize1D( ssize_t newlen )
@@ -147,9 +143,80 @@ template<typename T> void Dataset<T>::resize1D( ssize_t newlen )
   Dataset<T>::resize(newdims);
 }
 
+template<typename T> void Dataset<T>::refreshShape()
+{
+  // opening the dataset reads its shape, so only query if it was already open
+  if (!_group.isset()) {
+    group();
+    return;
+  }
+
+  if (!shape)
+    initShape();
+
+  readShape();
+}
+
+template<typename T> void Dataset<T>::refresh()
+{
+#if defined(H5_VERSION_GE) && H5_VERSION_GE(1, 10, 0)
+  if (_group.isset()) {
+    // other threads (see IOExecutor, DatasetStreamReader) may use the id that HDF5 reopens
+    HDF5Lock lock;
+
+    /* H5Drefresh() reopens the dataset under the same id, which fails for ids with more than
+       one reference, and closes the dataset under any other id. Copies of this object and other
+       Dataset objects would be left with a closed id, so refuse those, and drop our own extra
+       references while refreshing. */
+    const int refs = H5Iget_ref(_group);
+    if (refs < 0)
+      throw HDF5Exception("Could not get reference count of dataset " + _name);
+
+    if (refs > ownReferences() || openUnderOtherId(_group))
+      throw DALException("Cannot refresh dataset " + _name + ": other Dataset objects for it are still in use");
+
+    for (int r = 1; r < refs; r++)
+      H5Idec_ref(_group);
+
+    const herr_t result = H5Drefresh(_group);
+
+    if (H5Iis_valid(_group) <= 0) {
+      forgetGroup();
+      throw HDF5Exception("Could not refresh dataset " + _name + "; it was closed and can no longer be used");
+    }
+
+    for (int r = 1; r < refs; r++)
+      H5Iinc_ref(_group);
+
+    if (result < 0)
+      throw HDF5Exception("Could not refresh dataset " + _name);
+
+    // HDF5 reopened the dataset, possibly without our external file prefix
+    if (!shape)
+      initShape();
+
+    shape->efilePrefixLost = !hasExternalFilePrefix(_group);
+  }
+#endif
+
+  refreshShape();
+}
+
+template<typename T> const DatasetShape &Dataset<T>::cachedShape()
+{
+  if (!shape)
+    refreshShape();
+
+  return *shape;
+}
+
 template<typename T> std::vector<std::string> Dataset<T>::externalFiles()
 {
-  hid_gc_noref dcpl(H5Dget_create_plist(group()), H5Pclose, "Could not open dataset creation property list to get external files of dataset " + _name);
+  const IndexedObject *indexed = indexedObject();
+  if (indexed)
+    return indexed->externalFiles;
+
+  hid_gc_noref dcpl(H5Dget_create_plist(group()), H5Pclose, "Could not open dataset creation property list to get external files of dataset ", _name);
 
   int numfiles = H5Pget_external_count(dcpl);
 
@@ -172,6 +239,126 @@ template<typename T> std::vector<std::string> Dataset<T>::externalFiles()
   return files;
 }
 
+template<typename T> MappedRegion<T> Dataset<T>::mapRegion( size_t pos, size_t len )
+{
+  const DatasetShape &s = cachedShape();
+
+  hsize_t nelems = 1;
+  for (size_t i = 0; i < s.dims.size(); i++)
+    nelems *= s.dims[i];
+
+  if (pos > nelems || len > nelems - pos)
+    throw DALIndexError("Cannot map region beyond the end of dataset " + _name);
+
+  if (len == 0)
+    return MappedRegion<T>();
+
+  // only map raw data if no conversion is needed to interpret it as T
+  hid_gc_noref datatype(H5Dget_type(group()), H5Tclose, "Could not get datatype to map region of dataset ", _name);
+
+  if (H5Tequal(datatype, h5typemap<T>::memoryType()) <= 0)
+    throw DALValueError("Cannot map region if data is not stored in native format (e.g. byte order) in dataset " + _name);
+
+  hid_gc_noref dcpl(H5Dget_create_plist(group()), H5Pclose, "Could not open dataset creation property list to map region of dataset ", _name);
+
+  if (H5Pget_layout(dcpl) != H5D_CONTIGUOUS)
+    throw DALValueError("Cannot map region of non-contiguous dataset " + _name);
+
+  const int numfiles = H5Pget_external_count(dcpl);
+
+  if (numfiles < 0)
+    throw HDF5Exception("Could not get number of external files to map region of dataset " + _name);
+
+  if (numfiles == 0)
+    throw DALValueError("Cannot map region of dataset without external files " + _name);
+
+  // byte range requested, as a location in the concatenation of the external file segments
+  const hsize_t begin = pos * sizeof(T);
+  const hsize_t end   = begin + len * sizeof(T);
+
+  hsize_t segmentStart = 0;
+
+  for (int i = 0; i < numfiles; i++) {
+    char buf[1024];
+    off_t fileOffset;
+    hsize_t segmentSize;
+
+    if (H5Pget_external(dcpl, i, sizeof buf, buf, &fileOffset, &segmentSize) < 0)
+      throw HDF5Exception("Could not get external file to map region of dataset " + _name);
+
+    // null-terminate in case file name is >=1024 characters long
+    buf[sizeof buf - 1] = 0;
+
+    // H5F_UNLIMITED (last segment only) converts to a very large size
+    const hsize_t segmentEnd = segmentSize == H5F_UNLIMITED ? end : segmentStart + segmentSize;
+
+    if (begin >= segmentEnd) {
+      segmentStart = segmentEnd;
+      continue;
+    }
+
+    if (end > segmentEnd)
+      throw DALValueError("Cannot map region stored in multiple external files of dataset " + _name);
+
+    const off_t offset = fileOffset + (begin - segmentStart);
+
+    struct ScopedFD {
+      int fd;
+      ~ScopedFD() { ::close(fd); }
+    } sfd = { openExternalFile(buf) };
+
+    struct stat st;
+    if (::fstat(sfd.fd, &st) != 0)
+      throw DALException("Could not stat external file " + std::string(buf) + " to map region of dataset " + _name);
+
+    // mapped pages beyond the end of the file cannot be accessed
+    if (st.st_size < offset + static_cast<off_t>(end - begin))
+      throw DALValueError("Cannot map region not (yet) present in external file " + std::string(buf) + " of dataset " + _name);
+
+    return MappedRegion<T>(MemoryMap(sfd.fd, offset, end - begin));
+  }
+
+  throw DALValueError("Cannot map region beyond the external files of dataset " + _name);
+}
+
+template<typename T> ExternalFileSet Dataset<T>::externalFileSet()
+{
+  // raw data is only usable as T if no conversion is needed
+  hid_gc_noref datatype(H5Dget_type(group()), H5Tclose, "Could not get datatype to access external files of dataset ", _name);
+
+  if (H5Tequal(datatype, h5typemap<T>::memoryType()) <= 0)
+    throw DALValueError("Cannot access external files if data is not stored in native format (e.g. byte order) in dataset " + _name);
+
+  hid_gc_noref dcpl(H5Dget_create_plist(group()), H5Pclose, "Could not open dataset creation property list to access external files of dataset ", _name);
+
+  if (H5Pget_layout(dcpl) != H5D_CONTIGUOUS)
+    throw DALValueError("Cannot access external files of non-contiguous dataset " + _name);
+
+  const int numfiles = H5Pget_external_count(dcpl);
+
+  if (numfiles < 0)
+    throw HDF5Exception("Could not get number of external files of dataset " + _name);
+
+  if (numfiles == 0)
+    throw DALValueError("Cannot access external files of dataset without external files " + _name);
+
+  std::vector<ExternalFileSet::Segment> segments(numfiles);
+
+  for (int i = 0; i < numfiles; i++) {
+    char buf[1024];
+
+    if (H5Pget_external(dcpl, i, sizeof buf, buf, &segments[i].offset, &segments[i].size) < 0)
+      throw HDF5Exception("Could not get external file of dataset " + _name);
+
+    // null-terminate in case file name is >=1024 characters long
+    buf[sizeof buf - 1] = 0;
+
+    segments[i].filename = buf;
+  }
+
+  return ExternalFileSet(segments, fileDirfd());
+}
+
 template<typename T> void Dataset<T>::getMatrix( const std::vector<size_t> &pos,
         T *buffer, const std::vector<size_t> &size )
 {
@@ -188,173 +375,481 @@ template<typename T> void Dataset<T>::setMatrix( const std::vector<size_t> &pos,
   matrixIO(pos, const_cast<T *>(buffer), size, strides, false);
 }
 
+template<typename T> class Dataset<T>::MatrixRequest: public IORequest {
+public:
+  MatrixRequest( const Dataset<T> &dataset, const std::vector<size_t> &pos, T *buffer, const std::vector<size_t> &size, bool read )
+  : dataset(dataset), pos(pos), size(size), buffer(buffer), read(read) {}
+
+  virtual bool usesHDF5() const { return true; }
+
+  virtual void run() {
+    if (read)
+      dataset.getMatrix(pos, buffer, size);
+    else
+      dataset.setMatrix(pos, buffer, size);
+  }
+
+private:
+  Dataset<T> dataset; // a copy, so the caller's object can be destructed
+  const std::vector<size_t> pos, size;
+  T *buffer;
+  const bool read;
+};
+
+template<typename T> class Dataset<T>::RawReadRequest: public IORequest {
+public:
+  RawReadRequest( const ConcurrentReader<T> &reader, const std::vector<size_t> &pos, T *buffer, const std::vector<size_t> &size )
+  : reader(reader), pos(pos), size(size), buffer(buffer) {}
+
+  virtual bool usesHDF5() const { return false; }
+
+  virtual void run() {
+    reader.getMatrix(pos, buffer, size);
+  }
+
+private:
+  const ConcurrentReader<T> reader;
+  const std::vector<size_t> pos, size;
+  T *buffer;
+};
+
+template<typename T> bool Dataset<T>::rawReadable()
+{
+  if (rawAccess == RAW_UNKNOWN) {
+    try {
+      rawFiles = externalFileSet();
+      rawAccess = RAW_YES;
+    } catch (DALValueError &) {
+      // not stored in native format in contiguous external files
+      rawAccess = RAW_NO;
+    }
+  }
+
+  return rawAccess == RAW_YES;
+}
+
+template<typename T> IOFuture Dataset<T>::getMatrixAsync( const std::vector<size_t> &pos,
+        T *buffer, const std::vector<size_t> &size, IOExecutor &executor )
+{
+  // the executor may be calling HDF5 on other requests
+  HDF5Lock lock;
+
+  if (rawReadable()) {
+    const std::vector<hsize_t> &hdims = cachedShape().dims;
+    const std::vector<ssize_t> dims(hdims.begin(), hdims.end());
+
+    return executor.submit(new RawReadRequest(ConcurrentReader<T>(dims, rawFiles), pos, buffer, size));
+  }
+
+  return executor.submit(new MatrixRequest(*this, pos, buffer, size, true));
+}
+
+template<typename T> IOFuture Dataset<T>::setMatrixAsync( const std::vector<size_t> &pos,
+        const T *buffer, const std::vector<size_t> &size, IOExecutor &executor )
+{
+  HDF5Lock lock;
+
+  return executor.submit(new MatrixRequest(*this, pos, const_cast<T *>(buffer), size, false));
+}
+
 template<typename T> void Dataset<T>::get2D( const std::vector<size_t> &pos,
         T *outbuffer2, size_t dim1, size_t dim2, unsigned dim1index, unsigned dim2index )
 {
-  std::vector<size_t> size(ndims(), 1);
+  const size_t rank = ndims();
 
-  if (size.size() < 2)
+  if (rank < 2)
     throw DALValueError("Cannot get2D on fewer than 2 dimensional dataset " + _name);
 
-  if (dim1index >= size.size())
+  if (dim1index >= rank)
     throw DALIndexError("Cannot get2D if first dimension index exceeds rank for dataset " + _name);
 
-  if (dim2index >= size.size())
+  if (dim2index >= rank)
     throw DALIndexError("Cannot get2D if second dimension index exceeds rank for dataset " + _name);
 
-  // we don't do transposes
-  if (dim1index >= dim2index)
-    throw DALValueError("Cannot get2D if dimensions are not addressed in-order for dataset " + _name);
+  if (dim1index == dim2index)
+    throw DALValueError("Cannot get2D if dimensions are not distinct for dataset " + _name);
+
+  if (pos.size() != rank)
+    throw DALValueError("Cannot get2D if specified position does not match dimensionality of dataset " + _name);
+
+  size_t size[H5S_MAX_RANK], outStrides[H5S_MAX_RANK];
+
+  std::fill(size, size + rank, 1);
+  std::fill(outStrides, outStrides + rank, 0);
 
   size[dim1index] = dim1;
   size[dim2index] = dim2;
 
-  getMatrix(pos, outbuffer2, size);
+  outStrides[dim1index] = dim2;
+  outStrides[dim2index] = 1;
+
+  plannedRead(rank, &pos[0], size, outbuffer2, outStrides);
 }
 
 template<typename T> void Dataset<T>::set2D( const std::vector<size_t> &pos,
         const T *inbuffer2, size_t dim1, size_t dim2, unsigned dim1index, unsigned dim2index )
 {
-  std::vector<size_t> size(ndims(), 1);
+  const size_t rank = ndims();
 
-  if (size.size() < 2)
+  if (rank < 2)
     throw DALValueError("Cannot set2D on fewer than 2 dimensional dataset " + _name);
 
-  if (dim1index >= size.size())
+  if (dim1index >= rank)
     throw DALIndexError("Cannot set2D if first dimension index exceeds rank for dataset " + _name);
 
-  if (dim2index >= size.size())
+  if (dim2index >= rank)
     throw DALIndexError("Cannot set2D if second dimension index exceeds rank for dataset " + _name);
 
   // we don't do transposes
   if (dim1index >= dim2index)
     throw DALValueError("Cannot set2D if dimensions are not addressed in-order for dataset " + _name);
 
+  if (pos.size() != rank)
+    throw DALValueError("Cannot set2D if specified position does not match dimensionality of dataset " + _name);
+
+  size_t size[H5S_MAX_RANK];
+
+  std::fill(size, size + rank, 1);
+
   size[dim1index] = dim1;
   size[dim2index] = dim2;
 
-  setMatrix(pos, inbuffer2, size);
+  rawMatrixIO(rank, &pos[0], size, const_cast<T *>(inbuffer2), false);
 }
 
 template<typename T> void Dataset<T>::get3D( const std::vector<size_t> &pos,
         T *outbuffer3, size_t dim1, size_t dim2, size_t dim3, unsigned dim1index, unsigned dim2index, unsigned dim3index )
 {
-  std::vector<size_t> size(ndims(), 1);
+  const size_t rank = ndims();
 
-  if (size.size() < 3)
+  if (rank < 3)
     throw DALValueError("Cannot get3D on fewer than 3 dimensional dataset " + _name);
 
-  if (dim1index >= size.size())
+  if (dim1index >= rank)
     throw DALIndexError("Cannot get3D if first dimension index exceeds rank for dataset " + _name);
 
-  if (dim2index >= size.size())
+  if (dim2index >= rank)
     throw DALIndexError("Cannot get3D if second dimension index exceeds rank for dataset " + _name);
 
-  if (dim3index >= size.size())
+  if (dim3index >= rank)
     throw DALIndexError("Cannot get3D if third dimension index exceeds rank for dataset " + _name);
 
-  // we don't do transposes
-  if (dim1index >= dim2index || dim2index >= dim3index)
-    throw DALValueError("Cannot get3D if dimensions are not addressed in-order for dataset " + _name);
+  if (dim1index == dim2index || dim2index == dim3index || dim1index == dim3index)
+    throw DALValueError("Cannot get3D if dimensions are not distinct for dataset " + _name);
+
+  if (pos.size() != rank)
+    throw DALValueError("Cannot get3D if specified position does not match dimensionality of dataset " + _name);
+
+  size_t size[H5S_MAX_RANK], outStrides[H5S_MAX_RANK];
+
+  std::fill(size, size + rank, 1);
+  std::fill(outStrides, outStrides + rank, 0);
 
   size[dim1index] = dim1;
   size[dim2index] = dim2;
   size[dim3index] = dim3;
 
-  getMatrix(pos, outbuffer3, size);
+  outStrides[dim1index] = dim2 * dim3;
+  outStrides[dim2index] = dim3;
+  outStrides[dim3index] = 1;
+
+  plannedRead(rank, &pos[0], size, outbuffer3, outStrides);
 }
 
 template<typename T> void Dataset<T>::set3D( const std::vector<size_t> &pos,
         const T *inbuffer3, size_t dim1, size_t dim2, size_t dim3, unsigned dim1index, unsigned dim2index, unsigned dim3index )
 {
-  std::vector<size_t> size(ndims(), 1);
+  const size_t rank = ndims();
 
-  if (size.size() < 3)
+  if (rank < 3)
     throw DALValueError("Cannot set3D on fewer than 3 dimensional dataset " + _name);
 
-  if (dim1index >= size.size())
+  if (dim1index >= rank)
     throw DALIndexError("Cannot set3D if first dimension index exceeds rank for dataset " + _name);
 
-  if (dim2index >= size.size())
+  if (dim2index >= rank)
     throw DALIndexError("Cannot set3D if second dimension index exceeds rank for dataset " + _name);
 
-  if (dim3index >= size.size())
+  if (dim3index >= rank)
     throw DALIndexError("Cannot set3D if third dimension index exceeds rank for dataset " + _name);
 
   // we don't do transposes
   if (dim1index >= dim2index || dim2index >= dim3index)
     throw DALValueError("Cannot set3D if dimensions are not addressed in-order for dataset " + _name);
 
+  if (pos.size() != rank)
+    throw DALValueError("Cannot set3D if specified position does not match dimensionality of dataset " + _name);
+
+  size_t size[H5S_MAX_RANK];
+
+  std::fill(size, size + rank, 1);
+
   size[dim1index] = dim1;
   size[dim2index] = dim2;
   size[dim3index] = dim3;
 
-  setMatrix(pos, inbuffer3, size);
+  rawMatrixIO(rank, &pos[0], size, const_cast<T *>(inbuffer3), false);
 }
 
 template<typename T> void Dataset<T>::get1D( size_t pos, T *outbuffer, size_t len,
         unsigned dimIndex )
 {
-  std::vector<size_t> size(ndims(), 1);
+  const size_t rank = ndims();
 
-  if (dimIndex >= size.size())
+  if (dimIndex >= rank)
     throw DALIndexError("Cannot get1D if dimIndex exceeds rank of dataset " + _name);
 
+  size_t vpos[H5S_MAX_RANK], size[H5S_MAX_RANK], outStrides[H5S_MAX_RANK];
+
+  std::fill(vpos, vpos + rank, 0);
+  std::fill(size, size + rank, 1);
+  std::fill(outStrides, outStrides + rank, 1);
+
+  vpos[dimIndex] = pos;
   size[dimIndex] = len;
-  std::vector<size_t> vpos(1, pos);
 
-  getMatrix(vpos, outbuffer, size);
+  plannedRead(rank, vpos, size, outbuffer, outStrides);
+}
+
+template<typename T> IOFuture Dataset<T>::get1DAsync( size_t pos, T *outbuffer, size_t len )
+{
+  HDF5Lock lock;
+
+  const size_t rank = ndims();
+
+  std::vector<size_t> vpos(rank, 0), size(rank, 1);
+  vpos[0] = pos;
+  size[0] = len;
+
+  return getMatrixAsync(vpos, outbuffer, size);
 }
 
 template<typename T> void Dataset<T>::set1D( size_t pos, const T *inbuffer, size_t len,
         unsigned dimIndex )
 {
-  std::vector<size_t> size(ndims(), 1);
+  const size_t rank = ndims();
 
-  if (dimIndex >= size.size())
+  if (dimIndex >= rank)
     throw DALIndexError("Cannot set1D if dimIndex exceeds rank of dataset " + _name);
 
+  size_t vpos[H5S_MAX_RANK], size[H5S_MAX_RANK];
+
+  std::fill(vpos, vpos + rank, 0);
+  std::fill(size, size + rank, 1);
+
+  vpos[dimIndex] = pos;
   size[dimIndex] = len;
-  std::vector<size_t> vpos(1, pos);
 
-  setMatrix(vpos, inbuffer, size);
+  rawMatrixIO(rank, vpos, size, const_cast<T *>(inbuffer), false);
+}
+
+template<typename T> void Dataset<T>::gather( const std::vector< std::vector<size_t> > &positions,
+        const std::vector< std::vector<size_t> > &sizes, T *outbuffer )
+{
+  blocksIO(positions, sizes, outbuffer, true);
+}
+
+template<typename T> void Dataset<T>::scatter( const std::vector< std::vector<size_t> > &positions,
+        const std::vector< std::vector<size_t> > &sizes, const T *inbuffer )
+{
+  blocksIO(positions, sizes, const_cast<T *>(inbuffer), false);
+}
+
+template<typename T> void Dataset<T>::gather( const std::vector< std::vector<size_t> > &points, T *outbuffer )
+{
+  const size_t rank = ndims();
+  std::vector<hsize_t> coords;
+  coords.reserve(points.size() * rank);
+
+  for (size_t p = 0; p < points.size(); p++) {
+    if (points[p].size() != rank)
+      throw DALValueError("Cannot gather if specified point does not match dimensionality of dataset " + _name);
+
+    coords.insert(coords.end(), points[p].begin(), points[p].end());
+  }
+
+  pointsIO(coords, outbuffer, true);
+}
+
+template<typename T> void Dataset<T>::scatter( const std::vector< std::vector<size_t> > &points, const T *inbuffer )
+{
+  const size_t rank = ndims();
+  std::vector<hsize_t> coords;
+  coords.reserve(points.size() * rank);
+
+  for (size_t p = 0; p < points.size(); p++) {
+    if (points[p].size() != rank)
+      throw DALValueError("Cannot scatter if specified point does not match dimensionality of dataset " + _name);
+
+    coords.insert(coords.end(), points[p].begin(), points[p].end());
+  }
+
+  pointsIO(coords, const_cast<T *>(inbuffer), false);
+}
+
+template<typename T> void Dataset<T>::gather1D( const std::vector<size_t> &points, T *outbuffer, unsigned dimIndex )
+{
+  const size_t rank = ndims();
+
+  if (dimIndex >= rank)
+    throw DALIndexError("Cannot gather1D if dimIndex exceeds rank of dataset " + _name);
+
+  std::vector<hsize_t> coords(points.size() * rank, 0);
+
+  for (size_t p = 0; p < points.size(); p++)
+    coords[p * rank + dimIndex] = points[p];
+
+  pointsIO(coords, outbuffer, true);
+}
+
+template<typename T> void Dataset<T>::scatter1D( const std::vector<size_t> &points, const T *inbuffer, unsigned dimIndex )
+{
+  const size_t rank = ndims();
+
+  if (dimIndex >= rank)
+    throw DALIndexError("Cannot scatter1D if dimIndex exceeds rank of dataset " + _name);
+
+  std::vector<hsize_t> coords(points.size() * rank, 0);
+
+  for (size_t p = 0; p < points.size(); p++)
+    coords[p * rank + dimIndex] = points[p];
+
+  pointsIO(coords, const_cast<T *>(inbuffer), false);
 }
 
 template<typename T> T Dataset<T>::getScalar( const std::vector<size_t> &pos )
 {
+  const size_t rank = ndims();
+
+  if (pos.size() != rank)
+    throw DALValueError("Cannot getScalar if specified position does not match dimensionality of dataset " + _name);
+
   T value;
-  std::vector<size_t> size(ndims(), 1);
+  size_t size[H5S_MAX_RANK];
+
+  std::fill(size, size + rank, 1);
 
-  getMatrix(pos, &value, size);
+  rawMatrixIO(rank, &pos[0], size, &value, true);
 
   return value;
 }
 
 template<typename T> T Dataset<T>::getScalar1D( size_t pos )
 {
-  std::vector<size_t> vpos(1, pos);
+  const size_t vpos[1] = { pos };
   return Dataset<T>::getScalar(vpos);
 }
 
 template<typename T> void Dataset<T>::setScalar( const std::vector<size_t> &pos,
         const T &value )
 {
-  std::vector<size_t> size(ndims(), 1);
+  const size_t rank = ndims();
+
+  if (pos.size() != rank)
+    throw DALValueError("Cannot setScalar if specified position does not match dimensionality of dataset " + _name);
 
-  setMatrix(pos, &value, size);
+  size_t size[H5S_MAX_RANK];
+
+  std::fill(size, size + rank, 1);
+
+  rawMatrixIO(rank, &pos[0], size, const_cast<T *>(&value), false);
 }
 
 template<typename T> void Dataset<T>::setScalar1D( size_t pos, T value )
 {
-  std::vector<size_t> vpos(1, pos);
+  const size_t vpos[1] = { pos };
   Dataset<T>::setScalar(vpos, value);
 }
 
+template<typename T> template<size_t N> void Dataset<T>::getMatrix( const size_t (&pos)[N],
+        T *buffer, const size_t (&size)[N] )
+{
+  rawMatrixIO(N, pos, size, buffer, true);
+}
+
+template<typename T> template<size_t N> void Dataset<T>::setMatrix( const size_t (&pos)[N],
+        const T *buffer, const size_t (&size)[N] )
+{
+  rawMatrixIO(N, pos, size, const_cast<T *>(buffer), false);
+}
+
+template<typename T> template<size_t N> T Dataset<T>::getScalar( const size_t (&pos)[N] )
+{
+  T value;
+  size_t size[N];
+
+  std::fill(size, size + N, 1);
+
+  rawMatrixIO(N, pos, size, &value, true);
+
+  return value;
+}
+
+template<typename T> template<size_t N> void Dataset<T>::setScalar( const size_t (&pos)[N], const T &value )
+{
+  size_t size[N];
+
+  std::fill(size, size + N, 1);
+
+  rawMatrixIO(N, pos, size, const_cast<T *>(&value), false);
+}
+
 template<typename T> void Dataset<T>::open( hid_t parent, const std::string &name ) {
-  _group = hid_gc(H5Dopen2(parent, name.c_str(), H5P_DEFAULT), H5Dclose, "Could not open dataset " + _name);
+  bool prefixLost;
+  _group = hid_gc(openDataset(parent, name.c_str(), prefixLost), H5Dclose, "Could not open dataset ", _name);
+
+  // (re)fill the shared cache entry: a newly opened dataset may have been resized elsewhere
+  initShape();
+  shape->efilePrefixLost = prefixLost;
+
+  const IndexedObject *indexed = indexedObject();
+  if (indexed) {
+    shape->dims = indexed->dims;
+    shape->maxdims = indexed->maxdims;
+    attributes.assign(indexed->attributes);
+  } else {
+    readShape();
+  }
+
   initNodes();
 }
 
+template<typename T> void Dataset<T>::initShape()
+{
+  // The absolute path identifies the dataset within the file, regardless of the parent object used to reach it.
+  shape = &fileInfo.datasetShape(objectPath());
+}
+
+template<typename T> void Dataset<T>::readShape()
+{
+  hid_gc_noref dataspace(H5Dget_space(_group), H5Sclose, "Could not get dataspace to get dimensions of dataset ", _name);
+
+  const int rank = H5Sget_simple_extent_ndims(dataspace);
+
+  if (rank < 0)
+    throw HDF5Exception("Could not get number of dimensions of dataset " + _name);
+
+  std::vector<hsize_t> dims(rank), maxdims(rank);
+
+  if (rank > 0 && H5Sget_simple_extent_dims(dataspace, &dims[0], &maxdims[0]) < 0)
+    throw HDF5Exception("Could not get dimensions of dataset " + _name);
+
+  shape->dims.swap(dims);
+  shape->maxdims.swap(maxdims);
+}
+
+template<typename T> int Dataset<T>::openExternalFile( const std::string &filename ) const
+{
+  // Absolute names ignore the directory fd. AT_FDCWD is used if the HDF5 file was opened in ".".
+  const int fdirfd = fileDirfd();
+  const int fd = ::openat(fdirfd >= 0 ? fdirfd : AT_FDCWD, filename.c_str(), O_RDONLY);
+
+  if (fd == -1)
+    throw DALException("Could not open external file " + filename + " of dataset " + _name);
+
+  return fd;
+}
+
 template<typename T> bool Dataset<T>::bigEndian( enum Endianness endianness ) const
 {
   if (endianness == LITTLE)
@@ -365,13 +860,105 @@ template<typename T> bool Dataset<T>::bigEndian( enum Endianness endianness ) co
     return BYTE_ORDER == BIG_ENDIAN;
 }
 
+template<typename T> void Dataset<T>::plannedRead( size_t rank, const size_t *pos,
+        const size_t *size, T *buffer, const size_t *outStrides )
+{
+  const std::vector<hsize_t> &dims = cachedShape().dims;
+
+  if (rank != dims.size())
+    throw DALValueError("Cannot read block if specified position or block size does not match dimensionality of dataset " + _name);
+
+  for (size_t d = 0; d < rank; d++) {
+    if (pos[d] + size[d] > dims[d])
+      throw DALIndexError("Cannot read block beyond the dimensions of dataset " + _name);
+
+    if (size[d] == 0)
+      return;
+  }
+
+  // length of the contiguous runs on disk
+  size_t run = 1;
+
+  for (size_t d = rank; d > 0; d--) {
+    run *= size[d - 1];
+
+    if (size[d - 1] != dims[d - 1])
+      break;
+  }
+
+  // whether the buffer is laid out in the same order as the data on disk
+  bool inOrder = true;
+  size_t total = 1;
+
+  for (size_t d = rank; d > 0; d--) {
+    if (size[d - 1] > 1 && outStrides[d - 1] != total)
+      inOrder = false;
+
+    total *= size[d - 1];
+  }
+
+  const size_t blockBytes = readBlockBytes;
+  const size_t minRun = minRunBytes;
+
+  if (inOrder && (run == total || run * sizeof(T) >= minRun)) {
+    rawMatrixIO(rank, pos, size, buffer, true);
+    return;
+  }
+
+  // read row-blocks along the first dimension, either of the requested
+  // width or of the full width if the requested runs are short
+  size_t rowLength = 1;
+
+  for (size_t d = 1; d < rank; d++)
+    rowLength *= dims[d];
+
+  const bool wholeRows = run * sizeof(T) < minRun && rowLength * sizeof(T) <= blockBytes;
+
+  std::vector<size_t> blockPos(pos, pos + rank);
+  std::vector<size_t> blockSize(size, size + rank);
+
+  if (wholeRows) {
+    for (size_t d = 1; d < rank; d++) {
+      blockPos[d] = 0;
+      blockSize[d] = dims[d];
+    }
+  }
+
+  std::vector<size_t> blockStrides(rank);
+  size_t blockRow = 1;
+
+  for (size_t d = rank; d > 0; d--) {
+    blockStrides[d - 1] = blockRow;
+
+    if (d > 1)
+      blockRow *= blockSize[d - 1];
+  }
+
+  size_t offset = 0;
+
+  for (size_t d = 1; d < rank; d++)
+    offset += (pos[d] - blockPos[d]) * blockStrides[d];
+
+  const size_t rowsPerBlock = std::max<size_t>(1, blockBytes / (blockRow * sizeof(T)));
+  std::vector<T> block(std::min(rowsPerBlock, size[0]) * blockRow);
+  std::vector<size_t> copySize(size, size + rank);
+  const std::vector<size_t> copyStrides(outStrides, outStrides + rank);
+
+  for (size_t row = 0; row < size[0]; row += rowsPerBlock) {
+    blockPos[0]  = pos[0] + row;
+    blockSize[0] = std::min(rowsPerBlock, size[0] - row);
+    copySize[0]  = blockSize[0];
+
+    rawMatrixIO(rank, &blockPos[0], &blockSize[0], &block[0], true);
+
+    copyStrided(&block[offset], copySize, blockStrides, buffer + row * outStrides[0], copyStrides);
+  }
+}
+
 template<typename T> void Dataset<T>::matrixIO( const std::vector<size_t> &pos,
         T *buffer, const std::vector<size_t> &size, const std::vector<size_t> &strides, bool read )
 {
   const size_t rank = ndims();
-  const bool use_strides = strides.size() == rank;
-
-  std::vector<hsize_t> offset(rank), count(rank), stride(rank);
 
   if (pos.size() != rank)
     throw DALValueError("Cannot perform matrixIO if specified position does not match dimensionality of dataset " + _name);
@@ -379,49 +966,183 @@ template<typename T> void Dataset<T>::matrixIO( const std::vector<size_t> &pos,
   if (size.size() != rank)
     throw DALValueError("Cannot perform matrixIO if specified block size does not match dimensionality of dataset " + _name);
 
+  if (strides.size() != rank) {
+    rawMatrixIO(rank, &pos[0], &size[0], buffer, read);
+    return;
+  }
+
+  hsize_t offset[H5S_MAX_RANK], count[H5S_MAX_RANK];
+
   for (size_t i = 0; i < rank; i++) {
     offset[i] = pos[i];
     count[i]  = size[i];
   }
 
-  hid_gc_noref dataspace(H5Dget_space(group()), H5Sclose, "Could not retrieve dataspace " + _name);
+  hid_gc_noref dataspace(H5Dget_space(group()), H5Sclose, "Could not retrieve dataspace ", _name);
 
-  if (H5Sselect_hyperslab(dataspace, H5S_SELECT_SET, &offset[0], NULL, &count[0], NULL) < 0)
+  if (H5Sselect_hyperslab(dataspace, H5S_SELECT_SET, offset, NULL, count, NULL) < 0)
     throw HDF5Exception("Could not select hyperslab to perform matrixIO on dataset " + _name);
 
-  if (use_strides) {
-    // HDF5 doesn't support strides directly (*), so we present it with a larger continuous array which matches
-    // the strides. By subsequently only requesting to read a small portion of the array, everything works out.
-    
-    // (*) The strides in H5Sselect_hyperslab actually indicate how many elements to skip in each dimension,
-    //     /not/ the distance between neighbouring elements in memory.
-    for (size_t i = 0; i < rank; i++) {
-      if (i == rank - 1) {
-        // no need to extend the last dimension
-        count[i] = size[i];
-      } else {  
-        count[i] = strides[i] / strides[i+1];
-      }
-    }
-  } else {
-    for (size_t i = 0; i < rank; i++) {
-      count[i]  = size[i];
+  // HDF5 doesn't support strides directly (*), so we present it with a larger continuous array which matches
+  // the strides. By subsequently only requesting to read a small portion of the array, everything works out.
+  
+  // (*) The strides in H5Sselect_hyperslab actually indicate how many elements to skip in each dimension,
+  //     /not/ the distance between neighbouring elements in memory.
+  for (size_t i = 0; i < rank; i++) {
+    if (i == rank - 1) {
+      // no need to extend the last dimension
+      count[i] = size[i];
+    } else {  
+      count[i] = strides[i] / strides[i+1];
     }
   }
 
-  hid_gc_noref memspace(H5Screate_simple(rank, &count[0], NULL), H5Sclose, "Could not create simple dataspace to perform matrixIO on dataset " + _name);
+  hid_gc_noref memspace(H5Screate_simple(rank, count, NULL), H5Sclose, "Could not create simple dataspace to perform matrixIO on dataset ", _name);
 
   for (size_t i = 0; i < rank; i++) {
     offset[i] = 0;
     count[i]  = size[i];
   }
 
-  if (H5Sselect_hyperslab(memspace, H5S_SELECT_SET, &offset[0], NULL, &count[0], NULL) < 0)
+  if (H5Sselect_hyperslab(memspace, H5S_SELECT_SET, offset, NULL, count, NULL) < 0)
     throw HDF5Exception("Could not select hyperslab (2) to perform matrixIO on dataset " + _name);
 
+  transfer(memspace, dataspace, buffer, read);
+}
+
+template<typename T> void Dataset<T>::rawMatrixIO( size_t rank, const size_t *pos,
+        const size_t *size, T *buffer, bool read )
+{
+  if (rank != ndims())
+    throw DALValueError("Cannot perform matrixIO if specified position does not match dimensionality of dataset " + _name);
+
+  hsize_t offset[H5S_MAX_RANK], count[H5S_MAX_RANK];
+  hsize_t nrElements = 1;
+
+  for (size_t i = 0; i < rank; i++) {
+    offset[i] = pos[i];
+    count[i]  = size[i];
+
+    nrElements *= count[i];
+  }
+
+  const hid_t dataspace = cachedFileSpace();
+
+  if (H5Sselect_hyperslab(dataspace, H5S_SELECT_SET, offset, NULL, count, NULL) < 0)
+    throw HDF5Exception("Could not select hyperslab to perform matrixIO on dataset " + _name);
+
+  // the buffer is continuous, so its shape does not matter to HDF5
+  transfer(cachedMemSpace(nrElements), dataspace, buffer, read);
+}
+
+template<typename T> hid_t Dataset<T>::cachedFileSpace()
+{
+  const std::vector<hsize_t> &dims = cachedShape().dims;
+
+  // the dataset may have been resized since, possibly through another Dataset object
+  if (!fileSpace.isset() || fileSpaceDims != dims) {
+    fileSpace = hid_gc(H5Dget_space(group()), H5Sclose, "Could not retrieve dataspace ", _name);
+    fileSpaceDims = dims;
+  }
+
+  return fileSpace;
+}
+
+template<typename T> hid_t Dataset<T>::cachedMemSpace( hsize_t nrElements )
+{
+  for (size_t i = 0; i < nrMemSpaces; i++)
+    if (memSpaces[i].space.isset() && memSpaces[i].nrElements == nrElements)
+      return memSpaces[i].space;
+
+  MemSpace &m = memSpaces[nextMemSpace];
+  nextMemSpace = (nextMemSpace + 1) % nrMemSpaces;
+
+  m.space = hid_gc(H5Screate_simple(1, &nrElements, NULL), H5Sclose, "Could not create simple dataspace to perform matrixIO on dataset ", _name);
+  m.nrElements = nrElements;
+
+  return m.space;
+}
+
+template<typename T> void Dataset<T>::blocksIO( const std::vector< std::vector<size_t> > &positions,
+        const std::vector< std::vector<size_t> > &sizes, T *buffer, bool read )
+{
+  const size_t rank = ndims();
+
+  if (positions.size() != sizes.size())
+    throw DALValueError("Cannot perform blocksIO if the number of positions and block sizes differ for dataset " + _name);
+
+  std::vector<hsize_t> offset(rank), count(rank);
+
+  hid_gc_noref dataspace(H5Dget_space(group()), H5Sclose, "Could not retrieve dataspace ", _name);
+
+  hsize_t nrElements = 0;
+
+  for (size_t b = 0; b < positions.size(); b++) {
+    if (positions[b].size() != rank)
+      throw DALValueError("Cannot perform blocksIO if specified position does not match dimensionality of dataset " + _name);
+
+    if (sizes[b].size() != rank)
+      throw DALValueError("Cannot perform blocksIO if specified block size does not match dimensionality of dataset " + _name);
+
+    hsize_t blockElements = 1;
+
+    for (size_t i = 0; i < rank; i++) {
+      offset[i] = positions[b][i];
+      count[i]  = sizes[b][i];
+
+      blockElements *= count[i];
+    }
+
+    if (blockElements == 0)
+      continue;
+
+    if (H5Sselect_hyperslab(dataspace, nrElements == 0 ? H5S_SELECT_SET : H5S_SELECT_OR, &offset[0], NULL, &count[0], NULL) < 0)
+      throw HDF5Exception("Could not select hyperslab to perform blocksIO on dataset " + _name);
+
+    nrElements += blockElements;
+  }
+
+  if (nrElements == 0)
+    return;
+
+  // overlapping blocks would be merged, breaking the packing of the buffer
+  if (H5Sget_select_npoints(dataspace) != (hssize_t)nrElements)
+    throw DALValueError("Cannot perform blocksIO on overlapping blocks of dataset " + _name);
+
+  hid_gc_noref memspace(H5Screate_simple(1, &nrElements, NULL), H5Sclose, "Could not create simple dataspace to perform blocksIO on dataset ", _name);
+
+  transfer(memspace, dataspace, buffer, read);
+}
+
+template<typename T> void Dataset<T>::pointsIO( const std::vector<hsize_t> &coords, T *buffer, bool read )
+{
+  const size_t rank = ndims();
+  hsize_t nrPoints = rank == 0 ? 0 : coords.size() / rank;
+
+  if (nrPoints == 0)
+    return;
+
+  hid_gc_noref dataspace(H5Dget_space(group()), H5Sclose, "Could not retrieve dataspace ", _name);
+
+  if (H5Sselect_elements(dataspace, H5S_SELECT_SET, nrPoints, &coords[0]) < 0)
+    throw HDF5Exception("Could not select points to perform pointsIO on dataset " + _name);
+
+  hid_gc_noref memspace(H5Screate_simple(1, &nrPoints, NULL), H5Sclose, "Could not create simple dataspace to perform pointsIO on dataset ", _name);
+
+  transfer(memspace, dataspace, buffer, read);
+}
+
+template<typename T> void Dataset<T>::transfer( hid_t memspace, hid_t dataspace, T *buffer, bool read )
+{
+#if defined(H5_VERSION_GE) && H5_VERSION_GE(1, 10, 0)
+  // HDF5 resolves external files against the HDF5 file, unless it reopened the dataset without our prefix
+  const bool cwdRelative = cachedShape().efilePrefixLost;
+#else
+  const bool cwdRelative = true;
+#endif
 
   /*
-   * Work around HDF5 1.8 issue where external datasets are accessed relative to the cwd (instead of the HDF5 file).
+   * Work around HDF5 issue where external datasets are accessed relative to the cwd (instead of the HDF5 file).
    * Always (try to) restore the cwd in case the application depends on it. See known issue KI 1 for more detail.
    */
   struct ScopedCWD {
@@ -439,7 +1160,7 @@ template<typename T> void Dataset<T>::matrixIO( const std::vector<size_t> &pos,
    * Skip cwd fiddling if the HDF5 file was opened in ".". We could also skip the cwd fiddling if externalFiles()
    * is empty, but we always use external files for good reason and externalFiles() does another 2+N HDF5 calls.
    */
-  int fdirfd = fileDirfd();
+  int fdirfd = cwdRelative ? fileDirfd() : -1;
   if (fdirfd >= 0) {
     // Open the cwd, so we can (try to) fchdir() back to it afterwards. If err, go anyway (hopefully won't get the wrong file).
     sc.cwd_fd = ::open(".", O_RDONLY);
@@ -448,10 +1169,10 @@ template<typename T> void Dataset<T>::matrixIO( const std::vector<size_t> &pos,
 
   if (read) {
     if (H5Dread(group(), h5typemap<T>::memoryType(), memspace, dataspace, H5P_DEFAULT, buffer) < 0)
-      throw HDF5Exception("Could not perform matrixIO to read data from dataset " + _name);
+      throw HDF5Exception("Could not read data from dataset " + _name);
   } else {
     if (H5Dwrite(group(), h5typemap<T>::memoryType(), memspace, dataspace, H5P_DEFAULT, buffer) < 0)
-      throw HDF5Exception("Could not perform matrixIO to write data to dataset " + _name);
+      throw HDF5Exception("Could not write data to dataset " + _name);
   }    
 }
 
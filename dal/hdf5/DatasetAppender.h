@@ -0,0 +1,145 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_DATASET_APPENDER_H
+#define DAL_DATASET_APPENDER_H
+
+#include <cstddef>
+#include <vector>
+#include "Dataset.h"
+#include "Attribute.h"
+
+namespace dal {
+
+/*!
+ * \class DatasetAppender
+ *
+ * Appends data to an extendible dataset along its first dimension, for example to a
+ * dataset created with create1D(len, -1, "file.raw"). Writes are collected in a write-behind
+ * buffer, and the extent of the dataset grows geometrically, so the HDF5 metadata is only
+ * updated once in a while. close() trims the dataset to the exact length written.
+ *
+ * Until close(), the dataset may be longer than the data appended. Attributes registered
+ * through syncLength() are set to the appended length on flush() and close().
+ *
+ * C++ example:
+ * \code
+ *    TBB_DipoleDataset dipole(station.dipole(1, 2, 3));
+ *    dipole.create1D(0, -1, "dipole.raw");
+ *
+ *    DatasetAppender<short> appender(dipole);
+ *    appender.syncLength(dipole.dataLength());
+ *
+ *    while (...)
+ *      appender.append(samples, nrSamples);
+ *
+ *    appender.close();
+ * \endcode
+ */
+template<typename T> class DatasetAppender {
+public:
+  /*!
+   * Appends to `dataset`, starting at its current length. Up to `bufferBytes`
+   * of data are collected before they are written.
+   *
+   * Requires:
+   *    - dataset.ndims() >= 1
+   */
+  DatasetAppender( Dataset<T> &dataset, size_t bufferBytes = 4 * 1024 * 1024 );
+
+  /*!
+   * Closes the appender, see close(). Errors are ignored; call close()
+   * explicitly to be notified of them.
+   */
+  ~DatasetAppender();
+
+  /*!
+   * Appends `len` elements along the first dimension. For a multi-dimensional dataset,
+   * `data` holds `len` rows of all other dimensions, as for Dataset::setMatrix().
+   */
+  void append( const T *data, size_t len );
+
+  /*!
+   * Writes all buffered data to the dataset and updates the attributes registered through syncLength().
+   */
+  void flush();
+
+  /*!
+   * Flushes, trims the dataset to the appended length, and updates the attributes registered
+   * through syncLength(). The appender cannot be used afterwards.
+   */
+  void close();
+
+  //! Returns the number of elements along the first dimension appended so far, including the original length.
+  size_t length() const { return written + buffered; }
+
+  /*!
+   * Keeps `attribute` set to length() when flushing and closing, for example
+   * BF_StokesDataset::nofSamples() or TBB_DipoleDataset::dataLength().
+   * The attribute is created if it does not exist.
+   */
+  template<typename U> void syncLength( const Attribute<U> &attribute );
+
+private:
+  // not copyable
+  DatasetAppender( const DatasetAppender & );
+  DatasetAppender &operator=( const DatasetAppender & );
+
+  //! Type-erased length attribute, see syncLength().
+  class LengthAttribute {
+  public:
+    virtual ~LengthAttribute() {}
+    virtual void set( size_t length ) = 0;
+  };
+
+  template<typename U> class TypedLengthAttribute: public LengthAttribute {
+  public:
+    TypedLengthAttribute( const Attribute<U> &attribute ): attribute(attribute) {
+      if (!this->attribute.exists())
+        this->attribute.create();
+    }
+
+    virtual void set( size_t length ) { attribute.set(static_cast<U>(length)); }
+
+  private:
+    Attribute<U> attribute;
+  };
+
+  Dataset<T> &dataset;
+  std::vector<ssize_t> extent; // current extent of the dataset
+  ssize_t maxLength;           // maximum extent of the first dimension, or -1 if unlimited
+  size_t rowLength;            // number of elements per index of the first dimension
+
+  std::vector<T> buffer;
+  size_t bufferLength;         // capacity of the buffer, in rows
+  size_t written;              // rows written to the dataset
+  size_t buffered;             // rows in the buffer
+  bool closed;
+
+  std::vector<LengthAttribute *> lengthAttributes;
+
+  //! Writes `len` rows from `data` at the end of the written data, growing the extent if needed.
+  void write( const T *data, size_t len );
+
+  void updateLengthAttributes();
+};
+
+}
+
+#include "DatasetAppender.tcc"
+
+#endif
+
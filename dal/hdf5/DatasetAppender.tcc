@@ -0,0 +1,151 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+
+namespace dal {
+
+template<typename T> DatasetAppender<T>::DatasetAppender( Dataset<T> &dataset, size_t bufferBytes )
+:
+  dataset(dataset),
+  extent(dataset.dims()),
+  maxLength(-1),
+  rowLength(1),
+  bufferLength(0),
+  written(0),
+  buffered(0),
+  closed(false)
+{
+  if (extent.empty())
+    throw DALValueError("Cannot append to scalar dataset " + dataset.name());
+
+  maxLength = dataset.maxdims()[0];
+  written = extent[0];
+
+  for (size_t d = 1; d < extent.size(); d++)
+    rowLength *= extent[d];
+
+  bufferLength = std::max<size_t>(1, bufferBytes / std::max<size_t>(1, rowLength * sizeof(T)));
+  buffer.resize(bufferLength * rowLength);
+}
+
+template<typename T> DatasetAppender<T>::~DatasetAppender()
+{
+  try {
+    close();
+  } catch (DALException &) {
+  }
+
+  for (size_t i = 0; i < lengthAttributes.size(); i++)
+    delete lengthAttributes[i];
+}
+
+template<typename T> template<typename U> void DatasetAppender<T>::syncLength( const Attribute<U> &attribute )
+{
+  lengthAttributes.push_back(new TypedLengthAttribute<U>(attribute));
+}
+
+template<typename T> void DatasetAppender<T>::append( const T *data, size_t len )
+{
+  if (closed)
+    throw DALValueError("Cannot append to closed appender for dataset " + dataset.name());
+
+  // large blocks bypass the buffer
+  if (buffered == 0 && len >= bufferLength) {
+    write(data, len);
+    return;
+  }
+
+  while (len > 0) {
+    const size_t n = std::min(len, bufferLength - buffered);
+
+    std::copy(data, data + n * rowLength, buffer.begin() + buffered * rowLength);
+    buffered += n;
+    data += n * rowLength;
+    len -= n;
+
+    if (buffered == bufferLength) {
+      write(&buffer[0], buffered);
+      buffered = 0;
+    }
+  }
+}
+
+template<typename T> void DatasetAppender<T>::flush()
+{
+  if (closed)
+    return;
+
+  if (buffered > 0) {
+    write(&buffer[0], buffered);
+    buffered = 0;
+  }
+
+  updateLengthAttributes();
+}
+
+template<typename T> void DatasetAppender<T>::close()
+{
+  if (closed)
+    return;
+
+  flush();
+
+  closed = true;
+
+  if ((size_t)extent[0] != written) {
+    extent[0] = written;
+    dataset.resize(extent);
+  }
+}
+
+template<typename T> void DatasetAppender<T>::write( const T *data, size_t len )
+{
+  const size_t needed = written + len;
+
+  if ((size_t)extent[0] < needed) {
+    // grow geometrically, to avoid updating the extent on every write
+    size_t newLength = std::max(needed, 2 * (size_t)extent[0]);
+
+    if (maxLength >= 0)
+      newLength = std::min(newLength, (size_t)maxLength);
+
+    if (newLength < needed)
+      throw DALIndexError("Cannot append beyond the maximum dimensions of dataset " + dataset.name());
+
+    extent[0] = newLength;
+    dataset.resize(extent);
+  }
+
+  std::vector<size_t> pos(extent.size(), 0);
+  std::vector<size_t> size(extent.begin(), extent.end());
+
+  pos[0] = written;
+  size[0] = len;
+
+  dataset.setMatrix(pos, data, size);
+
+  written += len;
+}
+
+template<typename T> void DatasetAppender<T>::updateLengthAttributes()
+{
+  for (size_t i = 0; i < lengthAttributes.size(); i++)
+    lengthAttributes[i]->set(length());
+}
+
+}
+
@@ -0,0 +1,123 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_DATASET_FOLLOWER_H
+#define DAL_DATASET_FOLLOWER_H
+
+#include <cstddef>
+#include <vector>
+#include "Dataset.h"
+
+namespace dal {
+
+/*!
+ * \class DatasetFollower
+ *
+ * Follows a dataset that is being appended to by another process, typically in a file
+ * opened with SWMR_READ while the writer uses SWMR_WRITE (see File::startSWMRWrite()).
+ * New samples along dimension `dimIndex` are picked up by refreshing the dataset, and
+ * returned in order. See Dataset::refresh() for why the followed Dataset object must be
+ * the only one for its dataset.
+ *
+ * A sample is a slice of the dataset at one index along `dimIndex`, spanning all other
+ * dimensions. Blocks of samples are returned as by Dataset::getMatrix(), for
+ * position (0, ..., position(), ..., 0) and sizes (dims()[0], ..., n, ..., dims()[ndims()-1]).
+ *
+ * HDF5 does not signal extensions of a dataset, so wait() polls. The writer must only
+ * extend the dataset to cover data that it has written, so DatasetAppender, which grows
+ * datasets ahead of the data, is not suitable for writing followed datasets.
+ *
+ * C++ example:
+ * \code
+ *    TBB_File f("L12345_D20120101T000000.000Z_CS001_R000_tbb.h5", TBB_File::SWMR_READ);
+ *    TBB_DipoleDataset dipole(f.station("CS001").dipole(1, 2, 3));
+ *
+ *    DatasetFollower<short> follower(dipole);
+ *    std::vector<short> samples(1024);
+ *
+ *    while (follower.wait(1, 10.0) > 0) {
+ *      const size_t n = follower.next(&samples[0], samples.size());
+ *      process(&samples[0], n);
+ *    }
+ * \endcode
+ *
+ * The dataset must not be destructed while the follower exists.
+ */
+template<typename T> class DatasetFollower {
+public:
+  /*!
+   * Follows `dataset` along dimension `dimIndex`, starting at index `pos`. wait()
+   * checks for new samples every `pollInterval` seconds.
+   *
+   * Requires:
+   *    - dimIndex < dataset.ndims()
+   *    - pollInterval > 0
+   */
+  DatasetFollower( Dataset<T> &dataset, size_t pos = 0, unsigned dimIndex = 0, double pollInterval = 0.1 );
+
+  /*!
+   * Refreshes the dataset, and returns the number of samples available
+   * that have not been returned by next() yet. Does not block.
+   */
+  size_t poll();
+
+  /*!
+   * Waits until at least `minSamples` samples are available, or until `timeout` seconds
+   * have passed. A negative `timeout` waits indefinitely. Returns the number of
+   * samples available, which is less than `minSamples` on a timeout.
+   */
+  size_t wait( size_t minSamples = 1, double timeout = -1.0 );
+
+  /*!
+   * Reads up to `maxSamples` of the available samples into `buffer`, and advances past them.
+   * Returns the number of samples read, which is 0 if none are available. Does not refresh
+   * the dataset; call poll() or wait() first.
+   *
+   * Requires:
+   *    - buffer can hold maxSamples * sampleSize() values
+   */
+  size_t next( T *buffer, size_t maxSamples );
+
+  //! Returns the index along dimIndex of the next sample to be returned by next().
+  size_t position() const { return pos; }
+
+  //! Returns the number of values per sample.
+  size_t sampleSize() const { return _sampleSize; }
+
+private:
+  // not copyable
+  DatasetFollower( const DatasetFollower & );
+  DatasetFollower &operator=( const DatasetFollower & );
+
+  Dataset<T> &dataset;
+  const unsigned dimIndex;
+  const double pollInterval;
+
+  size_t pos;         // index along dimIndex of the next sample
+  size_t _sampleSize;
+
+  std::vector<ssize_t> dims; // dimensions at the last refresh
+
+  //! Returns the number of samples available according to dims.
+  size_t available() const;
+};
+
+}
+
+#include "DatasetFollower.tcc"
+
+#endif
+
@@ -0,0 +1,113 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace dal {
+
+template<typename T> DatasetFollower<T>::DatasetFollower( Dataset<T> &dataset, size_t pos, unsigned dimIndex, double pollInterval )
+:
+  dataset(dataset),
+  dimIndex(dimIndex),
+  pollInterval(pollInterval),
+  pos(pos),
+  _sampleSize(0)
+{
+  if (pollInterval <= 0.0)
+    throw DALValueError("Cannot follow with a poll interval of 0 dataset " + dataset.name());
+
+  dataset.refresh();
+  dims = dataset.dims();
+
+  if (dimIndex >= dims.size())
+    throw DALIndexError("Cannot follow if dimIndex exceeds rank of dataset " + dataset.name());
+
+  _sampleSize = 1;
+
+  for (size_t d = 0; d < dims.size(); d++)
+    if (d != dimIndex)
+      _sampleSize *= dims[d];
+}
+
+template<typename T> size_t DatasetFollower<T>::available() const
+{
+  const size_t end = dims[dimIndex];
+
+  return end > pos ? end - pos : 0;
+}
+
+template<typename T> size_t DatasetFollower<T>::poll()
+{
+  dataset.refresh();
+
+  const std::vector<ssize_t> newdims = dataset.dims();
+
+  for (size_t d = 0; d < dims.size(); d++)
+    if (d != dimIndex && newdims[d] != dims[d])
+      throw DALValueError("Cannot follow dataset " + dataset.name() + ": dimensions other than dimIndex changed");
+
+  dims = newdims;
+
+  return available();
+}
+
+template<typename T> size_t DatasetFollower<T>::wait( size_t minSamples, double timeout )
+{
+  struct timeval start, now;
+  gettimeofday(&start, NULL);
+
+  for (;;) {
+    const size_t nrAvailable = poll();
+
+    if (nrAvailable >= minSamples)
+      return nrAvailable;
+
+    gettimeofday(&now, NULL);
+    const double elapsed = (now.tv_sec - start.tv_sec) + (now.tv_usec - start.tv_usec) / 1.0e6;
+
+    if (timeout >= 0.0 && elapsed >= timeout)
+      return nrAvailable;
+
+    double sleepTime = pollInterval;
+    if (timeout >= 0.0)
+      sleepTime = std::min(sleepTime, timeout - elapsed);
+
+    usleep(static_cast<useconds_t>(sleepTime * 1.0e6));
+  }
+}
+
+template<typename T> size_t DatasetFollower<T>::next( T *buffer, size_t maxSamples )
+{
+  const size_t len = std::min(maxSamples, available());
+
+  if (len == 0)
+    return 0;
+
+  std::vector<size_t> blockPos(dims.size(), 0), blockSize(dims.begin(), dims.end());
+
+  blockPos[dimIndex]  = pos;
+  blockSize[dimIndex] = len;
+
+  dataset.getMatrix(blockPos, buffer, blockSize);
+
+  pos += len;
+  return len;
+}
+
+}
+
@@ -0,0 +1,147 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_DATASET_STREAM_READER_H
+#define DAL_DATASET_STREAM_READER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include "Dataset.h"
+
+namespace dal {
+
+/*!
+ * \class DatasetStreamReader
+ *
+ * Reads a dataset from start to end in fixed-size slices, prefetching the next slices
+ * on a background thread into a ring of page-aligned buffers. This allows processing
+ * of one slice to overlap with reading the next ones.
+ *
+ * The slices are blocks of sizes `size`, starting at position `pos` and advancing along
+ * dimension `dimIndex`, using the same conventions as Dataset::getMatrix(). The last slice
+ * is shorter along `dimIndex` if the dataset does not contain a whole number of slices.
+ *
+ * C++ example:
+ * \code
+ *    std::vector<size_t> pos(2, 0), size(2);
+ *    size[0] = 1024;             // samples per slice
+ *    size[1] = stokes.dims()[1]; // all channels
+ *
+ *    DatasetStreamReader<float> reader(stokes, pos, size);
+ *
+ *    while (const float *slice = reader.next())
+ *      process(slice, reader.sliceSize()[0]);
+ * \endcode
+ *
+ * Thread safety: the dataset is read from a background thread. A dataset stored in external raw
+ * files in the native format of T is read through a ConcurrentReader, without calling HDF5.
+ * Other datasets are read through HDF5, holding the HDF5Lock per slice. While such a reader exists,
+ * other threads must take the HDF5Lock around their DAL calls, unless the HDF5 library is built
+ * thread-safe, and must not hold it while calling next(). The dataset must not be destructed
+ * while the reader exists.
+ */
+template<typename T> class DatasetStreamReader {
+public:
+  /*!
+   * Starts reading slices of sizes `size` from `dataset`, starting at `pos` and
+   * advancing along dimension `dimIndex`. At most `queueLength` slices are read ahead.
+   *
+   * Requires:
+   *    - pos.size() == size.size() == dataset.ndims()
+   *    - dimIndex < dataset.ndims()
+   *    - queueLength >= 1
+   */
+  DatasetStreamReader( Dataset<T> &dataset, const std::vector<size_t> &pos, const std::vector<size_t> &size,
+                       unsigned dimIndex = 0, size_t queueLength = 2 );
+
+  /*!
+   * Stops reading ahead. Waits for a read in progress to finish.
+   */
+  ~DatasetStreamReader();
+
+  /*!
+   * Returns the next slice, waiting for it to be read if needed, or NULL
+   * if all slices have been returned. The returned buffer remains valid until
+   * the next call to next(), or until the reader is destructed.
+   *
+   * Rethrows a failure to read the slice as a DALException.
+   */
+  const T *next();
+
+  //! Returns the position of the slice returned by next().
+  const std::vector<size_t> &slicePos() const { return currentPos; }
+
+  //! Returns the sizes of the slice returned by next().
+  const std::vector<size_t> &sliceSize() const { return currentSize; }
+
+  //! Returns the total number of slices.
+  size_t nrSlices() const { return _nrSlices; }
+
+  //! Returns the number of slices that have been read ahead and are waiting to be returned by next().
+  size_t queueDepth() const;
+
+  //! Returns the total time in seconds that next() had to wait for slices to be read.
+  double stallTime() const;
+
+private:
+  // not copyable
+  DatasetStreamReader( const DatasetStreamReader & );
+  DatasetStreamReader &operator=( const DatasetStreamReader & );
+
+  Dataset<T> &dataset;
+  ConcurrentReader<T> *rawReader; // NULL if the dataset is read through HDF5
+  const std::vector<size_t> startPos;
+  const std::vector<size_t> _size;
+  const unsigned dimIndex;
+  size_t _nrSlices;
+  size_t endIndex; // end of the dataset along dimIndex
+
+  //! ring of slice buffers: the slice being processed, plus those read ahead
+  std::vector<T *> buffers;
+
+  std::vector<size_t> currentPos, currentSize;
+
+  mutable pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pthread_t thread;
+
+  // protected by mutex
+  size_t nrRead;     // number of slices read by the thread
+  size_t nrConsumed; // number of slices released by next()
+  bool holding;      // whether slice nrConsumed is handed out by next()
+  bool stop;
+  std::string error;
+  double _stallTime;
+
+  //! Returns the position and sizes of slice `index`.
+  void slice( size_t index, std::vector<size_t> &pos, std::vector<size_t> &size ) const;
+
+  void readLoop();
+
+  static void *readThread( void *arg );
+
+  //! Frees the buffers and the raw reader.
+  void freeBuffers();
+};
+
+}
+
+#include "DatasetStreamReader.tcc"
+
+#endif
+
@@ -0,0 +1,253 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdlib>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace dal {
+
+template<typename T> DatasetStreamReader<T>::DatasetStreamReader( Dataset<T> &dataset,
+        const std::vector<size_t> &pos, const std::vector<size_t> &size, unsigned dimIndex, size_t queueLength )
+:
+  dataset(dataset),
+  rawReader(0),
+  startPos(pos),
+  _size(size),
+  dimIndex(dimIndex),
+  _nrSlices(0),
+  endIndex(0),
+  nrRead(0),
+  nrConsumed(0),
+  holding(false),
+  stop(false),
+  _stallTime(0.0)
+{
+  const std::vector<ssize_t> dims = dataset.dims();
+
+  if (pos.size() != dims.size() || size.size() != dims.size())
+    throw DALValueError("Cannot stream if specified position or slice size does not match dimensionality of dataset " + dataset.name());
+
+  if (dimIndex >= dims.size())
+    throw DALIndexError("Cannot stream if dimIndex exceeds rank of dataset " + dataset.name());
+
+  if (queueLength == 0)
+    throw DALValueError("Cannot stream with a queue length of 0 from dataset " + dataset.name());
+
+  if (size[dimIndex] == 0)
+    throw DALValueError("Cannot stream empty slices from dataset " + dataset.name());
+
+  size_t nrElements = 1;
+
+  for (size_t d = 0; d < dims.size(); d++) {
+    if (pos[d] + (d == dimIndex ? 0 : size[d]) > (size_t)dims[d])
+      throw DALIndexError("Cannot stream slices beyond the dimensions of dataset " + dataset.name());
+
+    nrElements *= size[d];
+  }
+
+  endIndex = dims[dimIndex];
+  _nrSlices = (endIndex - pos[dimIndex] + size[dimIndex] - 1) / size[dimIndex];
+
+  // read raw data directly where possible, so that the thread does not need the HDF5Lock
+  try {
+    rawReader = new ConcurrentReader<T>(dataset);
+  } catch (DALValueError &) {
+    // not in native format in external files: read through HDF5
+  }
+
+  const size_t alignment = sysconf(_SC_PAGESIZE);
+
+  buffers.reserve(queueLength + 1);
+
+  for (size_t i = 0; i < queueLength + 1; i++) {
+    void *buffer;
+
+    if (posix_memalign(&buffer, alignment, std::max<size_t>(1, nrElements * sizeof(T))) != 0) {
+      freeBuffers();
+      throw DALException("Could not allocate stream buffers for dataset " + dataset.name());
+    }
+
+    buffers.push_back(static_cast<T *>(buffer));
+  }
+
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&cond, NULL);
+
+  if (pthread_create(&thread, NULL, readThread, this) != 0) {
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&mutex);
+    freeBuffers();
+    throw DALException("Could not start stream thread for dataset " + dataset.name());
+  }
+}
+
+template<typename T> DatasetStreamReader<T>::~DatasetStreamReader()
+{
+  pthread_mutex_lock(&mutex);
+  stop = true;
+  pthread_cond_broadcast(&cond);
+  pthread_mutex_unlock(&mutex);
+
+  pthread_join(thread, NULL);
+
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&mutex);
+  freeBuffers();
+}
+
+template<typename T> const T *DatasetStreamReader<T>::next()
+{
+  pthread_mutex_lock(&mutex);
+
+  // release the previous slice, so its buffer can be refilled
+  if (holding) {
+    holding = false;
+    nrConsumed++;
+    pthread_cond_broadcast(&cond);
+  }
+
+  if (nrConsumed == _nrSlices) {
+    pthread_mutex_unlock(&mutex);
+    return NULL;
+  }
+
+  if (nrRead == nrConsumed && error.empty()) {
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    while (nrRead == nrConsumed && error.empty())
+      pthread_cond_wait(&cond, &mutex);
+
+    gettimeofday(&end, NULL);
+    _stallTime += (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1.0e6;
+  }
+
+  if (nrRead == nrConsumed) {
+    const std::string msg = error;
+
+    pthread_mutex_unlock(&mutex);
+    throw DALException(msg);
+  }
+
+  holding = true;
+  const size_t index = nrConsumed;
+
+  pthread_mutex_unlock(&mutex);
+
+  slice(index, currentPos, currentSize);
+
+  return buffers[index % buffers.size()];
+}
+
+template<typename T> size_t DatasetStreamReader<T>::queueDepth() const
+{
+  pthread_mutex_lock(&mutex);
+  const size_t depth = nrRead - nrConsumed - (holding ? 1 : 0);
+  pthread_mutex_unlock(&mutex);
+
+  return depth;
+}
+
+template<typename T> double DatasetStreamReader<T>::stallTime() const
+{
+  pthread_mutex_lock(&mutex);
+  const double result = _stallTime;
+  pthread_mutex_unlock(&mutex);
+
+  return result;
+}
+
+template<typename T> void DatasetStreamReader<T>::slice( size_t index,
+        std::vector<size_t> &pos, std::vector<size_t> &size ) const
+{
+  pos = startPos;
+  size = _size;
+
+  pos[dimIndex] += index * _size[dimIndex];
+
+  // the last slice can be shorter
+  size[dimIndex] = std::min(size[dimIndex], endIndex - pos[dimIndex]);
+}
+
+template<typename T> void DatasetStreamReader<T>::readLoop()
+{
+  std::vector<size_t> pos, size;
+
+  pthread_mutex_lock(&mutex);
+
+  while (!stop && nrRead < _nrSlices) {
+    // wait for a free buffer
+    while (!stop && nrRead - nrConsumed == buffers.size())
+      pthread_cond_wait(&cond, &mutex);
+
+    if (stop)
+      break;
+
+    const size_t index = nrRead;
+
+    pthread_mutex_unlock(&mutex);
+
+    std::string msg;
+
+    try {
+      slice(index, pos, size);
+
+      if (rawReader) {
+        rawReader->getMatrix(pos, buffers[index % buffers.size()], size);
+      } else {
+        HDF5Lock lock;
+        dataset.getMatrix(pos, buffers[index % buffers.size()], size);
+      }
+    } catch (std::exception &e) {
+      msg = e.what();
+    }
+
+    pthread_mutex_lock(&mutex);
+
+    if (!msg.empty()) {
+      error = "Could not read slice from dataset " + dataset.name() + ": " + msg;
+      pthread_cond_broadcast(&cond);
+      break;
+    }
+
+    nrRead++;
+    pthread_cond_broadcast(&cond);
+  }
+
+  pthread_mutex_unlock(&mutex);
+}
+
+template<typename T> void *DatasetStreamReader<T>::readThread( void *arg )
+{
+  static_cast<DatasetStreamReader<T> *>(arg)->readLoop();
+
+  return NULL;
+}
+
+template<typename T> void DatasetStreamReader<T>::freeBuffers()
+{
+  for (size_t i = 0; i < buffers.size(); i++)
+    free(buffers[i]);
+
+  buffers.clear();
+
+  delete rawReader;
+  rawReader = 0;
+}
+
+}
+
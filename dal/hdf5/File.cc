@@ -16,27 +16,164 @@
  */
 #include "File.h"
 #include "Attribute.h"
+#include "types/FileCopy.h"
+#include "types/HDF5Lock.h"
+#include "types/ObjectAccess.h"
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// H5_VERSION_GE is not available in old HDF5 1.8 releases
+#ifdef H5_VERSION_GE
+#define DAL_HDF5_VERSION_GE(major, minor, release) H5_VERSION_GE(major, minor, release)
+#else
+#define DAL_HDF5_VERSION_GE(major, minor, release) 0
+#endif
+
+// H5Pset_file_locking() appeared in 1.10.7 and 1.12.1
+#define DAL_HAVE_FILE_LOCKING (DAL_HDF5_VERSION_GE(1, 12, 1) || (DAL_HDF5_VERSION_GE(1, 10, 7) && !DAL_HDF5_VERSION_GE(1, 11, 0)))
 
 using namespace std;
 
 namespace dal {
 
+//! The size of the memory blocks in which the core driver grows IN_MEMORY files.
+static const size_t coreIncrement = 1024 * 1024;
+
+FileAccessOptions::FileAccessOptions()
+:
+  metadataCacheSize(0),
+  sieveBufferSize(0),
+  pageBufferSize(0),
+  smallDataBlockSize(0),
+  metadataBlockSize(0),
+  fileLocking(-1),
+  evictOnClose(false),
+  persistOnClose(false),
+  deferChecks(false)
+{
+}
+
+FileAccessOptions FileAccessOptions::headerScan()
+{
+  FileAccessOptions options;
+
+  // each file is visited once, so caching beyond the file's lifetime does not pay off
+#if DAL_HDF5_VERSION_GE(1, 10, 1)
+  options.evictOnClose = true;
+#endif
+
+  return options;
+}
+
+FileAccessOptions FileAccessOptions::bulkRead()
+{
+  FileAccessOptions options;
+
+  options.metadataCacheSize = 64 * 1024 * 1024;
+  options.sieveBufferSize = 1024 * 1024;
+
+  return options;
+}
+
+//! Applies `options` to the file access property list `fapl`.
+static void setAccessOptions( hid_t fapl, const FileAccessOptions &options, const string &filename )
+{
+  if (options.metadataCacheSize > 0) {
+    H5AC_cache_config_t config;
+    config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+
+    if (H5Pget_mdc_config(fapl, &config) < 0)
+      throw HDF5Exception("Could not get metadata cache configuration to open file " + filename);
+
+    // start at the full size instead of growing to it
+    config.set_initial_size = true;
+    config.initial_size = options.metadataCacheSize;
+    config.max_size = options.metadataCacheSize;
+    config.min_size = min(config.min_size, options.metadataCacheSize);
+
+    if (H5Pset_mdc_config(fapl, &config) < 0)
+      throw HDF5Exception("Could not set metadata cache size to open file " + filename);
+  }
+
+  if (options.sieveBufferSize > 0 && H5Pset_sieve_buf_size(fapl, options.sieveBufferSize) < 0)
+    throw HDF5Exception("Could not set sieve buffer size to open file " + filename);
+
+  if (options.smallDataBlockSize > 0 && H5Pset_small_data_block_size(fapl, options.smallDataBlockSize) < 0)
+    throw HDF5Exception("Could not set small data block size to open file " + filename);
+
+  if (options.metadataBlockSize > 0 && H5Pset_meta_block_size(fapl, options.metadataBlockSize) < 0)
+    throw HDF5Exception("Could not set metadata block size to open file " + filename);
+
+  if (options.pageBufferSize > 0) {
+#if DAL_HDF5_VERSION_GE(1, 10, 1)
+    if (H5Pset_page_buffer_size(fapl, options.pageBufferSize, 0, 0) < 0)
+      throw HDF5Exception("Could not set page buffer size to open file " + filename);
+#else
+    throw DALValueError("Could not enable page buffering to open file " + filename + ": requires HDF5 1.10.1");
+#endif
+  }
+
+  if (options.fileLocking != -1) {
+#if DAL_HAVE_FILE_LOCKING
+    if (H5Pset_file_locking(fapl, options.fileLocking != 0, true) < 0)
+      throw HDF5Exception("Could not set file locking to open file " + filename);
+#else
+    throw DALValueError("Could not set file locking to open file " + filename + ": requires HDF5 1.10.7");
+#endif
+  }
+
+  if (options.evictOnClose) {
+#if DAL_HDF5_VERSION_GE(1, 10, 1)
+    if (H5Pset_evict_on_close(fapl, true) < 0)
+      throw HDF5Exception("Could not enable evict on close to open file " + filename);
+#else
+    throw DALValueError("Could not enable evict on close to open file " + filename + ": requires HDF5 1.10.1");
+#endif
+  }
+}
+
 File::File() {}
 
-File::File( const std::string &filename, FileMode mode, const std::string &versionAttrName )
+File::File( const std::string &filename, FileMode mode, const std::string &versionAttrName, const FileAccessOptions &options )
 :
   // Store the file hid as the group hid.
-  Group(openFile(filename, mode), FileInfo(filename, mode, versionAttrName))
+  Group(openFile(filename, mode, options), FileInfo(filename, mode, versionAttrName))
+{
+  initVersion(mode, versionAttrName, options.deferChecks);
+}
+
+File::File( const hid_gc &file, const std::string &filename, FileMode mode, const std::string &versionAttrName, bool deferChecks )
+:
+  Group(file, FileInfo(filename, mode, versionAttrName))
+{
+  initVersion(mode, versionAttrName, deferChecks);
+}
+
+File::File( const File &other )
+:
+  Group(other)
+{
+}
+
+void File::initVersion( FileMode mode, const std::string &versionAttrName, bool deferChecks )
 {
   if (!versionAttrName.empty()) {
     // To make specialized VersionType [gs]et() functions usable, access HDF5 version string attribute around it.
     // Not passed in initializer, because eval order of openFile(), FileInfo() is unspecified.
     Attribute<string> h5StoredVersionAttr(*this, versionAttrName);
 
-    if (mode == CREATE || mode == CREATE_EXCL) {
+    if (mode == CREATE || mode == CREATE_EXCL || mode == IN_MEMORY) {
       // In-memory version already default initialized.
       string defaultVersion(VersionType().to_string());
       h5StoredVersionAttr.create().set(defaultVersion);
+    } else if (deferChecks) {
+      // Read on first use, see Node::fileInfoVersion().
+      fileInfo.setFileVersionPending(true);
     } else {
       // Try to set in-memory version from HDF5 attribute.
       setFileInfoVersion(h5StoredVersionAttr.get());
@@ -46,7 +183,10 @@ File::File( const std::string &filename, FileMode mode, const std::string &versi
   }
 }
 
-File::~File() {}
+File::~File()
+{
+  // staged writes are committed once the last object of the file is destructed, see FileInfoType
+}
 
 File& File::operator=(File rhs)
 {
@@ -59,45 +199,125 @@ void swap(File& first, File& second)
   swap(static_cast<Group&>(first), static_cast<Group&>(second));
 }
 
-void File::open( const std::string &filename, FileMode mode, const std::string &versionAttrName )
+void File::open( const std::string &filename, FileMode mode, const std::string &versionAttrName, const FileAccessOptions &options )
+{
+  commitWrites();
+
+  File ftmp(filename, mode, versionAttrName, options);
+  swap(*this, ftmp);
+}
+
+void File::openImage( const std::string &filename, const void *image, size_t size, FileMode mode, const std::string &versionAttrName )
 {
-  File ftmp(filename, mode, versionAttrName);
+  if (mode != READ && mode != READWRITE)
+    throw DALValueError("Could not open file image: mode must be READ or READWRITE");
+
+  hid_gc_noref fapl(H5Pcreate(H5P_FILE_ACCESS), H5Pclose, "Could not create file access property list to open file image ", filename);
+
+  if (H5Pset_fapl_core(fapl, coreIncrement, false) < 0)
+    throw HDF5Exception("Could not select core driver to open file image " + filename);
+
+  if (H5Pset_file_image(fapl, const_cast<void *>(image), size) < 0)
+    throw HDF5Exception("Could not set file image to open " + filename);
+
+  const unsigned flags = mode == READ ? H5F_ACC_RDONLY : H5F_ACC_RDWR;
+  hid_gc file(H5Fopen(filename.c_str(), flags, fapl), H5Fclose, "Could not open file image ", filename);
+
+  commitWrites();
+
+  File ftmp(file, filename, mode, versionAttrName, false);
   swap(*this, ftmp);
 }
 
+vector<char> File::image()
+{
+  flush();
+
+  const ssize_t size = H5Fget_file_image(group(), NULL, 0);
+  if (size < 0)
+    throw HDF5Exception("Could not get size of file image of " + filename());
+
+  vector<char> buf(size);
+  if (size > 0 && H5Fget_file_image(group(), &buf[0], buf.size()) < 0)
+    throw HDF5Exception("Could not get file image of " + filename());
+
+  return buf;
+}
+
 void File::close()
 {
+  commitWrites();
+
   File ftmp;
   swap(*this, ftmp);
 }
 
-hid_gc File::openFile( const std::string &filename, FileMode mode ) const
+hid_gc File::openFile( const std::string &filename, FileMode mode, const FileAccessOptions &options ) const
 {
+  hid_gc_noref fapl(H5Pcreate(H5P_FILE_ACCESS), H5Pclose, "Could not create file access property list to open file ", filename);
+
+  setAccessOptions(fapl, options, filename);
+
   switch (mode) {
+    case IN_MEMORY:
+      if (H5Pset_fapl_core(fapl, coreIncrement, options.persistOnClose) < 0)
+        throw HDF5Exception("Could not select core driver to create file " + filename);
+
+      // create the file like CREATE, truncating any file with the same name if it is to be persisted
+      // fall through
+
     case CREATE:
     case CREATE_EXCL:
       {
-        hid_gc_noref fapl(H5Pcreate(H5P_FILE_ACCESS), H5Pclose, "Could not create file access property list to create file " + filename);
-
         /* We use the latest version to create the file, for maximum efficiency. HDF5 offers very little
-           choice here. */
-        if (H5Pset_libver_bounds(fapl, H5F_LIBVER_LATEST, H5F_LIBVER_LATEST) < 0)
+           choice here.
+
+           In-memory files are the exception: HDF5 does not update the superblock checksum when it
+           clears the write flags in an image of an open file (see image()), so we keep the
+           superblock version that has no checksum. */
+        const H5F_libver_t low = mode == IN_MEMORY ? H5F_LIBVER_EARLIEST : H5F_LIBVER_LATEST;
+
+        if (H5Pset_libver_bounds(fapl, low, H5F_LIBVER_LATEST) < 0)
           throw DALException("Could not set HDF5 version bounds to create forward compatible file");
 
+        hid_gc_noref fcpl(H5Pcreate(H5P_FILE_CREATE), H5Pclose, "Could not create file creation property list to create file ", filename);
+
+#if DAL_HDF5_VERSION_GE(1, 10, 1)
+        // HDF5 only allows page buffering for files that store their data in pages
+        if (options.pageBufferSize > 0 && H5Pset_file_space_strategy(fcpl, H5F_FSPACE_STRATEGY_PAGE, false, 1) < 0)
+          throw HDF5Exception("Could not set paged file space strategy to create file " + filename);
+#endif
+
         unsigned flags;
-        if (mode == CREATE)
+        if (mode == CREATE || mode == IN_MEMORY)
           flags = H5F_ACC_TRUNC;
         else // mode == CREATE_EXCL
           flags = H5F_ACC_EXCL;
 
-        return hid_gc(H5Fcreate(filename.c_str(), flags, H5P_DEFAULT, fapl), H5Fclose, "Could not create file " + filename);
+        return hid_gc(H5Fcreate(filename.c_str(), flags, fcpl, fapl), H5Fclose, "Could not create file ", filename);
       }  
 
     case READ:  
-      return hid_gc(H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT), H5Fclose, "Could not open file for read-only access; file " + filename);
+      return hid_gc(H5Fopen(filename.c_str(), H5F_ACC_RDONLY, fapl), H5Fclose, "Could not open file for read-only access; file ", filename);
 
     case READWRITE:  
-      return hid_gc(H5Fopen(filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT), H5Fclose, "Could not open file for read-write access; file " + filename);
+      return hid_gc(H5Fopen(filename.c_str(), H5F_ACC_RDWR, fapl), H5Fclose, "Could not open file for read-write access; file ", filename);
+
+#if DAL_HDF5_VERSION_GE(1, 10, 0)
+    case SWMR_READ:
+      return hid_gc(H5Fopen(filename.c_str(), H5F_ACC_RDONLY | H5F_ACC_SWMR_READ, fapl), H5Fclose, "Could not open file for SWMR read access; file ", filename);
+
+    case SWMR_WRITE:
+      // SWMR needs the file format of HDF5 1.10, which CREATE uses
+      if (H5Pset_libver_bounds(fapl, H5F_LIBVER_LATEST, H5F_LIBVER_LATEST) < 0)
+        throw DALException("Could not set HDF5 version bounds to open file for SWMR write access");
+
+      return hid_gc(H5Fopen(filename.c_str(), H5F_ACC_RDWR | H5F_ACC_SWMR_WRITE, fapl), H5Fclose, "Could not open file for SWMR write access; file ", filename);
+#else
+    case SWMR_READ:
+    case SWMR_WRITE:
+      throw DALValueError("Could not open file: SWMR access requires HDF5 1.10 or later; file " + filename);
+#endif
 
     default:
       throw DALValueError("Could not open file: unknown mode argument");
@@ -106,9 +326,380 @@ hid_gc File::openFile( const std::string &filename, FileMode mode ) const
 
 void File::flush()
 {
+  commitWrites();
+
   H5Fflush(group(), H5F_SCOPE_GLOBAL);
 }
 
+void File::setWriteBatching( bool enable )
+{
+  if (!enable)
+    commitWrites();
+
+  fileInfo.attributeBatch().setEnabled(enable);
+}
+
+bool File::writeBatching() const
+{
+  return fileInfo.attributeBatch().enabled();
+}
+
+void File::startSWMRWrite()
+{
+  commitWrites();
+
+#if DAL_HDF5_VERSION_GE(1, 10, 0)
+  // other threads (see IOExecutor, DatasetStreamReader) may use the objects that HDF5 reopens
+  HDF5Lock lock;
+
+  /* HDF5 reopens all open groups and datasets to start SWMR writing, registering each under
+     its old id again, which fails for ids with more than one reference, as held by copies of
+     DAL objects. So drop the extra references while starting, and restore them afterwards. */
+  const unsigned types = H5F_OBJ_DATASET | H5F_OBJ_GROUP | H5F_OBJ_LOCAL;
+  const ssize_t count = H5Fget_obj_count(group(), types);
+  if (count < 0)
+    throw HDF5Exception("Could not count open objects to start SWMR write access to file " + filename());
+
+  vector<hid_t> objects(count);
+  if (count > 0 && H5Fget_obj_ids(group(), types, count, &objects[0]) < 0)
+    throw HDF5Exception("Could not get open objects to start SWMR write access to file " + filename());
+
+  vector<int> extraRefs(count);
+  for (ssize_t i = 0; i < count; i++) {
+    extraRefs[i] = std::max(H5Iget_ref(objects[i]) - 1, 0);
+
+    for (int r = 0; r < extraRefs[i]; r++)
+      H5Idec_ref(objects[i]);
+  }
+
+  const herr_t result = H5Fstart_swmr_write(group());
+
+  // if starting failed halfway, HDF5 may have closed objects without reopening them
+  bool closed = false;
+
+  for (ssize_t i = 0; i < count; i++) {
+    if (H5Iis_valid(objects[i]) <= 0) {
+      closed = true;
+      continue;
+    }
+
+    for (int r = 0; r < extraRefs[i]; r++)
+      H5Iinc_ref(objects[i]);
+  }
+
+  if (result < 0) {
+    if (closed)
+      throw HDF5Exception("Could not start SWMR write access to file " + filename() + "; some of its open groups and datasets were closed and can no longer be used");
+
+    throw HDF5Exception("Could not start SWMR write access to file " + filename());
+  }
+
+  // HDF5 reopened the open datasets, possibly without our external file prefix (see DatasetShape)
+  for (ssize_t i = 0; i < count; i++) {
+    if (H5Iget_type(objects[i]) != H5I_DATASET)
+      continue;
+
+    const ssize_t pathlen = H5Iget_name(objects[i], NULL, 0);
+    if (pathlen <= 0)
+      continue;
+
+    vector<char> path(pathlen + 1);
+    if (H5Iget_name(objects[i], &path[0], path.size()) < 0)
+      continue;
+
+    fileInfo.datasetShape(&path[0]).efilePrefixLost = !hasExternalFilePrefix(objects[i]);
+  }
+#else
+  throw DALException("Could not start SWMR write access: requires HDF5 1.10 or later; file " + filename());
+#endif
+}
+
+void File::commitWrites()
+{
+  AttributeBatch &batch = fileInfo.attributeBatch();
+
+  if (!batch.empty())
+    batch.commit();
+}
+
+void File::writeIndex( const std::string &indexFilename )
+{
+  if (fileMode() != READ)
+    throw DALException("Could not write index of file opened for writing: " + filename());
+
+  MetadataIndex index;
+  index.build(group());
+  index.write(indexFilename.empty() ? filename() + ".dalidx" : indexFilename, filename());
+}
+
+bool File::loadIndex( const std::string &indexFilename )
+{
+  if (fileMode() != READ)
+    return false;
+
+  MetadataIndex &index = fileInfo.metadataIndex();
+  if (!index.read(indexFilename.empty() ? filename() + ".dalidx" : indexFilename, filename()))
+    return false;
+
+  const IndexedObject *root = index.find("/");
+  if (root)
+    attributes.assign(root->attributes);
+
+  return true;
+}
+
+static herr_t copyAttribute( hid_t from, const char *name, const H5A_info_t *, void *opData )
+{
+  const hid_t to = *static_cast<hid_t *>(opData);
+
+  // do not let exceptions pass through HDF5
+  try {
+    hid_gc_noref attr(H5Aopen(from, name, H5P_DEFAULT), H5Aclose, "Could not open attribute ", name);
+    hid_gc_noref datatype(H5Aget_type(attr), H5Tclose, "Could not get datatype of attribute ", name);
+    hid_gc_noref dataspace(H5Aget_space(attr), H5Sclose, "Could not get dataspace of attribute ", name);
+
+    const hssize_t nrElements = H5Sget_simple_extent_npoints(dataspace);
+    const size_t elementSize = H5Tget_size(datatype);
+    if (nrElements < 0 || elementSize == 0)
+      return -1;
+
+    // Reading with the file type as memory type keeps the value as is.
+    // Variable-length data is read into memory allocated by HDF5.
+    vector<char> buf(max<size_t>(1, nrElements * elementSize));
+    if (H5Aread(attr, datatype, &buf[0]) < 0)
+      return -1;
+
+    hid_gc_noref copy(H5Acreate2(to, name, datatype, dataspace, H5P_DEFAULT, H5P_DEFAULT), H5Aclose, "Could not create attribute ", name);
+    const herr_t written = H5Awrite(copy, datatype, &buf[0]);
+
+    H5Dvlen_reclaim(datatype, dataspace, H5P_DEFAULT, &buf[0]);
+
+    if (written < 0)
+      return -1;
+  } catch (...) {
+    return -1;
+  }
+
+  return 0;
+}
+
+//! Copies all attributes of HDF5 object `from` to `to`.
+static void copyAttributes( hid_t from, hid_t to, const string &name )
+{
+  hsize_t idx = 0;
+
+  if (H5Aiterate2(from, H5_INDEX_NAME, H5_ITER_NATIVE, &idx, copyAttribute, &to) < 0)
+    throw HDF5Exception("Could not copy attributes of " + name);
+}
+
+//! Returns the number of hard links to HDF5 object `object`.
+static unsigned linkCount( hid_t object )
+{
+#if DAL_HDF5_VERSION_GE(1, 12, 0)
+  H5O_info2_t info;
+  if (H5Oget_info3(object, &info, H5O_INFO_BASIC) < 0)
+#else
+  H5O_info_t info;
+#if DAL_HDF5_VERSION_GE(1, 10, 3)
+  if (H5Oget_info2(object, &info, H5O_INFO_BASIC) < 0)
+#else
+  if (H5Oget_info(object, &info) < 0)
+#endif
+#endif
+    throw HDF5Exception("Could not get number of links to object");
+
+  return info.rc;
+}
+
+struct LinkSearch {
+  string location;       // objectLocation() of the object to find
+  vector<string> paths;  // absolute paths of the hard links to it
+};
+
+static herr_t findLink( hid_t root, const char *name, const H5L_info_t *linkInfo, void *opData )
+{
+  LinkSearch &search = *static_cast<LinkSearch *>(opData);
+
+  // do not let exceptions pass through HDF5
+  try {
+    if (linkInfo->type != H5L_TYPE_HARD)
+      return 0;
+
+    const hid_t object = openObject(root, name);
+    if (object < 0)
+      return 0;
+
+    hid_gc_noref obj(object, H5Oclose, "Could not open object ", name);
+
+    if (objectLocation(obj) == search.location)
+      search.paths.push_back(string("/") + name);
+  } catch (...) {
+    return -1;
+  }
+
+  return 0;
+}
+
+//! Returns the absolute paths of the hard links in `file` to object `path`, other than `path`.
+static vector<string> otherLinks( hid_t file, const string &path )
+{
+  hid_gc_noref object(openObject(file, path.c_str()), H5Oclose, "Could not open object ", path);
+
+  LinkSearch search;
+
+  if (linkCount(object) > 1) {
+    search.location = objectLocation(object);
+
+    hid_gc_noref root(H5Gopen2(file, "/", H5P_DEFAULT), H5Gclose, "Could not open root group to find links to ", path);
+    if (H5Lvisit(root, H5_INDEX_NAME, H5_ITER_INC, findLink, &search) < 0)
+      throw HDF5Exception("Could not find all links to " + path);
+
+    search.paths.erase(std::remove(search.paths.begin(), search.paths.end(), path), search.paths.end());
+  }
+
+  return search.paths;
+}
+
+/*
+ * Replaces the external files of dataset `path` in `file` by `names`. The external file list
+ * cannot be changed, so the dataset is recreated with the new list and its attributes copied.
+ * The objects at `links` are replaced by hard links to the new dataset.
+ */
+static void setExternalFiles( hid_t file, const string &path, const vector<string> &names, const vector<string> &links )
+{
+  hid_gc_noref dataset(H5Dopen2(file, path.c_str(), H5P_DEFAULT), H5Dclose, "Could not open dataset ", path);
+  hid_gc_noref datatype(H5Dget_type(dataset), H5Tclose, "Could not get datatype of dataset ", path);
+  hid_gc_noref dataspace(H5Dget_space(dataset), H5Sclose, "Could not get dataspace of dataset ", path);
+  hid_gc_noref oldDcpl(H5Dget_create_plist(dataset), H5Pclose, "Could not open dataset creation property list of dataset ", path);
+  hid_gc_noref dcpl(H5Pcreate(H5P_DATASET_CREATE), H5Pclose, "Could not create dataset creation property list to copy dataset ", path);
+
+  H5Pset_layout(dcpl, H5D_CONTIGUOUS);
+
+  // the data is already in the external files: never overwrite it with fill values
+  if (H5Pset_fill_time(dcpl, H5D_FILL_TIME_NEVER) < 0)
+    throw HDF5Exception("Could not disable fill values to copy dataset " + path);
+
+  for (size_t i = 0; i < names.size(); i++) {
+    off_t offset;
+    hsize_t size;
+
+    if (H5Pget_external(oldDcpl, i, 0, NULL, &offset, &size) < 0)
+      throw HDF5Exception("Could not get external file of dataset " + path);
+
+    if (H5Pset_external(dcpl, names[i].c_str(), offset, size) < 0)
+      throw HDF5Exception("Could not add external file to copy dataset " + path);
+  }
+
+  const string newPath = path + ".copy";
+  hid_gc_noref newDataset(H5Dcreate2(file, newPath.c_str(), datatype, dataspace, H5P_DEFAULT, dcpl, H5P_DEFAULT), H5Dclose, "Could not create dataset ", newPath);
+
+  copyAttributes(dataset, newDataset, path);
+
+  if (H5Ldelete(file, path.c_str(), H5P_DEFAULT) < 0
+   || H5Lmove(file, newPath.c_str(), file, path.c_str(), H5P_DEFAULT, H5P_DEFAULT) < 0)
+    throw HDF5Exception("Could not replace dataset " + path);
+
+  for (size_t i = 0; i < links.size(); i++) {
+    const string &link = links[i];
+
+    if (H5Ldelete(file, link.c_str(), H5P_DEFAULT) < 0
+     || H5Lcreate_hard(file, path.c_str(), file, link.c_str(), H5P_DEFAULT, H5P_DEFAULT) < 0)
+      throw HDF5Exception("Could not link " + link + " to replaced dataset " + path);
+  }
+}
+
+void File::copyTo( const std::string &destination, CopyMode mode, unsigned nrThreads )
+{
+  commitWrites();
+
+  MetadataIndex index;
+  index.build(group());
+
+  const string sourceDir(FileInfo::getDirname(filename()));
+  const string destDir(FileInfo::getDirname(destination));
+
+  vector< pair<string, string> > copies;
+  map<string, string> sources;                 // destination -> source of the external files to copy
+  map<string, vector<string> > renamedFiles;   // dataset path -> new external file names
+
+  const map<string, IndexedObject> &objects = index.objects();
+
+  for (map<string, IndexedObject>::const_iterator i = objects.begin(); i != objects.end(); ++i) {
+    vector<string> names(i->second.externalFiles);
+    bool renamed = false;
+
+    for (size_t n = 0; n < names.size(); n++) {
+      const string &name = names[n];
+      const string source = name[0] == '/' ? name : sourceDir + "/" + name;
+
+      if (name[0] == '/' || name.find('/') != string::npos) {
+        names[n] = FileInfo::getBasename(name);
+        renamed = true;
+      }
+
+      const string dest = destDir + "/" + names[n];
+
+      map<string, string>::const_iterator prev = sources.find(dest);
+      if (prev != sources.end()) {
+        if (prev->second != source)
+          throw DALValueError("Could not copy both " + prev->second + " and " + source + " to " + dest);
+
+        continue; // shared by several datasets
+      }
+
+      sources[dest] = source;
+
+      struct stat st;
+      if (::stat(source.c_str(), &st) != 0) {
+        if (errno == ENOENT)
+          continue; // no data was written yet
+
+        throw DALException("Could not access external file " + source);
+      }
+
+      copies.push_back(make_pair(source, dest));
+    }
+
+    if (renamed)
+      renamedFiles[i->first] = names;
+  }
+
+  // create the destination first, so that an existing one is reported before any external file is copied
+  hid_gc copy(openFile(destination, CREATE_EXCL));
+  bool filesCopied = false;
+
+  try {
+    // removes its own copies on failure
+    copyFiles(copies, mode == HARDLINK, nrThreads);
+    filesCopied = true;
+
+    // copy the HDF5 objects; the root group cannot be copied itself
+    copyAttributes(group(), copy, "/");
+
+    const vector<string> names(memberNames());
+    for (size_t i = 0; i < names.size(); i++)
+      if (H5Ocopy(group(), names[i].c_str(), copy, names[i].c_str(), H5P_DEFAULT, H5P_DEFAULT) < 0)
+        throw HDF5Exception("Could not copy " + names[i] + " to " + destination);
+
+    /* The metadata index lists datasets with several hard links only under their first path,
+       and H5Ocopy() copies them once for every member of the root group through which they
+       can be reached. Link their other paths to the recreated dataset. */
+    for (map<string, vector<string> >::const_iterator i = renamedFiles.begin(); i != renamedFiles.end(); ++i)
+      setExternalFiles(copy, i->first, i->second, otherLinks(group(), i->first));
+
+    if (H5Fflush(copy, H5F_SCOPE_GLOBAL) < 0)
+      throw HDF5Exception("Could not flush " + destination);
+  } catch (...) {
+    // do not leave a partial copy behind
+    if (filesCopied)
+      for (size_t i = 0; i < copies.size(); i++)
+        ::unlink(copies[i].second.c_str());
+
+    ::unlink(destination.c_str());
+    throw;
+  }
+}
+
 bool File::exists() const
 {
   return true;
@@ -121,7 +712,7 @@ Attribute<VersionType> File::version()
 
 void File::initFileNodes()
 {
-  addNode( new Attribute<VersionType>(*this, versionAttrName()) );
+  addNode(versionAttrName(), createNode< Attribute<VersionType> >);
 }
 
 void File::open( hid_t parent, const std::string &name )
@@ -18,6 +18,7 @@
 #define DAL_FILE_H
 
 #include <string>
+#include <vector>
 #include <hdf5.h>
 #include "types/versiontype.h"
 #include "Group.h"
@@ -25,6 +26,80 @@
 
 namespace dal {
 
+/*!
+ * HDF5 file access settings, passed when opening or creating a File. The default
+ * values keep the HDF5 defaults. headerScan() and bulkRead() provide profiles
+ * for common access patterns.
+ *
+ * Settings that the HDF5 library in use does not support cause an exception when
+ * the file is opened, except that the profiles only use supported settings.
+ *
+ * Python example:
+ * \code
+ *    # Create a new HDF5 file called "example.h5"
+ *    >>> f = File("example.h5", File.CREATE)
+ *    >>> f.close()
+ *
+ *    # Reopen it with a larger metadata cache
+ *    >>> options = FileAccessOptions.headerScan()
+ *    >>> options.metadataCacheSize = 64 * 1024 * 1024
+ *    >>> f = File("example.h5", File.READ, "", options)
+ *
+ *    # Clean up
+ *    >>> import os
+ *    >>> os.remove("example.h5")
+ * \endcode
+ */
+struct FileAccessOptions {
+  FileAccessOptions();
+
+  //! Maximum size of the metadata cache in bytes (0: HDF5 default, which adapts between 1 and 32 MiB).
+  size_t metadataCacheSize;
+
+  //! Size of the sieve buffer in bytes, used for partial I/O on contiguous data stored inside the HDF5 file (0: HDF5 default of 64 KiB).
+  size_t sieveBufferSize;
+
+  /*!
+   * Size of the page buffer in bytes (0: disabled). Requires HDF5 1.10.1.
+   * HDF5 can only open files with page buffering that store their data in pages,
+   * so files created with page buffering do so.
+   */
+  size_t pageBufferSize;
+
+  //! Size of the blocks in which small raw data resp. metadata allocations are aggregated when writing (0: HDF5 default of 2 KiB).
+  size_t smallDataBlockSize;
+  size_t metadataBlockSize;
+
+  //! Whether to lock the file: 1 to lock, 0 not to lock (e.g. for file systems without locking), -1 for the HDF5 default. Requires HDF5 1.10.7.
+  int fileLocking;
+
+  //! Whether to evict the metadata of an object from the cache once it is closed, to save memory. Requires HDF5 1.10.1.
+  bool evictOnClose;
+
+  //! For IN_MEMORY files: whether to write the file to disk (under its file name) when it is closed.
+  bool persistOnClose;
+
+  /*!
+   * Whether to make opening an existing file cheaper by deferring checks: the version attribute
+   * is read when the file version is first needed, so a missing version attribute is reported then.
+   * Subclasses skip their file type checks (e.g. FILETYPE and TELESCOPE) entirely: they only run
+   * if the caller calls checkFileType(), see for example CLA_File::checkFileType().
+   */
+  bool deferChecks;
+
+  /*!
+   * Settings to read the attributes of many files, for example to list their headers:
+   * objects are read once, so their metadata is evicted when closed to keep memory use flat.
+   */
+  static FileAccessOptions headerScan();
+
+  /*!
+   * Settings to read large amounts of data from a few files: a large metadata cache and
+   * a large sieve buffer, so that the HDF5 internals do not limit the I/O request sizes.
+   */
+  static FileAccessOptions bulkRead();
+};
+
 /*!
  * A File object encapsulates the data and provides the functions to operate on a HDF5 file.
  *
@@ -41,6 +116,14 @@ namespace dal {
  */
 class File: public Group {
 public:
+  /*!
+   * How copyTo() creates the copies of external data files.
+   * COPY makes a copy, sharing the data blocks with the original if the file system supports it.
+   * HARDLINK creates hard links to the originals, or copies if that is not possible. A hard linked
+   * copy shares its raw data with the original: writing to the data of either file changes both.
+   */
+  enum CopyMode { COPY, HARDLINK };
+
   /*!
    * Create default File object.
    * This is intended to be able to have a container that contains a File object before the filename is known.
@@ -52,6 +135,14 @@ public:
    * Try to open or create `filename` with open mode `mode` and treat `versionAttrName` as the version attribute name.
    * For an existing file, the specified version attribute must exist. For a new file, it will be created.
    * The default value skips Node tracking (except Group's GROUPTYPE) and versioning.
+   * HDF5 accesses the file using the settings in `options`, see FileAccessOptions.
+   *
+   * Mode IN_MEMORY creates a new file in memory, using the HDF5 core driver. It is discarded when
+   * closed, unless options.persistOnClose is set. Datasets created with an external file keep their
+   * data in the in-memory file instead.
+   *
+   * Modes SWMR_READ and SWMR_WRITE open a file written with CREATE for single-writer/multiple-reader
+   * access, see startSWMRWrite(). They require HDF5 1.10 or later.
    *
    * See the class description for more info on reopening and closing files.
    *
@@ -70,7 +161,13 @@ public:
    *    >>> os.remove("example.h5")
    * \endcode
    */
-  File( const std::string &filename, FileMode mode = READ, const std::string &versionAttrName = "");
+  File( const std::string &filename, FileMode mode = READ, const std::string &versionAttrName = "",
+        const FileAccessOptions &options = FileAccessOptions() );
+
+  /*!
+   * Create a File object that refers to the same HDF5 file as `other`.
+   */
+  File( const File &other );
 
   /*!
    * Destruct File object.
@@ -91,14 +188,32 @@ public:
   friend void swap(File& first, File& second);
 
   /*!
-   * Open or create `filename` with open mode `mode` and treat `versionAttrName` as the version attribute name.
-   * Upon return, the previously opened file reference (if any) has been closed.
+   * Open or create `filename` with open mode `mode` and treat `versionAttrName` as the version attribute name,
+   * using the HDF5 settings in `options`. Upon return, the previously opened file reference (if any) has been closed.
    * If an exception is thrown, the previously opened file reference (if any) is unaltered.
    *
    * See the File(filename, mode, versionAttrName) constructor for more info.
    * See the class description for more info on reopening and closing files.
    */
-  void open( const std::string &filename, FileMode mode = READ, const std::string &versionAttrName = "");
+  void open( const std::string &filename, FileMode mode = READ, const std::string &versionAttrName = "",
+             const FileAccessOptions &options = FileAccessOptions() );
+
+  /*!
+   * Opens the file image `image` of `size` bytes (for example, obtained by image()) as a file in memory
+   * called `filename`, with open mode READ or READWRITE. The image is copied, and changes are
+   * made to the copy only. See open() for the other arguments.
+   */
+  void openImage( const std::string &filename, const void *image, size_t size, FileMode mode = READ,
+                  const std::string &versionAttrName = "" );
+
+  /*!
+   * Returns an image of this file as it would be stored on disk, including any staged attribute writes.
+   * Mostly useful for IN_MEMORY files.
+   *
+   * Note: HDF5 produces an unreadable image of a file opened for writing if the file uses
+   * a checksummed superblock (as CREATE does). IN_MEMORY files avoid such a superblock.
+   */
+  std::vector<char> image();
 
   /*!
    * Indicate that this File object will not be used anymore to access the underlying HDF5 file (if any),
@@ -109,10 +224,145 @@ public:
   virtual void close();
 
   /*!
-   * Commit any changes to disk.
+   * Commit any changes to disk, including any staged attribute writes.
    */
   void flush();
 
+  /*!
+   * Switches a file opened with CREATE to single-writer/multiple-reader (SWMR) writing, after
+   * which other processes can open it with SWMR_READ and follow the data as it is appended
+   * (see Dataset::refresh() and DatasetFollower). Files opened with SWMR_WRITE are in this state already.
+   *
+   * Create all groups, datasets and attributes before, as HDF5 does not allow objects
+   * to be added in SWMR mode. Readers see the new extents of datasets once flush() is called.
+   * The writer has to open the file before any SWMR readers do.
+   *
+   * HDF5 reopens the open groups and datasets of the file, holding off other threads using HDF5Lock.
+   * If that fails halfway, objects that HDF5 closed can no longer be used, which the exception says.
+   * Requires HDF5 1.10 or later.
+   */
+  void startSWMRWrite();
+
+  /*!
+   * Enables or disables write batching. While enabled, attributes that are created or set are
+   * staged in memory instead of written. The staged attributes are written group by group,
+   * each created directly with its final type and size, at flush(), close(), open(), when write
+   * batching is disabled, or once the last object (File, Group, Dataset, ...) of the file is
+   * destructed. Reading or removing an attribute first commits all staged writes.
+   *
+   * A staged attribute replaces any attribute with the same name in the file, and strings are
+   * always written as variable length strings. Errors are reported when the writes are committed,
+   * except on destruction, where they are lost.
+   *
+   * Python example:
+   * \code
+   *    # Create a new HDF5 file called "example.h5"
+   *    >>> f = File("example.h5", File.CREATE)
+   *
+   *    # Stage attributes in memory
+   *    >>> f.setWriteBatching(True)
+   *    >>> a = AttributeString(f, "EXAMPLE_ATTR")
+   *    >>> a.value = "hello world"
+   *
+   *    # Write them to the file
+   *    >>> f.flush()
+   *
+   *    # Clean up
+   *    >>> import os
+   *    >>> os.remove("example.h5")
+   * \endcode
+   */
+  void setWriteBatching( bool enable );
+
+  //! Returns whether write batching is enabled. See setWriteBatching().
+  bool writeBatching() const;
+
+  /*!
+   * Writes a sidecar index of the metadata of this file to `indexFilename`,
+   * or to filename() + ".dalidx" if empty. The index contains the object tree,
+   * the shapes and external files of all datasets, and the values of all attributes,
+   * together with the size, modification time and a checksum of the file.
+   *
+   * Closing a file that was opened for writing may modify it, which would invalidate
+   * the index. So the file must be opened READ, or a DALException is thrown.
+   */
+  void writeIndex( const std::string &indexFilename = "" );
+
+  /*!
+   * Loads a sidecar index written by writeIndex() from `indexFilename`, or from filename() + ".dalidx"
+   * if empty. Afterwards, the attributes, members, dimensions and external files of all objects
+   * in the index are served from memory, as if loadAttributes() was called on every group and dataset.
+   * Data is still read from HDF5.
+   *
+   * Returns false, and leaves this object unaltered, if the file was not opened READ, or if the
+   * index is missing, corrupt, or stale (the file changed after the index was written).
+   *
+   * Python example:
+   * \code
+   *    # Create a new HDF5 file called "example.h5"
+   *    >>> f = File("example.h5", File.CREATE)
+   *    >>> a = AttributeString(f, "EXAMPLE_ATTR")
+   *    >>> a.value = "hello world"
+   *
+   *    # Reopen it read-only and write its index
+   *    >>> del a
+   *    >>> f.close()
+   *    >>> f = File("example.h5", File.READ)
+   *    >>> f.writeIndex()
+   *
+   *    # Subsequent opens can use the index
+   *    >>> f = File("example.h5", File.READ)
+   *    >>> f.loadIndex()
+   *    True
+   *    >>> AttributeString(f, "EXAMPLE_ATTR").value
+   *    'hello world'
+   *
+   *    # Clean up
+   *    >>> import os
+   *    >>> os.remove("example.h5")
+   *    >>> os.remove("example.h5.dalidx")
+   * \endcode
+   */
+  bool loadIndex( const std::string &indexFilename = "" );
+
+  /*!
+   * Copies this file to a new HDF5 file `destination`, including the external data files of its
+   * datasets, which are copied (or linked, see CopyMode) next to `destination` using up to
+   * `nrThreads` threads. The HDF5 metadata is copied using H5Ocopy(). None of the created files
+   * may exist yet.
+   *
+   * External file names that are relative and without directory are kept, so the copy refers
+   * to its own external files. Other names are rewritten to their base name in the copy, also
+   * for datasets that can be reached through several hard links.
+   * Relative names are resolved against the directory of this file. External files that
+   * do not exist (yet) are skipped.
+   *
+   * On failure, an exception is thrown and the files created by this call are removed again.
+   *
+   * Python example:
+   * \code
+   *    # Create a new HDF5 file called "example.h5", with a dataset stored in "example.raw"
+   *    >>> f = File("example.h5", File.CREATE)
+   *    >>> d = DatasetFloat(f, "DATA")
+   *    >>> d = d.create1D(4, 4, "example.raw")
+   *    >>> d.set1D(0, [1.0, 2.0, 3.0, 4.0])
+   *
+   *    # Copy it to another directory, including example.raw
+   *    >>> import os
+   *    >>> os.mkdir("copy")
+   *    >>> f.copyTo("copy/example.h5")
+   *    >>> os.path.exists("copy/example.raw")
+   *    True
+   *
+   *    # Clean up
+   *    >>> import shutil
+   *    >>> shutil.rmtree("copy")
+   *    >>> os.remove("example.h5")
+   *    >>> os.remove("example.raw")
+   * \endcode
+   */
+  void copyTo( const std::string &destination, CopyMode mode = COPY, unsigned nrThreads = 4 );
+
   /*!
    * Returns whether this file exists (i.e. true).
    */
@@ -160,9 +410,15 @@ public:
   Attribute<VersionType> version();
 
 private:
+  File( const hid_gc &file, const std::string &filename, FileMode mode, const std::string &versionAttrName,
+        bool deferChecks );
+
+  void initVersion( FileMode mode, const std::string &versionAttrName, bool deferChecks );
+
   virtual void open( hid_t parent, const std::string &name );
 
-  hid_gc openFile( const std::string &filename, FileMode mode ) const;
+  hid_gc openFile( const std::string &filename, FileMode mode, const FileAccessOptions &options = FileAccessOptions() ) const;
+  void commitWrites();
   void initFileNodes();
 };
 
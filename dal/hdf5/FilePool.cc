@@ -0,0 +1,227 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FilePool.h"
+#include <sstream>
+#include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace dal {
+
+FilePool::FilePool( size_t capacity )
+:
+  _capacity(capacity),
+  _hits(0),
+  _misses(0)
+{
+  if (capacity == 0)
+    throw DALValueError("Could not create file pool with a capacity of 0");
+
+  pthread_mutex_init(&mutex, NULL);
+}
+
+FilePool::~FilePool()
+{
+  clear();
+
+  pthread_mutex_destroy(&mutex);
+}
+
+FilePool &FilePool::global()
+{
+  // Never destructed, as HDF5 may already have shut down when static objects are destructed.
+  static FilePool *pool = new FilePool;
+
+  return *pool;
+}
+
+void FilePool::evict( const std::string &filename )
+{
+  pthread_mutex_lock(&mutex);
+
+  for (EntryList::iterator it = entries.begin(); it != entries.end(); ) {
+    if (it->filename == filename) {
+      index.erase(it->key);
+      delete it->file;
+      it = entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  pthread_mutex_unlock(&mutex);
+}
+
+void FilePool::clear()
+{
+  pthread_mutex_lock(&mutex);
+  shrink(0);
+  pthread_mutex_unlock(&mutex);
+}
+
+size_t FilePool::size() const
+{
+  pthread_mutex_lock(&mutex);
+  const size_t result = index.size();
+  pthread_mutex_unlock(&mutex);
+
+  return result;
+}
+
+size_t FilePool::capacity() const
+{
+  pthread_mutex_lock(&mutex);
+  const size_t result = _capacity;
+  pthread_mutex_unlock(&mutex);
+
+  return result;
+}
+
+void FilePool::setCapacity( size_t capacity )
+{
+  if (capacity == 0)
+    throw DALValueError("Could not set capacity of file pool to 0");
+
+  pthread_mutex_lock(&mutex);
+  _capacity = capacity;
+  shrink(capacity);
+  pthread_mutex_unlock(&mutex);
+}
+
+size_t FilePool::hits() const
+{
+  pthread_mutex_lock(&mutex);
+  const size_t result = _hits;
+  pthread_mutex_unlock(&mutex);
+
+  return result;
+}
+
+size_t FilePool::misses() const
+{
+  pthread_mutex_lock(&mutex);
+  const size_t result = _misses;
+  pthread_mutex_unlock(&mutex);
+
+  return result;
+}
+
+std::string FilePool::makeKey( const std::string &filename, FileMode mode, const char *type, bool deferChecks )
+{
+  // a file opened with deferred checks must not be handed out to callers that want them
+  ostringstream key;
+  key << type << '\0' << mode << '\0' << deferChecks << '\0' << filename;
+
+  return key.str();
+}
+
+File *FilePool::find( const std::string &key )
+{
+  map<string, EntryList::iterator>::const_iterator it = index.find(key);
+
+  if (it == index.end())
+    return NULL;
+
+  // mark as most recently used; list iterators remain valid when splicing
+  entries.splice(entries.begin(), entries, it->second);
+
+  return it->second->file;
+}
+
+void FilePool::add( const std::string &filename, const std::string &key, FileMode mode, File *file )
+{
+  Entry entry;
+  entry.filename = filename;
+  entry.key = key;
+  entry.mode = mode;
+  entry.file = file;
+
+  entries.push_front(entry);
+  index[key] = entries.begin();
+
+  shrink(_capacity);
+}
+
+//! Returns whether HDF5 has `filename` open for reading only, through any file id.
+static bool isOpenForReading( const std::string &filename )
+{
+  struct stat target;
+  if (::stat(filename.c_str(), &target) != 0)
+    return false;
+
+  const ssize_t nrFiles = H5Fget_obj_count(H5F_OBJ_ALL, H5F_OBJ_FILE);
+  if (nrFiles <= 0)
+    return false;
+
+  vector<hid_t> files(nrFiles);
+  const ssize_t n = H5Fget_obj_ids(H5F_OBJ_ALL, H5F_OBJ_FILE, files.size(), &files[0]);
+
+  for (ssize_t i = 0; i < n; i++) {
+    unsigned intent;
+    if (H5Fget_intent(files[i], &intent) < 0 || (intent & H5F_ACC_RDWR))
+      continue;
+
+    const ssize_t len = H5Fget_name(files[i], NULL, 0);
+    if (len < 0)
+      continue;
+
+    vector<char> name(len + 1);
+    if (H5Fget_name(files[i], &name[0], name.size()) < 0)
+      continue;
+
+    // the same file can be named in different ways
+    struct stat st;
+    if (::stat(&name[0], &st) == 0 && st.st_dev == target.st_dev && st.st_ino == target.st_ino)
+      return true;
+  }
+
+  return false;
+}
+
+void FilePool::evictReadOnly( const std::string &filename )
+{
+  bool evicted = false;
+
+  for (EntryList::iterator it = entries.begin(); it != entries.end(); ) {
+    if (it->filename == filename && it->mode == File::READ) {
+      index.erase(it->key);
+      delete it->file;
+      it = entries.erase(it);
+
+      evicted = true;
+    } else {
+      ++it;
+    }
+  }
+
+  if (evicted && isOpenForReading(filename))
+    throw DALException("Could not get file from pool for writing: copies of it that were opened for reading are still in use; file " + filename);
+}
+
+void FilePool::shrink( size_t capacity )
+{
+  while (entries.size() > capacity) {
+    index.erase(entries.back().key);
+    delete entries.back().file;
+    entries.pop_back();
+  }
+}
+
+}
+
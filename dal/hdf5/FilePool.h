@@ -0,0 +1,168 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_FILE_POOL_H
+#define DAL_FILE_POOL_H
+
+#include <cstddef>
+#include <string>
+#include <list>
+#include <map>
+#include <pthread.h>
+#include "File.h"
+
+namespace dal {
+
+/*!
+ * \class FilePool
+ *
+ * Keeps recently used files open, so that programs that access many files, or the same
+ * files repeatedly, do not pay for opening them every time. Files are keyed by their
+ * name, their open mode, their class (File, TBB_File, BF_File, ...) and whether their
+ * checks were deferred, so a file opened with FileAccessOptions::deferChecks is never
+ * handed out to a get() call that wants the checks. Once more than capacity() files are
+ * pooled, the least recently used one is dropped from the pool.
+ *
+ * The pool hands out copies of its File objects, which refer to the same open HDF5 file.
+ * HDF5 closes a file once neither the pool nor any copy refers to it. The HDF5 files in
+ * the same directory share one directory file descriptor, pooled or not.
+ *
+ * Files are opened with the FileAccessOptions given to the get() call that opens them;
+ * use FileAccessOptions::deferChecks for cheaper opens. Files are keyed by the name as given,
+ * so use absolute names if the working directory changes. A pooled file that is modified
+ * on disk by another program is not reopened; call evict() to do so.
+ *
+ * A file pooled for READWRITE also serves get() calls for READ. As HDF5 cannot open a file
+ * for writing while it has the file open for reading, a get() call for READWRITE first drops
+ * the READ copies of the file from the pool. If copies of those are still in use outside the
+ * pool, it throws a DALException instead.
+ *
+ * C++ example:
+ * \code
+ *    for (size_t i = 0; i < filenames.size(); i++) {
+ *      TBB_File f = FilePool::global().get<TBB_File>(filenames[i]);
+ *      ...
+ *    }
+ * \endcode
+ *
+ * The member functions of FilePool are thread safe. Using the files handed out from
+ * several threads requires a thread-safe build of HDF5.
+ */
+class FilePool {
+public:
+  typedef File::FileMode FileMode;
+
+  /*!
+   * Creates a pool holding at most `capacity` files.
+   *
+   * Requires:
+   *    - capacity >= 1
+   */
+  FilePool( size_t capacity = 256 );
+
+  /*!
+   * Drops all files from the pool.
+   */
+  ~FilePool();
+
+  /*!
+   * Returns the pool shared by the whole process. It is never destructed, so
+   * it can be used until the program exits.
+   */
+  static FilePool &global();
+
+  /*!
+   * Returns `filename` opened as an F (File or a subclass) with mode `mode`, opening it
+   * with `options` if it is not in the pool. Modes that create files are not supported.
+   */
+  template<typename F> F get( const std::string &filename, FileMode mode = File::READ,
+                              const FileAccessOptions &options = FileAccessOptions() );
+
+  /*!
+   * Drops `filename` from the pool, for all modes and classes.
+   */
+  void evict( const std::string &filename );
+
+  /*!
+   * Drops all files from the pool.
+   */
+  void clear();
+
+  //! Returns the number of files in the pool.
+  size_t size() const;
+
+  //! Returns the maximum number of files in the pool.
+  size_t capacity() const;
+
+  //! Sets the maximum number of files in the pool, dropping the least recently used ones if needed.
+  void setCapacity( size_t capacity );
+
+  //! Returns the number of get() calls that were served from the pool resp. that opened the file.
+  size_t hits() const;
+  size_t misses() const;
+
+private:
+  // not copyable
+  FilePool( const FilePool & );
+  FilePool &operator=( const FilePool & );
+
+  struct Entry {
+    std::string filename;
+    std::string key;
+    FileMode mode;
+    File *file;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  //! Pooled files, most recently used first.
+  EntryList entries;
+
+  std::map<std::string, EntryList::iterator> index;
+
+  size_t _capacity;
+  size_t _hits, _misses;
+
+  mutable pthread_mutex_t mutex;
+
+  //! Opens `filename` as an F. Specialized for File, which takes a version attribute name.
+  template<typename F> static F *openFile( const std::string &filename, FileMode mode, const FileAccessOptions &options );
+
+  //! Returns the key of a file opened as `type` with `mode`, with or without deferred checks.
+  static std::string makeKey( const std::string &filename, FileMode mode, const char *type, bool deferChecks );
+
+  //! Returns the pooled file for `key` and marks it most recently used, or NULL. Requires the mutex.
+  File *find( const std::string &key );
+
+  //! Adds `file`, opened with `mode`, to the pool, which takes ownership, dropping files beyond capacity(). Requires the mutex.
+  void add( const std::string &filename, const std::string &key, FileMode mode, File *file );
+
+  /*!
+   * Drops the files opened for READ with name `filename` from the pool, so that it can be opened for writing.
+   * Throws a DALException if HDF5 still has the file open for reading afterwards. Requires the mutex.
+   */
+  void evictReadOnly( const std::string &filename );
+
+  //! Drops the least recently used files until at most `capacity` are left. Requires the mutex.
+  void shrink( size_t capacity );
+};
+
+}
+
+#include "FilePool.tcc"
+
+#endif
+
@@ -0,0 +1,72 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <typeinfo>
+
+namespace dal {
+
+template<typename F> F *FilePool::openFile( const std::string &filename, FileMode mode, const FileAccessOptions &options )
+{
+  return new F(filename, mode, options);
+}
+
+template<> inline File *FilePool::openFile<File>( const std::string &filename, FileMode mode, const FileAccessOptions &options )
+{
+  return new File(filename, mode, "", options);
+}
+
+template<typename F> F FilePool::get( const std::string &filename, FileMode mode, const FileAccessOptions &options )
+{
+  if (mode == File::CREATE || mode == File::CREATE_EXCL || mode == File::IN_MEMORY)
+    throw DALValueError("Could not get file from pool: cannot create files through a pool; file " + filename);
+
+  const std::string key = makeKey(filename, mode, typeid(F).name(), options.deferChecks);
+
+  pthread_mutex_lock(&mutex);
+
+  try {
+    File *file = find(key);
+
+    // a file opened for writing can also be read
+    if (!file && mode == File::READ)
+      file = find(makeKey(filename, File::READWRITE, typeid(F).name(), options.deferChecks));
+
+    if (file) {
+      _hits++;
+    } else {
+      _misses++;
+
+      // HDF5 cannot open a file for writing while it has it open for reading
+      if (mode == File::READWRITE)
+        evictReadOnly(filename);
+
+      // opened under the lock, so that concurrent calls do not open the same file twice
+      file = openFile<F>(filename, mode, options);
+      add(filename, key, mode, file);
+    }
+
+    F result(*static_cast<F *>(file));
+
+    pthread_mutex_unlock(&mutex);
+    return result;
+  } catch (...) {
+    pthread_mutex_unlock(&mutex);
+    throw;
+  }
+}
+
+}
+
@@ -16,6 +16,9 @@
  */
 #include "Group.h"
 #include "exceptions/exceptions.h"
+#include "exceptions/errorstack.h"
+#include "types/ObjectAccess.h"
+#include <set>
 
 using namespace std;
 
@@ -29,7 +32,9 @@ Group::Group( const Group &other )
 :
   Node(other.parent, other._name, other.fileInfo),
   _group(other._group),
-  nodeMap(other.nodeMap)
+  attributes(other.attributes),
+  extraNodes(other.extraNodes)
+  // nodeMap is not copied: its Node objects are owned by other, and are reconstructed on use
 {
 }
 
@@ -63,6 +68,8 @@ void swap(Group& first, Group& second)
 {
   swap(static_cast<Node&>(first), static_cast<Node&>(second));
   swap(first._group, second._group);
+  swap(first.attributes, second.attributes);
+  swap(first.extraNodes, second.extraNodes);
   swap(first.nodeMap, second.nodeMap);
 }
 
@@ -71,9 +78,9 @@ void swap(Group& first, Group& second)
  * If it is a Dataset, Dataset<T>::create() throws.
  */
 Group& Group::create() {
-  hid_gc_noref gcpl(H5Pcreate(H5P_GROUP_CREATE), H5Pclose, "Could not create group creation property list to create group " + _name);
+  hid_gc_noref gcpl(H5Pcreate(H5P_GROUP_CREATE), H5Pclose, "Could not create group creation property list to create group ", _name);
 
-  _group = hid_gc(H5Gcreate2(parent, _name.c_str(), H5P_DEFAULT, gcpl, H5P_DEFAULT), H5Gclose, "Could not create group " + _name);
+  _group = hid_gc(H5Gcreate2(parent, _name.c_str(), H5P_DEFAULT, gcpl, H5P_DEFAULT), H5Gclose, "Could not create group ", _name);
   initNodes();
 
   return *this;
@@ -100,7 +107,7 @@ void Group::set( const Group &other, bool deepcopy ) {
     remove();
   }
 
-  hid_gc ocpl(H5Pcreate(H5P_OBJECT_COPY), H5Pclose, "Could not create object creation property list to set group " + _name);
+  hid_gc ocpl(H5Pcreate(H5P_OBJECT_COPY), H5Pclose, "Could not create object creation property list to set group ", _name);
 
   if (!deepcopy) {
     // do a shallow copy
@@ -109,6 +116,10 @@ void Group::set( const Group &other, bool deepcopy ) {
     }
   }
 
+  // make sure staged attribute writes are copied (see File::setWriteBatching())
+  if (!other.fileInfo.attributeBatch().empty())
+    other.fileInfo.attributeBatch().commit();
+
   // H5Ocopy allows us to copy all properties, subgroups, etc, even across files
   if (H5Ocopy(other.parent, other._name.c_str(), parent, _name.c_str(), ocpl, H5P_DEFAULT) < 0)
     throw HDF5Exception("Could not copy object to set group " + _name);
@@ -124,52 +135,144 @@ const hid_gc &Group::group() {
 
 void Group::open( hid_t parent, const std::string &name )
 {
-  _group = hid_gc(H5Gopen2(parent, name.c_str(), H5P_DEFAULT), H5Gclose, "Could not open group " + _name);
+  _group = hid_gc(H5Gopen2(parent, name.c_str(), H5P_DEFAULT), H5Gclose, "Could not open group ", _name);
+
+  const IndexedObject *indexed = indexedObject();
+  if (indexed)
+    attributes.assign(indexed->attributes);
+
   initNodes();
 }
 
+void Group::loadAttributes()
+{
+  // make sure staged attribute writes are seen (see File::setWriteBatching())
+  if (!fileInfo.attributeBatch().empty())
+    fileInfo.attributeBatch().commit();
+
+  if (!attributes.load(group()))
+    throw HDF5Exception("Could not load attributes of group " + _name);
+}
+
+string Group::objectPath()
+{
+  const hid_t object = group();
+
+  const ssize_t pathlen = H5Iget_name(object, NULL, 0);
+  if (pathlen <= 0)
+    throw HDF5Exception("Could not get path name of " + _name);
+
+  vector<char> path(pathlen + 1);
+  if (H5Iget_name(object, &path[0], path.size()) < 0)
+    throw HDF5Exception("Could not get path name of " + _name);
+
+  return &path[0];
+}
+
+const IndexedObject *Group::indexedObject()
+{
+  const MetadataIndex &index = fileInfo.metadataIndex();
+  if (!index.loaded())
+    return NULL;
+
+  return index.find(objectPath());
+}
+
 Attribute<string> Group::groupType()
 {
-  return getNode("GROUPTYPE");
+  return Attribute<string>(*this, "GROUPTYPE");
+}
+
+static const NodeSchema groupNodes[] = {
+  { "GROUPTYPE", createNode< Attribute<string> > }
+};
+
+const NodeSchemaTable Group::nodeSchema = {
+  NULL, groupNodes, sizeof groupNodes / sizeof groupNodes[0]
+};
+
+const NodeSchemaTable &Group::schema() const
+{
+  return nodeSchema;
 }
 
 void Group::initNodes()
 {
-  addNode(new Attribute<string>(*this, "GROUPTYPE"));
 }
 
-void Group::addNode( Node *attr )
+void Group::addNode( const std::string &name, NodeFactory create )
 {
-  if (!attr)
+  if (!create)
     throw DALValueError("Could not add NULL node");
 
-  if (nodeMap.find(attr->name()) != nodeMap.end())
-    throw DALValueError("Could not add already existing node " + attr->name()); 
+  if (findNode(name))
+    throw DALValueError("Could not add already existing node " + name); 
+
+  extraNodes[name] = create;
+}
+
+NodeFactory Group::findNode( const std::string &name ) const
+{
+  map<string, NodeFactory>::const_iterator it(extraNodes.find(name));
+  if (it != extraNodes.end())
+    return it->second;
+
+  for (const NodeSchemaTable *table = &schema(); table; table = table->base)
+    for (size_t i = 0; i < table->nrNodes; i++)
+      if (name == table->nodes[i].name)
+        return table->nodes[i].create;
 
-  nodeMap[attr->name()] = attr;
+  return NULL;
 }
 
 ImplicitDowncast<Node> Group::getNode( const std::string &name )
 {
-  // Make sure nodeMap is populated. If group does not exist, better know it early.
+  // Make sure extra nodes are registered. If group does not exist, better know it early.
   group();
 
-  std::map<std::string, Node*>::const_iterator it(nodeMap.find(name));
-  if (it == nodeMap.end())
+  map<string, Node*>::const_iterator it(nodeMap.find(name));
+  if (it != nodeMap.end())
+    return *it->second;
+
+  NodeFactory create = findNode(name);
+  if (!create)
     throw DALValueError("Could not get (find) node " + name);
 
-  return *it->second;
+  Node *node = create(*this, name);
+  nodeMap[name] = node;
+
+  return *node;
 }
 
 vector<string> Group::nodeNames() {
-  vector<string> names;
-  names.reserve(nodeMap.size());
+  std::set<string> names;
 
-  for( map<string, Node*>::const_iterator i = nodeMap.begin(); i != nodeMap.end(); ++i ) {
-    names.push_back(i->first);
+  for( map<string, NodeFactory>::const_iterator i = extraNodes.begin(); i != extraNodes.end(); ++i ) {
+    names.insert(i->first);
   }
 
-  return names;
+  for (const NodeSchemaTable *table = &schema(); table; table = table->base)
+    for (size_t i = 0; i < table->nrNodes; i++)
+      names.insert(table->nodes[i].name);
+
+  return vector<string>(names.begin(), names.end());
+}
+
+int Group::ownReferences() const
+{
+  // _group holds two (see hid_gc), and each node a copy as its parent
+  return 2 + nodeMap.size();
+}
+
+void Group::forgetGroup()
+{
+  // their ids are invalid, so their references cannot be dropped
+  DisableErrorPrinting dep;
+
+  freeNodeMap();
+  nodeMap.clear();
+
+  _group = hid_gc();
 }
 
 void Group::freeNodeMap()
@@ -181,27 +284,151 @@ void Group::freeNodeMap()
   //nodeMap.clear(); // redundant
 }
 
+struct MemberIteration {
+  vector<MemberInfo> *members;
+  size_t maxMembers; // stop after this many members (0: no limit)
+  bool withType;
+  bool withShape;
+};
+
+static herr_t addMember( hid_t group, const char *name, const H5L_info_t *linkInfo, void *opData )
+{
+  MemberIteration &iteration = *static_cast<MemberIteration *>(opData);
+
+  // do not let exceptions pass through HDF5
+  try {
+    iteration.members->push_back(MemberInfo());
+
+    MemberInfo &info = iteration.members->back();
+    info.name = name;
+
+    if (iteration.withType) {
+      hid_t object;
+
+      if (linkInfo->type == H5L_TYPE_HARD) {
+        DisableErrorPrinting dep;
+
+        // open by address, to avoid looking up the name again
+#if defined(H5L_info_t_vers) && H5L_info_t_vers >= 2
+        object = H5Oopen_by_token(group, linkInfo->u.token);
+#else
+        object = H5Oopen_by_addr(group, linkInfo->u.address);
+#endif
+        // datasets open with another access property list need to be opened by name
+        if (object < 0)
+          object = openObject(group, name);
+      } else {
+        // follow soft and external links
+        object = openObject(group, name);
+      }
+
+      if (object >= 0) {
+        hid_gc_noref obj(object, H5Oclose, "Could not open member ", info.name);
+
+        info.describe(obj, iteration.withShape);
+      } // else: dangling link; type remains UNKNOWN
+    }
+  } catch (...) {
+    return -1;
+  }
+
+  return iteration.maxMembers > 0 && iteration.members->size() >= iteration.maxMembers ? 1 : 0;
+}
+
+vector<MemberInfo> Group::members( bool withShape ) {
+  const IndexedObject *indexed = indexedObject();
+  if (indexed) {
+    vector<MemberInfo> result(indexed->members);
+
+    if (!withShape)
+      for (size_t i = 0; i < result.size(); i++) {
+        result[i].dims.clear();
+        result[i].elementSize = 0;
+      }
+
+    return result;
+  }
+
+  vector<MemberInfo> result;
+  MemberIteration iteration = { &result, 0, true, withShape };
+  hsize_t idx = 0;
+
+  // Use H5_INDEX_NAME, because for H5_INDEX_CRT_ORDER, it had to be created with a creation index.
+  if (H5Literate(group(), H5_INDEX_NAME, H5_ITER_INC, &idx, addMember, &iteration) < 0)
+    throw HDF5Exception("Could not iterate over members of group " + _name);
+
+  return result;
+}
+
 vector<string> Group::memberNames() {
-  vector<string> names;
-  H5G_info_t groupInfo;
-
-  if (H5Gget_info(group(), &groupInfo) < 0)
-    throw HDF5Exception("Could not get info with number of member names for group " + _name);
-
-  // Loop around H5Lget_name_by_idx(). Can also use H5Literate(), but it is more fuss for what we need here.
-  char linkName[128];
-  for (size_t i = 0; i < groupInfo.nlinks; i++) {
-    // Use H5_INDEX_NAME, because for H5_INDEX_CRT_ORDER, it had to be created with a creation index.
-    ssize_t size = H5Lget_name_by_idx(group(), ".", H5_INDEX_NAME, H5_ITER_NATIVE, i, linkName, sizeof linkName, H5P_DEFAULT);
-    if (size < 0)
-      throw HDF5Exception("Could not get link member name by index for group " + _name); // TODO: _name is "" for TBB_File::stations(); should be "/"
-    linkName[sizeof linkName - 1] = '\0'; // unclear if H5Lget_name_by_idx() always terminates, so do it.
-
-    names.push_back(linkName);
+  const IndexedObject *indexed = indexedObject();
+  if (indexed) {
+    vector<string> names(indexed->members.size());
+    for (size_t i = 0; i < names.size(); i++)
+      names[i] = indexed->members[i].name;
+
+    return names;
   }
 
+  vector<MemberInfo> members;
+  MemberIteration iteration = { &members, 0, false, false };
+  hsize_t idx = 0;
+
+  if (H5Literate(group(), H5_INDEX_NAME, H5_ITER_INC, &idx, addMember, &iteration) < 0)
+    throw HDF5Exception("Could not iterate over member names of group " + _name);
+
+  vector<string> names(members.size());
+  for (size_t i = 0; i < members.size(); i++)
+    names[i] = members[i].name;
+
   return names;
 }
 
+MemberIterator::MemberIterator( Group &group, bool withShape )
+:
+  group(group.group()), // friend-allowed
+  groupName(group.name()),
+  withShape(withShape),
+  nextIndex(0),
+  done(false),
+  batchPos(0)
+{
+}
+
+bool MemberIterator::hasNext()
+{
+  if (batchPos == batch.size())
+    fetch();
+
+  return batchPos < batch.size();
+}
+
+MemberInfo MemberIterator::next()
+{
+  if (!hasNext())
+    throw DALIndexError("No more members in group " + groupName);
+
+  return batch[batchPos++];
+}
+
+void MemberIterator::fetch()
+{
+  batch.clear();
+  batchPos = 0;
+
+  if (done)
+    return;
+
+  MemberIteration iteration = { &batch, batchSize, true, withShape };
+
+  // nextIndex is updated to the link after the last one visited
+  const herr_t status = H5Literate(group, H5_INDEX_NAME, H5_ITER_INC, &nextIndex, addMember, &iteration);
+  if (status < 0)
+    throw HDF5Exception("Could not iterate over members of group " + groupName);
+
+  // H5Literate returns 0 if it visited all remaining links
+  done = status == 0;
+}
+
 }
 
@@ -22,16 +22,55 @@
 #include <map>
 #include <hdf5.h>
 #include "types/implicitdowncast.h"
+#include "types/MemberInfo.h"
 #include "Node.h"
 #include "Attribute.h"
 
 namespace dal {
 
+class Group;
+
+#ifndef SWIG
+
+//! Constructs a Node object of the right type for node `name` in `parent`.
+typedef Node *(*NodeFactory)( Group &parent, const std::string &name );
+
+//! NodeFactory for nodes of type N (a subclass of Node).
+template<typename N> Node *createNode( Group &parent, const std::string &name )
+{
+  return new N(parent, name);
+}
+
+/*!
+ * Describes a node that a class of groups expects to be present:
+ * its HDF5 name, and (through `create`) its type.
+ */
+struct NodeSchema {
+  const char *name;
+  NodeFactory create;
+};
+
+/*!
+ * A static table of the nodes that a class of groups expects to be present,
+ * extending the table of its base class (`base`, or NULL if none).
+ *
+ * Tables are constant-initialized arrays, so they cost nothing when a group is opened.
+ * Node objects are only constructed if requested through Group::getNode().
+ */
+struct NodeSchemaTable {
+  const NodeSchemaTable *base;
+  const NodeSchema *nodes;
+  size_t nrNodes;
+};
+
+#endif
+
 /*!
  * Wraps an HDF5 group, providing core functionality.
  *
  * A Group maintains a set of registered Nodes that it
- * expects to be present.
+ * expects to be present, described by static tables
+ * (see schema()).
  */
 class Group: public Node {
 public:
@@ -94,21 +133,78 @@ public:
    * Copies all members from another group into this one.
    *
    * If `deepcopy` is set, subgroups and datasets are copied as well.
+   * External data files are not copied: copied datasets refer to the same files.
+   * Use File::copyTo() to copy a file including its external data.
    */
   void set( const Group &other, bool deepcopy );
 
+  /*!
+   * Reads all attributes of this group (or dataset) in a single pass. Afterwards, exists(),
+   * size(), get() and valid() of its attributes are served from memory, which is a lot
+   * faster when reading many attributes, for example to dump the headers of many files.
+   *
+   * An attribute that is created, set or removed through this object (or a copy) is
+   * read from HDF5 again. Changes made through other objects or processes are not
+   * seen until loadAttributes() is called again.
+   *
+   * Python example:
+   * \code
+   *    # Create a new HDF5 file called "example.h5"
+   *    >>> f = File("example.h5", File.CREATE)
+   *    >>> a = AttributeString(f, "EXAMPLE_ATTR")
+   *    >>> a.value = "hello world"
+   *
+   *    # Read all attributes of the root group at once
+   *    >>> f.loadAttributes()
+   *    >>> a.value
+   *    'hello world'
+   *
+   *    # Clean up
+   *    >>> import os
+   *    >>> os.remove("example.h5")
+   * \endcode
+   */
+  void loadAttributes();
+
   Attribute<std::string> groupType();
 
   /*!
-   * Returns a list of the HDF5 names of all nodes registered
+   * Returns a sorted list of the HDF5 names of all nodes registered
    * in this class.
    */
   std::vector<std::string> nodeNames();
 
+  /*!
+   * Returns the names and object types of all members of this group, sorted by name,
+   * using a single iteration over its links. Hard links are followed by address,
+   * so members are not looked up by name. If `withShape` is set, the dimensions
+   * and element size of datasets are filled in as well.
+   *
+   * See MemberIterator to iterate over the members lazily.
+   *
+   * Python example:
+   * \code
+   *    # Create a new HDF5 file called "example.h5"
+   *    >>> f = File("example.h5", File.CREATE)
+   *    >>> g = Group(f, "GROUP")
+   *    >>> g = g.create()
+   *
+   *    # List the members of the root group
+   *    >>> [(m.name, m.type == MemberInfo.GROUP) for m in f.members()]
+   *    [('GROUP', True)]
+   *
+   *    # Clean up
+   *    >>> import os
+   *    >>> os.remove("example.h5")
+   * \endcode
+   */
+  std::vector<MemberInfo> members( bool withShape = false );
+
 #ifndef SWIG
 
   /*!
-   * Returns a reference to a node from the map. initNodes() is called
+   * Returns a reference to a registered node. The Node object is constructed
+   * on first use and owned by this group. initNodes() is called
    * if needed, and an exception is thrown if the group
    * has not been opened or created yet.
    *
@@ -129,34 +225,126 @@ protected:
   //! hid of the Group. Always read it through group(). Set only once, then call initNodes().
   hid_gc _group;
 
+  //! Values of the attributes of this group, shared with its Attribute objects. See loadAttributes().
+  AttributeCache attributes;
+
 
   friend Node::Node( Group &parent, const std::string &name );
+  friend class MemberIterator;
   /*!
    * Exposes the HDF5 object ID of this group. Opens the group if needed.
    */
   const hid_gc &group(); // protected w/ friend above to keep hid_gc inside DAL
 
+  /*!
+   * The nodes that every group expects to be present (GROUPTYPE).
+   */
+  static const NodeSchemaTable nodeSchema;
+
+  /*!
+   * Returns the table of nodes registered by the class of this group.
+   * Subclasses that register nodes define their own static `nodeSchema`
+   * table (extending that of their base class) and return it here.
+   */
+  virtual const NodeSchemaTable &schema() const;
+
+  /*!
+   * Called once the group is opened or created. Override to register
+   * nodes whose names are only known at run time, using addNode().
+   */
   virtual void initNodes();
 
   /*!
-   * Add a node to the node map. Ownerschip is taken. Do not pass NULL.
+   * Registers a node that is not in schema(), for this object (and its copies) only.
    */
-  void addNode( Node *attr );
+  void addNode( const std::string &name, NodeFactory create );
 
   std::vector<std::string> memberNames();
 
+  //! Returns the absolute HDF5 path of this group. Opens the group if needed.
+  std::string objectPath();
+
+  //! Returns the metadata index entry of this group, or NULL if there is none. See File::loadIndex().
+  const IndexedObject *indexedObject();
+
+  /*!
+   * Returns the number of references to the HDF5 object of this group that are held by this
+   * object and by the nodes it owns. Any further references are held by copies of it.
+   */
+  int ownReferences() const;
+
+  /*!
+   * Closes the nodes owned by this object and forgets the HDF5 object of this group,
+   * for when HDF5 closed it under us. This object can no longer be used afterwards.
+   */
+  void forgetGroup();
+
   //! Constructor for root group (in File) only
   Group( const hid_gc &fileId, FileInfo fileInfo );
 
 private:
-  //! The map containing all (registered) nodes in this set
+  //! Nodes registered through addNode()
+  std::map<std::string, NodeFactory> extraNodes;
+
+  //! The Node objects constructed by getNode(), owned by this object
   std::map<std::string, Node*> nodeMap;
 
+  NodeFactory findNode( const std::string &name ) const;
+
   virtual void open( hid_t parent, const std::string &name );
 
   void freeNodeMap();
 };
 
+/*!
+ * Iterates lazily over the members of a group, in the order of Group::members(),
+ * fetching them from HDF5 in batches. Links that are added or removed during
+ * the iteration may be missed or returned twice.
+ *
+ * Python example:
+ * \code
+ *    # Create a new HDF5 file called "example.h5"
+ *    >>> f = File("example.h5", File.CREATE)
+ *    >>> g = Group(f, "GROUP")
+ *    >>> g = g.create()
+ *
+ *    # Iterate over the members of the root group
+ *    >>> for m in f.iterMembers():
+ *    ...   print m.name
+ *    GROUP
+ *
+ *    # Clean up
+ *    >>> import os
+ *    >>> os.remove("example.h5")
+ * \endcode
+ */
+class MemberIterator {
+public:
+  MemberIterator( Group &group, bool withShape = false );
+
+  //! Returns whether there are more members.
+  bool hasNext();
+
+  //! Returns the next member. Throws a DALIndexError if there are no more members.
+  MemberInfo next();
+
+private:
+  static const size_t batchSize = 64;
+
+  hid_gc group;
+  std::string groupName;
+  bool withShape;
+
+  //! The index of the next link to fetch from HDF5, and whether there is none.
+  hsize_t nextIndex;
+  bool done;
+
+  std::vector<MemberInfo> batch;
+  size_t batchPos;
+
+  void fetch();
+};
+
 }
 
 #endif
@@ -13,11 +13,11 @@
 // loading the actual class.
 %extend dal::Group {
   /*
-   * Each Group allows nodes to be registered in a generic
-   * map<string, Node*> using the addNode method. The getNode method
-   * is used for node lookup in that map. Nodes in the map are typically
-   * subclasses of Node. In C++, we can use dynamic_cast to cast
-   * the received object to its proper type.
+   * Each Group class registers the nodes it expects in a static
+   * schema table (see NodeSchema). The getNode method looks up a node
+   * by name and returns a reference to a Node object of the registered
+   * type (a subclass of Node), which the group keeps. In C++, we can use
+   * dynamic_cast to cast the received object to its proper type.
    *
    * In SWIG however, we prefer to pass around regular objects instead
    * of references and pointers, to prevent crashes due to incorrect
@@ -118,6 +118,13 @@
 // do not bother renaming operator=: Python users do not need it
 %ignore dal::Group::operator=;
 
+%include hdf5/types/MemberInfo.h
+
+vector_typemap( dal::MemberInfo );
+
+// Python iterators raise StopIteration instead of calling hasNext()
+%rename(_next) dal::MemberIterator::next;
+
 %include hdf5/Group.h
 
 %extend dal::Group {
@@ -125,6 +132,26 @@
     def create(self, *args, **kwargs):
       self._create(*args, **kwargs)
       return self
+
+    def iterMembers(self, withShape=False):
+      """
+        Returns a lazy iterator over the members of this group (see members()).
+      """
+      return MemberIterator(self, withShape)
+  %}
+}
+
+%extend dal::MemberIterator {
+  %pythoncode %{
+    def __iter__(self):
+      return self
+
+    def next(self):
+      if not self.hasNext():
+        raise StopIteration
+      return self._next()
+
+    __next__ = next
   %}
 }
 
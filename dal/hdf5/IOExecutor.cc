@@ -0,0 +1,262 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "IOExecutor.h"
+#include "types/HDF5Lock.h"
+#include "exceptions/exceptions.h"
+#include <algorithm>
+#include <exception>
+
+using namespace std;
+
+namespace dal {
+
+/*
+ * Stores the completion state of a request. Intended to be used through IOFuture only.
+ */
+class IOFutureType {
+  friend class IOFuture;
+
+  mutable pthread_mutex_t mutex;
+  mutable pthread_cond_t cond;
+
+  // protected by mutex
+  unsigned refCount;
+  bool done;
+  string error;
+
+  IOFutureType(bool done) : refCount(1), done(done) {
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+  }
+
+  ~IOFutureType() {
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&mutex);
+  }
+};
+
+IOFuture::IOFuture() : ptr(new IOFutureType(true)) { }
+
+IOFuture::IOFuture(bool ready) : ptr(new IOFutureType(ready)) { }
+
+IOFuture::IOFuture(const IOFuture& other) : ptr(other.ptr) {
+  pthread_mutex_lock(&ptr->mutex);
+  ptr->refCount += 1;
+  pthread_mutex_unlock(&ptr->mutex);
+}
+
+IOFuture::~IOFuture() {
+  pthread_mutex_lock(&ptr->mutex);
+  const unsigned refCount = --ptr->refCount;
+  pthread_mutex_unlock(&ptr->mutex);
+
+  if (refCount == 0)
+    delete ptr;
+}
+
+IOFuture& IOFuture::operator=(IOFuture rhs) {
+  swap(*this, rhs);
+  return *this;
+}
+
+void swap(IOFuture& first, IOFuture& second) {
+  std::swap(first.ptr, second.ptr);
+}
+
+bool IOFuture::ready() const {
+  pthread_mutex_lock(&ptr->mutex);
+  const bool done = ptr->done;
+  pthread_mutex_unlock(&ptr->mutex);
+
+  return done;
+}
+
+void IOFuture::wait() const {
+  pthread_mutex_lock(&ptr->mutex);
+  while (!ptr->done)
+    pthread_cond_wait(&ptr->cond, &ptr->mutex);
+  const string error(ptr->error);
+  pthread_mutex_unlock(&ptr->mutex);
+
+  if (!error.empty())
+    throw DALException(error);
+}
+
+void IOFuture::complete(const std::string& error) {
+  pthread_mutex_lock(&ptr->mutex);
+  ptr->done = true;
+  ptr->error = error;
+  pthread_cond_broadcast(&ptr->cond);
+  pthread_mutex_unlock(&ptr->mutex);
+}
+
+
+IOExecutor::IOExecutor( unsigned nrRawThreads )
+:
+  _pending(0),
+  stop(false)
+{
+  if (nrRawThreads == 0)
+    throw DALValueError("Could not create I/O executor without raw I/O threads");
+
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&queued, NULL);
+  pthread_cond_init(&completed, NULL);
+
+  for (unsigned i = 0; i < 1 + nrRawThreads; i++) {
+    pthread_t thread;
+
+    if (pthread_create(&thread, NULL, i == 0 ? hdf5Thread : rawThread, this) != 0) {
+      stopThreads();
+      throw DALException("Could not start I/O executor thread");
+    }
+
+    threads.push_back(thread);
+  }
+}
+
+IOExecutor::~IOExecutor()
+{
+  stopThreads();
+}
+
+void IOExecutor::stopThreads()
+{
+  pthread_mutex_lock(&mutex);
+  stop = true;
+  pthread_cond_broadcast(&queued);
+  pthread_mutex_unlock(&mutex);
+
+  for (size_t i = 0; i < threads.size(); i++)
+    pthread_join(threads[i], NULL);
+  threads.clear();
+
+  pthread_cond_destroy(&completed);
+  pthread_cond_destroy(&queued);
+  pthread_mutex_destroy(&mutex);
+}
+
+IOExecutor &IOExecutor::global()
+{
+  // Never destructed, as HDF5 may already have shut down when static objects are destructed.
+  static IOExecutor *executor = new IOExecutor;
+
+  return *executor;
+}
+
+IOFuture IOExecutor::submit( IORequest *request )
+{
+  Entry entry(request);
+
+  pthread_mutex_lock(&mutex);
+  (request->usesHDF5() ? hdf5Queue : rawQueue).push_back(entry);
+  _pending++;
+  pthread_cond_broadcast(&queued);
+  pthread_mutex_unlock(&mutex);
+
+  return entry.future;
+}
+
+void IOExecutor::waitAll()
+{
+  pthread_mutex_lock(&mutex);
+  while (_pending > 0)
+    pthread_cond_wait(&completed, &mutex);
+  pthread_mutex_unlock(&mutex);
+}
+
+size_t IOExecutor::pending() const
+{
+  pthread_mutex_lock(&mutex);
+  const size_t result = _pending;
+  pthread_mutex_unlock(&mutex);
+
+  return result;
+}
+
+/*
+ * Runs and deletes `request`, which may hold HDF5 objects. Stores any failure in `error`,
+ * as exceptions cannot escape the executor threads.
+ */
+static void runRequest( IORequest *request, string &error )
+{
+  try {
+    request->run();
+  } catch (std::exception &e) {
+    error = e.what();
+
+    if (error.empty())
+      error = "Unknown failure";
+  } catch (...) {
+    error = "Unknown failure";
+  }
+
+  delete request;
+}
+
+void IOExecutor::workLoop( bool hdf5 )
+{
+  std::deque<Entry> &queue = hdf5 ? hdf5Queue : rawQueue;
+
+  pthread_mutex_lock(&mutex);
+
+  for (;;) {
+    // finish the queue before stopping
+    while (queue.empty() && !stop)
+      pthread_cond_wait(&queued, &mutex);
+
+    if (queue.empty())
+      break;
+
+    Entry entry = queue.front();
+    queue.pop_front();
+
+    pthread_mutex_unlock(&mutex);
+
+    string error;
+
+    if (hdf5) {
+      HDF5Lock lock;
+      runRequest(entry.request, error);
+    } else {
+      runRequest(entry.request, error);
+    }
+
+    entry.future.complete(error);
+
+    pthread_mutex_lock(&mutex);
+    _pending--;
+    pthread_cond_broadcast(&completed);
+  }
+
+  pthread_mutex_unlock(&mutex);
+}
+
+void *IOExecutor::hdf5Thread( void *arg )
+{
+  static_cast<IOExecutor *>(arg)->workLoop(true);
+  return NULL;
+}
+
+void *IOExecutor::rawThread( void *arg )
+{
+  static_cast<IOExecutor *>(arg)->workLoop(false);
+  return NULL;
+}
+
+}
+
@@ -0,0 +1,167 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_IO_EXECUTOR_H
+#define DAL_IO_EXECUTOR_H
+
+#include <cstddef>
+#include <string>
+#include <deque>
+#include <vector>
+#include <pthread.h>
+
+namespace dal {
+
+class IOFutureType;
+
+/*!
+ * An IOFuture object is a reference to the reference counted completion state of an
+ * asynchronous request, as returned by Dataset::getMatrixAsync() and IOExecutor::submit().
+ * Copies refer to the same request. A default constructed IOFuture is ready.
+ */
+class IOFuture {
+  IOFutureType* ptr;
+
+public:
+  IOFuture();
+  IOFuture(const IOFuture& other);
+  ~IOFuture();
+  IOFuture& operator=(IOFuture rhs);
+
+  friend void swap(IOFuture& first, IOFuture& second);
+
+  //! Returns whether the request has completed, successfully or not.
+  bool ready() const;
+
+  /*!
+   * Waits for the request to complete. Rethrows a failure of the request as a DALException.
+   */
+  void wait() const;
+
+private:
+  friend class IOExecutor;
+
+  //! Creates a future that is ready, or pending until complete() is called.
+  explicit IOFuture(bool ready);
+
+  //! Marks the request as completed. A non-empty `error` is thrown by wait().
+  void complete(const std::string& error);
+};
+
+#ifndef SWIG
+/*!
+ * A request to run on an IOExecutor.
+ */
+class IORequest {
+public:
+  virtual ~IORequest() {}
+
+  /*!
+   * Whether run() or the destructor call HDF5. Such requests run one at a time, in
+   * submission order, holding the HDF5Lock. Other requests run in parallel, in any order.
+   */
+  virtual bool usesHDF5() const = 0;
+
+  //! Performs the request. Failures are reported as exceptions.
+  virtual void run() = 0;
+};
+#endif
+
+/*!
+ * \class IOExecutor
+ *
+ * Runs I/O requests on threads owned by DAL, so that the caller can overlap them with
+ * computation. Requests that call HDF5 are run in order by a single thread, holding the
+ * HDF5Lock. Requests that do not call HDF5, such as reads of external raw files through
+ * pread(), are run in parallel by a pool of threads.
+ *
+ * Requests are not ordered with respect to requests of the other kind. For example, wait
+ * for a write to complete before reading the same data.
+ *
+ * While requests that call HDF5 may be in flight, other threads (including the caller)
+ * must take the HDF5Lock around their DAL calls, unless HDF5 is built thread-safe.
+ *
+ * C++ only: Python code cannot take the HDF5Lock, and the Python bindings have no way to
+ * keep numpy buffers alive until a request completes. Python code uses the blocking calls.
+ */
+class IOExecutor {
+public:
+  /*!
+   * Starts one thread for requests that call HDF5 and `nrRawThreads` threads for other requests.
+   *
+   * Requires:
+   *    nrRawThreads >= 1
+   */
+  explicit IOExecutor( unsigned nrRawThreads = 4 );
+
+  //! Completes all pending requests and stops the threads.
+  ~IOExecutor();
+
+  /*!
+   * Returns the executor shared by the whole process, used by Dataset::getMatrixAsync() and
+   * friends. It is never destructed, so it can be used until the program exits.
+   */
+  static IOExecutor &global();
+
+#ifndef SWIG
+  /*!
+   * Queues `request` and returns its completion state. The executor takes ownership of
+   * `request`, and deletes it before the request is marked as completed.
+   */
+  IOFuture submit( IORequest *request );
+#endif
+
+  //! Waits until all requests submitted so far have completed.
+  void waitAll();
+
+  //! Returns the number of requests submitted, but not completed yet.
+  size_t pending() const;
+
+private:
+  // not copyable
+  IOExecutor( const IOExecutor & );
+  IOExecutor &operator=( const IOExecutor & );
+
+  struct Entry {
+    IORequest *request;
+    IOFuture future;
+
+    Entry( IORequest *request ): request(request), future(false) {}
+  };
+
+  mutable pthread_mutex_t mutex;
+  pthread_cond_t queued, completed;
+
+  // protected by mutex
+  std::deque<Entry> hdf5Queue, rawQueue;
+  size_t _pending;
+  bool stop;
+
+  std::vector<pthread_t> threads;
+
+  //! Completes the queued requests, stops the threads, and releases the synchronisation objects.
+  void stopThreads();
+
+  void workLoop( bool hdf5 );
+
+  static void *hdf5Thread( void *arg );
+  static void *rawThread( void *arg );
+};
+
+}
+
+#endif
+
@@ -36,7 +36,18 @@ Node::Node( Group &parent, const std::string &name )
   parent(parent.group()), // .group(): friend-allowed
   _name(name),
   minVersion(parent.minVersion),
-  fileInfo(parent.fileInfo)
+  fileInfo(parent.fileInfo),
+  parentAttributes(parent.attributes) // friend-allowed
+{
+}
+
+Node::Node( const Node &other )
+:
+  parent(other.parent),
+  _name(other._name),
+  minVersion(other.minVersion),
+  fileInfo(other.fileInfo),
+  parentAttributes(other.parentAttributes)
 {
 }
 
@@ -64,6 +75,7 @@ void swap(Node& first, Node& second)
   swap(first._name, second._name);
   std::swap(first.minVersion, second.minVersion);
   swap(first.fileInfo, second.fileInfo);
+  swap(first.parentAttributes, second.parentAttributes);
 }
 
 
@@ -81,7 +93,7 @@ Node::FileMode Node::fileMode() const {
 
 bool Node::canWrite() const {
   FileMode mode = fileMode();
-  return mode == CREATE || mode == CREATE_EXCL || mode == READWRITE;
+  return mode == CREATE || mode == CREATE_EXCL || mode == IN_MEMORY || mode == READWRITE || mode == SWMR_WRITE;
 }
 
 const std::string& Node::versionAttrName() const {
@@ -93,6 +105,20 @@ int Node::fileDirfd() const {
 }
 
 VersionType& Node::fileInfoVersion() const {
+  if (fileInfo.fileVersionPending()) {
+    // The file was opened with deferred checks: read the version attribute of the root group now.
+    hid_gc_noref file(H5Iget_file_id(parent), H5Fclose, "Could not get file to read version attribute ", versionAttrName());
+
+    // read only the version attribute, to keep deferred opens cheap
+    CachedAttribute version;
+    if (!AttributeCache::read(file, versionAttrName(), version) || !version.isString || version.nrElements != 1)
+      throw DALException("Could not read version attribute " + versionAttrName());
+
+    // copies share the same file info
+    FileInfo info(fileInfo);
+    info.setFileVersion(VersionType(version.strings[0]));
+  }
+
   return fileInfo.fileVersion();
 }
 
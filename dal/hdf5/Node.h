@@ -22,6 +22,7 @@
 #include <typeinfo>
 #include "types/hid_gc.h"
 #include "types/FileInfo.h"
+#include "types/AttributeCache.h"
 #include "types/versiontype.h"
 
 namespace dal {
@@ -36,6 +37,9 @@ public:
   /*!
    * File open/create mode.
    * If the filename already exists, CREATE will truncate it, while CREATE_EXCL will throw.
+   * IN_MEMORY creates a new file in memory, which is only written to disk if requested (see File).
+   * SWMR_READ and SWMR_WRITE open an existing file for single-writer/multiple-reader access,
+   * allowing readers to follow a file while it is being written (see File::startSWMRWrite()).
    * None means not opened. It is used internally; not for DAL users.
    *
    * For why this needs to be here, see the FileInfo class description.
@@ -48,12 +52,17 @@ public:
   static const FileMode READWRITE   = 2;
   static const FileMode CREATE      = 3;
   static const FileMode CREATE_EXCL = 4;
+  static const FileMode IN_MEMORY   = 5;
+  static const FileMode SWMR_READ   = 6;
+  static const FileMode SWMR_WRITE  = 7;
 
 
   Node();
 
   Node( Group &parent, const std::string &name );
 
+  Node( const Node &other );
+
   virtual ~Node();
 
   Node& operator=(Node rhs);
@@ -238,6 +247,9 @@ protected:
 
   FileInfo fileInfo; // proxy/reference object to reference-counted structure
 
+  //! The attribute cache of the parent group, used by attributes. See Group::loadAttributes().
+  AttributeCache parentAttributes;
+
   //! Constructor for Node of root group (in File) only
   Node( const hid_gc &parent, const std::string &name, FileInfo fileInfo);
 
@@ -0,0 +1,172 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "AttributeBatch.h"
+#include "ObjectAccess.h"
+#include <cstring>
+#include <set>
+
+using namespace std;
+
+namespace dal {
+
+AttributeBatch::AttributeBatch() : _enabled(false) { }
+
+bool AttributeBatch::contains( hid_t parent, const std::string &name ) const
+{
+  map<hid_t, size_t>::const_iterator hit = hidIndex.find(parent);
+  if (hit != hidIndex.end())
+    return groups[hit->second].index.count(name) > 0;
+
+  // another hid may refer to a staged group
+  map<string, size_t>::const_iterator git = groupIndex.find(objectLocation(parent));
+  if (git != groupIndex.end())
+    return groups[git->second].index.count(name) > 0;
+
+  return false;
+}
+
+AttributeBatch::StagedAttribute &AttributeBatch::stagedAttribute( const hid_gc &parent, const std::string &name )
+{
+  map<hid_t, size_t>::iterator hit = hidIndex.find(parent);
+  if (hit == hidIndex.end()) {
+    // a new hid, possibly of a group that was staged through another hid
+    map<string, size_t>::iterator git = groupIndex.insert(make_pair(objectLocation(parent), groups.size())).first;
+    if (git->second == groups.size())
+      groups.push_back(StagedGroup());
+
+    hit = hidIndex.insert(make_pair(static_cast<hid_t>(parent), git->second)).first;
+    groups[git->second].parents.push_back(parent);
+  }
+
+  StagedGroup &group = groups[hit->second];
+
+  map<string, size_t>::iterator ait = group.index.find(name);
+  if (ait == group.index.end()) {
+    ait = group.index.insert(make_pair(name, group.attributes.size())).first;
+
+    group.attributes.push_back(StagedAttribute());
+  }
+
+  StagedAttribute &attr = group.attributes[ait->second];
+  attr = StagedAttribute();
+  attr.name = name;
+
+  return attr;
+}
+
+void AttributeBatch::stage( const hid_gc &parent, const std::string &name, hid_t fileType, hid_t memType,
+                            bool scalar, size_t nrElements, const void *data )
+{
+  StagedAttribute &attr = stagedAttribute(parent, name);
+
+  attr.fileType   = fileType;
+  attr.memType    = memType;
+  attr.isString   = false;
+  attr.scalar     = scalar;
+  attr.nrElements = scalar ? 1 : nrElements;
+  attr.hasData    = data != NULL;
+
+  if (data) {
+    attr.data.resize(attr.nrElements * H5Tget_size(memType));
+    if (!attr.data.empty())
+      memcpy(&attr.data[0], data, attr.data.size());
+  }
+}
+
+void AttributeBatch::stageStrings( const hid_gc &parent, const std::string &name,
+                                   bool scalar, size_t nrElements, const std::string *data )
+{
+  StagedAttribute &attr = stagedAttribute(parent, name);
+
+  attr.fileType   = 0;
+  attr.memType    = 0;
+  attr.isString   = true;
+  attr.scalar     = scalar;
+  attr.nrElements = scalar ? 1 : nrElements;
+  attr.hasData    = data != NULL;
+
+  if (data)
+    attr.strings.assign(data, data + attr.nrElements);
+}
+
+void AttributeBatch::commit()
+{
+  // Clear the batch first, so that a failure does not leave it half-committed
+  vector<StagedGroup> staged;
+  staged.swap(groups);
+  groupIndex.clear();
+  hidIndex.clear();
+
+  for (size_t i = 0; i < staged.size(); i++)
+    commitGroup(staged[i]);
+}
+
+static herr_t collectAttributeName( hid_t, const char *name, const H5A_info_t *, void *opData )
+{
+  static_cast<set<string> *>(opData)->insert(name);
+  return 0;
+}
+
+void AttributeBatch::commitGroup( StagedGroup &group )
+{
+  // Determine which attributes exist in a single pass, instead of calling H5Aexists() for each of them
+  set<string> existing;
+  hsize_t idx = 0;
+  if (H5Aiterate2(group.parents[0], H5_INDEX_NAME, H5_ITER_NATIVE, &idx, collectAttributeName, &existing) < 0)
+    throw HDF5Exception("Could not iterate attributes to commit staged attributes");
+
+  hid_gc_noref stringType(H5Tcopy(H5T_C_S1), H5Tclose, "Could not create string datatype to commit staged attributes");
+  if (H5Tset_size(stringType, H5T_VARIABLE) < 0)
+    throw HDF5Exception("Could not create string datatype to commit staged attributes");
+
+  for (size_t i = 0; i < group.attributes.size(); i++) {
+    const StagedAttribute &attr = group.attributes[i];
+    const char *name = attr.name.c_str();
+
+    if (existing.count(attr.name) && H5Adelete(group.parents[0], name) < 0)
+      throw HDF5Exception("Could not remove attribute to commit staged attribute " + attr.name);
+
+    hsize_t count = attr.nrElements;
+    hid_gc_noref dataspace(attr.scalar ? H5Screate(H5S_SCALAR) : count == 0 ? H5Screate(H5S_NULL) : H5Screate_simple(1, &count, NULL),
+                           H5Sclose, "Could not create dataspace to commit staged attribute ", attr.name);
+
+    const hid_t fileType = attr.isString ? static_cast<hid_t>(stringType) : attr.fileType;
+    hid_gc_noref attribute(H5Acreate2(group.parents[0], name, fileType, dataspace, H5P_DEFAULT, H5P_DEFAULT),
+                           H5Aclose, "Could not create to commit staged attribute ", attr.name);
+
+    if (!attr.hasData || attr.nrElements == 0)
+      continue;
+
+    herr_t status;
+
+    if (attr.isString) {
+      vector<const char *> c_strs(attr.strings.size());
+      for (size_t j = 0; j < c_strs.size(); j++)
+        c_strs[j] = attr.strings[j].c_str();
+
+      status = H5Awrite(attribute, stringType, &c_strs[0]);
+    } else {
+      status = H5Awrite(attribute, attr.memType, &attr.data[0]);
+    }
+
+    if (status < 0)
+      throw HDF5Exception("Could not write to commit staged attribute " + attr.name);
+  }
+}
+
+}
+
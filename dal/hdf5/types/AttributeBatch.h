@@ -0,0 +1,110 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_ATTRIBUTE_BATCH_H
+#define DAL_ATTRIBUTE_BATCH_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <hdf5.h>
+#include "hid_gc.h"
+
+namespace dal {
+
+/*!
+ * Attribute writes that are staged in memory while write batching is enabled,
+ * see File::setWriteBatching(). An AttributeBatch is stored in FileInfo, and thus
+ * shared by all objects in a file.
+ *
+ * Attributes are staged per parent object, and committed group by group. Parents are
+ * identified by their location in the file, so objects that refer to the same group
+ * through different hids stage into the same group. Staging an attribute again replaces
+ * the staged type, size and value, so the last write wins. On commit,
+ * each attribute is created directly with its final type and size, replacing any
+ * attribute with the same name in the file.
+ */
+class AttributeBatch {
+public:
+  AttributeBatch();
+
+  bool enabled() const { return _enabled; }
+  void setEnabled( bool enabled ) { _enabled = enabled; }
+
+  //! Returns whether there are no staged writes.
+  bool empty() const { return groups.empty(); }
+
+  //! Returns whether attribute `name` of `parent` is staged.
+  bool contains( hid_t parent, const std::string &name ) const;
+
+  /*!
+   * Stages attribute `name` of `parent` with file datatype `fileType`, and a scalar (`scalar`) or
+   * array dataspace of `nrElements` elements. Its value is copied from `data`, which holds the elements
+   * in datatype `memType`. If `data` is NULL, the attribute is created with the HDF5 fill value.
+   * The datatypes must remain valid until commit().
+   */
+  void stage( const hid_gc &parent, const std::string &name, hid_t fileType, hid_t memType,
+              bool scalar, size_t nrElements, const void *data );
+
+  /*!
+   * Stages a variable-length string attribute `name` of `parent`, similar to stage().
+   * If `data` is NULL, the attribute is created with empty strings.
+   */
+  void stageStrings( const hid_gc &parent, const std::string &name,
+                     bool scalar, size_t nrElements, const std::string *data );
+
+  /*!
+   * Writes all staged attributes to the file, and clears the batch. If an attribute
+   * cannot be written, the remaining writes are dropped and an HDF5Exception is thrown.
+   */
+  void commit();
+
+private:
+  struct StagedAttribute {
+    std::string name;
+    hid_t fileType;
+    hid_t memType;
+    bool isString;
+    bool scalar;
+    size_t nrElements;
+    bool hasData;
+    std::vector<char> data;
+    std::vector<std::string> strings;
+  };
+
+  struct StagedGroup {
+    //! The hids through which attributes were staged. Keeping them open keeps their values valid in hidIndex.
+    std::vector<hid_gc> parents;
+    std::vector<StagedAttribute> attributes;
+    std::map<std::string, size_t> index; // name -> attributes[index]
+  };
+
+  bool _enabled;
+
+  //! Staged groups in the order in which they were first staged.
+  std::vector<StagedGroup> groups;
+  std::map<std::string, size_t> groupIndex; // location of parent -> groups[index]
+  std::map<hid_t, size_t> hidIndex;         // parent -> groups[index], to avoid looking up the location again
+
+  StagedAttribute &stagedAttribute( const hid_gc &parent, const std::string &name );
+
+  static void commitGroup( StagedGroup &group );
+};
+
+}
+
+#endif
+
@@ -0,0 +1,258 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "AttributeCache.h"
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+namespace dal {
+
+bool CachedAttribute::convert( hid_t memType, void *buffer ) const
+{
+  if (nrElements == 0)
+    return true;
+
+  const size_t srcSize = H5Tget_size(type);
+  const size_t dstSize = H5Tget_size(memType);
+  if (srcSize == 0 || dstSize == 0)
+    return false;
+
+  // H5Tconvert converts in place, so the buffer has to fit the largest of both types
+  vector<char> conv(nrElements * max(srcSize, dstSize));
+  vector<char> background(nrElements * dstSize);
+  memcpy(&conv[0], &data[0], data.size());
+
+  if (H5Tconvert(type, memType, nrElements, &conv[0], &background[0], H5P_DEFAULT) < 0)
+    return false;
+
+  memcpy(buffer, &conv[0], nrElements * dstSize);
+  return true;
+}
+
+static void readAttribute( hid_t attr, CachedAttribute &value )
+{
+  hid_gc_noref dataspace(H5Aget_space(attr), H5Sclose, "Could not get dataspace of attribute");
+
+  switch (H5Sget_simple_extent_type(dataspace)) {
+    case H5S_SCALAR:
+      value.nrElements = 1;
+      break;
+
+    case H5S_NULL:
+      value.nrElements = 0;
+      break;
+
+    case H5S_SIMPLE: {
+      const hssize_t npoints = H5Sget_simple_extent_npoints(dataspace);
+      if (npoints < 0)
+        return;
+      value.nrElements = npoints;
+      break;
+    }
+
+    default:
+      return;
+  }
+
+  value.type = hid_gc(H5Aget_type(attr), H5Tclose, "Could not get datatype of attribute");
+
+  const H5T_class_t typeClass = H5Tget_class(value.type);
+
+  if (typeClass == H5T_STRING) {
+    value.isString = true;
+
+    const htri_t isVariable = H5Tis_variable_str(value.type);
+    if (isVariable < 0)
+      return;
+    value.variableString = isVariable > 0;
+
+    value.strings.resize(value.nrElements);
+    if (value.nrElements == 0) {
+      value.decoded = true;
+      return;
+    }
+
+    if (value.variableString) {
+      hid_gc_noref datatype(H5Tcopy(H5T_C_S1), H5Tclose, "Could not create string datatype");
+      if (H5Tset_size(datatype, H5T_VARIABLE) < 0)
+        return;
+
+      vector<char *> c_strs(value.nrElements, 0);
+      if (H5Aread(attr, datatype, &c_strs[0]) < 0)
+        return;
+
+      for (size_t i = 0; i < c_strs.size(); i++)
+        if (c_strs[i])
+          value.strings[i] = c_strs[i];
+
+      if (H5Dvlen_reclaim(datatype, dataspace, H5P_DEFAULT, &c_strs[0]) < 0)
+        return;
+    } else {
+      const size_t size = H5Tget_size(value.type);
+
+      hid_gc_noref datatype(H5Tcopy(H5T_C_S1), H5Tclose, "Could not create string datatype");
+      if (H5Tset_size(datatype, size) < 0 || H5Tset_strpad(datatype, H5T_STR_NULLTERM) < 0)
+        return;
+
+      vector<char> buf(value.nrElements * size);
+      if (H5Aread(attr, datatype, &buf[0]) < 0)
+        return;
+
+      for (size_t i = 0; i < value.nrElements; i++) {
+        const char *str = &buf[i * size];
+        const char *end = static_cast<const char*>(memchr(str, '\0', size));
+
+        value.strings[i].assign(str, end ? end - str : size);
+      }
+    }
+
+    value.decoded = true;
+    return;
+  }
+
+  if (typeClass == H5T_NO_CLASS
+   || H5Tdetect_class(value.type, H5T_VLEN) != 0
+   || H5Tdetect_class(value.type, H5T_STRING) != 0
+   || H5Tdetect_class(value.type, H5T_REFERENCE) != 0)
+    return; // raw values would refer to memory or objects that we do not track
+
+  value.data.resize(value.nrElements * H5Tget_size(value.type));
+  if (value.nrElements > 0 && H5Aread(attr, value.type, &value.data[0]) < 0)
+    return;
+
+  value.decoded = true;
+}
+
+static herr_t cacheAttribute( hid_t location, const char *name, const H5A_info_t *, void *opData )
+{
+  map<string, CachedAttribute> &values = *static_cast<map<string, CachedAttribute> *>(opData);
+
+  // Register the attribute even if it cannot be read, so that it still exists
+  // in the cache. Its value is then read (and any error reported) by Attribute<T>.
+  CachedAttribute &value = values[name];
+
+  try {
+    hid_gc_noref attr(H5Aopen(location, name, H5P_DEFAULT), H5Aclose, "Could not open attribute");
+
+    readAttribute(attr, value);
+  } catch (HDF5Exception &) {
+    value = CachedAttribute();
+  } catch (...) {
+    // do not let exceptions pass through HDF5
+    return -1;
+  }
+
+  return 0;
+}
+
+AttributeCache::AttributeCache() : ptr(new AttributeCacheType) { }
+
+AttributeCache::AttributeCache(const AttributeCache& other) : ptr(other.ptr) {
+  ptr->refCount += 1;
+}
+
+AttributeCache::~AttributeCache() {
+  if (--ptr->refCount == 0)
+    delete ptr;
+}
+
+AttributeCache& AttributeCache::operator=(AttributeCache rhs) {
+  swap(*this, rhs);
+  return *this;
+}
+
+void swap(AttributeCache& ac0, AttributeCache& ac1) {
+  // no need to fiddle with the refCount
+  std::swap(ac0.ptr, ac1.ptr);
+}
+
+bool AttributeCache::load( hid_t object ) const {
+  map<string, CachedAttribute> values;
+  hsize_t idx = 0;
+
+  if (H5Aiterate2(object, H5_INDEX_NAME, H5_ITER_NATIVE, &idx, cacheAttribute, &values) < 0)
+    return false;
+
+  ptr->values.swap(values);
+  ptr->forgotten.clear();
+  ptr->loaded = true;
+  return true;
+}
+
+bool AttributeCache::read( hid_t object, const std::string &name, CachedAttribute &value ) {
+  if (H5Aexists(object, name.c_str()) <= 0)
+    return false;
+
+  hid_gc_noref attr(H5Aopen(object, name.c_str(), H5P_DEFAULT), H5Aclose, "Could not open attribute ", name);
+
+  readAttribute(attr, value);
+  return value.decoded;
+}
+
+void AttributeCache::assign( const std::map<std::string, CachedAttribute> &values ) const {
+  ptr->values = values;
+  ptr->forgotten.clear();
+  ptr->loaded = true;
+}
+
+const std::map<std::string, CachedAttribute> &AttributeCache::allValues() const {
+  return ptr->values;
+}
+
+void AttributeCache::clear() const {
+  ptr->values.clear();
+  ptr->forgotten.clear();
+  ptr->loaded = false;
+}
+
+bool AttributeCache::loaded() const {
+  return ptr->loaded;
+}
+
+int AttributeCache::exists( const std::string &name ) const {
+  if (!ptr->loaded || ptr->forgotten.count(name))
+    return -1;
+
+  return ptr->values.count(name) ? 1 : 0;
+}
+
+const CachedAttribute *AttributeCache::value( const std::string &name ) const {
+  if (!ptr->loaded || ptr->forgotten.count(name))
+    return NULL;
+
+  map<string, CachedAttribute>::const_iterator it = ptr->values.find(name);
+  if (it == ptr->values.end() || !it->second.decoded)
+    return NULL;
+
+  return &it->second;
+}
+
+void AttributeCache::forget( const std::string &name ) const {
+  if (!ptr->loaded)
+    return;
+
+  ptr->values.erase(name);
+  ptr->forgotten.insert(name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+AttributeCacheType::AttributeCacheType() : refCount(1), loaded(false) { }
+
+}
+
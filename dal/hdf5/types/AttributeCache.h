@@ -0,0 +1,143 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_ATTRIBUTE_CACHE_H
+#define DAL_ATTRIBUTE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <hdf5.h>
+#include "hid_gc.h"
+
+namespace dal {
+
+class AttributeCacheType;
+
+/*!
+ * The value of an attribute as read by AttributeCache::load().
+ */
+struct CachedAttribute {
+  CachedAttribute(): decoded(false), nrElements(0), isString(false), variableString(false) {}
+
+  //! Whether the value could be read. If not, the attribute is read from HDF5 on each access.
+  bool decoded;
+
+  //! The number of elements (1 for a scalar, 0 for an empty attribute).
+  size_t nrElements;
+
+  //! Whether this is a string attribute. If so, its value is stored in `strings`, otherwise in `data`.
+  bool isString;
+  bool variableString;
+  std::vector<std::string> strings;
+
+  //! The datatype of the attribute on disk, and its raw value in that type.
+  hid_gc type;
+  std::vector<char> data;
+
+  /*!
+   * Converts the (non-string) value to `memType` and stores it in `buffer`,
+   * which must hold nrElements elements. Returns false if the types cannot be converted.
+   */
+  bool convert( hid_t memType, void *buffer ) const;
+};
+
+/*!
+ * An AttributeCache object is a reference to a reference counted set of attribute
+ * values of one group or dataset, see Group::loadAttributes(). Copies share the values.
+ *
+ * Until load() is called, the cache is empty and all queries return "unknown".
+ */
+class AttributeCache {
+  AttributeCacheType* ptr;
+
+public:
+  AttributeCache();
+  AttributeCache(const AttributeCache& other);
+  ~AttributeCache();
+  AttributeCache& operator=(AttributeCache rhs);
+
+  friend void swap(AttributeCache& ac0, AttributeCache& ac1);
+
+  /*!
+   * Reads all attributes of the HDF5 object `object` using a single H5Aiterate2 pass,
+   * replacing any previously loaded values. Returns false if the attributes could not be iterated.
+   */
+  bool load( hid_t object ) const;
+
+  /*!
+   * Reads only attribute `name` of the HDF5 object `object` into `value`, without caching it.
+   * Returns false if the attribute does not exist or could not be read.
+   */
+  static bool read( hid_t object, const std::string &name, CachedAttribute &value );
+
+  /*!
+   * Replaces any previously loaded values by `values`, as if they were read by load().
+   * Used to serve attributes from a MetadataIndex.
+   */
+  void assign( const std::map<std::string, CachedAttribute> &values ) const;
+
+  //! Returns all loaded values, indexed by attribute name.
+  const std::map<std::string, CachedAttribute> &allValues() const;
+
+  //! Drops all values. Subsequent queries return "unknown" until load() is called again.
+  void clear() const;
+
+  //! Returns whether load() has been called (and not undone by clear()).
+  bool loaded() const;
+
+  /*!
+   * Returns whether attribute `name` exists: 1 if it does, 0 if it does not,
+   * and -1 if the cache does not know.
+   */
+  int exists( const std::string &name ) const;
+
+  /*!
+   * Returns the cached value of attribute `name`, or NULL if it has to be read from HDF5.
+   * The pointer remains valid until this cache is modified.
+   */
+  const CachedAttribute *value( const std::string &name ) const;
+
+  /*!
+   * Marks attribute `name` as modified (created, set or removed): queries
+   * for it will return "unknown" until load() is called again.
+   */
+  void forget( const std::string &name ) const;
+};
+
+/*!
+ * Stores the attribute values for AttributeCache. Do not use directly.
+ */
+class AttributeCacheType {
+  friend class AttributeCache;
+
+  unsigned refCount;
+
+  bool loaded;
+
+  std::map<std::string, CachedAttribute> values;
+
+  //! Attributes modified since load().
+  std::set<std::string> forgotten;
+
+  AttributeCacheType();
+};
+
+}
+
+#endif
+
@@ -0,0 +1,179 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <algorithm>
+#include <string>
+#include "ExternalFileSet.h"
+#include "../exceptions/exceptions.h"
+
+using namespace std;
+
+namespace dal {
+
+/*
+ * Stores the segments and their file descriptors. Intended to be used through ExternalFileSet only.
+ */
+class ExternalFileSetType {
+  friend class ExternalFileSet;
+
+  // protects refCount and fds
+  mutable pthread_mutex_t mutex;
+  unsigned refCount;
+
+  vector<ExternalFileSet::Segment> segments;
+
+  //! Directory to resolve relative file names against.
+  int dirfd;
+
+  //! File descriptor per segment, or -1 if not opened yet.
+  mutable vector<int> fds;
+
+  ExternalFileSetType() : refCount(1), dirfd(-1) {
+    pthread_mutex_init(&mutex, NULL);
+  }
+
+  ~ExternalFileSetType() {
+    for (size_t i = 0; i < fds.size(); i++)
+      if (fds[i] != -1)
+        ::close(fds[i]);
+
+    if (dirfd != -1)
+      ::close(dirfd);
+
+    pthread_mutex_destroy(&mutex);
+  }
+
+  //! Returns the file descriptor of segment `index`, opening the file if needed.
+  int fd(size_t index) const;
+};
+
+int ExternalFileSetType::fd(size_t index) const {
+  pthread_mutex_lock(&mutex);
+
+  if (fds[index] == -1)
+    fds[index] = ::openat(dirfd, segments[index].filename.c_str(), O_RDONLY);
+
+  const int result = fds[index];
+
+  pthread_mutex_unlock(&mutex);
+
+  if (result == -1)
+    throw DALException("Could not open external file " + segments[index].filename + ": " + strerror(errno));
+
+  return result;
+}
+
+ExternalFileSet::ExternalFileSet() : ptr(new ExternalFileSetType) { }
+
+ExternalFileSet::ExternalFileSet(const vector<Segment>& segments, int dirfd) : ptr(new ExternalFileSetType) {
+  ptr->segments = segments;
+  ptr->fds.resize(segments.size(), -1);
+
+  // keep our own reference to the directory, also to become independent of the cwd
+  ptr->dirfd = dirfd == -1 ? ::open(".", O_RDONLY) : ::dup(dirfd);
+  if (ptr->dirfd == -1) {
+    const string errstr(strerror(errno));
+    delete ptr;
+    throw DALException("Could not open directory of external files: " + errstr);
+  }
+}
+
+ExternalFileSet::ExternalFileSet(const ExternalFileSet& other) : ptr(other.ptr) {
+  pthread_mutex_lock(&ptr->mutex);
+  ptr->refCount += 1;
+  pthread_mutex_unlock(&ptr->mutex);
+}
+
+ExternalFileSet::~ExternalFileSet() {
+  pthread_mutex_lock(&ptr->mutex);
+  const unsigned refCount = --ptr->refCount;
+  pthread_mutex_unlock(&ptr->mutex);
+
+  if (refCount == 0)
+    delete ptr;
+}
+
+ExternalFileSet& ExternalFileSet::operator=(ExternalFileSet rhs) {
+  swap(*this, rhs);
+  return *this;
+}
+
+void swap(ExternalFileSet& first, ExternalFileSet& second) {
+  std::swap(first.ptr, second.ptr);
+}
+
+void ExternalFileSet::read(hsize_t pos, void* buffer, size_t length) const {
+  char* out = static_cast<char*>(buffer);
+  hsize_t segmentStart = 0;
+
+  for (size_t i = 0; i < ptr->segments.size() && length > 0; i++) {
+    const Segment& segment = ptr->segments[i];
+    const bool unlimited = segment.size == H5F_UNLIMITED;
+
+    if (!unlimited && pos >= segmentStart + segment.size) {
+      segmentStart += segment.size;
+      continue;
+    }
+
+    const hsize_t inSegment = pos - segmentStart;
+    const size_t n = unlimited ? length : static_cast<size_t>(std::min<hsize_t>(length, segment.size - inSegment));
+
+    const int fd = ptr->fd(i);
+    off_t offset = segment.offset + inSegment;
+    size_t done = 0;
+
+    while (done < n) {
+      const ssize_t r = ::pread(fd, out + done, n - done, offset);
+
+      if (r == -1) {
+        if (errno == EINTR)
+          continue;
+
+        throw DALException("Could not read external file " + segment.filename + ": " + strerror(errno));
+      }
+
+      if (r == 0) {
+        // end of file: the data has not been written (yet)
+        memset(out + done, 0, n - done);
+        break;
+      }
+
+      done += r;
+      offset += r;
+    }
+
+    out    += n;
+    pos    += n;
+    length -= n;
+
+    if (!unlimited)
+      segmentStart += segment.size;
+  }
+
+  if (length > 0)
+    throw DALIndexError("Cannot read beyond the last external file " + (ptr->segments.empty() ? string() : ptr->segments.back().filename));
+}
+
+}
+
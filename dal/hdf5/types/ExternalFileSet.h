@@ -0,0 +1,78 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_EXTERNAL_FILE_SET_H
+#define DAL_EXTERNAL_FILE_SET_H
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <hdf5.h>
+
+namespace dal {
+
+class ExternalFileSetType;
+
+/*!
+ * An ExternalFileSet object is a reference to a reference counted set of external raw data files,
+ * read with pread() without calling HDF5. Together, the segments of the files form the raw data
+ * of a contiguous dataset, as set by H5Pset_external().
+ *
+ * The files are opened read-only on first use, and stay open until the last reference is destructed.
+ * A default constructed ExternalFileSet contains no segments.
+ *
+ * Thread safety: read() may be called concurrently, also on the same object. Copies may be
+ * made and destructed in different threads.
+ */
+class ExternalFileSet {
+  ExternalFileSetType* ptr;
+
+public:
+  //! A part of an external file, as returned by H5Pget_external().
+  struct Segment {
+    std::string filename;
+    off_t offset;
+    hsize_t size; // H5F_UNLIMITED for an unbounded last segment
+  };
+
+  ExternalFileSet();
+
+  /*!
+   * Refers to `segments`. Relative file names are resolved against the directory
+   * opened as `dirfd`, or against the cwd if `dirfd` is -1. Both are resolved now,
+   * so later changes to the cwd do not matter. `dirfd` may be closed afterwards.
+   */
+  ExternalFileSet(const std::vector<Segment>& segments, int dirfd);
+
+  ExternalFileSet(const ExternalFileSet& other);
+  ~ExternalFileSet();
+  ExternalFileSet& operator=(ExternalFileSet rhs);
+
+  friend void swap(ExternalFileSet& first, ExternalFileSet& second);
+
+  /*!
+   * Reads `length` bytes from byte `pos` of the concatenated segments into `buffer`.
+   * Like HDF5, bytes beyond the end of a file are read as zeros.
+   * Throws a DALIndexError if the bytes are beyond the last segment, and a DALException
+   * if a file cannot be opened or read.
+   */
+  void read(hsize_t pos, void* buffer, size_t length) const;
+};
+
+}
+
+#endif
+
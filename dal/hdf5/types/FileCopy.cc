@@ -0,0 +1,181 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FileCopy.h"
+#include "ParallelTasks.h"
+#include "../exceptions/exceptions.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+#endif
+
+using namespace std;
+
+namespace dal {
+
+static string errorString( const string &msg )
+{
+  return msg + ": " + strerror(errno);
+}
+
+//! Copies the remaining contents of `in` to `out`, starting at their current offsets.
+static void copyContents( int in, int out, off_t size, const string &source )
+{
+#if defined(__linux__) && defined(FICLONE)
+  // share the data blocks (btrfs, XFS, ...): no data is copied at all
+  if (::ioctl(out, FICLONE, in) == 0)
+    return;
+#endif
+
+#if defined(__linux__) && defined(SYS_copy_file_range)
+  // copy within the kernel, which can also offload the copy to the file server (NFS 4.2, ...)
+  off_t done = 0;
+
+  while (done < size) {
+    const size_t maxChunk = 1 << 30;
+    const ssize_t n = ::syscall(SYS_copy_file_range, in, NULL, out, NULL, min<off_t>(size - done, maxChunk), 0);
+
+    if (n <= 0)
+      break; // not supported (e.g. across file systems), or end of file: copy the rest below
+
+    done += n;
+  }
+#else
+  (void)size;
+#endif
+
+  vector<char> buf(1 << 20);
+
+  for (;;) {
+    const ssize_t n = ::read(in, &buf[0], buf.size());
+
+    if (n == 0)
+      break;
+
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+
+      throw DALException(errorString("Could not read " + source));
+    }
+
+    for (ssize_t written = 0; written < n; ) {
+      const ssize_t w = ::write(out, &buf[written], n - written);
+
+      if (w < 0) {
+        if (errno == EINTR)
+          continue;
+
+        throw DALException(errorString("Could not write copy of " + source));
+      }
+
+      written += w;
+    }
+  }
+}
+
+void copyFile( const std::string &source, const std::string &destination, bool hardlink )
+{
+  if (hardlink) {
+    if (::link(source.c_str(), destination.c_str()) == 0)
+      return;
+
+    if (errno != EXDEV && errno != EPERM)
+      throw DALException(errorString("Could not hard link " + source + " to " + destination));
+
+    // different file system, or hard links not supported: copy instead
+  }
+
+  const int in = ::open(source.c_str(), O_RDONLY);
+  if (in < 0)
+    throw DALException(errorString("Could not open " + source + " for copying"));
+
+  struct stat st;
+  if (::fstat(in, &st) != 0) {
+    ::close(in);
+    throw DALException(errorString("Could not stat " + source + " for copying"));
+  }
+
+  const int out = ::open(destination.c_str(), O_WRONLY | O_CREAT | O_EXCL, st.st_mode & 0777);
+  if (out < 0) {
+    ::close(in);
+    throw DALException(errorString("Could not create " + destination));
+  }
+
+  try {
+    copyContents(in, out, st.st_size, source);
+  } catch (DALException &) {
+    ::close(in);
+    ::close(out);
+    ::unlink(destination.c_str());
+    throw;
+  }
+
+  ::close(in);
+
+  if (::close(out) != 0) {
+    ::unlink(destination.c_str());
+    throw DALException(errorString("Could not write copy of " + source));
+  }
+}
+
+struct FileCopyTasks: public ParallelTasks {
+  FileCopyTasks( const vector< pair<string, string> > &files, bool hardlink )
+  :
+    files(files),
+    hardlink(hardlink),
+    copied(files.size(), 0)
+  {
+  }
+
+  virtual void run( size_t i )
+  {
+    copyFile(files[i].first, files[i].second, hardlink);
+    copied[i] = 1;
+  }
+
+  const vector< pair<string, string> > &files;
+  const bool hardlink;
+
+  vector<char> copied; // whether each file was copied; each entry is set by one task only
+};
+
+void copyFiles( const std::vector< std::pair<std::string, std::string> > &files, bool hardlink, unsigned nrThreads )
+{
+  FileCopyTasks tasks(files, hardlink);
+
+  try {
+    runTasks(tasks, files.size(), nrThreads);
+  } catch (DALException &) {
+    for (size_t i = 0; i < files.size(); i++)
+      if (tasks.copied[i])
+        ::unlink(files[i].second.c_str());
+
+    throw;
+  }
+}
+
+}
+
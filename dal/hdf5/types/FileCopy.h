@@ -0,0 +1,50 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_FILE_COPY_H
+#define DAL_FILE_COPY_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace dal {
+
+/*!
+ * Copies the file `source` to `destination`, which must not exist yet. The copy is made
+ * as cheaply as the file systems allow: by sharing the data blocks (a reflink, FICLONE)
+ * if possible, otherwise by copying within the kernel (copy_file_range), and otherwise
+ * through a userspace buffer.
+ *
+ * If `hardlink` is set, `destination` is created as a hard link to `source` instead,
+ * falling back to a copy if both are on different file systems.
+ *
+ * Throws a DALException on failure, in which case `destination` is not created.
+ */
+void copyFile( const std::string &source, const std::string &destination, bool hardlink );
+
+/*!
+ * Copies each (source, destination) pair in `files` using copyFile(), using up to
+ * `nrThreads` threads. If any copy fails, the remaining files are skipped, the copies
+ * made so far are removed, and a DALException describing the first error is thrown once
+ * all threads are done.
+ */
+void copyFiles( const std::vector< std::pair<std::string, std::string> > &files, bool hardlink, unsigned nrThreads );
+
+}
+
+#endif
+
@@ -22,7 +22,10 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <libgen.h>
+#include <pthread.h>
 
+#include <map>
+#include <utility>
 #include <vector>
 #include "FileInfo.h"
 
@@ -44,7 +47,7 @@ FileInfo::FileInfo(const FileInfo& other) : ptr(other.ptr) {
 FileInfo::~FileInfo() {
   if (--ptr->refCount == 0) {
     if (ptr->fdirfd != -1)
-      ::close(ptr->fdirfd);
+      releaseDirfd(ptr->fdirfd);
     delete ptr;
   }
 }
@@ -81,13 +84,93 @@ VersionType& FileInfo::fileVersion() const {
 
 void FileInfo::setFileVersion(const VersionType& newVersion) {
   ptr->fileVersion = newVersion;
+  ptr->fileVersionPending = false;
 }
 
+bool FileInfo::fileVersionPending() const {
+  return ptr->fileVersionPending;
+}
+
+void FileInfo::setFileVersionPending(bool pending) {
+  ptr->fileVersionPending = pending;
+}
+
+DatasetShape& FileInfo::datasetShape(const std::string& datasetPath) const {
+  // std::map never moves its elements, so references into it remain valid
+  return ptr->datasetShapes[datasetPath];
+}
+
+AttributeBatch& FileInfo::attributeBatch() const {
+  return ptr->attributeBatch;
+}
+
+MetadataIndex& FileInfo::metadataIndex() const {
+  return ptr->metadataIndex;
+}
+
+/*
+ * Directory descriptors shared by all open files, so that opening many files in
+ * the same directory costs a single descriptor. Keyed by device and inode, as
+ * the same directory can be named in different ways.
+ */
+typedef pair<dev_t, ino_t> DirKey;
+
+struct SharedDir {
+  DirKey key;
+  unsigned refCount;
+};
+
+static pthread_mutex_t sharedDirsMutex = PTHREAD_MUTEX_INITIALIZER;
+static map<DirKey, int> sharedDirfds;   // directory -> fd
+static map<int, SharedDir> sharedDirs;  // fd -> directory
+
 int FileInfo::openOtherDirname(const std::string& filename) {
   string dirName(getDirname(filename));
   if (dirName == ".")
     return -1;
-  return ::open(dirName.c_str(), O_RDONLY);
+
+  struct stat st;
+  if (::stat(dirName.c_str(), &st) != 0)
+    return -1;
+
+  const DirKey key(st.st_dev, st.st_ino);
+
+  pthread_mutex_lock(&sharedDirsMutex);
+
+  int fd;
+  map<DirKey, int>::const_iterator it = sharedDirfds.find(key);
+
+  if (it != sharedDirfds.end()) {
+    fd = it->second;
+    sharedDirs[fd].refCount++;
+  } else {
+    fd = ::open(dirName.c_str(), O_RDONLY);
+
+    if (fd != -1) {
+      SharedDir &dir = sharedDirs[fd];
+      dir.key = key;
+      dir.refCount = 1;
+      sharedDirfds[key] = fd;
+    }
+  }
+
+  pthread_mutex_unlock(&sharedDirsMutex);
+
+  return fd;
+}
+
+void FileInfo::releaseDirfd(int fd) {
+  pthread_mutex_lock(&sharedDirsMutex);
+
+  map<int, SharedDir>::iterator it = sharedDirs.find(fd);
+
+  if (it != sharedDirs.end() && --it->second.refCount == 0) {
+    sharedDirfds.erase(it->second.key);
+    sharedDirs.erase(it);
+    ::close(fd);
+  }
+
+  pthread_mutex_unlock(&sharedDirsMutex);
 }
 
 // static functions
@@ -113,7 +196,7 @@ std::string FileInfo::getDirname(const std::string& filename) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-FileInfoType::FileInfoType() : refCount(1), fdirfd(-1), fileMode(0) { }
+FileInfoType::FileInfoType() : refCount(1), fdirfd(-1), fileMode(0), fileVersionPending(false) { }
 
 FileInfoType::FileInfoType(const std::string& filename, int fdirfd,
                            FileInfo::FileMode fileMode, const std::string& versionAttrName)
@@ -122,8 +205,20 @@ FileInfoType::FileInfoType(const std::string& filename, int fdirfd,
 , fdirfd(fdirfd)
 , fileMode(fileMode)
 , versionAttrName(versionAttrName)
+, fileVersionPending(false)
 { }
 
+FileInfoType::~FileInfoType() {
+  // the last object of the file is gone, so nobody else will commit the staged writes
+  if (!attributeBatch.empty()) {
+    try {
+      attributeBatch.commit();
+    } catch (DALException &) {
+      // cannot throw from a destructor; call File::flush() or File::close() to see errors
+    }
+  }
+}
+
 
 }
 
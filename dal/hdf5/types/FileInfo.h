@@ -18,12 +18,34 @@
 #define DAL_FILE_INFO_H
 
 #include <string>
+#include <vector>
+#include <map>
+#include <hdf5.h>
 #include "versiontype.h"
+#include "AttributeBatch.h"
+#include "MetadataIndex.h"
 
 namespace dal {
 
 class FileInfoType;
 
+/*!
+ * Cached extent of an HDF5 dataset, shared through FileInfo by all Dataset objects
+ * that refer to the same dataset. The rank is dims.size().
+ * An element of maxdims equal to H5S_UNLIMITED represents an unbounded dimension.
+ *
+ * efilePrefixLost is set while HDF5 has the dataset open without the external file prefix
+ * of datasetAccessList(), see hasExternalFilePrefix(). Dataset::transfer() then changes
+ * the cwd to the directory of the HDF5 file, as with HDF5 1.8.
+ */
+struct DatasetShape {
+  std::vector<hsize_t> dims;
+  std::vector<hsize_t> maxdims;
+  bool efilePrefixLost;
+
+  DatasetShape() : efilePrefixLost(false) {}
+};
+
 /*!
  * A FileInfo object is a reference to a reference counted FileInfoType object.
  * All FileInfoType members are read-only, except fileVersion.
@@ -50,14 +72,42 @@ public:
   const std::string& versionAttrName() const;
   VersionType& fileVersion() const;
 
+  //! Sets the file version, and marks it as no longer pending.
   void setFileVersion(const VersionType& newVersion);
 
+  /*!
+   * Returns whether the file version has yet to be read from the version attribute,
+   * because the file was opened with FileAccessOptions::deferChecks. See Node::fileInfoVersion().
+   */
+  bool fileVersionPending() const;
+  void setFileVersionPending(bool pending);
+
+  /*!
+   * Returns the shape cache entry for the dataset with absolute HDF5 path `datasetPath`.
+   * A new entry is empty (rank 0) until filled by its Dataset.
+   * The returned reference stays valid as long as this FileInfo object (or a copy) exists.
+   */
+  DatasetShape& datasetShape(const std::string& datasetPath) const;
+
+  //! Returns the staged attribute writes of this file. See File::setWriteBatching().
+  AttributeBatch& attributeBatch() const;
+
+  //! Returns the metadata index of this file. See File::loadIndex().
+  MetadataIndex& metadataIndex() const;
+
 
   static std::string getBasename(const std::string& filename);
   static std::string getDirname(const std::string& filename);
 
 private:
-  int openOtherDirname(const std::string& filename);
+  /*!
+   * Returns a file descriptor of the directory of `filename`, or -1 if "." or failed to open.
+   * Files in the same directory share the descriptor, see releaseDirfd().
+   */
+  static int openOtherDirname(const std::string& filename);
+
+  //! Releases a descriptor returned by openOtherDirname(), closing it once it is no longer shared.
+  static void releaseDirfd(int fd);
 };
 
 /*!
@@ -100,10 +150,25 @@ class FileInfoType {
   // Not initialized by the constructor, because we don't know for sure if the file is already open.
   VersionType fileVersion;
 
+  //! Whether fileVersion has yet to be read. See FileInfo::fileVersionPending().
+  bool fileVersionPending;
+
+  //! Cached dataset shapes, indexed by absolute HDF5 path. See Dataset::refreshShape().
+  std::map<std::string, DatasetShape> datasetShapes;
+
+  //! Attribute writes staged while write batching is enabled.
+  AttributeBatch attributeBatch;
+
+  //! Metadata served from a sidecar index, if loaded.
+  MetadataIndex metadataIndex;
+
 
   FileInfoType();
   FileInfoType(const std::string& filename, const int fdirfd,
                FileInfo::FileMode fileMode, const std::string& versionAttrName);
+
+  //! Commits the staged attribute writes, which keep their groups, and thus the HDF5 file, open until then.
+  ~FileInfoType();
 };
 
 
@@ -0,0 +1,47 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <pthread.h>
+#include "HDF5Lock.h"
+
+namespace dal {
+
+static pthread_mutex_t hdf5Mutex;
+static pthread_once_t hdf5MutexOnce = PTHREAD_ONCE_INIT;
+
+static void initHDF5Mutex()
+{
+  // PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP is not portable
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&hdf5Mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+}
+
+HDF5Lock::HDF5Lock()
+{
+  pthread_once(&hdf5MutexOnce, initHDF5Mutex);
+  pthread_mutex_lock(&hdf5Mutex);
+}
+
+HDF5Lock::~HDF5Lock()
+{
+  pthread_mutex_unlock(&hdf5Mutex);
+}
+
+}
+
@@ -0,0 +1,51 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_HDF5_LOCK_H
+#define DAL_HDF5_LOCK_H
+
+namespace dal {
+
+/*!
+ * Serializes HDF5 calls between threads. Unless the HDF5 library is built thread-safe,
+ * only one thread may call HDF5 at a time, including through DAL objects.
+ *
+ * An HDF5Lock object holds a process-wide lock for its life time. The lock is recursive,
+ * so a thread holding it may create nested HDF5Lock objects. DAL takes the lock where it
+ * calls HDF5 on behalf of other threads (see ConcurrentReader); applications that use DAL
+ * from several threads take it around their own DAL calls:
+ * \code
+ *    {
+ *      HDF5Lock lock;
+ *      std::vector<TBB_DipoleDataset> dipoles(station.dipoleDatasets());
+ *    }
+ * \endcode
+ */
+class HDF5Lock {
+public:
+  HDF5Lock();
+  ~HDF5Lock();
+
+private:
+  // not copyable
+  HDF5Lock( const HDF5Lock & );
+  HDF5Lock &operator=( const HDF5Lock & );
+};
+
+}
+
+#endif
+
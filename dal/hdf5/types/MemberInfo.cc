@@ -0,0 +1,64 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MemberInfo.h"
+#include "hid_gc.h"
+#include "../exceptions/exceptions.h"
+
+using namespace std;
+
+namespace dal {
+
+void MemberInfo::describe( hid_t object, bool withShape )
+{
+  switch (H5Iget_type(object)) {
+    case H5I_GROUP:
+      type = GROUP;
+      break;
+
+    case H5I_DATASET:
+      type = DATASET;
+      break;
+
+    case H5I_DATATYPE:
+      type = DATATYPE;
+      break;
+
+    default:
+      type = UNKNOWN;
+      break;
+  }
+
+  if (!withShape || type != DATASET)
+    return;
+
+  hid_gc_noref dataspace(H5Dget_space(object), H5Sclose, "Could not get dataspace of member ", name);
+  hid_gc_noref datatype(H5Dget_type(object), H5Tclose, "Could not get datatype of member ", name);
+
+  const int rank = H5Sget_simple_extent_ndims(dataspace);
+  if (rank < 0)
+    throw HDF5Exception("Could not get rank of member " + name);
+
+  vector<hsize_t> dimensions(rank);
+  if (rank > 0 && H5Sget_simple_extent_dims(dataspace, &dimensions[0], NULL) < 0)
+    throw HDF5Exception("Could not get dimensions of member " + name);
+
+  dims.assign(dimensions.begin(), dimensions.end());
+  elementSize = H5Tget_size(datatype);
+}
+
+}
+
@@ -0,0 +1,62 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_MEMBER_INFO_H
+#define DAL_MEMBER_INFO_H
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <hdf5.h>
+
+namespace dal {
+
+/*!
+ * Describes a member of a group, see Group::members().
+ */
+struct MemberInfo {
+  enum Type {
+    UNKNOWN,  // for example a dangling soft link
+    GROUP,
+    DATASET,
+    DATATYPE
+  };
+
+  MemberInfo(): type(UNKNOWN), elementSize(0) {}
+
+  //! The name of the link to the member.
+  std::string name;
+
+  //! The type of the object linked to.
+  Type type;
+
+  //! For datasets, if requested: the dimensions and the size of an element in bytes.
+  std::vector<ssize_t> dims;
+  size_t elementSize;
+
+#ifndef SWIG
+  /*!
+   * Fills in the type of the open HDF5 object `object` and, if `withShape` is set
+   * and it is a dataset, its dimensions and element size.
+   */
+  void describe( hid_t object, bool withShape );
+#endif
+};
+
+}
+
+#endif
+
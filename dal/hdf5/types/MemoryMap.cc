@@ -0,0 +1,106 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include "MemoryMap.h"
+#include "../exceptions/exceptions.h"
+
+using namespace std;
+
+namespace dal {
+
+/*
+ * Stores the actual mapping. Intended to be used through MemoryMap only.
+ */
+class MemoryMapType {
+  friend class MemoryMap;
+
+  unsigned refCount;
+
+  //! Page aligned start and length as passed to mmap() and munmap().
+  void* base;
+  size_t baseLength;
+
+  //! The bytes requested by the user, within [base, base + baseLength).
+  const char* start;
+  size_t length;
+
+  MemoryMapType() : refCount(1), base(0), baseLength(0), start(0), length(0) { }
+};
+
+MemoryMap::MemoryMap() : ptr(new MemoryMapType) { }
+
+MemoryMap::MemoryMap(int fd, off_t offset, size_t length) : ptr(new MemoryMapType) {
+  if (length == 0)
+    return;
+
+  // mmap() requires a page aligned offset
+  const off_t pageSize = ::sysconf(_SC_PAGESIZE);
+  const off_t alignedOffset = offset - offset % pageSize;
+  const size_t lead = offset - alignedOffset;
+
+  void* base = ::mmap(NULL, lead + length, PROT_READ, MAP_SHARED, fd, alignedOffset);
+  if (base == MAP_FAILED) {
+    const string errstr(strerror(errno));
+    delete ptr;
+    throw DALException("Could not memory map file: " + errstr);
+  }
+
+  ptr->base       = base;
+  ptr->baseLength = lead + length;
+  ptr->start      = static_cast<const char*>(base) + lead;
+  ptr->length     = length;
+}
+
+MemoryMap::MemoryMap(const MemoryMap& other) : ptr(other.ptr) {
+  ptr->refCount += 1;
+}
+
+MemoryMap::~MemoryMap() {
+  if (--ptr->refCount == 0) {
+    if (ptr->base)
+      ::munmap(ptr->base, ptr->baseLength);
+    delete ptr;
+  }
+}
+
+MemoryMap& MemoryMap::operator=(MemoryMap rhs) {
+  swap(*this, rhs);
+  return *this;
+}
+
+void swap(MemoryMap& first, MemoryMap& second) {
+  std::swap(first.ptr, second.ptr);
+}
+
+const void* MemoryMap::data() const {
+  return ptr->start;
+}
+
+size_t MemoryMap::size() const {
+  return ptr->length;
+}
+
+}
+
@@ -0,0 +1,87 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_MEMORY_MAP_H
+#define DAL_MEMORY_MAP_H
+
+#include <cstddef>
+#include <sys/types.h>
+
+namespace dal {
+
+class MemoryMapType;
+
+/*!
+ * A MemoryMap object is a reference to a reference counted, read-only memory mapping
+ * of (part of) a file. The mapping is removed once the last reference is destructed.
+ * A default constructed MemoryMap maps nothing (size() == 0).
+ */
+class MemoryMap {
+  MemoryMapType* ptr;
+
+public:
+  MemoryMap();
+
+  /*!
+   * Maps `length` bytes of the file opened as `fd`, starting at byte `offset`.
+   * The offset does not need to be page aligned. `fd` may be closed afterwards.
+   * Throws a DALException if the mapping fails.
+   */
+  MemoryMap(int fd, off_t offset, size_t length);
+
+  MemoryMap(const MemoryMap& other);
+  ~MemoryMap();
+  MemoryMap& operator=(MemoryMap rhs);
+
+  friend void swap(MemoryMap& first, MemoryMap& second);
+
+  //! Returns the start of the mapped bytes.
+  const void* data() const;
+
+  //! Returns the number of mapped bytes.
+  size_t size() const;
+};
+
+/*!
+ * Typed read-only view on a MemoryMap, as returned by Dataset<T>::mapRegion().
+ * Copies refer to the same mapping.
+ */
+template<typename T> class MappedRegion {
+public:
+  typedef const T *const_iterator;
+
+  MappedRegion() {}
+  explicit MappedRegion( const MemoryMap &map ): map(map) {}
+
+  //! Returns the first element of the region.
+  const T *data() const { return static_cast<const T*>(map.data()); }
+
+  //! Returns the number of elements in the region.
+  size_t size() const { return map.size() / sizeof(T); }
+
+  const T &operator[]( size_t index ) const { return data()[index]; }
+
+  const_iterator begin() const { return data(); }
+  const_iterator end() const { return data() + size(); }
+
+private:
+  MemoryMap map;
+};
+
+}
+
+#endif
+
@@ -0,0 +1,608 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MetadataIndex.h"
+#include "hid_gc.h"
+#include "ObjectAccess.h"
+#include "../exceptions/exceptions.h"
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace dal {
+
+/*
+ * Index file layout (native byte order, which is checked on read):
+ *
+ *   magic "DALIDX" + format version, byte order mark
+ *   signature of the HDF5 file: size, mtime (s, ns), checksum
+ *   number of objects, followed by each object (see putObject())
+ *   checksum of all preceding bytes
+ *
+ * Strings and arrays are stored as a 64-bit length followed by their elements.
+ * Attribute datatypes are stored using H5Tencode().
+ */
+static const char indexMagic[8] = { 'D', 'A', 'L', 'I', 'D', 'X', '\0', '1' };
+static const uint32_t byteOrderMark = 0x01020304;
+
+//! The number of bytes at the start and at the end of the HDF5 file included in its checksum.
+static const size_t signatureBlockSize = 64 * 1024;
+
+static uint64_t fnv1a( uint64_t hash, const char *data, size_t size )
+{
+  for (size_t i = 0; i < size; i++) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 0x100000001b3ULL;
+  }
+
+  return hash;
+}
+
+static const uint64_t fnv1aInit = 0xcbf29ce484222325ULL;
+
+/*
+ * Identifies the contents of an HDF5 file. HDF5 keeps its superblock at the start
+ * and usually appends metadata at the end, so besides the size and modification time,
+ * only the first and last blocks are checksummed to keep this cheap for large files.
+ */
+struct FileSignature {
+  uint64_t size;
+  int64_t mtimeSec;
+  int64_t mtimeNsec;
+  uint64_t checksum;
+
+  bool operator==( const FileSignature &other ) const {
+    return size == other.size && mtimeSec == other.mtimeSec && mtimeNsec == other.mtimeNsec && checksum == other.checksum;
+  }
+};
+
+static bool readBlock( int fd, vector<char> &buf, off_t offset )
+{
+  size_t done = 0;
+
+  while (done < buf.size()) {
+    const ssize_t n = ::pread(fd, &buf[done], buf.size() - done, offset + done);
+    if (n <= 0)
+      return false;
+
+    done += n;
+  }
+
+  return true;
+}
+
+static bool fileSignature( const string &filename, FileSignature &sig )
+{
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  bool ok = ::fstat(fd, &st) == 0;
+
+  if (ok) {
+    sig.size = st.st_size;
+    sig.mtimeSec = st.st_mtim.tv_sec;
+    sig.mtimeNsec = st.st_mtim.tv_nsec;
+
+    vector<char> buf(min<uint64_t>(sig.size, signatureBlockSize));
+    ok = !buf.empty() && readBlock(fd, buf, 0);
+    sig.checksum = ok ? fnv1a(fnv1aInit, &buf[0], buf.size()) : 0;
+
+    if (ok && sig.size > signatureBlockSize) {
+      ok = readBlock(fd, buf, sig.size - buf.size());
+      sig.checksum = fnv1a(sig.checksum, &buf[0], buf.size());
+    }
+  }
+
+  ::close(fd);
+  return ok;
+}
+
+// ----- Serialisation -----
+
+static void putRaw( vector<char> &buf, const void *data, size_t size )
+{
+  const char *bytes = static_cast<const char *>(data);
+  buf.insert(buf.end(), bytes, bytes + size);
+}
+
+template<typename T> static void put( vector<char> &buf, T value )
+{
+  putRaw(buf, &value, sizeof value);
+}
+
+static void putString( vector<char> &buf, const string &str )
+{
+  put<uint64_t>(buf, str.size());
+  putRaw(buf, str.data(), str.size());
+}
+
+template<typename T> static void putArray( vector<char> &buf, const vector<T> &values )
+{
+  put<uint64_t>(buf, values.size());
+  for (size_t i = 0; i < values.size(); i++)
+    put<T>(buf, values[i]);
+}
+
+static void putStrings( vector<char> &buf, const vector<string> &strs )
+{
+  put<uint64_t>(buf, strs.size());
+  for (size_t i = 0; i < strs.size(); i++)
+    putString(buf, strs[i]);
+}
+
+static void putAttribute( vector<char> &buf, const CachedAttribute &value )
+{
+  put<uint8_t>(buf, value.decoded);
+  if (!value.decoded)
+    return;
+
+  put<uint64_t>(buf, value.nrElements);
+  put<uint8_t>(buf, value.isString);
+
+  if (value.isString) {
+    put<uint8_t>(buf, value.variableString);
+    putStrings(buf, value.strings);
+    return;
+  }
+
+  size_t typeSize = 0;
+  if (H5Tencode(value.type, NULL, &typeSize) < 0)
+    throw HDF5Exception("Could not encode attribute datatype for index");
+
+  vector<char> encodedType(typeSize);
+  if (H5Tencode(value.type, &encodedType[0], &typeSize) < 0)
+    throw HDF5Exception("Could not encode attribute datatype for index");
+
+  putArray(buf, encodedType);
+  putArray(buf, value.data);
+}
+
+static void putObject( vector<char> &buf, const string &path, const IndexedObject &object )
+{
+  putString(buf, path);
+  put<uint32_t>(buf, object.type);
+
+  put<uint64_t>(buf, object.members.size());
+  for (size_t i = 0; i < object.members.size(); i++) {
+    const MemberInfo &member = object.members[i];
+
+    putString(buf, member.name);
+    put<uint32_t>(buf, member.type);
+    putArray(buf, vector<int64_t>(member.dims.begin(), member.dims.end()));
+    put<uint64_t>(buf, member.elementSize);
+  }
+
+  putArray(buf, vector<uint64_t>(object.dims.begin(), object.dims.end()));
+  putArray(buf, vector<uint64_t>(object.maxdims.begin(), object.maxdims.end()));
+  putStrings(buf, object.externalFiles);
+
+  put<uint64_t>(buf, object.attributes.size());
+  for (map<string, CachedAttribute>::const_iterator i = object.attributes.begin(); i != object.attributes.end(); ++i) {
+    putString(buf, i->first);
+    putAttribute(buf, i->second);
+  }
+}
+
+/*
+ * Reads values from an index file in memory. Throws a DALException if it is truncated.
+ */
+class IndexReader {
+public:
+  IndexReader( const vector<char> &buf, size_t size ): buf(buf), size(size), pos(0) {}
+
+  void raw( void *data, size_t n ) {
+    if (n > size - pos)
+      throw DALException("Index file is truncated");
+
+    if (n > 0)
+      memcpy(data, &buf[pos], n);
+    pos += n;
+  }
+
+  template<typename T> T get() {
+    T value;
+    raw(&value, sizeof value);
+    return value;
+  }
+
+  //! Reads an array length, checking that it fits in the remaining data.
+  size_t length( size_t elementSize ) {
+    const uint64_t n = get<uint64_t>();
+    if (elementSize > 0 && n > (size - pos) / elementSize)
+      throw DALException("Index file is truncated");
+
+    return n;
+  }
+
+  string getString() {
+    string str(length(1), '\0');
+    if (!str.empty())
+      raw(&str[0], str.size());
+    return str;
+  }
+
+  template<typename T> vector<T> getArray() {
+    vector<T> values(length(sizeof(T)));
+    for (size_t i = 0; i < values.size(); i++)
+      values[i] = get<T>();
+    return values;
+  }
+
+  vector<string> getStrings() {
+    vector<string> strs(length(sizeof(uint64_t)));
+    for (size_t i = 0; i < strs.size(); i++)
+      strs[i] = getString();
+    return strs;
+  }
+
+  bool atEnd() const { return pos == size; }
+
+private:
+  const vector<char> &buf;
+  const size_t size;
+  size_t pos;
+};
+
+static MemberInfo::Type getType( IndexReader &reader )
+{
+  const uint32_t type = reader.get<uint32_t>();
+  if (type > MemberInfo::DATATYPE)
+    throw DALException("Index file contains an unknown object type");
+
+  return static_cast<MemberInfo::Type>(type);
+}
+
+static void getAttribute( IndexReader &reader, CachedAttribute &value )
+{
+  value.decoded = reader.get<uint8_t>();
+  if (!value.decoded)
+    return;
+
+  value.nrElements = reader.get<uint64_t>();
+  value.isString = reader.get<uint8_t>();
+
+  if (value.isString) {
+    value.variableString = reader.get<uint8_t>();
+    value.strings = reader.getStrings();
+
+    if (value.strings.size() != value.nrElements)
+      throw DALException("Index file contains an inconsistent string attribute");
+    return;
+  }
+
+  const vector<char> encodedType = reader.getArray<char>();
+  if (encodedType.empty())
+    throw DALException("Index file contains an attribute without datatype");
+
+  value.type = hid_gc(H5Tdecode(&encodedType[0]), H5Tclose, "Could not decode attribute datatype from index");
+  value.data = reader.getArray<char>();
+
+  if (value.data.size() != value.nrElements * H5Tget_size(value.type))
+    throw DALException("Index file contains an inconsistent attribute");
+}
+
+static void getObject( IndexReader &reader, IndexedObject &object )
+{
+  object.type = getType(reader);
+
+  object.members.resize(reader.length(sizeof(uint64_t)));
+  for (size_t i = 0; i < object.members.size(); i++) {
+    MemberInfo &member = object.members[i];
+
+    member.name = reader.getString();
+    member.type = getType(reader);
+
+    const vector<int64_t> dims = reader.getArray<int64_t>();
+    member.dims.assign(dims.begin(), dims.end());
+    member.elementSize = reader.get<uint64_t>();
+  }
+
+  const vector<uint64_t> dims = reader.getArray<uint64_t>();
+  const vector<uint64_t> maxdims = reader.getArray<uint64_t>();
+  object.dims.assign(dims.begin(), dims.end());
+  object.maxdims.assign(maxdims.begin(), maxdims.end());
+  object.externalFiles = reader.getStrings();
+
+  const size_t nrAttributes = reader.length(sizeof(uint64_t));
+  for (size_t i = 0; i < nrAttributes; i++) {
+    const string name = reader.getString();
+
+    getAttribute(reader, object.attributes[name]);
+  }
+}
+
+// ----- Building -----
+
+static void indexObject( hid_t object, const string &path, IndexedObject &entry )
+{
+  MemberInfo info;
+  info.name = path;
+  info.describe(object, false);
+  entry.type = info.type;
+
+  AttributeCache attributes;
+  if (!attributes.load(object))
+    throw HDF5Exception("Could not read attributes of " + path + " for index");
+
+  entry.attributes = attributes.allValues();
+
+  if (entry.type != MemberInfo::DATASET)
+    return;
+
+  hid_gc_noref dataspace(H5Dget_space(object), H5Sclose, "Could not get dataspace for index of dataset ", path);
+
+  const int rank = H5Sget_simple_extent_ndims(dataspace);
+  if (rank < 0)
+    throw HDF5Exception("Could not get number of dimensions for index of dataset " + path);
+
+  entry.dims.resize(rank);
+  entry.maxdims.resize(rank);
+  if (rank > 0 && H5Sget_simple_extent_dims(dataspace, &entry.dims[0], &entry.maxdims[0]) < 0)
+    throw HDF5Exception("Could not get dimensions for index of dataset " + path);
+
+  hid_gc_noref dcpl(H5Dget_create_plist(object), H5Pclose, "Could not open dataset creation property list for index of dataset ", path);
+
+  const int numfiles = H5Pget_external_count(dcpl);
+  if (numfiles < 0)
+    throw HDF5Exception("Could not get number of external files for index of dataset " + path);
+
+  entry.externalFiles.resize(numfiles);
+  for (int i = 0; i < numfiles; i++) {
+    char buf[1024];
+    if (H5Pget_external(dcpl, i, sizeof buf, buf, NULL, NULL) < 0)
+      throw HDF5Exception("Could not get file name of external file for index of dataset " + path);
+
+    // null-terminate in case file name is >=1024 characters long
+    buf[sizeof buf - 1] = 0;
+
+    entry.externalFiles[i] = buf;
+  }
+}
+
+struct IndexBuild {
+  map<string, IndexedObject> *objects;
+
+  //! Addresses of the objects indexed so far, to index objects with several hard links only once.
+  set<string> visited;
+};
+
+static herr_t indexLink( hid_t root, const char *name, const H5L_info_t *linkInfo, void *opData )
+{
+  IndexBuild &build = *static_cast<IndexBuild *>(opData);
+
+  // do not let exceptions pass through HDF5
+  try {
+    const string relativePath(name);
+    const string::size_type slash = relativePath.rfind('/');
+    const string path = "/" + relativePath;
+    const string parentPath = slash == string::npos ? "/" : "/" + relativePath.substr(0, slash);
+
+    MemberInfo member;
+    member.name = slash == string::npos ? relativePath : relativePath.substr(slash + 1);
+
+    // H5Lvisit does not follow soft links, so only hard links lead to new objects
+    const hid_t object = openObject(root, name);
+    if (object >= 0) {
+      hid_gc_noref obj(object, H5Oclose, "Could not open object for index ", path);
+
+      member.describe(obj, true);
+
+      if (linkInfo->type == H5L_TYPE_HARD) {
+#if defined(H5L_info_t_vers) && H5L_info_t_vers >= 2
+        const string address(reinterpret_cast<const char *>(&linkInfo->u.token), sizeof linkInfo->u.token);
+#else
+        const string address(reinterpret_cast<const char *>(&linkInfo->u.address), sizeof linkInfo->u.address);
+#endif
+
+        // H5Lvisit lists the members of a group only once, under its first path,
+        // so other paths to the same object are left out of the index.
+        if (build.visited.insert(address).second)
+          indexObject(obj, path, (*build.objects)[path]);
+      }
+    } // else: dangling link; type remains UNKNOWN
+
+    (*build.objects)[parentPath].members.push_back(member);
+  } catch (...) {
+    return -1;
+  }
+
+  return 0;
+}
+
+MetadataIndex::MetadataIndex() : ptr(new MetadataIndexType) { }
+
+MetadataIndex::MetadataIndex(const MetadataIndex& other) : ptr(other.ptr) {
+  ptr->refCount += 1;
+}
+
+MetadataIndex::~MetadataIndex() {
+  if (--ptr->refCount == 0)
+    delete ptr;
+}
+
+MetadataIndex& MetadataIndex::operator=(MetadataIndex rhs) {
+  swap(*this, rhs);
+  return *this;
+}
+
+void swap(MetadataIndex& mi0, MetadataIndex& mi1) {
+  // no need to fiddle with the refCount
+  std::swap(mi0.ptr, mi1.ptr);
+}
+
+void MetadataIndex::build( hid_t file ) const {
+  map<string, IndexedObject> objects;
+
+  hid_gc_noref root(H5Gopen2(file, "/", H5P_DEFAULT), H5Gclose, "Could not open root group for index");
+  indexObject(root, "/", objects["/"]);
+
+  IndexBuild build = { &objects, set<string>() };
+
+  // H5_INDEX_NAME visits the members of each group in the order of Group::members()
+  if (H5Lvisit(root, H5_INDEX_NAME, H5_ITER_INC, indexLink, &build) < 0)
+    throw HDF5Exception("Could not visit all objects for index");
+
+  ptr->objects.swap(objects);
+  ptr->loaded = true;
+}
+
+void MetadataIndex::write( const std::string &indexFilename, const std::string &filename ) const {
+  FileSignature sig;
+  if (!fileSignature(filename, sig))
+    throw DALException("Could not read signature for index of file " + filename);
+
+  vector<char> buf;
+  putRaw(buf, indexMagic, sizeof indexMagic);
+  put<uint32_t>(buf, byteOrderMark);
+
+  put<uint64_t>(buf, sig.size);
+  put<int64_t>(buf, sig.mtimeSec);
+  put<int64_t>(buf, sig.mtimeNsec);
+  put<uint64_t>(buf, sig.checksum);
+
+  put<uint64_t>(buf, ptr->objects.size());
+  for (map<string, IndexedObject>::const_iterator i = ptr->objects.begin(); i != ptr->objects.end(); ++i)
+    putObject(buf, i->first, i->second);
+
+  put<uint64_t>(buf, fnv1a(fnv1aInit, &buf[0], buf.size()));
+
+  // Write to a temporary file and rename it, so that readers never see a partial index.
+  ostringstream tmpName;
+  tmpName << indexFilename << ".tmp" << ::getpid();
+
+  const int fd = ::open(tmpName.str().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    throw DALException("Could not create index file " + indexFilename);
+
+  size_t done = 0;
+  while (done < buf.size()) {
+    const ssize_t n = ::write(fd, &buf[done], buf.size() - done);
+    if (n <= 0)
+      break;
+
+    done += n;
+  }
+
+  if (::close(fd) != 0 || done != buf.size() || ::rename(tmpName.str().c_str(), indexFilename.c_str()) != 0) {
+    ::unlink(tmpName.str().c_str());
+    throw DALException("Could not write index file " + indexFilename);
+  }
+}
+
+bool MetadataIndex::read( const std::string &indexFilename, const std::string &filename ) const {
+  const int fd = ::open(indexFilename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  vector<char> buf;
+
+  bool ok = ::fstat(fd, &st) == 0;
+  if (ok) {
+    buf.resize(st.st_size);
+    ok = readBlock(fd, buf, 0);
+  }
+
+  ::close(fd);
+
+  if (!ok || buf.size() < sizeof indexMagic + sizeof(uint64_t))
+    return false;
+
+  // verify the checksum first, so that parsing only sees intact data
+  const size_t contentSize = buf.size() - sizeof(uint64_t);
+  uint64_t checksum;
+  memcpy(&checksum, &buf[contentSize], sizeof checksum);
+
+  if (checksum != fnv1a(fnv1aInit, &buf[0], contentSize))
+    return false;
+
+  map<string, IndexedObject> objects;
+
+  try {
+    IndexReader reader(buf, contentSize);
+
+    char magic[sizeof indexMagic];
+    reader.raw(magic, sizeof magic);
+    if (memcmp(magic, indexMagic, sizeof magic) != 0 || reader.get<uint32_t>() != byteOrderMark)
+      return false;
+
+    FileSignature stored;
+    stored.size = reader.get<uint64_t>();
+    stored.mtimeSec = reader.get<int64_t>();
+    stored.mtimeNsec = reader.get<int64_t>();
+    stored.checksum = reader.get<uint64_t>();
+
+    FileSignature current;
+    if (!fileSignature(filename, current) || !(current == stored))
+      return false;
+
+    const size_t nrObjects = reader.length(sizeof(uint64_t));
+    for (size_t i = 0; i < nrObjects; i++) {
+      const string path = reader.getString();
+
+      getObject(reader, objects[path]);
+    }
+
+    if (!reader.atEnd())
+      return false;
+  } catch (DALException &) {
+    return false;
+  }
+
+  ptr->objects.swap(objects);
+  ptr->loaded = true;
+  return true;
+}
+
+bool MetadataIndex::loaded() const {
+  return ptr->loaded;
+}
+
+void MetadataIndex::clear() const {
+  ptr->objects.clear();
+  ptr->loaded = false;
+}
+
+const IndexedObject *MetadataIndex::find( const std::string &path ) const {
+  if (!ptr->loaded)
+    return NULL;
+
+  map<string, IndexedObject>::const_iterator it = ptr->objects.find(path);
+  if (it == ptr->objects.end())
+    return NULL;
+
+  return &it->second;
+}
+
+const std::map<std::string, IndexedObject> &MetadataIndex::objects() const {
+  return ptr->objects;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MetadataIndexType::MetadataIndexType() : refCount(1), loaded(false) { }
+
+}
+
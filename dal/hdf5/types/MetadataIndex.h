@@ -0,0 +1,124 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_METADATA_INDEX_H
+#define DAL_METADATA_INDEX_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <hdf5.h>
+#include "AttributeCache.h"
+#include "MemberInfo.h"
+
+namespace dal {
+
+class MetadataIndexType;
+
+/*!
+ * The metadata of one HDF5 object as stored in a MetadataIndex.
+ */
+struct IndexedObject {
+  IndexedObject(): type(MemberInfo::UNKNOWN) {}
+
+  MemberInfo::Type type;
+
+  //! For groups: the members, sorted by name, including the dimensions and element sizes of datasets.
+  std::vector<MemberInfo> members;
+
+  //! For datasets: the dimensions, maximum dimensions, and external files.
+  std::vector<hsize_t> dims;
+  std::vector<hsize_t> maxdims;
+  std::vector<std::string> externalFiles;
+
+  //! The attribute values, as read by AttributeCache::load().
+  std::map<std::string, CachedAttribute> attributes;
+};
+
+/*!
+ * A MetadataIndex object is a reference to a reference counted snapshot of the metadata
+ * of an HDF5 file: its object tree, dataset shapes, external file lists and attribute values,
+ * indexed by absolute HDF5 path. See File::writeIndex() and File::loadIndex().
+ *
+ * The index is stored in a sidecar file together with the size, modification time and
+ * a checksum of the HDF5 file it describes, so a stale index is detected and ignored.
+ */
+class MetadataIndex {
+  MetadataIndexType* ptr;
+
+public:
+  MetadataIndex();
+  MetadataIndex(const MetadataIndex& other);
+  ~MetadataIndex();
+  MetadataIndex& operator=(MetadataIndex rhs);
+
+  friend void swap(MetadataIndex& mi0, MetadataIndex& mi1);
+
+  /*!
+   * Reads the metadata of all objects reachable through hard links from the root group of `file`,
+   * replacing the current contents.
+   */
+  void build( hid_t file ) const;
+
+  /*!
+   * Writes the index to `indexFilename`, marked with the size, modification time and checksum
+   * of HDF5 file `filename`. Throws a DALException on failure.
+   */
+  void write( const std::string &indexFilename, const std::string &filename ) const;
+
+  /*!
+   * Reads the index from `indexFilename`, replacing the current contents. Returns false,
+   * leaving the current contents unaltered, if it cannot be read, is corrupt, or does not match the
+   * current size, modification time or checksum of HDF5 file `filename`.
+   */
+  bool read( const std::string &indexFilename, const std::string &filename ) const;
+
+  //! Returns whether build() or read() filled this index.
+  bool loaded() const;
+
+  //! Drops the contents.
+  void clear() const;
+
+  /*!
+   * Returns the metadata of the object with absolute HDF5 path `path`,
+   * or NULL if the index is not loaded or does not contain it.
+   * The pointer remains valid until this index is modified.
+   */
+  const IndexedObject *find( const std::string &path ) const;
+
+  //! Returns all objects in the index, indexed by absolute HDF5 path.
+  const std::map<std::string, IndexedObject> &objects() const;
+};
+
+/*!
+ * Stores the objects for MetadataIndex. Do not use directly.
+ */
+class MetadataIndexType {
+  friend class MetadataIndex;
+
+  unsigned refCount;
+
+  bool loaded;
+
+  std::map<std::string, IndexedObject> objects;
+
+  MetadataIndexType();
+};
+
+}
+
+#endif
+
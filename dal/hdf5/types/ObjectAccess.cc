@@ -0,0 +1,139 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ObjectAccess.h"
+#include "../exceptions/errorstack.h"
+#include "../exceptions/exceptions.h"
+#include <vector>
+
+namespace dal {
+
+hid_gc datasetAccessList()
+{
+  hid_gc dapl(H5Pcreate(H5P_DATASET_ACCESS), H5Pclose, "Could not create dataset access property list");
+
+#if defined(H5_VERSION_GE) && H5_VERSION_GE(1, 10, 0)
+  /*
+   * "${ORIGIN}" is replaced by the directory of the HDF5 file once, when the dataset is opened.
+   * This makes external file access independent of the cwd, so Dataset::transfer() does not
+   * need to change it.
+   */
+  if (H5Pset_efile_prefix(dapl, "${ORIGIN}") < 0)
+    throw HDF5Exception("Could not set external file prefix of dataset access property list");
+#endif
+
+  return dapl;
+}
+
+hid_t openObject( hid_t loc, const char *name )
+{
+  DisableErrorPrinting dep;
+
+  const hid_t object = H5Oopen(loc, name, H5P_DEFAULT);
+  if (object >= 0)
+    return object;
+
+  return H5Dopen2(loc, name, datasetAccessList());
+}
+
+hid_t openDataset( hid_t loc, const char *name, bool &prefixLost )
+{
+  prefixLost = false;
+
+  {
+    DisableErrorPrinting dep;
+
+    const hid_t dataset = H5Dopen2(loc, name, datasetAccessList());
+    if (dataset >= 0)
+      return dataset;
+  }
+
+  const hid_t dataset = H5Dopen2(loc, name, H5P_DEFAULT);
+  if (dataset >= 0)
+    prefixLost = true;
+
+  return dataset;
+}
+
+bool hasExternalFilePrefix( hid_t dataset )
+{
+#if defined(H5_VERSION_GE) && H5_VERSION_GE(1, 10, 0)
+  hid_gc_noref dapl(H5Dget_access_plist(dataset), H5Pclose, "Could not get dataset access property list");
+
+  const ssize_t prefixLen = H5Pget_efile_prefix(dapl, NULL, 0);
+  if (prefixLen < 0)
+    throw HDF5Exception("Could not get external file prefix of dataset access property list");
+
+  return prefixLen > 0;
+#else
+  (void)dataset;
+  return false;
+#endif
+}
+
+std::string objectLocation( hid_t object )
+{
+  std::string location;
+
+#if defined(H5_VERSION_GE) && H5_VERSION_GE(1, 12, 0)
+  H5O_info2_t info;
+  if (H5Oget_info3(object, &info, H5O_INFO_BASIC) < 0)
+    throw HDF5Exception("Could not determine location of object");
+
+  location.append(reinterpret_cast<const char *>(&info.token), sizeof info.token);
+#else
+  H5O_info_t info;
+#if defined(H5_VERSION_GE) && H5_VERSION_GE(1, 10, 3)
+  if (H5Oget_info2(object, &info, H5O_INFO_BASIC) < 0)
+#else
+  if (H5Oget_info(object, &info) < 0)
+#endif
+    throw HDF5Exception("Could not determine location of object");
+
+  location.append(reinterpret_cast<const char *>(&info.addr), sizeof info.addr);
+#endif
+
+  // objects in other files (e.g. through external links) can have the same address
+  location.append(reinterpret_cast<const char *>(&info.fileno), sizeof info.fileno);
+
+  return location;
+}
+
+bool openUnderOtherId( hid_t object )
+{
+  hid_gc_noref file(H5Iget_file_id(object), H5Fclose, "Could not get file of object");
+
+  const unsigned types = H5F_OBJ_DATASET | H5F_OBJ_GROUP | H5F_OBJ_DATATYPE;
+  const ssize_t count = H5Fget_obj_count(file, types);
+  if (count < 0)
+    throw HDF5Exception("Could not get open objects of file");
+
+  std::vector<hid_t> objects(count + 1);
+  const ssize_t nrObjects = H5Fget_obj_ids(file, types, objects.size(), &objects[0]);
+  if (nrObjects < 0)
+    throw HDF5Exception("Could not get open objects of file");
+
+  const std::string location(objectLocation(object));
+
+  for (ssize_t i = 0; i < nrObjects; i++)
+    if (objects[i] != object && objectLocation(objects[i]) == location)
+      return true;
+
+  return false;
+}
+
+}
+
@@ -0,0 +1,68 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_OBJECT_ACCESS_H
+#define DAL_OBJECT_ACCESS_H
+
+#include <string>
+#include <hdf5.h>
+#include "hid_gc.h"
+
+namespace dal {
+
+/*!
+ * Returns a new dataset access property list, with which DAL opens and creates all datasets.
+ * From HDF5 1.10, it lets HDF5 resolve relative external file names against the directory
+ * of the HDF5 file, instead of against the current working directory (see Known Issue 1).
+ */
+hid_gc datasetAccessList();
+
+/*!
+ * Opens object `name` in `loc`, like H5Oopen(). HDF5 refuses to open a dataset that is already
+ * open with a different external file prefix, which H5Oopen() cannot pass. Such datasets are
+ * opened with datasetAccessList() instead. Returns a negative value if the object cannot be opened
+ * (e.g. a dangling link), without printing HDF5 errors.
+ */
+hid_t openObject( hid_t loc, const char *name );
+
+/*!
+ * Opens dataset `name` in `loc` with datasetAccessList(), like H5Dopen2(). If HDF5 has the dataset
+ * open already without the external file prefix (see hasExternalFilePrefix()), it is opened without
+ * the prefix as well, and `prefixLost` is set. Returns a negative value if the dataset cannot be opened.
+ */
+hid_t openDataset( hid_t loc, const char *name, bool &prefixLost );
+
+/*!
+ * Returns whether HDF5 resolves relative external file names of the open `dataset` against the
+ * directory of the HDF5 file. H5Drefresh() and H5Fstart_swmr_write() reopen datasets without the
+ * prefix set by datasetAccessList(), after which HDF5 resolves them against the cwd until all
+ * handles to the dataset are closed. Always returns false for HDF5 1.8.
+ */
+bool hasExternalFilePrefix( hid_t dataset );
+
+//! Returns a key that identifies the object `object` refers to, regardless of the hid used.
+std::string objectLocation( hid_t object );
+
+/*!
+ * Returns whether the object `object` refers to is also open under another id. HDF5 cannot
+ * reopen objects under their id (see H5Drefresh()) while they are.
+ */
+bool openUnderOtherId( hid_t object );
+
+}
+
+#endif
+
@@ -0,0 +1,147 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ParallelTasks.h"
+#include "../exceptions/exceptions.h"
+#include <algorithm>
+#include <exception>
+#include <new>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+using namespace std;
+
+namespace dal {
+
+//! A copy of an exception thrown by a task, which can be rethrown with its original type.
+class TaskError {
+public:
+  virtual ~TaskError() {}
+  virtual void rethrow() const = 0;
+};
+
+template<typename E> class TaskErrorOf: public TaskError {
+public:
+  TaskErrorOf( const E &e ): e(e) {}
+  virtual void rethrow() const { throw e; }
+
+private:
+  const E e;
+};
+
+struct TaskQueue {
+  ParallelTasks *tasks;
+  size_t nrTasks;
+
+  pthread_mutex_t mutex;
+  size_t next;        // the next task to run
+  TaskError *error;   // the first error, if any
+};
+
+static void setError( TaskQueue &queue, TaskError *error )
+{
+  pthread_mutex_lock(&queue.mutex);
+  if (!queue.error) {
+    queue.error = error;
+    error = NULL;
+  }
+  pthread_mutex_unlock(&queue.mutex);
+
+  delete error;
+}
+
+static void *taskWorker( void *arg )
+{
+  TaskQueue &queue = *static_cast<TaskQueue *>(arg);
+
+  for (;;) {
+    pthread_mutex_lock(&queue.mutex);
+
+    if (queue.next == queue.nrTasks || queue.error) {
+      pthread_mutex_unlock(&queue.mutex);
+      break;
+    }
+
+    const size_t i = queue.next++;
+
+    pthread_mutex_unlock(&queue.mutex);
+
+    // an exception escaping a thread terminates the program, so catch them all
+    try {
+      queue.tasks->run(i);
+    } catch (HDF5Exception &e) {
+      setError(queue, new TaskErrorOf<HDF5Exception>(e));
+    } catch (DALIndexError &e) {
+      setError(queue, new TaskErrorOf<DALIndexError>(e));
+    } catch (DALValueError &e) {
+      setError(queue, new TaskErrorOf<DALValueError>(e));
+    } catch (DALException &e) {
+      setError(queue, new TaskErrorOf<DALException>(e));
+    } catch (std::bad_alloc &e) {
+      setError(queue, new TaskErrorOf<std::bad_alloc>(e));
+    } catch (std::exception &e) {
+      setError(queue, new TaskErrorOf<DALException>(DALException(string("Task failed: ") + e.what())));
+    } catch (...) {
+      setError(queue, new TaskErrorOf<DALException>(DALException("Task failed with an unknown exception")));
+    }
+  }
+
+  return NULL;
+}
+
+void runTasks( ParallelTasks &tasks, size_t nrTasks, unsigned nrThreads )
+{
+  TaskQueue queue;
+  queue.tasks = &tasks;
+  queue.nrTasks = nrTasks;
+  queue.next = 0;
+  queue.error = NULL;
+  pthread_mutex_init(&queue.mutex, NULL);
+
+  const size_t nrWorkers = min<size_t>(max(nrThreads, 1U), nrTasks);
+  vector<pthread_t> threads;
+
+  // the calling thread is one of the workers
+  for (size_t i = 1; i < nrWorkers; i++) {
+    pthread_t thread;
+
+    // if we cannot start more threads, run the tasks with the ones we have
+    if (pthread_create(&thread, NULL, taskWorker, &queue) != 0)
+      break;
+
+    threads.push_back(thread);
+  }
+
+  taskWorker(&queue);
+
+  for (size_t i = 0; i < threads.size(); i++)
+    pthread_join(threads[i], NULL);
+
+  pthread_mutex_destroy(&queue.mutex);
+
+  if (queue.error) {
+    try {
+      queue.error->rethrow();
+    } catch (...) {
+      delete queue.error;
+      throw;
+    }
+  }
+}
+
+}
+
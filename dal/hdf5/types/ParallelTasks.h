@@ -0,0 +1,49 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_PARALLEL_TASKS_H
+#define DAL_PARALLEL_TASKS_H
+
+#include <cstddef>
+
+namespace dal {
+
+/*!
+ * A set of independent tasks, numbered 0, 1, ..., to run with runTasks().
+ */
+class ParallelTasks {
+public:
+  virtual ~ParallelTasks() {}
+
+  /*!
+   * Performs task `i`. Called from several threads at once, for different `i`.
+   * Reports errors by throwing an exception, preferably a DALException.
+   */
+  virtual void run( size_t i ) = 0;
+};
+
+/*!
+ * Runs tasks 0 to `nrTasks` - 1 of `tasks` using up to `nrThreads` threads, one of which
+ * is the calling thread. If a task fails, the tasks that have not started yet are skipped,
+ * and the first error is thrown once all threads are done. DAL exceptions (DALValueError,
+ * HDF5Exception, ...) and std::bad_alloc keep their type; other exceptions become a DALException.
+ */
+void runTasks( ParallelTasks &tasks, size_t nrTasks, unsigned nrThreads );
+
+}
+
+#endif
+
@@ -21,6 +21,7 @@
 #include "hid_gc.h"
 #include "h5complex.h"
 #include "h5tuple.h"
+#include "h5typeregistry.h"
 #include "isderivedfrom.h"
 
 namespace dal {
@@ -122,9 +123,9 @@ template<> struct h5typemap<bool> {
 };
 
 template<typename T> struct h5typemap< std::complex<T> > {
-  static inline hid_gc memoryType()               { return h5complexType( h5typemap<T>::memoryType() );        }
-  static inline hid_gc attributeType()            { return h5complexType( h5typemap<T>::attributeType() );     }
-  static inline hid_gc dataType( bool bigEndian ) { return h5complexType( h5typemap<T>::dataType(bigEndian) ); }
+  static inline hid_t memoryType()               { return h5complexTypeCached( h5typemap<T>::memoryType() );        }
+  static inline hid_t attributeType()            { return h5complexTypeCached( h5typemap<T>::attributeType() );     }
+  static inline hid_t dataType( bool bigEndian ) { return h5complexTypeCached( h5typemap<T>::dataType(bigEndian) ); }
 };
 
 /*
@@ -144,9 +145,9 @@ template<typename T, int> struct h5typemap_proxy {
 template<typename T> struct h5typemap_proxy<T,1> {
   // The specialisation for TupleUntemplated and subclasses thereof
 
-  static inline hid_gc memoryType()               { return h5tupleType( h5typemap<typename T::type>::memoryType(), T::size() );        }
-  static inline hid_gc attributeType()            { return h5tupleType( h5typemap<typename T::type>::attributeType(), T::size() );     }
-  static inline hid_gc dataType( bool bigEndian ) { return h5tupleType( h5typemap<typename T::type>::dataType(bigEndian), T::size() ); }
+  static inline hid_t memoryType()               { return h5tupleTypeCached( h5typemap<typename T::type>::memoryType(), T::size() );        }
+  static inline hid_t attributeType()            { return h5tupleTypeCached( h5typemap<typename T::type>::attributeType(), T::size() );     }
+  static inline hid_t dataType( bool bigEndian ) { return h5tupleTypeCached( h5typemap<typename T::type>::dataType(bigEndian), T::size() ); }
 };
 
 /*
@@ -158,17 +159,17 @@ template<typename T> struct h5typemap {
   /*!
    * HDF5 type identifier for type T in memory (the native C++ type)
    */
-  static inline hid_gc memoryType()               { return proxy::memoryType(); }
+  static inline hid_t memoryType()               { return proxy::memoryType(); }
 
   /*!
    * HDF5 type identifier for attributes of type T on disk
    */
-  static inline hid_gc attributeType()            { return proxy::attributeType(); }
+  static inline hid_t attributeType()            { return proxy::attributeType(); }
 
   /*!
    * HDF5 type identifier for datasets of type T on disk
    */
-  static inline hid_gc dataType( bool bigEndian ) { return proxy::dataType(bigEndian); }
+  static inline hid_t dataType( bool bigEndian ) { return proxy::dataType(bigEndian); }
 
 private:  
   // Defer calls to the proper specialisation
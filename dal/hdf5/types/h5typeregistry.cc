@@ -0,0 +1,130 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "h5typeregistry.h"
+#include "h5complex.h"
+#include "h5tuple.h"
+#include <map>
+#include <pthread.h>
+
+using namespace std;
+
+namespace dal {
+
+enum RegisteredTypeKind { COMPLEX, TUPLE };
+
+struct RegisteredTypeKey {
+  RegisteredTypeKind kind;
+  hid_t base;
+  size_t num;
+
+  bool operator<( const RegisteredTypeKey &other ) const {
+    if (kind != other.kind)
+      return kind < other.kind;
+    if (base != other.base)
+      return base < other.base;
+    return num < other.num;
+  }
+};
+
+// Only ever accessed while holding registryMutex. Entries are never closed explicitly, as
+// locked types are released by HDF5 at shutdown, which may happen after our static destructors.
+static map<RegisteredTypeKey, hid_t> *registry = 0;
+static pthread_mutex_t registryMutex = PTHREAD_MUTEX_INITIALIZER;
+
+struct RegistryLock {
+  RegistryLock() { pthread_mutex_lock(&registryMutex); }
+  ~RegistryLock() { pthread_mutex_unlock(&registryMutex); }
+};
+
+#if defined(H5_VERSION_GE) && H5_VERSION_GE(1, 13, 0)
+// Whether clearRegistry() is registered to run when the library shuts down.
+static bool clearOnClose = false;
+
+static void clearRegistry( void * )
+{
+  RegistryLock lock;
+
+  // HDF5 releases the types itself, and may reissue their identifiers once reopened
+  if (registry)
+    registry->clear();
+
+  // H5close() forgets its callbacks
+  clearOnClose = false;
+}
+#endif
+
+static hid_t lookup( RegisteredTypeKind kind, hid_t base, size_t num )
+{
+  RegisteredTypeKey key;
+  key.kind = kind;
+  key.base = base;
+  key.num  = num;
+
+  RegistryLock lock;
+
+  if (!registry)
+    registry = new map<RegisteredTypeKey, hid_t>;
+
+#if defined(H5_VERSION_GE) && H5_VERSION_GE(1, 13, 0)
+  if (!clearOnClose) {
+    if (H5atclose(clearRegistry, NULL) < 0)
+      throw HDF5Exception("Could not register datatype registry for library shutdown");
+
+    clearOnClose = true;
+  }
+
+  map<RegisteredTypeKey, hid_t>::iterator it = registry->find(key);
+
+  if (it != registry->end())
+    return it->second;
+#else
+  map<RegisteredTypeKey, hid_t>::iterator it = registry->find(key);
+
+  // A closed and reopened library invalidates all previous identifiers. Without H5atclose(),
+  // only identifiers that were not reissued to other datatypes are detected, see the header.
+  if (it != registry->end() && H5Iis_valid(it->second) > 0 && H5Iget_type(it->second) == H5I_DATATYPE)
+    return it->second;
+#endif
+
+  hid_gc type = kind == COMPLEX ? h5complexType(base) : h5tupleType(base, num);
+
+  // keep our own reference, which outlives the hid_gc
+  if (H5Iinc_ref(type) < 0)
+    throw HDF5Exception("Could not register datatype");
+
+  if (H5Tlock(type) < 0) {
+    H5Idec_ref(type);
+    throw HDF5Exception("Could not lock registered datatype");
+  }
+
+  (*registry)[key] = type;
+
+  return type;
+}
+
+hid_t h5complexTypeCached( hid_t halftype )
+{
+  return lookup(COMPLEX, halftype, 0);
+}
+
+hid_t h5tupleTypeCached( hid_t element, size_t num )
+{
+  return lookup(TUPLE, element, num);
+}
+
+}
+
@@ -0,0 +1,47 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_H5TYPEREGISTRY_H
+#define DAL_H5TYPEREGISTRY_H
+
+#include <cstddef>
+#include <hdf5.h>
+
+namespace dal {
+
+/*
+ * Process-wide registry of derived HDF5 datatypes (complex and tuple types).
+ *
+ * Each type is created once and locked using H5Tlock, so it cannot be modified or
+ * closed by users, and is released by HDF5 itself when the library shuts down (also
+ * from its atexit handler). From HDF5 1.13, the registry is cleared at shutdown (see
+ * H5atclose), so the types are recreated if the library is reopened (H5close/H5open).
+ * Older versions have no such hook: after reopening, an entry whose identifier HDF5
+ * reissued to another datatype goes undetected, so do not reopen the library with them.
+ *
+ * The returned identifiers must not be closed. The registry is protected by a mutex.
+ */
+
+//! Returns the complex datatype with real and imaginary parts of type `halftype`, see h5complexType().
+hid_t h5complexTypeCached( hid_t halftype );
+
+//! Returns the array datatype of `num` elements of type `element`, see h5tupleType().
+hid_t h5tupleTypeCached( hid_t element, size_t num );
+
+}
+
+#endif
+
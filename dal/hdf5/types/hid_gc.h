@@ -23,6 +23,12 @@
 
 namespace dal {
 
+/*
+ * The constructors throw an HDF5Exception if the hid is invalid. To avoid building
+ * error messages for the (common) successful case, pass a fixed description and a
+ * name separately, e.g. hid_gc(H5Dopen2(...), H5Dclose, "Could not open dataset ", _name).
+ */
+
 //! Autocloses hid_t types using closefunc() on destruction, and keeps a reference count.
 class hid_gc
 {
@@ -30,7 +36,7 @@ public:
   // allow deference of actual construction to operator=
   hid_gc(): hid(0), closefunc(0) {}
 
-  hid_gc(hid_t hid, herr_t (*closefunc)(hid_t) = 0, const std::string &errordesc = ""): hid(hid), closefunc(closefunc) {
+  hid_gc(hid_t hid, herr_t (*closefunc)(hid_t) = 0, const char *errordesc = ""): hid(hid), closefunc(closefunc) {
     // checking for success here greatly reduces the code base
     if (hid <= 0)
       throw HDF5Exception(errordesc);
@@ -38,6 +44,21 @@ public:
     H5Iinc_ref(hid);
   }
 
+  hid_gc(hid_t hid, herr_t (*closefunc)(hid_t), const std::string &errordesc): hid(hid), closefunc(closefunc) {
+    if (hid <= 0)
+      throw HDF5Exception(errordesc);
+
+    H5Iinc_ref(hid);
+  }
+
+  //! The error description is `errordesc` followed by `name`, concatenated only on failure.
+  hid_gc(hid_t hid, herr_t (*closefunc)(hid_t), const char *errordesc, const std::string &name): hid(hid), closefunc(closefunc) {
+    if (hid <= 0)
+      throw HDF5Exception(errordesc + name);
+
+    H5Iinc_ref(hid);
+  }
+
   hid_gc( const hid_gc &other ): hid(other.hid), closefunc(other.closefunc) {
     if (isset()) {
       H5Iinc_ref(hid);
@@ -80,12 +101,23 @@ private:
 class hid_gc_noref
 {
 public:
-  hid_gc_noref(hid_t hid, herr_t (*closefunc)(hid_t) = 0, const std::string &errordesc = ""): hid(hid), closefunc(closefunc) {
+  hid_gc_noref(hid_t hid, herr_t (*closefunc)(hid_t) = 0, const char *errordesc = ""): hid(hid), closefunc(closefunc) {
     // checking for success here greatly reduces the code base
     if (hid <= 0)
       throw HDF5Exception(errordesc);
   }
 
+  hid_gc_noref(hid_t hid, herr_t (*closefunc)(hid_t), const std::string &errordesc): hid(hid), closefunc(closefunc) {
+    if (hid <= 0)
+      throw HDF5Exception(errordesc);
+  }
+
+  //! The error description is `errordesc` followed by `name`, concatenated only on failure.
+  hid_gc_noref(hid_t hid, herr_t (*closefunc)(hid_t), const char *errordesc, const std::string &name): hid(hid), closefunc(closefunc) {
+    if (hid <= 0)
+      throw HDF5Exception(errordesc + name);
+  }
+
   ~hid_gc_noref() {
     if (isset() && closefunc) {
       closefunc(hid);
@@ -0,0 +1,179 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_TRANSPOSE_H
+#define DAL_TRANSPOSE_H
+
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace dal {
+
+/*
+ * In-memory copy kernels used by Dataset to rearrange data read from disk.
+ * Strides are in elements. A "row" is the slowest varying index of the source.
+ */
+
+//! Tile size (in elements per side) used to keep both source and destination of a transpose in cache.
+const size_t transposeTileSize = 32;
+
+/*!
+ * Transposes 4x4 elements of 4 bytes each from `src` (row stride `srcRowStride`)
+ * to `dst` (row stride `dstRowStride`). Returns false if not supported for T.
+ */
+template<typename T, size_t S> struct Transpose4x4 {
+  static bool apply( const T *, size_t, T *, size_t ) { return false; }
+};
+
+#ifdef __SSE__
+template<typename T> struct Transpose4x4<T, 4> {
+  static bool apply( const T *src, size_t srcRowStride, T *dst, size_t dstRowStride ) {
+    // only the bit patterns are moved, so any 4-byte type can be handled as float
+    const float *s = reinterpret_cast<const float *>(src);
+    float *d = reinterpret_cast<float *>(dst);
+
+    __m128 r0 = _mm_loadu_ps(s);
+    __m128 r1 = _mm_loadu_ps(s + srcRowStride);
+    __m128 r2 = _mm_loadu_ps(s + 2 * srcRowStride);
+    __m128 r3 = _mm_loadu_ps(s + 3 * srcRowStride);
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    _mm_storeu_ps(d,                    r0);
+    _mm_storeu_ps(d + dstRowStride,     r1);
+    _mm_storeu_ps(d + 2 * dstRowStride, r2);
+    _mm_storeu_ps(d + 3 * dstRowStride, r3);
+
+    return true;
+  }
+};
+#endif
+
+/*!
+ * Copies a `rows` x `cols` matrix from `src` to `dst`, where element (r, c) is read from
+ * src[r * srcRowStride + c * srcColStride] and written to dst[r * dstRowStride + c * dstColStride].
+ *
+ * Contiguous rows are copied as a whole. A transpose (contiguous source rows, contiguous
+ * destination columns) is done in cache-sized tiles, using SIMD for 4-byte types if available.
+ */
+template<typename T> void copy2D( const T *src, size_t rows, size_t cols, size_t srcRowStride, size_t srcColStride,
+                                  T *dst, size_t dstRowStride, size_t dstColStride )
+{
+  if (srcColStride == 1 && dstColStride == 1) {
+    for (size_t r = 0; r < rows; r++)
+      std::copy(src + r * srcRowStride, src + r * srcRowStride + cols, dst + r * dstRowStride);
+
+    return;
+  }
+
+  const bool transpose = srcColStride == 1 && dstRowStride == 1;
+  const size_t tile = transposeTileSize;
+
+  for (size_t r0 = 0; r0 < rows; r0 += tile) {
+    const size_t r1 = std::min(rows, r0 + tile);
+
+    for (size_t c0 = 0; c0 < cols; c0 += tile) {
+      const size_t c1 = std::min(cols, c0 + tile);
+
+      size_t r = r0;
+
+      if (transpose) {
+        // whole 4x4 blocks first, if supported for T
+        for (; r + 4 <= r1; r += 4) {
+          size_t c = c0;
+
+          for (; c + 4 <= c1; c += 4)
+            if (!Transpose4x4<T, sizeof(T)>::apply(src + r * srcRowStride + c, srcRowStride, dst + c * dstColStride + r, dstColStride))
+              break;
+
+          for (size_t rr = r; rr < r + 4; rr++)
+            for (size_t cc = c; cc < c1; cc++)
+              dst[cc * dstColStride + rr] = src[rr * srcRowStride + cc];
+        }
+      }
+
+      // remaining rows, or all rows if not transposing
+      for (; r < r1; r++)
+        for (size_t c = c0; c < c1; c++)
+          dst[r * dstRowStride + c * dstColStride] = src[r * srcRowStride + c * srcColStride];
+    }
+  }
+}
+
+/*!
+ * Copies an N-dimensional block of sizes `size` from `src` to `dst`, with the strides
+ * of each dimension given by `srcStrides` and `dstStrides`. The two fastest varying
+ * dimensions (ignoring those of size 1) are copied using copy2D().
+ */
+template<typename T> void copyStrided( const T *src, const std::vector<size_t> &size, const std::vector<size_t> &srcStrides,
+                                       T *dst, const std::vector<size_t> &dstStrides )
+{
+  std::vector<size_t> n, ss, ds;
+
+  // dimensions of size 1 do not influence the layout
+  for (size_t d = 0; d < size.size(); d++) {
+    if (size[d] == 0)
+      return;
+
+    if (size[d] > 1) {
+      n.push_back(size[d]);
+      ss.push_back(srcStrides[d]);
+      ds.push_back(dstStrides[d]);
+    }
+  }
+
+  while (n.size() < 2) {
+    n.insert(n.begin(), 1);
+    ss.insert(ss.begin(), 0);
+    ds.insert(ds.begin(), 0);
+  }
+
+  const size_t outer = n.size() - 2;
+  std::vector<size_t> idx(outer, 0);
+
+  for (;;) {
+    size_t srcOffset = 0, dstOffset = 0;
+
+    for (size_t d = 0; d < outer; d++) {
+      srcOffset += idx[d] * ss[d];
+      dstOffset += idx[d] * ds[d];
+    }
+
+    copy2D(src + srcOffset, n[outer], n[outer + 1], ss[outer], ss[outer + 1], dst + dstOffset, ds[outer], ds[outer + 1]);
+
+    // advance to the next 2D slice
+    size_t d = outer;
+
+    for (; d > 0; d--) {
+      if (++idx[d - 1] < n[d - 1])
+        break;
+
+      idx[d - 1] = 0;
+    }
+
+    if (d == 0)
+      break;
+  }
+}
+
+}
+
+#endif
+
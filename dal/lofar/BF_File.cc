@@ -22,21 +22,21 @@ namespace dal {
 
 BF_File::BF_File() {}
 
-BF_File::BF_File( const std::string &filename, FileMode mode )
+BF_File::BF_File( const std::string &filename, FileMode mode, const FileAccessOptions &options )
 :
-  CLA_File(filename, mode)
+  CLA_File(filename, mode, options)
 {
-  openFile(mode);
+  openFile(mode, options.deferChecks);
 }
 
 BF_File::~BF_File() {}
 
-void BF_File::open( const std::string &filename, FileMode mode )
+void BF_File::open( const std::string &filename, FileMode mode, const FileAccessOptions &options )
 {
   // As long as we have no member vars, keep open() and close() simple. See CLA_File::open().
-  CLA_File::open(filename, mode);
+  CLA_File::open(filename, mode, options);
 
-  openFile(mode);
+  openFile(mode, options.deferChecks);
 }
 
 void BF_File::close()
@@ -44,112 +44,130 @@ void BF_File::close()
   CLA_File::close();
 }
 
-void BF_File::openFile( FileMode mode )
+void BF_File::checkFileType()
 {
-  initFileNodes();
+  CLA_File::checkFileType();
+  checkBfFileType();
+}
+
+void BF_File::checkBfFileType()
+{
+  bool isBfFileType = false;
+  try {
+    isBfFileType = fileType().get() == "bf" || fileType().get() == "dynspec"; // dynspec is very similar
+  } catch (DALException& ) {
+  }
+  if (!isBfFileType) {
+    throw DALException("Failed to open BF file: A BF file must have FILETYPE=\"bf\".");
+  }
+}
 
-  if (mode == CREATE || mode == CREATE_EXCL) {
+void BF_File::openFile( FileMode mode, bool deferChecks )
+{
+  if (mode == CREATE || mode == CREATE_EXCL || mode == IN_MEMORY) {
     fileType().create().set("bf");
     docName() .create().set("ICD 3: Beam-Formed Data");
     docVersion()       .set(VersionType(2, 5)); // already created by File
-  } else {
-    bool isBfFileType = false;
-    try {
-      isBfFileType = fileType().get() == "bf" || fileType().get() == "dynspec"; // dynspec is very similar
-    } catch (DALException& ) {
-    }
-    if (!isBfFileType) {
-      throw DALException("Failed to open BF file: A BF file must have FILETYPE=\"bf\".");
-    }
+  } else if (!deferChecks) {
+    // TELESCOPE is checked by CLA_File
+    checkBfFileType();
   }
 }
 
-void BF_File::initFileNodes() {
-  CLA_File::initNodes();
-  addNode( new Attribute<string>(*this, "CREATE_OFFLINE_ONLINE") );
-  addNode( new Attribute<string>(*this, "BF_FORMAT") );
-  addNode( new Attribute<string>(*this, "BF_VERSION") );
-  addNode( new Attribute<double>(*this, "TOTAL_INTEGRATION_TIME") );
-  addNode( new Attribute<string>(*this, "TOTAL_INTEGRATION_TIME_UNIT") );
-  addNode( new Attribute<string>(*this, "OBSERVATION_DATATYPE") );
-  addNode( new Attribute<double>(*this, "SUB_ARRAY_POINTING_DIAMETER") );
-  addNode( new Attribute<string>(*this, "SUB_ARRAY_POINTING_DIAMETER_UNIT") );
-  addNode( new Attribute<double>(*this, "BANDWIDTH") );
-  addNode( new Attribute<string>(*this, "BANDWIDTH_UNIT") );
-  addNode( new Attribute<double>(*this, "BEAM_DIAMETER") );
-  addNode( new Attribute<string>(*this, "BEAM_DIAMETER_UNIT") );
-  addNode( new Attribute<unsigned>(*this, "OBSERVATION_NOF_SUB_ARRAY_POINTINGS") );
-  addNode( new Attribute<unsigned>(*this, "NOF_SUB_ARRAY_POINTINGS") );
+static const NodeSchema bfFileNodes[] = {
+  { "CREATE_OFFLINE_ONLINE", createNode< Attribute<string> > },
+  { "BF_FORMAT", createNode< Attribute<string> > },
+  { "BF_VERSION", createNode< Attribute<string> > },
+  { "TOTAL_INTEGRATION_TIME", createNode< Attribute<double> > },
+  { "TOTAL_INTEGRATION_TIME_UNIT", createNode< Attribute<string> > },
+  { "OBSERVATION_DATATYPE", createNode< Attribute<string> > },
+  { "SUB_ARRAY_POINTING_DIAMETER", createNode< Attribute<double> > },
+  { "SUB_ARRAY_POINTING_DIAMETER_UNIT", createNode< Attribute<string> > },
+  { "BANDWIDTH", createNode< Attribute<double> > },
+  { "BANDWIDTH_UNIT", createNode< Attribute<string> > },
+  { "BEAM_DIAMETER", createNode< Attribute<double> > },
+  { "BEAM_DIAMETER_UNIT", createNode< Attribute<string> > },
+  { "OBSERVATION_NOF_SUB_ARRAY_POINTINGS", createNode< Attribute<unsigned> > },
+  { "NOF_SUB_ARRAY_POINTINGS", createNode< Attribute<unsigned> > }
+};
+
+const NodeSchemaTable BF_File::nodeSchema = {
+  &CLA_File::nodeSchema, bfFileNodes, sizeof bfFileNodes / sizeof bfFileNodes[0]
+};
+
+const NodeSchemaTable &BF_File::schema() const
+{
+  return nodeSchema;
 }
 
 Attribute<string> BF_File::createOfflineOnline()
 {
-  return getNode("CREATE_OFFLINE_ONLINE");
+  return Attribute<string>(*this, "CREATE_OFFLINE_ONLINE");
 }
 
 Attribute<string> BF_File::BFFormat()
 {
-  return getNode("BF_FORMAT");
+  return Attribute<string>(*this, "BF_FORMAT");
 }
 
 Attribute<string> BF_File::BFVersion()
 {
-  return getNode("BF_VERSION");
+  return Attribute<string>(*this, "BF_VERSION");
 }
 
 Attribute<double> BF_File::totalIntegrationTime()
 {
-  return getNode("TOTAL_INTEGRATION_TIME");
+  return Attribute<double>(*this, "TOTAL_INTEGRATION_TIME");
 }
 
 Attribute<string> BF_File::totalIntegrationTimeUnit()
 {
-  return getNode("TOTAL_INTEGRATION_TIME_UNIT");
+  return Attribute<string>(*this, "TOTAL_INTEGRATION_TIME_UNIT");
 }  
   
 Attribute<string> BF_File::observationDatatype()
 {
-  return getNode("OBSERVATION_DATATYPE");
+  return Attribute<string>(*this, "OBSERVATION_DATATYPE");
 }
 
 Attribute<double> BF_File::subArrayPointingDiameter()
 {
-  return getNode("SUB_ARRAY_POINTING_DIAMETER");
+  return Attribute<double>(*this, "SUB_ARRAY_POINTING_DIAMETER");
 }
 
 Attribute<string> BF_File::subArrayPointingDiameterUnit()
 {
-  return getNode("SUB_ARRAY_POINTING_DIAMETER_UNIT");
+  return Attribute<string>(*this, "SUB_ARRAY_POINTING_DIAMETER_UNIT");
 }  
   
 Attribute<double> BF_File::bandwidth()
 {
-  return getNode("BANDWIDTH");
+  return Attribute<double>(*this, "BANDWIDTH");
 }
 
 Attribute<string> BF_File::bandwidthUnit()
 {
-  return getNode("BANDWIDTH_UNIT");
+  return Attribute<string>(*this, "BANDWIDTH_UNIT");
 }
   
 Attribute<double> BF_File::beamDiameter()
 {
-  return getNode("BEAM_DIAMETER");
+  return Attribute<double>(*this, "BEAM_DIAMETER");
 }
 
 Attribute<string> BF_File::beamDiameterUnit()
 {
-  return getNode("BEAM_DIAMETER_UNIT");
+  return Attribute<string>(*this, "BEAM_DIAMETER_UNIT");
 }
   
 Attribute<unsigned> BF_File::observationNofSubArrayPointings()
 {
-  return getNode("OBSERVATION_NOF_SUB_ARRAY_POINTINGS");
+  return Attribute<unsigned>(*this, "OBSERVATION_NOF_SUB_ARRAY_POINTINGS");
 }
   
 Attribute<unsigned> BF_File::nofSubArrayPointings()
 {
-  return getNode("NOF_SUB_ARRAY_POINTINGS");
+  return Attribute<unsigned>(*this, "NOF_SUB_ARRAY_POINTINGS");
 }
 
 string BF_File::subArrayPointingName( unsigned nr )
@@ -178,104 +196,112 @@ BF_SubArrayPointing::BF_SubArrayPointing( Group &parent, const std::string &name
 {
 }
 
-void BF_SubArrayPointing::initNodes() {
-  Group::initNodes();
-  addNode( new Attribute<string>(*this, "EXPTIME_START_UTC") );
-  addNode( new Attribute<string>(*this, "EXPTIME_END_UTC") );
-  addNode( new Attribute<double>(*this, "EXPTIME_START_MJD") );
-  addNode( new Attribute<double>(*this, "EXPTIME_END_MJD") );
-  addNode( new Attribute<double>(*this, "TOTAL_INTEGRATION_TIME") );
-  addNode( new Attribute<string>(*this, "TOTAL_INTEGRATION_TIME_UNIT") );
-  addNode( new Attribute<double>(*this, "POINT_RA") );
-  addNode( new Attribute<string>(*this, "POINT_RA_UNIT") );
-  addNode( new Attribute<double>(*this, "POINT_DEC") );
-  addNode( new Attribute<string>(*this, "POINT_DEC_UNIT") );
-  addNode( new Attribute< vector<double> >(*this, "POINT_ALTITUDE") );
-  addNode( new Attribute< vector<string> >(*this, "POINT_ALTITUDE_UNIT") );
-  addNode( new Attribute< vector<double> >(*this, "POINT_AZIMUTH") );
-  addNode( new Attribute< vector<string> >(*this, "POINT_AZIMUTH_UNIT") );
-  addNode( new Attribute<unsigned>(*this, "OBSERVATION_NOF_BEAMS") );
-  addNode( new Attribute<unsigned>(*this, "NOF_BEAMS") );
+static const NodeSchema bfSubArrayPointingNodes[] = {
+  { "EXPTIME_START_UTC", createNode< Attribute<string> > },
+  { "EXPTIME_END_UTC", createNode< Attribute<string> > },
+  { "EXPTIME_START_MJD", createNode< Attribute<double> > },
+  { "EXPTIME_END_MJD", createNode< Attribute<double> > },
+  { "TOTAL_INTEGRATION_TIME", createNode< Attribute<double> > },
+  { "TOTAL_INTEGRATION_TIME_UNIT", createNode< Attribute<string> > },
+  { "POINT_RA", createNode< Attribute<double> > },
+  { "POINT_RA_UNIT", createNode< Attribute<string> > },
+  { "POINT_DEC", createNode< Attribute<double> > },
+  { "POINT_DEC_UNIT", createNode< Attribute<string> > },
+  { "POINT_ALTITUDE", createNode< Attribute< vector<double> > > },
+  { "POINT_ALTITUDE_UNIT", createNode< Attribute< vector<string> > > },
+  { "POINT_AZIMUTH", createNode< Attribute< vector<double> > > },
+  { "POINT_AZIMUTH_UNIT", createNode< Attribute< vector<string> > > },
+  { "OBSERVATION_NOF_BEAMS", createNode< Attribute<unsigned> > },
+  { "NOF_BEAMS", createNode< Attribute<unsigned> > }
+};
+
+const NodeSchemaTable BF_SubArrayPointing::nodeSchema = {
+  &Group::nodeSchema, bfSubArrayPointingNodes, sizeof bfSubArrayPointingNodes / sizeof bfSubArrayPointingNodes[0]
+};
+
+const NodeSchemaTable &BF_SubArrayPointing::schema() const
+{
+  return nodeSchema;
 }
 
 Attribute<string> BF_SubArrayPointing::expTimeStartUTC()
 {
-  return getNode("EXPTIME_START_UTC");
+  return Attribute<string>(*this, "EXPTIME_START_UTC");
 }
 
 Attribute<string> BF_SubArrayPointing::expTimeEndUTC()
 {
-  return getNode("EXPTIME_END_UTC");
+  return Attribute<string>(*this, "EXPTIME_END_UTC");
 }
 
 Attribute<double> BF_SubArrayPointing::expTimeStartMJD()
 {
-  return getNode("EXPTIME_START_MJD");
+  return Attribute<double>(*this, "EXPTIME_START_MJD");
 }
 
 Attribute<double> BF_SubArrayPointing::expTimeEndMJD()
 {
-  return getNode("EXPTIME_END_MJD");
+  return Attribute<double>(*this, "EXPTIME_END_MJD");
 }
 
 Attribute<double> BF_SubArrayPointing::totalIntegrationTime()
 {
-  return getNode("TOTAL_INTEGRATION_TIME");
+  return Attribute<double>(*this, "TOTAL_INTEGRATION_TIME");
 }
 
 Attribute<string> BF_SubArrayPointing::totalIntegrationTimeUnit()
 {
-  return getNode("TOTAL_INTEGRATION_TIME_UNIT");
+  return Attribute<string>(*this, "TOTAL_INTEGRATION_TIME_UNIT");
 }  
 
 Attribute<double> BF_SubArrayPointing::pointRA()
 {
-  return getNode("POINT_RA");
+  return Attribute<double>(*this, "POINT_RA");
 }
 
 Attribute<string> BF_SubArrayPointing::pointRAUnit()
 {
-  return getNode("POINT_RA_UNIT");
+  return Attribute<string>(*this, "POINT_RA_UNIT");
 }
 
 Attribute<double> BF_SubArrayPointing::pointDEC()
 {
-  return getNode("POINT_DEC");
+  return Attribute<double>(*this, "POINT_DEC");
 }
 
 Attribute<string> BF_SubArrayPointing::pointDECUnit()
 {
-  return getNode("POINT_DEC_UNIT");
+  return Attribute<string>(*this, "POINT_DEC_UNIT");
 }
 
 Attribute< vector<double> > BF_SubArrayPointing::pointAltitude()
 {
-  return getNode("POINT_ALTITUDE");
+  return Attribute< vector<double> >(*this, "POINT_ALTITUDE");
 }
 
 Attribute< vector<string> > BF_SubArrayPointing::pointAltitudeUnit()
 {
-  return getNode("POINT_ALTITUDE_UNIT");
+  return Attribute< vector<string> >(*this, "POINT_ALTITUDE_UNIT");
 }
 
 Attribute< vector<double> > BF_SubArrayPointing::pointAzimuth()
 {
-  return getNode("POINT_AZIMUTH");
+  return Attribute< vector<double> >(*this, "POINT_AZIMUTH");
 }
 
 Attribute< vector<string> > BF_SubArrayPointing::pointAzimuthUnit()
 {
-  return getNode("POINT_AZIMUTH_UNIT");
+  return Attribute< vector<string> >(*this, "POINT_AZIMUTH_UNIT");
 }
 
 Attribute<unsigned> BF_SubArrayPointing::observationNofBeams()
 {
-  return getNode("OBSERVATION_NOF_BEAMS");
+  return Attribute<unsigned>(*this, "OBSERVATION_NOF_BEAMS");
 }
 
 Attribute<unsigned> BF_SubArrayPointing::nofBeams()
 {
-  return getNode("NOF_BEAMS");
+  return Attribute<unsigned>(*this, "NOF_BEAMS");
 }
 
 string BF_SubArrayPointing::beamName( unsigned nr )
@@ -303,248 +329,256 @@ BF_BeamGroup::BF_BeamGroup( Group &parent, const std::string &name )
 {
 }
 
-void BF_BeamGroup::initNodes() {
-  Group::initNodes();
-  addNode( new Attribute< vector<string> >(*this, "TARGETS") );
-  addNode( new Attribute<unsigned>(*this, "NOF_STATIONS") );
-  addNode( new Attribute< vector<string> >(*this, "STATIONS_LIST") );
-  addNode( new Attribute<unsigned>(*this, "NOF_SAMPLES") );
-  addNode( new Attribute<double>(*this, "SAMPLING_RATE") );
-  addNode( new Attribute<string>(*this, "SAMPLING_RATE_UNIT") );
-  addNode( new Attribute<double>(*this, "SAMPLING_TIME") );
-  addNode( new Attribute<string>(*this, "SAMPLING_TIME_UNIT") );
-  addNode( new Attribute<unsigned>(*this, "CHANNELS_PER_SUBBAND") );
-  addNode( new Attribute<double>(*this, "SUBBAND_WIDTH") );
-  addNode( new Attribute<string>(*this, "SUBBAND_WIDTH_UNIT") );
-  addNode( new Attribute<double>(*this, "CHANNEL_WIDTH") );
-  addNode( new Attribute<string>(*this, "CHANNEL_WIDTH_UNIT") );
-  addNode( new Attribute<string>(*this, "TRACKING") );
-  addNode( new Attribute<double>(*this, "POINT_RA") );
-  addNode( new Attribute<string>(*this, "POINT_RA_UNIT") );
-  addNode( new Attribute<double>(*this, "POINT_DEC") );
-  addNode( new Attribute<string>(*this, "POINT_DEC_UNIT") );
-  addNode( new Attribute<double>(*this, "POINT_OFFSET_RA") );
-  addNode( new Attribute<string>(*this, "POINT_OFFSET_RA_UNIT") );
-  addNode( new Attribute<double>(*this, "POINT_OFFSET_DEC") );
-  addNode( new Attribute<string>(*this, "POINT_OFFSET_DEC_UNIT") );
-  addNode( new Attribute<double>(*this, "BEAM_DIAMETER_RA") );
-  addNode( new Attribute<string>(*this, "BEAM_DIAMETER_RA_UNIT") );
-  addNode( new Attribute<double>(*this, "BEAM_DIAMETER_DEC") );
-  addNode( new Attribute<string>(*this, "BEAM_DIAMETER_DEC_UNIT") );
-  addNode( new Attribute<double>(*this, "BEAM_FREQUENCY_CENTER") );
-  addNode( new Attribute<string>(*this, "BEAM_FREQUENCY_CENTER_UNIT") );
-  addNode( new Attribute<bool>(*this, "FOLDED_DATA") );
-  addNode( new Attribute<double>(*this, "FOLD_PERIOD") );
-  addNode( new Attribute<string>(*this, "FOLD_PERIOD_UNIT") );
-  addNode( new Attribute<string>(*this, "DEDISPERSION") );
-  addNode( new Attribute<double>(*this, "DISPERSION_MEASURE") );
-  addNode( new Attribute<string>(*this, "DISPERSION_MEASURE_UNIT") );
-  addNode( new Attribute<bool>(*this, "BARYCENTERED") );
-  addNode( new Attribute<unsigned>(*this, "OBSERVATION_NOF_STOKES") );
-  addNode( new Attribute<unsigned>(*this, "NOF_STOKES") );
-  addNode( new Attribute< vector<string> >(*this, "STOKES_COMPONENTS") );
-  addNode( new Attribute<bool>(*this, "COMPLEX_VOLTAGE") );
-  addNode( new Attribute<string>(*this, "SIGNAL_SUM") );
+static const NodeSchema bfBeamGroupNodes[] = {
+  { "TARGETS", createNode< Attribute< vector<string> > > },
+  { "NOF_STATIONS", createNode< Attribute<unsigned> > },
+  { "STATIONS_LIST", createNode< Attribute< vector<string> > > },
+  { "NOF_SAMPLES", createNode< Attribute<unsigned> > },
+  { "SAMPLING_RATE", createNode< Attribute<double> > },
+  { "SAMPLING_RATE_UNIT", createNode< Attribute<string> > },
+  { "SAMPLING_TIME", createNode< Attribute<double> > },
+  { "SAMPLING_TIME_UNIT", createNode< Attribute<string> > },
+  { "CHANNELS_PER_SUBBAND", createNode< Attribute<unsigned> > },
+  { "SUBBAND_WIDTH", createNode< Attribute<double> > },
+  { "SUBBAND_WIDTH_UNIT", createNode< Attribute<string> > },
+  { "CHANNEL_WIDTH", createNode< Attribute<double> > },
+  { "CHANNEL_WIDTH_UNIT", createNode< Attribute<string> > },
+  { "TRACKING", createNode< Attribute<string> > },
+  { "POINT_RA", createNode< Attribute<double> > },
+  { "POINT_RA_UNIT", createNode< Attribute<string> > },
+  { "POINT_DEC", createNode< Attribute<double> > },
+  { "POINT_DEC_UNIT", createNode< Attribute<string> > },
+  { "POINT_OFFSET_RA", createNode< Attribute<double> > },
+  { "POINT_OFFSET_RA_UNIT", createNode< Attribute<string> > },
+  { "POINT_OFFSET_DEC", createNode< Attribute<double> > },
+  { "POINT_OFFSET_DEC_UNIT", createNode< Attribute<string> > },
+  { "BEAM_DIAMETER_RA", createNode< Attribute<double> > },
+  { "BEAM_DIAMETER_RA_UNIT", createNode< Attribute<string> > },
+  { "BEAM_DIAMETER_DEC", createNode< Attribute<double> > },
+  { "BEAM_DIAMETER_DEC_UNIT", createNode< Attribute<string> > },
+  { "BEAM_FREQUENCY_CENTER", createNode< Attribute<double> > },
+  { "BEAM_FREQUENCY_CENTER_UNIT", createNode< Attribute<string> > },
+  { "FOLDED_DATA", createNode< Attribute<bool> > },
+  { "FOLD_PERIOD", createNode< Attribute<double> > },
+  { "FOLD_PERIOD_UNIT", createNode< Attribute<string> > },
+  { "DEDISPERSION", createNode< Attribute<string> > },
+  { "DISPERSION_MEASURE", createNode< Attribute<double> > },
+  { "DISPERSION_MEASURE_UNIT", createNode< Attribute<string> > },
+  { "BARYCENTERED", createNode< Attribute<bool> > },
+  { "OBSERVATION_NOF_STOKES", createNode< Attribute<unsigned> > },
+  { "NOF_STOKES", createNode< Attribute<unsigned> > },
+  { "STOKES_COMPONENTS", createNode< Attribute< vector<string> > > },
+  { "COMPLEX_VOLTAGE", createNode< Attribute<bool> > },
+  { "SIGNAL_SUM", createNode< Attribute<string> > }
+};
+
+const NodeSchemaTable BF_BeamGroup::nodeSchema = {
+  &Group::nodeSchema, bfBeamGroupNodes, sizeof bfBeamGroupNodes / sizeof bfBeamGroupNodes[0]
+};
+
+const NodeSchemaTable &BF_BeamGroup::schema() const
+{
+  return nodeSchema;
 }
 
 Attribute< vector<string> > BF_BeamGroup::targets()
 {
-  return getNode("TARGETS");
+  return Attribute< vector<string> >(*this, "TARGETS");
 }
 
 Attribute<unsigned> BF_BeamGroup::nofStations()
 {
-  return getNode("NOF_STATIONS");
+  return Attribute<unsigned>(*this, "NOF_STATIONS");
 }
 
 Attribute< vector<string> > BF_BeamGroup::stationsList()
 {
-  return getNode("STATIONS_LIST");
+  return Attribute< vector<string> >(*this, "STATIONS_LIST");
 }
 
 Attribute<unsigned> BF_BeamGroup::nofSamples()
 {
-  return getNode("NOF_SAMPLES");
+  return Attribute<unsigned>(*this, "NOF_SAMPLES");
 }
 
 Attribute<double> BF_BeamGroup::samplingRate()
 {
-  return getNode("SAMPLING_RATE");
+  return Attribute<double>(*this, "SAMPLING_RATE");
 }
 
 Attribute<string> BF_BeamGroup::samplingRateUnit()
 {
-  return getNode("SAMPLING_RATE_UNIT");
+  return Attribute<string>(*this, "SAMPLING_RATE_UNIT");
 }
 
 Attribute<double> BF_BeamGroup::samplingTime()
 {
-  return getNode("SAMPLING_TIME");
+  return Attribute<double>(*this, "SAMPLING_TIME");
 }
 
 Attribute<string> BF_BeamGroup::samplingTimeUnit()
 {
-  return getNode("SAMPLING_TIME_UNIT");
+  return Attribute<string>(*this, "SAMPLING_TIME_UNIT");
 }
 
 Attribute<unsigned> BF_BeamGroup::channelsPerSubband()
 {
-  return getNode("CHANNELS_PER_SUBBAND");
+  return Attribute<unsigned>(*this, "CHANNELS_PER_SUBBAND");
 }
 
 Attribute<double> BF_BeamGroup::subbandWidth()
 {
-  return getNode("SUBBAND_WIDTH");
+  return Attribute<double>(*this, "SUBBAND_WIDTH");
 }
 
 Attribute<string> BF_BeamGroup::subbandWidthUnit()
 {
-  return getNode("SUBBAND_WIDTH_UNIT");
+  return Attribute<string>(*this, "SUBBAND_WIDTH_UNIT");
 }
 
 Attribute<double> BF_BeamGroup::channelWidth()
 {
-  return getNode("CHANNEL_WIDTH");
+  return Attribute<double>(*this, "CHANNEL_WIDTH");
 }
 
 Attribute<string> BF_BeamGroup::channelWidthUnit()
 {
-  return getNode("CHANNEL_WIDTH_UNIT");
+  return Attribute<string>(*this, "CHANNEL_WIDTH_UNIT");
 }
 
 Attribute<string> BF_BeamGroup::tracking()
 {
-  return getNode("TRACKING");
+  return Attribute<string>(*this, "TRACKING");
 }
 
 Attribute<double> BF_BeamGroup::pointRA()
 {
-  return getNode("POINT_RA");
+  return Attribute<double>(*this, "POINT_RA");
 }
 
 Attribute<string> BF_BeamGroup::pointRAUnit()
 {
-  return getNode("POINT_RA_UNIT");
+  return Attribute<string>(*this, "POINT_RA_UNIT");
 }
 
 Attribute<double> BF_BeamGroup::pointDEC()
 {
-  return getNode("POINT_DEC");
+  return Attribute<double>(*this, "POINT_DEC");
 }
 
 Attribute<string> BF_BeamGroup::pointDECUnit()
 {
-  return getNode("POINT_DEC_UNIT");
+  return Attribute<string>(*this, "POINT_DEC_UNIT");
 }
 
 Attribute<double> BF_BeamGroup::pointOffsetRA()
 {
-  return getNode("POINT_OFFSET_RA");
+  return Attribute<double>(*this, "POINT_OFFSET_RA");
 }
 
 Attribute<string> BF_BeamGroup::pointOffsetRAUnit()
 {
-  return getNode("POINT_OFFSET_RA_UNIT");
+  return Attribute<string>(*this, "POINT_OFFSET_RA_UNIT");
 }
 
 Attribute<double> BF_BeamGroup::pointOffsetDEC()
 {
-  return getNode("POINT_OFFSET_DEC");
+  return Attribute<double>(*this, "POINT_OFFSET_DEC");
 }
 
 Attribute<string> BF_BeamGroup::pointOffsetDECUnit()
 {
-  return getNode("POINT_OFFSET_DEC_UNIT");
+  return Attribute<string>(*this, "POINT_OFFSET_DEC_UNIT");
 }
 
 Attribute<double> BF_BeamGroup::beamDiameterRA()
 {
-  return getNode("BEAM_DIAMETER_RA");
+  return Attribute<double>(*this, "BEAM_DIAMETER_RA");
 }
 
 Attribute<string> BF_BeamGroup::beamDiameterRAUnit()
 {
-  return getNode("BEAM_DIAMETER_RA_UNIT");
+  return Attribute<string>(*this, "BEAM_DIAMETER_RA_UNIT");
 }
 
 Attribute<double> BF_BeamGroup::beamDiameterDEC()
 {
-  return getNode("BEAM_DIAMETER_DEC");
+  return Attribute<double>(*this, "BEAM_DIAMETER_DEC");
 }
 
 Attribute<string> BF_BeamGroup::beamDiameterDECUnit()
 {
-  return getNode("BEAM_DIAMETER_DEC_UNIT");
+  return Attribute<string>(*this, "BEAM_DIAMETER_DEC_UNIT");
 }
 
 Attribute<double> BF_BeamGroup::beamFrequencyCenter()
 {
-  return getNode("BEAM_FREQUENCY_CENTER");
+  return Attribute<double>(*this, "BEAM_FREQUENCY_CENTER");
 }
 
 Attribute<string> BF_BeamGroup::beamFrequencyCenterUnit()
 {
-  return getNode("BEAM_FREQUENCY_CENTER_UNIT");
+  return Attribute<string>(*this, "BEAM_FREQUENCY_CENTER_UNIT");
 }
 
 Attribute<bool> BF_BeamGroup::foldedData()
 {
-  return getNode("FOLDED_DATA");
+  return Attribute<bool>(*this, "FOLDED_DATA");
 }
 
 Attribute<double> BF_BeamGroup::foldPeriod()
 {
-  return getNode("FOLD_PERIOD");
+  return Attribute<double>(*this, "FOLD_PERIOD");
 }
 
 Attribute<string> BF_BeamGroup::foldPeriodUnit()
 {
-  return getNode("FOLD_PERIOD_UNIT");
+  return Attribute<string>(*this, "FOLD_PERIOD_UNIT");
 }
 
 Attribute<string> BF_BeamGroup::dedispersion()
 {
-  return getNode("DEDISPERSION");
+  return Attribute<string>(*this, "DEDISPERSION");
 }
 
 Attribute<double> BF_BeamGroup::dispersionMeasure()
 {
-  return getNode("DISPERSION_MEASURE");
+  return Attribute<double>(*this, "DISPERSION_MEASURE");
 }
 
 Attribute<string> BF_BeamGroup::dispersionMeasureUnit()
 {
-  return getNode("DISPERSION_MEASURE_UNIT");
+  return Attribute<string>(*this, "DISPERSION_MEASURE_UNIT");
 }
 
 Attribute<bool> BF_BeamGroup::barycentered()
 {
-  return getNode("BARYCENTERED");
+  return Attribute<bool>(*this, "BARYCENTERED");
 }
 
 Attribute<unsigned> BF_BeamGroup::observationNofStokes()
 {
-  return getNode("OBSERVATION_NOF_STOKES");
+  return Attribute<unsigned>(*this, "OBSERVATION_NOF_STOKES");
 }
 
 Attribute<unsigned> BF_BeamGroup::nofStokes()
 {
-  return getNode("NOF_STOKES");
+  return Attribute<unsigned>(*this, "NOF_STOKES");
 }
 
 Attribute< vector<string> > BF_BeamGroup::stokesComponents()
 {
-  return getNode("STOKES_COMPONENTS");
+  return Attribute< vector<string> >(*this, "STOKES_COMPONENTS");
 }
 
 Attribute<bool> BF_BeamGroup::complexVoltage()
 {
-  return getNode("COMPLEX_VOLTAGE");
+  return Attribute<bool>(*this, "COMPLEX_VOLTAGE");
 }
 
 Attribute<string> BF_BeamGroup::signalSum()
 {
-  return getNode("SIGNAL_SUM");
+  return Attribute<string>(*this, "SIGNAL_SUM");
 }
 
 BF_ProcessingHistory BF_BeamGroup::processHistory()
@@ -582,39 +616,46 @@ BF_StokesDataset::BF_StokesDataset( Group &parent, const std::string &name )
 {
 }
 
-void BF_StokesDataset::initNodes()
+static const NodeSchema bfStokesDatasetNodes[] = {
+  { "DATATYPE", createNode< Attribute<string> > },
+  { "STOKES_COMPONENT", createNode< Attribute<string> > },
+  { "NOF_CHANNELS", createNode< Attribute< vector<unsigned> > > },
+  { "NOF_SUBBANDS", createNode< Attribute<unsigned> > },
+  { "NOF_SAMPLES", createNode< Attribute<unsigned> > }
+};
+
+const NodeSchemaTable BF_StokesDataset::nodeSchema = {
+  &Group::nodeSchema, bfStokesDatasetNodes, sizeof bfStokesDatasetNodes / sizeof bfStokesDatasetNodes[0]
+};
+
+const NodeSchemaTable &BF_StokesDataset::schema() const
 {
-  Dataset<float>::initNodes();
-  addNode( new Attribute<string>(*this, "DATATYPE") );
-  addNode( new Attribute<string>(*this, "STOKES_COMPONENT") );
-  addNode( new Attribute< vector<unsigned> >(*this, "NOF_CHANNELS") );
-  addNode( new Attribute<unsigned>(*this, "NOF_SUBBANDS") );
-  addNode( new Attribute<unsigned>(*this, "NOF_SAMPLES") );
+  return nodeSchema;
 }
 
 Attribute<string> BF_StokesDataset::dataType()
 {
-  return getNode("DATATYPE");
+  return Attribute<string>(*this, "DATATYPE");
 }
 
 Attribute<string> BF_StokesDataset::stokesComponent()
 {
-  return getNode("STOKES_COMPONENT");
+  return Attribute<string>(*this, "STOKES_COMPONENT");
 }
 
 Attribute< vector<unsigned> > BF_StokesDataset::nofChannels()
 {
-  return getNode("NOF_CHANNELS");
+  return Attribute< vector<unsigned> >(*this, "NOF_CHANNELS");
 }
 
 Attribute<unsigned> BF_StokesDataset::nofSubbands()
 {
-  return getNode("NOF_SUBBANDS");
+  return Attribute<unsigned>(*this, "NOF_SUBBANDS");
 }
 
 Attribute<unsigned> BF_StokesDataset::nofSamples()
 {
-  return getNode("NOF_SAMPLES");
+  return Attribute<unsigned>(*this, "NOF_SAMPLES");
 }
 
 }
@@ -41,15 +41,20 @@ public:
   BF_File();
 
   /*!
-   * Open `filename` for reading/writing/creation.
+   * Open `filename` for reading/writing/creation, accessing it with the HDF5 settings in `options`.
    */
-  BF_File( const std::string &filename, FileMode mode = READ );
+  BF_File( const std::string &filename, FileMode mode = READ, const FileAccessOptions &options = FileAccessOptions() );
 
   virtual ~BF_File();
 
-  virtual void open( const std::string &filename, FileMode mode = READ );
+  virtual void open( const std::string &filename, FileMode mode = READ, const FileAccessOptions &options = FileAccessOptions() );
   virtual void close();
 
+  /*!
+   * Throws a DALException if this file is not a BF file (see CLA_File::checkFileType()).
+   */
+  virtual void checkFileType();
+
   Attribute<std::string>  createOfflineOnline();
   Attribute<std::string>  BFFormat();
   Attribute<std::string>  BFVersion();
@@ -75,9 +80,13 @@ public:
 protected:
   std::string             subArrayPointingName( unsigned nr );
 
+protected:
+  static const NodeSchemaTable nodeSchema;
+  virtual const NodeSchemaTable &schema() const;
+
 private:
-  void                    openFile( FileMode mode );
-  void                    initFileNodes();
+  void                    openFile( FileMode mode, bool deferChecks );
+  void                    checkBfFileType();
 };
 
 class BF_SysLog: public Group {
@@ -123,7 +132,8 @@ public:
 protected:
   std::string             beamName( unsigned nr );
 
-  virtual void            initNodes();
+  static const NodeSchemaTable nodeSchema;
+  virtual const NodeSchemaTable &schema() const;
 };
 
 class BF_BeamGroup: public Group {
@@ -194,7 +204,8 @@ protected:
   std::string             stokesName( unsigned nr );
   std::string             coordinatesName();
 
-  virtual void            initNodes();
+  static const NodeSchemaTable nodeSchema;
+  virtual const NodeSchemaTable &schema() const;
 };
 
 class BF_StokesDataset: public Dataset<float> {
@@ -209,7 +220,8 @@ public:
   Attribute<unsigned>     nofSamples();
 
 protected:
-  virtual void            initNodes();
+  static const NodeSchemaTable nodeSchema;
+  virtual const NodeSchemaTable &schema() const;
 };
 
 }
@@ -30,21 +30,21 @@ namespace dal {
 
 CLA_File::CLA_File() {}
 
-CLA_File::CLA_File( const std::string &filename, FileMode mode )
+CLA_File::CLA_File( const std::string &filename, FileMode mode, const FileAccessOptions &options )
 :
-  File(filename, mode, "DOC_VERSION")
+  File(filename, mode, "DOC_VERSION", options)
 {
-  openFile(filename, mode);
+  openFile(filename, mode, options.deferChecks);
 }
 
 CLA_File::~CLA_File() {}
 
-void CLA_File::open( const std::string &filename, FileMode mode )
+void CLA_File::open( const std::string &filename, FileMode mode, const FileAccessOptions &options )
 {
   // As long as we have no member vars, keep open() and close() simple. See File::open().
-  File::open(filename, mode, "DOC_VERSION");
+  File::open(filename, mode, "DOC_VERSION", options);
 
-  openFile(filename, mode);
+  openFile(filename, mode, options.deferChecks);
 }
 
 void CLA_File::close()
@@ -52,61 +52,70 @@ void CLA_File::close()
   File::close();
 }
 
-void CLA_File::openFile( const std::string &filename, FileMode mode )
+void CLA_File::checkFileType()
 {
-  initFileNodes();
+  bool isCompatibleFileType = false;
+  try {
+    isCompatibleFileType = telescope().get() == "LOFAR";
+  } catch (DALException& ) {
+  }
+  if (!isCompatibleFileType) {
+    throw DALException("Failed to open file: A LOFAR data product must have TELESCOPE=\"LOFAR\".\n");
+  }
+}
 
-  if (mode == CREATE || mode == CREATE_EXCL) {
+void CLA_File::openFile( const std::string &filename, FileMode mode, bool deferChecks )
+{
+  if (mode == CREATE || mode == CREATE_EXCL || mode == IN_MEMORY) {
     telescope().create().set("LOFAR");
     fileName().create().set(FileInfo::getBasename(File::filename()));
     fileDate().create().set(getFileModDate(filename)); // UTC
-  } else {
-    bool isCompatibleFileType = false;
-    try {
-      isCompatibleFileType = telescope().get() == "LOFAR";
-    } catch (DALException& ) {
-    }
-    if (!isCompatibleFileType) {
-      throw DALException("Failed to open file: A LOFAR data product must have TELESCOPE=\"LOFAR\".\n");
-    }
+  } else if (!deferChecks) {
+    checkFileType();
   }
 }
 
-void CLA_File::initFileNodes()
-{
-  //addNode( new Attribute<string>(*this, "GROUPTYPE") ); // already added by Group
-  addNode( new Attribute<string>(*this, "FILENAME") );
-  addNode( new Attribute<string>(*this, "FILEDATE") );
-  addNode( new Attribute<string>(*this, "FILETYPE") );
-  addNode( new Attribute<string>(*this, "TELESCOPE") );
-  addNode( new Attribute<string>(*this, "PROJECT_ID") );
-  addNode( new Attribute<string>(*this, "PROJECT_TITLE") );
-  addNode( new Attribute<string>(*this, "PROJECT_PI") );
-  addNode( new Attribute<string>(*this, "PROJECT_CO_I") );
-  addNode( new Attribute<string>(*this, "PROJECT_CONTACT") );
-  addNode( new Attribute<string>(*this, "OBSERVATION_ID") );
-  addNode( new Attribute<string>(*this, "OBSERVATION_START_UTC") );
-  addNode( new Attribute<double>(*this, "OBSERVATION_START_MJD") );
-  addNode( new Attribute<string>(*this, "OBSERVATION_END_UTC") );
-  addNode( new Attribute<double>(*this, "OBSERVATION_END_MJD") );
-  addNode( new Attribute<unsigned>(*this, "OBSERVATION_NOF_STATIONS") );
-  addNode( new Attribute< vector<string> >(*this, "OBSERVATION_STATIONS_LIST") );
-  addNode( new Attribute<double>(*this, "OBSERVATION_FREQUENCY_MIN") );
-  addNode( new Attribute<double>(*this, "OBSERVATION_FREQUENCY_CENTER") );
-  addNode( new Attribute<double>(*this, "OBSERVATION_FREQUENCY_MAX") );
-  addNode( new Attribute<string>(*this, "OBSERVATION_FREQUENCY_UNIT") );
-  addNode( new Attribute<unsigned>(*this, "OBSERVATION_NOF_BITS_PER_SAMPLE") );
-  addNode( new Attribute<double>(*this, "CLOCK_FREQUENCY") );
-  addNode( new Attribute<string>(*this, "CLOCK_FREQUENCY_UNIT") );
-  addNode( new Attribute<string>(*this, "ANTENNA_SET") );
-  addNode( new Attribute<string>(*this, "FILTER_SELECTION") );
-  addNode( new Attribute< vector<string> >(*this, "TARGETS") );
-  addNode( new Attribute<string>(*this, "SYSTEM_VERSION") );
-  addNode( new Attribute<string>(*this, "PIPELINE_NAME") );
-  addNode( new Attribute<string>(*this, "PIPELINE_VERSION") );
-  addNode( new Attribute<string>(*this, "DOC_NAME") );
-  //addNode( new Attribute<VersionType>(*this, "DOC_VERSION") ); // already added by File
-  addNode( new Attribute<string>(*this, "NOTES") );
+static const NodeSchema claFileNodes[] = {
+  { "FILENAME", createNode< Attribute<string> > },
+  { "FILEDATE", createNode< Attribute<string> > },
+  { "FILETYPE", createNode< Attribute<string> > },
+  { "TELESCOPE", createNode< Attribute<string> > },
+  { "PROJECT_ID", createNode< Attribute<string> > },
+  { "PROJECT_TITLE", createNode< Attribute<string> > },
+  { "PROJECT_PI", createNode< Attribute<string> > },
+  { "PROJECT_CO_I", createNode< Attribute<string> > },
+  { "PROJECT_CONTACT", createNode< Attribute<string> > },
+  { "OBSERVATION_ID", createNode< Attribute<string> > },
+  { "OBSERVATION_START_UTC", createNode< Attribute<string> > },
+  { "OBSERVATION_START_MJD", createNode< Attribute<double> > },
+  { "OBSERVATION_END_UTC", createNode< Attribute<string> > },
+  { "OBSERVATION_END_MJD", createNode< Attribute<double> > },
+  { "OBSERVATION_NOF_STATIONS", createNode< Attribute<unsigned> > },
+  { "OBSERVATION_STATIONS_LIST", createNode< Attribute< vector<string> > > },
+  { "OBSERVATION_FREQUENCY_MIN", createNode< Attribute<double> > },
+  { "OBSERVATION_FREQUENCY_CENTER", createNode< Attribute<double> > },
+  { "OBSERVATION_FREQUENCY_MAX", createNode< Attribute<double> > },
+  { "OBSERVATION_FREQUENCY_UNIT", createNode< Attribute<string> > },
+  { "OBSERVATION_NOF_BITS_PER_SAMPLE", createNode< Attribute<unsigned> > },
+  { "CLOCK_FREQUENCY", createNode< Attribute<double> > },
+  { "CLOCK_FREQUENCY_UNIT", createNode< Attribute<string> > },
+  { "ANTENNA_SET", createNode< Attribute<string> > },
+  { "FILTER_SELECTION", createNode< Attribute<string> > },
+  { "TARGETS", createNode< Attribute< vector<string> > > },
+  { "SYSTEM_VERSION", createNode< Attribute<string> > },
+  { "PIPELINE_NAME", createNode< Attribute<string> > },
+  { "PIPELINE_VERSION", createNode< Attribute<string> > },
+  { "DOC_NAME", createNode< Attribute<string> > },
+  { "NOTES", createNode< Attribute<string> > }
+};
+
+const NodeSchemaTable CLA_File::nodeSchema = {
+  &Group::nodeSchema, claFileNodes, sizeof claFileNodes / sizeof claFileNodes[0]
+};
+
+const NodeSchemaTable &CLA_File::schema() const
+{
+  return nodeSchema;
 }
 
 /*!
@@ -158,162 +167,162 @@ std::string CLA_File::formatFilenameTimestamp(const struct timeval& tv, const ch
 
 Attribute<string> CLA_File::fileName()
 {
-  return getNode("FILENAME");
+  return Attribute<string>(*this, "FILENAME");
 }
 
 Attribute<string> CLA_File::fileDate()
 {
-  return getNode("FILEDATE");
+  return Attribute<string>(*this, "FILEDATE");
 }
 
 Attribute<string> CLA_File::fileType()
 {
-  return getNode("FILETYPE");
+  return Attribute<string>(*this, "FILETYPE");
 }
 
 Attribute<string> CLA_File::telescope()
 {
-  return getNode("TELESCOPE");
+  return Attribute<string>(*this, "TELESCOPE");
 }
 
 Attribute<string> CLA_File::projectID()
 {
-  return getNode("PROJECT_ID");
+  return Attribute<string>(*this, "PROJECT_ID");
 }
 
 Attribute<string> CLA_File::projectTitle()
 {
-  return getNode("PROJECT_TITLE");
+  return Attribute<string>(*this, "PROJECT_TITLE");
 }
 
 Attribute<string> CLA_File::projectPI()
 {
-  return getNode("PROJECT_PI");
+  return Attribute<string>(*this, "PROJECT_PI");
 }
 
 Attribute<string> CLA_File::projectCOI()
 {
-  return getNode("PROJECT_CO_I");
+  return Attribute<string>(*this, "PROJECT_CO_I");
 }
 
 Attribute<string> CLA_File::projectContact()
 {
-  return getNode("PROJECT_CONTACT");
+  return Attribute<string>(*this, "PROJECT_CONTACT");
 }
 
 Attribute<string> CLA_File::observationID()
 {
-  return getNode("OBSERVATION_ID");
+  return Attribute<string>(*this, "OBSERVATION_ID");
 }
 
 Attribute<string> CLA_File::observationStartUTC()
 {
-  return getNode("OBSERVATION_START_UTC");
+  return Attribute<string>(*this, "OBSERVATION_START_UTC");
 }
 
 Attribute<double> CLA_File::observationStartMJD()
 {
-  return getNode("OBSERVATION_START_MJD");
+  return Attribute<double>(*this, "OBSERVATION_START_MJD");
 }
 
 Attribute<string> CLA_File::observationEndUTC()
 {
-  return getNode("OBSERVATION_END_UTC");
+  return Attribute<string>(*this, "OBSERVATION_END_UTC");
 }
 
 Attribute<double> CLA_File::observationEndMJD()
 {
-  return getNode("OBSERVATION_END_MJD");
+  return Attribute<double>(*this, "OBSERVATION_END_MJD");
 }
 
 Attribute<unsigned> CLA_File::observationNofStations()
 {
-  return getNode("OBSERVATION_NOF_STATIONS");
+  return Attribute<unsigned>(*this, "OBSERVATION_NOF_STATIONS");
 }
 
 Attribute< vector<string> > CLA_File::observationStationsList()
 {
-  return getNode("OBSERVATION_STATIONS_LIST");
+  return Attribute< vector<string> >(*this, "OBSERVATION_STATIONS_LIST");
 }
 
 Attribute<double> CLA_File::observationFrequencyMax()
 {
-  return getNode("OBSERVATION_FREQUENCY_MAX");
+  return Attribute<double>(*this, "OBSERVATION_FREQUENCY_MAX");
 }
 
 Attribute<double> CLA_File::observationFrequencyMin()
 {
-  return getNode("OBSERVATION_FREQUENCY_MIN");
+  return Attribute<double>(*this, "OBSERVATION_FREQUENCY_MIN");
 }
 
 Attribute<double> CLA_File::observationFrequencyCenter()
 {
-  return getNode("OBSERVATION_FREQUENCY_CENTER");
+  return Attribute<double>(*this, "OBSERVATION_FREQUENCY_CENTER");
 }
 
 Attribute<string> CLA_File::observationFrequencyUnit()
 {
-  return getNode("OBSERVATION_FREQUENCY_UNIT");
+  return Attribute<string>(*this, "OBSERVATION_FREQUENCY_UNIT");
 }
 
 Attribute<unsigned> CLA_File::observationNofBitsPerSample()
 {
-  return getNode("OBSERVATION_NOF_BITS_PER_SAMPLE");
+  return Attribute<unsigned>(*this, "OBSERVATION_NOF_BITS_PER_SAMPLE");
 }
 
 Attribute<double> CLA_File::clockFrequency()
 {
-  return getNode("CLOCK_FREQUENCY");
+  return Attribute<double>(*this, "CLOCK_FREQUENCY");
 }
 
 Attribute<string> CLA_File::clockFrequencyUnit()
 {
-  return getNode("CLOCK_FREQUENCY_UNIT");
+  return Attribute<string>(*this, "CLOCK_FREQUENCY_UNIT");
 }
 
 Attribute<string> CLA_File::antennaSet()
 {
-  return getNode("ANTENNA_SET");
+  return Attribute<string>(*this, "ANTENNA_SET");
 }
 
 Attribute<string> CLA_File::filterSelection()
 {
-  return getNode("FILTER_SELECTION");
+  return Attribute<string>(*this, "FILTER_SELECTION");
 }
 
 Attribute< vector<string> > CLA_File::targets()
 {
-  return getNode("TARGETS");
+  return Attribute< vector<string> >(*this, "TARGETS");
 }
 
 Attribute<string> CLA_File::systemVersion()
 {
-  return getNode("SYSTEM_VERSION");
+  return Attribute<string>(*this, "SYSTEM_VERSION");
 }
 
 Attribute<string> CLA_File::pipelineName()
 {
-  return getNode("PIPELINE_NAME");
+  return Attribute<string>(*this, "PIPELINE_NAME");
 }
 
 Attribute<string> CLA_File::pipelineVersion()
 {
-  return getNode("PIPELINE_VERSION");
+  return Attribute<string>(*this, "PIPELINE_VERSION");
 }
 
 Attribute<string> CLA_File::docName()
 {
-  return getNode("DOC_NAME");
+  return Attribute<string>(*this, "DOC_NAME");
 }
 
 Attribute<VersionType> CLA_File::docVersion()
 {
-  return getNode("DOC_VERSION");
+  return Attribute<VersionType>(*this, "DOC_VERSION");
 }
 
 Attribute<string> CLA_File::notes()
 {
-  return getNode("NOTES");
+  return Attribute<string>(*this, "NOTES");
 }
 
 }
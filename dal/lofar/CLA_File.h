@@ -34,13 +34,20 @@ namespace dal {
 class CLA_File: public File {
 public:
   CLA_File();
-  CLA_File( const std::string &filename, FileMode mode = READ );
+  CLA_File( const std::string &filename, FileMode mode = READ, const FileAccessOptions &options = FileAccessOptions() );
 
   virtual ~CLA_File();
 
-  void open( const std::string &filename, FileMode mode = READ );
+  void open( const std::string &filename, FileMode mode = READ, const FileAccessOptions &options = FileAccessOptions() );
   virtual void close();
 
+  /*!
+   * Throws a DALException if this file is not a LOFAR data product (TELESCOPE must be "LOFAR").
+   * Done when opening an existing file. Files opened with FileAccessOptions::deferChecks are
+   * not checked, unless the caller calls this function.
+   */
+  virtual void checkFileType();
+
   Attribute<std::string> fileName();
   Attribute<std::string> fileDate();
   Attribute<std::string> fileType();
@@ -88,9 +95,12 @@ protected:
   std::string             formatFilenameTimestamp( const struct timeval& tv, const char* output_format,
                                                   const char* output_format_secs, size_t output_size ) const;
 
+protected:
+  static const NodeSchemaTable nodeSchema;
+  virtual const NodeSchemaTable &schema() const;
+
 private:
-  void                    openFile( const std::string &filename, FileMode mode );
-  void                    initFileNodes();
+  void                    openFile( const std::string &filename, FileMode mode, bool deferChecks );
 };
 
 }
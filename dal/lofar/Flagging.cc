@@ -16,6 +16,7 @@
  */
 #include "Flagging.h"
 
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
@@ -34,5 +35,167 @@ string Range::to_string() {
   return oss.str();
 }
 
+static bool beginBefore( const Range &a, const Range &b )
+{
+  return a.begin < b.begin;
+}
+
+static bool endsBefore( const Range &range, unsigned long long pos )
+{
+  return range.end < pos;
+}
+
+static bool endsAfter( unsigned long long pos, const Range &range )
+{
+  return pos < range.end;
+}
+
+//! Appends `range` to the sorted `ranges`, merging it with the last range if they overlap or touch.
+static void append( vector<Range> &ranges, const Range &range )
+{
+  if (range.begin >= range.end)
+    return;
+
+  if (!ranges.empty() && range.begin <= ranges.back().end)
+    ranges.back().end = max(ranges.back().end, range.end);
+  else
+    ranges.push_back(range);
+}
+
+RangeSet::RangeSet() {}
+
+RangeSet::RangeSet( const vector<Range> &ranges )
+{
+  vector<Range> sorted(ranges);
+  sort(sorted.begin(), sorted.end(), beginBefore);
+
+  for (size_t i = 0; i < sorted.size(); i++)
+    append(_ranges, sorted[i]);
+}
+
+RangeSet::RangeSet( const Attribute< vector<Range> > &attr )
+{
+  *this = RangeSet(attr.get());
+}
+
+void RangeSet::store( Attribute< vector<Range> > attr ) const
+{
+  attr.value = _ranges;
+}
+
+unsigned long long RangeSet::count() const
+{
+  unsigned long long total = 0;
+
+  for (size_t i = 0; i < _ranges.size(); i++)
+    total += _ranges[i].end - _ranges[i].begin;
+
+  return total;
+}
+
+size_t RangeSet::firstEndingAfter( unsigned long long pos ) const
+{
+  return upper_bound(_ranges.begin(), _ranges.end(), pos, endsAfter) - _ranges.begin();
+}
+
+void RangeSet::insert( const Range &range )
+{
+  if (range.begin >= range.end)
+    return;
+
+  // the ranges that overlap or touch `range` are merged into it
+  const vector<Range>::iterator first = lower_bound(_ranges.begin(), _ranges.end(), range.begin, endsBefore);
+  vector<Range>::iterator last = first;
+
+  Range merged(range);
+
+  for (; last != _ranges.end() && last->begin <= range.end; ++last) {
+    merged.begin = min(merged.begin, last->begin);
+    merged.end   = max(merged.end,   last->end);
+  }
+
+  if (first == last) {
+    _ranges.insert(first, merged);
+  } else {
+    *first = merged;
+    _ranges.erase(first + 1, last);
+  }
+}
+
+bool RangeSet::contains( unsigned long long pos ) const
+{
+  const size_t i = firstEndingAfter(pos);
+
+  return i < _ranges.size() && _ranges[i].begin <= pos;
+}
+
+bool RangeSet::overlaps( const Range &range ) const
+{
+  if (range.begin >= range.end)
+    return false;
+
+  const size_t i = firstEndingAfter(range.begin);
+
+  return i < _ranges.size() && _ranges[i].begin < range.end;
+}
+
+RangeSet RangeSet::unite( const RangeSet &other ) const
+{
+  RangeSet result;
+  result._ranges.reserve(_ranges.size() + other._ranges.size());
+
+  size_t i = 0, j = 0;
+
+  while (i < _ranges.size() || j < other._ranges.size()) {
+    if (j == other._ranges.size() || (i < _ranges.size() && _ranges[i].begin < other._ranges[j].begin))
+      append(result._ranges, _ranges[i++]);
+    else
+      append(result._ranges, other._ranges[j++]);
+  }
+
+  return result;
+}
+
+RangeSet RangeSet::intersect( const RangeSet &other ) const
+{
+  RangeSet result;
+
+  size_t i = 0, j = 0;
+
+  while (i < _ranges.size() && j < other._ranges.size()) {
+    const unsigned long long begin = max(_ranges[i].begin, other._ranges[j].begin);
+    const unsigned long long end   = min(_ranges[i].end,   other._ranges[j].end);
+
+    if (begin < end)
+      result._ranges.push_back(Range(begin, end));
+
+    if (_ranges[i].end < other._ranges[j].end)
+      i++;
+    else
+      j++;
+  }
+
+  return result;
+}
+
+RangeSet RangeSet::complement( const Range &domain ) const
+{
+  RangeSet result;
+
+  unsigned long long pos = domain.begin;
+
+  for (size_t i = firstEndingAfter(domain.begin); i < _ranges.size() && _ranges[i].begin < domain.end; i++) {
+    if (pos < _ranges[i].begin)
+      result._ranges.push_back(Range(pos, _ranges[i].begin));
+
+    pos = _ranges[i].end;
+  }
+
+  if (pos < domain.end)
+    result._ranges.push_back(Range(pos, domain.end));
+
+  return result;
+}
+
 }
 
@@ -19,7 +19,10 @@
 
 #include <cstddef>
 #include <string>
+#include <vector>
 #include "../hdf5/types/h5tuple.h"
+#include "../hdf5/Attribute.h"
+#include "../hdf5/Dataset.h"
 
 namespace dal {
 
@@ -42,7 +45,130 @@ struct Range : public TupleBase<unsigned long long, 2> {
   std::string to_string();
 };
 
+/*!
+ * A set of positions, stored as a sorted list of disjoint, non-adjacent Ranges.
+ * Flag lists such as TBB_DipoleDataset::flagOffsets() may contain overlapping or
+ * unsorted ranges; RangeSet normalises them once, after which queries take
+ * O(log n) time and set operations take time linear in the number of ranges.
+ *
+ * Python example:
+ * \code
+ *    >>> s = RangeSet([Range(10, 20), Range(0, 5), Range(15, 30)])
+ *    >>> s.ranges()
+ *    [[0,5), [10,30)]
+ *    >>> s.contains(12)
+ *    True
+ *    >>> s.complement(Range(0, 40)).ranges()
+ *    [[5,10), [30,40)]
+ * \endcode
+ */
+class RangeSet {
+public:
+  RangeSet();
+
+  //! Creates a set of all positions covered by `ranges`, which may overlap and be in any order.
+  RangeSet( const std::vector<Range> &ranges );
+
+  //! Creates a set of the positions stored in the flag list `attr`.
+  RangeSet( const Attribute< std::vector<Range> > &attr );
+
+  //! Stores this set in the flag list `attr`, creating it if needed.
+  void store( Attribute< std::vector<Range> > attr ) const;
+
+  //! Returns the sorted, disjoint and non-adjacent ranges in this set.
+  std::vector<Range> ranges() const { return _ranges; }
+
+  //! Returns whether this set is empty.
+  bool empty() const { return _ranges.empty(); }
+
+  //! Returns the number of positions in this set.
+  unsigned long long count() const;
+
+  //! Adds the positions of `range` to this set.
+  void insert( const Range &range );
+
+  //! Returns whether `pos` is in this set. Takes O(log n) time.
+  bool contains( unsigned long long pos ) const;
+
+  //! Returns whether any position in `range` is in this set. Takes O(log n) time.
+  bool overlaps( const Range &range ) const;
+
+  //! Returns the positions in this set, in `other`, or in both.
+  RangeSet unite( const RangeSet &other ) const;
+
+  //! Returns the positions in both this set and `other`.
+  RangeSet intersect( const RangeSet &other ) const;
+
+  //! Returns the positions in `domain` that are not in this set.
+  RangeSet complement( const Range &domain ) const;
+
+private:
+  std::vector<Range> _ranges;
+
+  //! Returns the index of the first range that ends after `pos`, or _ranges.size().
+  size_t firstEndingAfter( unsigned long long pos ) const;
+};
+
+/*!
+ * How getMasked() treats flagged values:
+ *   MASK_SKIP: leave them out, packing the unflagged values at the start of the buffer,
+ *   MASK_ZERO: set them to 0,
+ *   MASK_NAN:  set them to NaN (floating-point types only; complex values get NaN as both
+ *              their real and imaginary parts).
+ */
+enum MaskMode { MASK_SKIP, MASK_ZERO, MASK_NAN };
+
+/*!
+ * Retrieves `len` data values starting at index `pos` of dimension `dimIndex` of `dataset`,
+ * like Dataset::get1D(), except for the positions in `flags`, which are treated according to `mode`.
+ * Large flagged regions are not read.
+ *
+ * Returns the number of values stored in `outbuffer`, which is `len` unless `mode` is MASK_SKIP.
+ *
+ * Python example:
+ * \code
+ *    # Create a dataset holding the values 0 to 9
+ *    >>> f = File("example.h5", File.CREATE)
+ *    >>> d = DatasetShort(f, "EXAMPLE_DATASET")
+ *    >>> d.create1D(10, 10)
+ *    >>> import numpy
+ *    >>> d.set1D(0, numpy.arange(10, dtype=d.dtype))
+ *
+ *    # Flag positions 2 to 4 and 7 (TBB_DipoleDataset.flagOffsets() returns such a list)
+ *    >>> flags = RangeSet([Range(2, 5), Range(7, 8)])
+ *
+ *    # Read only the unflagged values
+ *    >>> x = numpy.zeros(10, dtype=d.dtype)
+ *    >>> getMasked(d, 0, x, flags, MASK_SKIP)
+ *    6
+ *    >>> x[:6]
+ *    array([0, 1, 5, 6, 8, 9], dtype=int16)
+ *
+ *    # Read all values, with the flagged ones set to 0
+ *    >>> getMasked(d, 0, x, flags, MASK_ZERO)
+ *    10
+ *    >>> x
+ *    array([0, 1, 0, 0, 0, 5, 6, 0, 8, 9], dtype=int16)
+ *
+ *    # Clean up
+ *    >>> del d
+ *    >>> del f
+ *    >>> import os
+ *    >>> os.remove("example.h5")
+ * \endcode
+ *
+ * Requires:
+ *    - pos + len <= dataset.dims()[dimIndex]
+ *    - len <= size of outbuffer
+ *    - dimIndex < dataset.ndims()
+ *    - mode != MASK_NAN or T (for complex T, its value type) has a quiet NaN
+ */
+template<typename T> size_t getMasked( Dataset<T> &dataset, size_t pos, T *outbuffer, size_t len,
+                                       const RangeSet &flags, MaskMode mode, unsigned dimIndex = 0 );
+
 }
 
+#include "Flagging.tcc"
+
 #endif
 
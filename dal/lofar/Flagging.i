@@ -9,3 +9,6 @@ AddAttributeAndVector( Range, %arg(dal::Range) );
   }
 }
 
+%template(getMasked) dal::getMasked<short>;
+%template(getMasked) dal::getMasked<float>;
+%template(getMasked) dal::getMasked< std::complex<float> >;
@@ -0,0 +1,92 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <complex>
+#include <limits>
+
+namespace dal {
+
+//! The value with which getMasked() fills flagged positions for MASK_NAN, if T has one.
+template<typename T> struct MaskNaN {
+  static bool available() { return std::numeric_limits<T>::has_quiet_NaN; }
+  static T value() { return std::numeric_limits<T>::quiet_NaN(); }
+};
+
+template<typename T> struct MaskNaN< std::complex<T> > {
+  static bool available() { return std::numeric_limits<T>::has_quiet_NaN; }
+  static std::complex<T> value() { return std::complex<T>(std::numeric_limits<T>::quiet_NaN(), std::numeric_limits<T>::quiet_NaN()); }
+};
+
+//! Flagged gaps between unflagged runs shorter than this number of values are read by getMasked() rather than skipped.
+static const unsigned long long maskedReadGap = 64 * 1024;
+
+template<typename T> size_t getMasked( Dataset<T> &dataset, size_t pos, T *outbuffer, size_t len,
+                                       const RangeSet &flags, MaskMode mode, unsigned dimIndex )
+{
+  if (mode == MASK_NAN && !MaskNaN<T>::available())
+    throw DALValueError("Cannot mask with NaN if the type has no NaN for dataset " + dataset.name());
+
+  const std::vector<ssize_t> dims = dataset.dims();
+
+  if (dimIndex >= dims.size())
+    throw DALIndexError("Cannot getMasked if dimIndex exceeds rank of dataset " + dataset.name());
+
+  if (pos + len > (size_t)dims[dimIndex])
+    throw DALIndexError("Cannot getMasked beyond the end of dataset " + dataset.name());
+
+  const std::vector<Range> runs = flags.complement(Range(pos, pos + len)).ranges();
+
+  // Read the unflagged runs at their place in outbuffer. Runs separated by short flagged
+  // gaps are read together, as one large read is cheaper than many small ones.
+  for (size_t r = 0; r < runs.size(); ) {
+    const unsigned long long begin = runs[r].begin;
+    unsigned long long end = runs[r].end;
+
+    for (r++; r < runs.size() && runs[r].begin - end < maskedReadGap; r++)
+      end = runs[r].end;
+
+    dataset.get1D(begin, outbuffer + (begin - pos), end - begin, dimIndex);
+  }
+
+  if (mode == MASK_SKIP) {
+    // pack the unflagged values at the start
+    size_t nrUnflagged = 0;
+
+    for (size_t r = 0; r < runs.size(); r++) {
+      std::copy(outbuffer + (runs[r].begin - pos), outbuffer + (runs[r].end - pos), outbuffer + nrUnflagged);
+      nrUnflagged += runs[r].end - runs[r].begin;
+    }
+
+    return nrUnflagged;
+  }
+
+  // fill the flagged values
+  const T fill = mode == MASK_NAN ? MaskNaN<T>::value() : T();
+  size_t filled = 0;
+
+  for (size_t r = 0; r < runs.size(); r++) {
+    std::fill(outbuffer + filled, outbuffer + (runs[r].begin - pos), fill);
+    filled = runs[r].end - pos;
+  }
+
+  std::fill(outbuffer + filled, outbuffer + len, fill);
+
+  return len;
+}
+
+}
+
@@ -15,6 +15,13 @@
  * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "TBB_File.h"
+#include "../hdf5/ConcurrentReader.h"
+#include "../hdf5/types/HDF5Lock.h"
+#include "../hdf5/types/ParallelTasks.h"
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
@@ -22,21 +29,21 @@ namespace dal {
 
 TBB_File::TBB_File() {}
 
-TBB_File::TBB_File( const std::string &filename, FileMode mode )
+TBB_File::TBB_File( const std::string &filename, FileMode mode, const FileAccessOptions &options )
 :
-  CLA_File(filename, mode)
+  CLA_File(filename, mode, options)
 {
-  openFile(mode);
+  openFile(mode, options.deferChecks);
 }
 
 TBB_File::~TBB_File() {}
 
-void TBB_File::open( const std::string &filename, FileMode mode )
+void TBB_File::open( const std::string &filename, FileMode mode, const FileAccessOptions &options )
 {
   // As long as we have no member vars, keep open() and close() simple. See CLA_File::open().
-  CLA_File::open(filename, mode);
+  CLA_File::open(filename, mode, options);
 
-  openFile(mode);
+  openFile(mode, options.deferChecks);
 }
 
 void TBB_File::close()
@@ -44,30 +51,48 @@ void TBB_File::close()
   CLA_File::close();
 }
 
-void TBB_File::openFile( FileMode mode )
+void TBB_File::checkFileType()
 {
-  initFileNodes();
+  CLA_File::checkFileType();
+  checkTbbFileType();
+}
 
-  if (mode == CREATE || mode == CREATE_EXCL) {
+void TBB_File::checkTbbFileType()
+{
+  bool isTbbFileType = false;
+  try {
+    isTbbFileType = fileType().get() == "tbb";
+  } catch (DALException& ) {
+  }
+  if (!isTbbFileType) {
+    throw DALException("Failed to open TBB file: A TBB file must have FILETYPE=\"tbb\".");
+  }
+}
+
+void TBB_File::openFile( FileMode mode, bool deferChecks )
+{
+  if (mode == CREATE || mode == CREATE_EXCL || mode == IN_MEMORY) {
     fileType().create().set("tbb");
     docName() .create().set("ICD 1: TBB Time-Series Data");
     docVersion()       .set(VersionType(3, 3)); // already created by File
-  } else {
-    bool isTbbFileType = false;
-    try {
-      isTbbFileType = fileType().get() == "tbb";
-    } catch (DALException& ) {
-    }
-    if (!isTbbFileType) {
-      throw DALException("Failed to open TBB file: A TBB file must have FILETYPE=\"tbb\".");
-    }
+  } else if (!deferChecks) {
+    // TELESCOPE is checked by CLA_File
+    checkTbbFileType();
   }
 }
 
-void TBB_File::initFileNodes() {
-  CLA_File::initNodes();
-  addNode( new Attribute<string>(*this, "OPERATING_MODE") );
-  addNode( new Attribute<unsigned>(*this, "NOF_STATIONS") );
+static const NodeSchema tbbFileNodes[] = {
+  { "OPERATING_MODE", createNode< Attribute<string> > },
+  { "NOF_STATIONS", createNode< Attribute<unsigned> > }
+};
+
+const NodeSchemaTable TBB_File::nodeSchema = {
+  &CLA_File::nodeSchema, tbbFileNodes, sizeof tbbFileNodes / sizeof tbbFileNodes[0]
+};
+
+const NodeSchemaTable &TBB_File::schema() const
+{
+  return nodeSchema;
 }
 
 Attribute<string> TBB_File::operatingMode()
@@ -84,15 +109,13 @@ vector<TBB_Station> TBB_File::stations()
 {
   const string stPrefix("STATION_");
   vector<TBB_Station> stationGroups;
-  vector<string> membNames(memberNames());
 
-  for (vector<string>::const_iterator it(membNames.begin()); it != membNames.end(); ++it) {
+  // A single pass over the links returns both the names and the object types.
+  vector<MemberInfo> membs(members());
+  for (vector<MemberInfo>::const_iterator it(membs.begin()); it != membs.end(); ++it) {
     // Filter the names that appear to be stations and fill the vector with objects of the right type.
-    if (it->find(stPrefix) == 0) {
-      TBB_Station statioGroup(*this, *it);
-      if(statioGroup.isHDF5Group()) {
-        stationGroups.push_back(statioGroup);
-      }
+    if (it->type == MemberInfo::GROUP && it->name.find(stPrefix) == 0) {
+      stationGroups.push_back(TBB_Station(*this, it->name));
     }
   }
 
@@ -120,33 +143,40 @@ TBB_Trigger::TBB_Trigger( Group &parent, const std::string &name )
 {
 }
 
-void TBB_Trigger::initNodes() {
-  Group::initNodes();
-  addNode( new Attribute<string>(*this, "TRIGGER_TYPE") );
-  addNode( new Attribute<int>(*this, "TRIGGER_VERSION") );
-  addNode( new Attribute<int>(*this, "PARAM_COINCIDENCE_CHANNELS") );
-  addNode( new Attribute<double>(*this, "PARAM_COINCIDENCE_TIME") );
-  addNode( new Attribute<string>(*this, "PARAM_DIRECTION_FIT") );
-  addNode( new Attribute<double>(*this, "PARAM_ELEVATION_MIN") );
-  addNode( new Attribute<double>(*this, "PARAM_FIT_VARIANCE_MAX") );
+static const NodeSchema tbbTriggerNodes[] = {
+  { "TRIGGER_TYPE", createNode< Attribute<string> > },
+  { "TRIGGER_VERSION", createNode< Attribute<int> > },
+  { "PARAM_COINCIDENCE_CHANNELS", createNode< Attribute<int> > },
+  { "PARAM_COINCIDENCE_TIME", createNode< Attribute<double> > },
+  { "PARAM_DIRECTION_FIT", createNode< Attribute<string> > },
+  { "PARAM_ELEVATION_MIN", createNode< Attribute<double> > },
+  { "PARAM_FIT_VARIANCE_MAX", createNode< Attribute<double> > },
 
   // optional parameters for version >= 3.3 "spectral" operatingMode, default to 0.
   // ICD states that non-filled-in parameters should/can be present, and should contain 0 by default.
-  addNode( new Attribute<double>(*this, "TRIGGER_DISPERSION_MEASURE") );
-  addNode( new Attribute<string>(*this, "TRIGGER_DISPERSION_MEASURE_UNIT") );
-  addNode( new Attribute<vector<unsigned> >(*this, "TIME") );
-  addNode( new Attribute<vector<unsigned> >(*this, "SAMPLE_NUMBER") );
-  addNode( new Attribute<string>(*this, "FIT_DIRECTION_COORDINATE_SYSTEM") );
-  addNode( new Attribute<double>(*this, "FIT_DIRECTION_ANGLE1") );
-  addNode( new Attribute<double>(*this, "FIT_DIRECTION_ANGLE2") );
-  addNode( new Attribute<double>(*this, "FIT_DIRECTION_DISTANCE") );
-  addNode( new Attribute<double>(*this, "FIT_DIRECTION_VARIANCE") );
-  addNode( new Attribute<double>(*this, "REFERENCE_FREQUENCY") );
-  addNode( new Attribute<vector<double> >(*this, "OBSERVATORY_COORDINATES") );
-  addNode( new Attribute<string>(*this, "OBSERVATORY_COORDINATES_COORDINATE_SYSTEM") );
-  addNode( new Attribute<string>(*this, "TRIGGER_ID") );
-  addNode( new Attribute<string>(*this, "ADDITIONAL_INFO") );
-
+  { "TRIGGER_DISPERSION_MEASURE", createNode< Attribute<double> > },
+  { "TRIGGER_DISPERSION_MEASURE_UNIT", createNode< Attribute<string> > },
+  { "TIME", createNode< Attribute< vector<unsigned> > > },
+  { "SAMPLE_NUMBER", createNode< Attribute< vector<unsigned> > > },
+  { "FIT_DIRECTION_COORDINATE_SYSTEM", createNode< Attribute<string> > },
+  { "FIT_DIRECTION_ANGLE1", createNode< Attribute<double> > },
+  { "FIT_DIRECTION_ANGLE2", createNode< Attribute<double> > },
+  { "FIT_DIRECTION_DISTANCE", createNode< Attribute<double> > },
+  { "FIT_DIRECTION_VARIANCE", createNode< Attribute<double> > },
+  { "REFERENCE_FREQUENCY", createNode< Attribute<double> > },
+  { "OBSERVATORY_COORDINATES", createNode< Attribute< vector<double> > > },
+  { "OBSERVATORY_COORDINATES_COORDINATE_SYSTEM", createNode< Attribute<string> > },
+  { "TRIGGER_ID", createNode< Attribute<string> > },
+  { "ADDITIONAL_INFO", createNode< Attribute<string> > }
+};
+
+const NodeSchemaTable TBB_Trigger::nodeSchema = {
+  &Group::nodeSchema, tbbTriggerNodes, sizeof tbbTriggerNodes / sizeof tbbTriggerNodes[0]
+};
+
+const NodeSchemaTable &TBB_Trigger::schema() const
+{
+  return nodeSchema;
 }
 
 Attribute<string> TBB_Trigger::triggerType()
@@ -260,18 +290,26 @@ TBB_Station::TBB_Station( Group &parent, const std::string &name )
 {
 }
 
-void TBB_Station::initNodes() {
-  Group::initNodes();
-  addNode( new Attribute<string>(*this, "STATION_NAME") );
-  addNode( new Attribute< vector<double> >(*this, "STATION_POSITION") );
-  addNode( new Attribute<string>(*this, "STATION_POSITION_UNIT") );
-  addNode( new Attribute<string>(*this, "STATION_POSITION_FRAME") );
-  addNode( new Attribute< vector<double> >(*this, "BEAM_DIRECTION") );
-  addNode( new Attribute<string>(*this, "BEAM_DIRECTION_UNIT") );
-  addNode( new Attribute<string>(*this, "BEAM_DIRECTION_FRAME") );
-  addNode( new Attribute<double>(*this, "CLOCK_OFFSET") );
-  addNode( new Attribute<string>(*this, "CLOCK_OFFSET_UNIT") );
-  addNode( new Attribute<unsigned>(*this, "NOF_DIPOLES") );
+static const NodeSchema tbbStationNodes[] = {
+  { "STATION_NAME", createNode< Attribute<string> > },
+  { "STATION_POSITION", createNode< Attribute< vector<double> > > },
+  { "STATION_POSITION_UNIT", createNode< Attribute<string> > },
+  { "STATION_POSITION_FRAME", createNode< Attribute<string> > },
+  { "BEAM_DIRECTION", createNode< Attribute< vector<double> > > },
+  { "BEAM_DIRECTION_UNIT", createNode< Attribute<string> > },
+  { "BEAM_DIRECTION_FRAME", createNode< Attribute<string> > },
+  { "CLOCK_OFFSET", createNode< Attribute<double> > },
+  { "CLOCK_OFFSET_UNIT", createNode< Attribute<string> > },
+  { "NOF_DIPOLES", createNode< Attribute<unsigned> > }
+};
+
+const NodeSchemaTable TBB_Station::nodeSchema = {
+  &Group::nodeSchema, tbbStationNodes, sizeof tbbStationNodes / sizeof tbbStationNodes[0]
+};
+
+const NodeSchemaTable &TBB_Station::schema() const
+{
+  return nodeSchema;
 }
 
 Attribute<string> TBB_Station::stationName()
@@ -333,14 +371,11 @@ vector<TBB_DipoleDataset> TBB_Station::dipoleDatasets()
   const string dpPrefix("DIPOLE_");
   vector<TBB_DipoleDataset> dipoleDatasets;
 
-  vector<string> membNames(memberNames());
-  for (vector<string>::const_iterator it(membNames.begin()); it != membNames.end(); ++it) {
+  vector<MemberInfo> membs(members());
+  for (vector<MemberInfo>::const_iterator it(membs.begin()); it != membs.end(); ++it) {
     // Filter the names that appear to be dipoles and fill the vector with objects of the right type.
-    if (it->find(dpPrefix) == 0) {
-      TBB_DipoleDataset dipoleDataset(*this, *it);
-      if(dipoleDataset.isHDF5DataSet()) {
-        dipoleDatasets.push_back(dipoleDataset);
-      }
+    if (it->type == MemberInfo::DATASET && it->name.find(dpPrefix) == 0) {
+      dipoleDatasets.push_back(TBB_DipoleDataset(*this, it->name));
     }
   }
 
@@ -352,14 +387,11 @@ vector<TBB_DipoleGroup> TBB_Station::dipoleGroups()
   const string dpPrefix("DIPOLE_");
   vector<TBB_DipoleGroup> dipoleGroups;
 
-  vector<string> membNames(memberNames());
-  for (vector<string>::const_iterator it(membNames.begin()); it != membNames.end(); ++it) {
+  vector<MemberInfo> membs(members());
+  for (vector<MemberInfo>::const_iterator it(membs.begin()); it != membs.end(); ++it) {
     // Filter the names that appear to be dipoles and fill the vector with objects of the right type.
-    if (it->find(dpPrefix) == 0) {
-      TBB_DipoleGroup dipoleGroup(*this, *it);
-      if(dipoleGroup.isHDF5Group()) {
-        dipoleGroups.push_back(dipoleGroup);
-      }
+    if (it->type == MemberInfo::GROUP && it->name.find(dpPrefix) == 0) {
+      dipoleGroups.push_back(TBB_DipoleGroup(*this, it->name));
     }
   }
 
@@ -394,32 +426,40 @@ TBB_DipoleGroup::TBB_DipoleGroup( Group &parent, const std::string &name )
 {
 }
 
-void TBB_DipoleGroup::initNodes() {
-  Group::initNodes();
-  addNode( new Attribute<unsigned>(*this, "STATION_ID") );
-  addNode( new Attribute<unsigned>(*this, "RSP_ID") );
-  addNode( new Attribute<unsigned>(*this, "RCU_ID") );
-  addNode( new Attribute<double>(*this, "SAMPLE_FREQUENCY") );
-  addNode( new Attribute<string>(*this, "SAMPLE_FREQUENCY_UNIT") );
-  addNode( new Attribute<unsigned>(*this, "NYQUIST_ZONE") );
-  addNode( new Attribute<double>(*this, "ADC2VOLTAGE") );
-  addNode( new Attribute<double>(*this, "CABLE_DELAY") );
-  addNode( new Attribute<string>(*this, "CABLE_DELAY_UNIT") );
-  addNode( new Attribute<double>(*this, "DIPOLE_CALIBRATION_DELAY") );
-  addNode( new Attribute<string>(*this, "DIPOLE_CALIBRATION_DELAY_UNIT") );
-  addNode( new Attribute< vector<complex<double> > >(*this, "DIPOLE_CALIBRATION_DELAY_GAIN_CURVE") );
-  addNode( new Attribute< vector<double> >(*this, "ANTENNA_POSITION") );
-  addNode( new Attribute<string>(*this, "ANTENNA_POSITION_UNIT") );
-  addNode( new Attribute<string>(*this, "ANTENNA_POSITION_FRAME") );
-  addNode( new Attribute< vector<double> >(*this, "ANTENNA_NORMAL_VECTOR") );
-  addNode( new Attribute< vector<double> >(*this, "ANTENNA_ROTATION_MATRIX") );
-  addNode( new Attribute< vector<double> >(*this, "TILE_BEAM") );
-  addNode( new Attribute<string>(*this, "TILE_BEAM_UNIT") );
-  addNode( new Attribute<string>(*this, "TILE_BEAM_FRAME") );
-  addNode( new Attribute<double>(*this, "DISPERSION_MEASURE") );
-  addNode( new Attribute<string>(*this, "DISPERSION_MEASURE_UNIT") );
-  addNode( new Attribute<unsigned>(*this, "NOF_SUBBANDS") );
-  addNode( new Attribute<vector<unsigned> >(*this, "SUBBANDS") );
+static const NodeSchema tbbDipoleGroupNodes[] = {
+  { "STATION_ID", createNode< Attribute<unsigned> > },
+  { "RSP_ID", createNode< Attribute<unsigned> > },
+  { "RCU_ID", createNode< Attribute<unsigned> > },
+  { "SAMPLE_FREQUENCY", createNode< Attribute<double> > },
+  { "SAMPLE_FREQUENCY_UNIT", createNode< Attribute<string> > },
+  { "NYQUIST_ZONE", createNode< Attribute<unsigned> > },
+  { "ADC2VOLTAGE", createNode< Attribute<double> > },
+  { "CABLE_DELAY", createNode< Attribute<double> > },
+  { "CABLE_DELAY_UNIT", createNode< Attribute<string> > },
+  { "DIPOLE_CALIBRATION_DELAY", createNode< Attribute<double> > },
+  { "DIPOLE_CALIBRATION_DELAY_UNIT", createNode< Attribute<string> > },
+  { "DIPOLE_CALIBRATION_DELAY_GAIN_CURVE", createNode< Attribute< vector<complex<double> > > > },
+  { "ANTENNA_POSITION", createNode< Attribute< vector<double> > > },
+  { "ANTENNA_POSITION_UNIT", createNode< Attribute<string> > },
+  { "ANTENNA_POSITION_FRAME", createNode< Attribute<string> > },
+  { "ANTENNA_NORMAL_VECTOR", createNode< Attribute< vector<double> > > },
+  { "ANTENNA_ROTATION_MATRIX", createNode< Attribute< vector<double> > > },
+  { "TILE_BEAM", createNode< Attribute< vector<double> > > },
+  { "TILE_BEAM_UNIT", createNode< Attribute<string> > },
+  { "TILE_BEAM_FRAME", createNode< Attribute<string> > },
+  { "DISPERSION_MEASURE", createNode< Attribute<double> > },
+  { "DISPERSION_MEASURE_UNIT", createNode< Attribute<string> > },
+  { "NOF_SUBBANDS", createNode< Attribute<unsigned> > },
+  { "SUBBANDS", createNode< Attribute< vector<unsigned> > > }
+};
+
+const NodeSchemaTable TBB_DipoleGroup::nodeSchema = {
+  &Group::nodeSchema, tbbDipoleGroupNodes, sizeof tbbDipoleGroupNodes / sizeof tbbDipoleGroupNodes[0]
+};
+
+const NodeSchemaTable &TBB_DipoleGroup::schema() const
+{
+  return nodeSchema;
 }
 
 Attribute<unsigned> TBB_DipoleGroup::stationID()
@@ -547,14 +587,11 @@ vector<TBB_SubbandDataset> TBB_DipoleGroup::subbandDatasets()
   const string sbPrefix("SB_");
   vector<TBB_SubbandDataset> subbandDatasets;
 
-  vector<string> membNames(memberNames());
-  for (vector<string>::const_iterator it(membNames.begin()); it != membNames.end(); ++it) {
-    // Filter the names that appear to be dipoles and fill the vector with objects of the right type.
-    if (it->find(sbPrefix) == 0) {
-      TBB_SubbandDataset subbandDataset(*this, *it);
-      if(subbandDataset.isHDF5DataSet()) {
-        subbandDatasets.push_back(subbandDataset);
-      }
+  vector<MemberInfo> membs(members());
+  for (vector<MemberInfo>::const_iterator it(membs.begin()); it != membs.end(); ++it) {
+    // Filter the names that appear to be subbands and fill the vector with objects of the right type.
+    if (it->type == MemberInfo::DATASET && it->name.find(sbPrefix) == 0) {
+      subbandDatasets.push_back(TBB_SubbandDataset(*this, it->name));
     }
   }
 
@@ -581,35 +618,43 @@ TBB_DipoleDataset::TBB_DipoleDataset( Group &parent, const std::string &name )
 {
 }
 
-void TBB_DipoleDataset::initNodes() {
-  Dataset<short>::initNodes();
-  addNode( new Attribute<unsigned>(*this, "STATION_ID") );
-  addNode( new Attribute<unsigned>(*this, "RSP_ID") );
-  addNode( new Attribute<unsigned>(*this, "RCU_ID") );
-  addNode( new Attribute<double>(*this, "SAMPLE_FREQUENCY") );
-  addNode( new Attribute<string>(*this, "SAMPLE_FREQUENCY_UNIT") );
-  addNode( new Attribute<unsigned>(*this, "TIME") );
-  addNode( new Attribute<unsigned>(*this, "SAMPLE_NUMBER") );
-  addNode( new Attribute<unsigned>(*this, "SLICE_NUMBER") );
-  addNode( new Attribute<unsigned>(*this, "SAMPLES_PER_FRAME") );
-  addNode( new Attribute<unsigned long long>(*this, "DATA_LENGTH") );
-  addNode( new Attribute< vector<Range> >(*this, "FLAG_OFFSETS") );
-  addNode( new Attribute<unsigned>(*this, "NYQUIST_ZONE") );
-  addNode( new Attribute<double>(*this, "CABLE_DELAY") );
-  addNode( new Attribute<string>(*this, "CABLE_DELAY_UNIT") );
-  addNode( new Attribute<double>(*this, "DIPOLE_CALIBRATION_DELAY") );
-  addNode( new Attribute<string>(*this, "DIPOLE_CALIBRATION_DELAY_UNIT") );
-  addNode( new Attribute< vector<complex<double> > >(*this, "DIPOLE_CALIBRATION_DELAY_GAIN_CURVE") );
-  addNode( new Attribute< vector<double> >(*this, "ANTENNA_POSITION") );
-  addNode( new Attribute<string>(*this, "ANTENNA_POSITION_UNIT") );
-  addNode( new Attribute<string>(*this, "ANTENNA_POSITION_FRAME") );
-  addNode( new Attribute< vector<double> >(*this, "ANTENNA_NORMAL_VECTOR") );
-  addNode( new Attribute< vector<double> >(*this, "ANTENNA_ROTATION_MATRIX") );
-  addNode( new Attribute< vector<double> >(*this, "TILE_BEAM") );
-  addNode( new Attribute<string>(*this, "TILE_BEAM_UNIT") );
-  addNode( new Attribute<string>(*this, "TILE_BEAM_FRAME") );
-  addNode( new Attribute<double>(*this, "DISPERSION_MEASURE") );
-  addNode( new Attribute<string>(*this, "DISPERSION_MEASURE_UNIT") );
+static const NodeSchema tbbDipoleDatasetNodes[] = {
+  { "STATION_ID", createNode< Attribute<unsigned> > },
+  { "RSP_ID", createNode< Attribute<unsigned> > },
+  { "RCU_ID", createNode< Attribute<unsigned> > },
+  { "SAMPLE_FREQUENCY", createNode< Attribute<double> > },
+  { "SAMPLE_FREQUENCY_UNIT", createNode< Attribute<string> > },
+  { "TIME", createNode< Attribute<unsigned> > },
+  { "SAMPLE_NUMBER", createNode< Attribute<unsigned> > },
+  { "SLICE_NUMBER", createNode< Attribute<unsigned> > },
+  { "SAMPLES_PER_FRAME", createNode< Attribute<unsigned> > },
+  { "DATA_LENGTH", createNode< Attribute< unsigned long long > > },
+  { "FLAG_OFFSETS", createNode< Attribute< vector<Range> > > },
+  { "NYQUIST_ZONE", createNode< Attribute<unsigned> > },
+  { "CABLE_DELAY", createNode< Attribute<double> > },
+  { "CABLE_DELAY_UNIT", createNode< Attribute<string> > },
+  { "DIPOLE_CALIBRATION_DELAY", createNode< Attribute<double> > },
+  { "DIPOLE_CALIBRATION_DELAY_UNIT", createNode< Attribute<string> > },
+  { "DIPOLE_CALIBRATION_DELAY_GAIN_CURVE", createNode< Attribute< vector<complex<double> > > > },
+  { "ANTENNA_POSITION", createNode< Attribute< vector<double> > > },
+  { "ANTENNA_POSITION_UNIT", createNode< Attribute<string> > },
+  { "ANTENNA_POSITION_FRAME", createNode< Attribute<string> > },
+  { "ANTENNA_NORMAL_VECTOR", createNode< Attribute< vector<double> > > },
+  { "ANTENNA_ROTATION_MATRIX", createNode< Attribute< vector<double> > > },
+  { "TILE_BEAM", createNode< Attribute< vector<double> > > },
+  { "TILE_BEAM_UNIT", createNode< Attribute<string> > },
+  { "TILE_BEAM_FRAME", createNode< Attribute<string> > },
+  { "DISPERSION_MEASURE", createNode< Attribute<double> > },
+  { "DISPERSION_MEASURE_UNIT", createNode< Attribute<string> > }
+};
+
+const NodeSchemaTable TBB_DipoleDataset::nodeSchema = {
+  &Group::nodeSchema, tbbDipoleDatasetNodes, sizeof tbbDipoleDatasetNodes / sizeof tbbDipoleDatasetNodes[0]
+};
+
+const NodeSchemaTable &TBB_DipoleDataset::schema() const
+{
+  return nodeSchema;
 }
 
 Attribute<unsigned> TBB_DipoleDataset::stationID()
@@ -747,26 +792,179 @@ Attribute<string> TBB_DipoleDataset::dispersionMeasureUnit()
   return Attribute<string>(*this, "DISPERSION_MEASURE_UNIT");
 }
 
+//! Bytes to read per block while scanning for lost frames, which bounds the memory used per dipole.
+static const size_t scanBlockBytes = 1024 * 1024;
+
+//! Returns whether all `len` values at `data` are 0.
+static bool allZero( const short *data, size_t len )
+{
+  size_t i = 0;
+
+#ifdef __SSE2__
+  // most frames are not lost, and have a non-zero value early on
+  const __m128i zero = _mm_setzero_si128();
+
+  for (; i + 32 <= len; i += 32) {
+    const __m128i *v = reinterpret_cast<const __m128i *>(data + i);
+    const __m128i any = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(v),     _mm_loadu_si128(v + 1)),
+                                     _mm_or_si128(_mm_loadu_si128(v + 2), _mm_loadu_si128(v + 3)));
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) != 0xFFFF)
+      return false;
+  }
+#endif
+
+  for (; i < len; i++)
+    if (data[i] != 0)
+      return false;
+
+  return true;
+}
+
+/*
+ * Scans `dipole` for lost frames. Reads through `reader` if not NULL, else through HDF5,
+ * holding the HDF5Lock only while reading, so other threads can scan meanwhile.
+ */
+static vector<Range> scanDipole( TBB_DipoleDataset &dipole, const ConcurrentReader<short> *reader, unsigned samplesPerFrame )
+{
+  if (samplesPerFrame == 0)
+    throw DALValueError("Cannot scan for lost frames of 0 samples in dataset " + dipole.name());
+
+  size_t len;
+
+  if (reader) {
+    len = reader->dims1D();
+  } else {
+    HDF5Lock lock;
+    len = dipole.dims1D();
+  }
+
+  const size_t nrFrames = len / samplesPerFrame;
+  const size_t framesPerBlock = max<size_t>(1, scanBlockBytes / (samplesPerFrame * sizeof(short)));
+
+  vector<short> block(min(framesPerBlock, nrFrames) * samplesPerFrame);
+  vector<Range> lost;
+
+  for (size_t frame = 0; frame < nrFrames; frame += framesPerBlock) {
+    const size_t nrBlockFrames = min(framesPerBlock, nrFrames - frame);
+    const size_t pos = frame * samplesPerFrame;
+
+    if (reader) {
+      reader->get1D(pos, &block[0], nrBlockFrames * samplesPerFrame);
+    } else {
+      HDF5Lock lock;
+      dipole.get1D(pos, &block[0], nrBlockFrames * samplesPerFrame);
+    }
+
+    for (size_t f = 0; f < nrBlockFrames; f++) {
+      if (!allZero(&block[f * samplesPerFrame], samplesPerFrame))
+        continue;
+
+      const unsigned long long begin = pos + f * samplesPerFrame;
+      const unsigned long long end = begin + samplesPerFrame;
+
+      if (!lost.empty() && lost.back().end == begin)
+        lost.back().end = end;
+      else
+        lost.push_back(Range(begin, end));
+    }
+  }
+
+  return lost;
+}
+
+vector<Range> TBB_DipoleDataset::scanLostFrames( unsigned samplesPerFrame )
+{
+  return scanLostFramesParallel(vector<TBB_DipoleDataset>(1, *this), samplesPerFrame, 1)[0];
+}
+
+struct ScanTasks: public ParallelTasks {
+  ScanTasks( vector<TBB_DipoleDataset> &dipoles, const vector<const ConcurrentReader<short> *> &readers,
+             unsigned samplesPerFrame, vector< vector<Range> > &results )
+  :
+    dipoles(dipoles),
+    readers(readers),
+    samplesPerFrame(samplesPerFrame),
+    results(results)
+  {
+  }
+
+  virtual void run( size_t i )
+  {
+    results[i] = scanDipole(dipoles[i], readers[i], samplesPerFrame);
+  }
+
+  vector<TBB_DipoleDataset> &dipoles;
+  const vector<const ConcurrentReader<short> *> &readers;
+  const unsigned samplesPerFrame;
+  vector< vector<Range> > &results;
+};
+
+vector< vector<Range> > TBB_DipoleDataset::scanLostFramesParallel( const vector<TBB_DipoleDataset> &dipoleDatasets,
+        unsigned samplesPerFrame, unsigned nrThreads )
+{
+  // read the raw data directly where possible
+  vector<TBB_DipoleDataset> dipoles;
+  vector< ConcurrentReader<short> > readerStore;
+  vector<const ConcurrentReader<short> *> readers(dipoleDatasets.size(), static_cast<const ConcurrentReader<short> *>(NULL));
+  vector<size_t> readerIndex;
+
+  {
+    HDF5Lock lock;
+
+    // copies share the HDF5 objects; copy here, as copying calls HDF5
+    dipoles = dipoleDatasets;
+
+    readerStore.reserve(dipoles.size());
+    for (size_t i = 0; i < dipoles.size(); i++) {
+      try {
+        readerStore.push_back(ConcurrentReader<short>(dipoles[i]));
+        readerIndex.push_back(i);
+      } catch (DALValueError &) {
+        // not in native format in external files: read through HDF5
+      }
+    }
+  }
+
+  for (size_t r = 0; r < readerIndex.size(); r++)
+    readers[readerIndex[r]] = &readerStore[r];
+
+  vector< vector<Range> > results(dipoles.size());
+
+  ScanTasks tasks(dipoles, readers, samplesPerFrame, results);
+  runTasks(tasks, dipoles.size(), nrThreads);
+
+  return results;
+}
+
 TBB_SubbandDataset::TBB_SubbandDataset( Group &parent, const std::string &name )
 :
   Dataset< std::complex< int16_t > >(parent, name)
 {
 }
 
-void TBB_SubbandDataset::initNodes() {
-  Dataset< std::complex< int16_t > >::initNodes();
-  addNode( new Attribute<unsigned>(*this, "TIME") );
-  addNode( new Attribute<double>(*this, "CENTRAL_FREQUENCY") );
-  addNode( new Attribute<string>(*this, "CENTRAL_FREQUENCY_UNIT") );
-  addNode( new Attribute<double>(*this, "BANDWIDTH") );
-  addNode( new Attribute<string>(*this, "BANDWIDTH_UNIT") );
-  addNode( new Attribute<double>(*this, "TIME_RESOLUTION") );
-  addNode( new Attribute<string>(*this, "TIME_RESOLUTION_UNIT") );
-  addNode( new Attribute<unsigned>(*this, "BAND_NUMBER") );
-  addNode( new Attribute<unsigned>(*this, "SLICE_NUMBER") );
-  addNode( new Attribute<unsigned>(*this, "SAMPLES_PER_FRAME") );
-  addNode( new Attribute<unsigned long long>(*this, "DATA_LENGTH") );
-  addNode( new Attribute< vector<Range> >(*this, "FLAG_OFFSETS") );
+static const NodeSchema tbbSubbandDatasetNodes[] = {
+  { "TIME", createNode< Attribute<unsigned> > },
+  { "CENTRAL_FREQUENCY", createNode< Attribute<double> > },
+  { "CENTRAL_FREQUENCY_UNIT", createNode< Attribute<string> > },
+  { "BANDWIDTH", createNode< Attribute<double> > },
+  { "BANDWIDTH_UNIT", createNode< Attribute<string> > },
+  { "TIME_RESOLUTION", createNode< Attribute<double> > },
+  { "TIME_RESOLUTION_UNIT", createNode< Attribute<string> > },
+  { "BAND_NUMBER", createNode< Attribute<unsigned> > },
+  { "SLICE_NUMBER", createNode< Attribute<unsigned> > },
+  { "SAMPLES_PER_FRAME", createNode< Attribute<unsigned> > },
+  { "DATA_LENGTH", createNode< Attribute< unsigned long long > > },
+  { "FLAG_OFFSETS", createNode< Attribute< vector<Range> > > }
+};
+
+const NodeSchemaTable TBB_SubbandDataset::nodeSchema = {
+  &Group::nodeSchema, tbbSubbandDatasetNodes, sizeof tbbSubbandDatasetNodes / sizeof tbbSubbandDatasetNodes[0]
+};
+
+const NodeSchemaTable &TBB_SubbandDataset::schema() const
+{
+  return nodeSchema;
 }
 
 Attribute<unsigned> TBB_SubbandDataset::time()
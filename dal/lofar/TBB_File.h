@@ -43,15 +43,20 @@ public:
   TBB_File();
 
   /*!
-   * Open `filename` for reading/writing/creation.
+   * Open `filename` for reading/writing/creation, accessing it with the HDF5 settings in `options`.
    */
-  TBB_File( const std::string &filename, FileMode mode = READ );
+  TBB_File( const std::string &filename, FileMode mode = READ, const FileAccessOptions &options = FileAccessOptions() );
 
   virtual ~TBB_File();
 
-  virtual void open( const std::string &filename, FileMode mode = READ );
+  virtual void open( const std::string &filename, FileMode mode = READ, const FileAccessOptions &options = FileAccessOptions() );
   virtual void close();
 
+  /*!
+   * Throws a DALException if this file is not a TBB file (see CLA_File::checkFileType()).
+   */
+  virtual void checkFileType();
+
   /*! operatingMode() returns the operatingMode in which the TBB data was recorded.
    * This can be either "transient" (since v1.0) or "spectral" (since v3.0)
    */
@@ -64,9 +69,13 @@ public:
 
   virtual TBB_Trigger    trigger();
 
+protected:
+  static const NodeSchemaTable nodeSchema;
+  virtual const NodeSchemaTable &schema() const;
+
 private:
-  void                   openFile( FileMode mode );
-  void                   initFileNodes();
+  void                   openFile( FileMode mode, bool deferChecks );
+  void                   checkTbbFileType();
 
   std::string            stationGroupName( const std::string &stationName );
 };
@@ -102,7 +111,8 @@ public:
   Attribute<std::string>            additionalInfo();
 
 protected:
-  virtual void           initNodes();
+  static const NodeSchemaTable nodeSchema;
+  virtual const NodeSchemaTable &schema() const;
 };
 
 class TBB_Station: public Group {
@@ -140,7 +150,8 @@ private:
   std::string                           dipoleDatasetName( unsigned stationID, unsigned rspID, unsigned rcuID );
 
 protected:
-  virtual void                          initNodes();
+  static const NodeSchemaTable nodeSchema;
+  virtual const NodeSchemaTable &schema() const;
 };
 
 /*!
@@ -225,7 +236,8 @@ private:
   std::string                           subbandDatasetName( unsigned subband_nr );
 
 protected:
-  virtual void                          initNodes();
+  static const NodeSchemaTable nodeSchema;
+  virtual const NodeSchemaTable &schema() const;
 };
 
 
@@ -271,8 +283,27 @@ public:
   virtual Attribute<double>                     dispersionMeasure();
   virtual Attribute<std::string>                dispersionMeasureUnit();
 
+  /*!
+   * Returns the sample ranges of all frames of `samplesPerFrame` samples that contain only zeros,
+   * which is how lost frames are stored. Frames are counted from the start of the dataset;
+   * adjacent lost frames are merged into a single range. A trailing partial frame is not scanned.
+   * The result can be stored as is in flagOffsets().
+   *
+   * The dataset is read in blocks of about 1 MiB, bypassing HDF5 if it is stored in external raw files.
+   */
+  std::vector<Range> scanLostFrames( unsigned samplesPerFrame = 1024 );
+
+  /*!
+   * Runs scanLostFrames() on all `dipoles` using `nrThreads` threads, and returns the results
+   * in the same order. Dipoles stored in external raw files are read in parallel; others are read
+   * one block at a time through HDF5 (see HDF5Lock), while the scanning is done in parallel.
+   */
+  static std::vector< std::vector<Range> > scanLostFramesParallel( const std::vector<TBB_DipoleDataset> &dipoles,
+                                                                    unsigned samplesPerFrame = 1024, unsigned nrThreads = 4 );
+
 protected:
-  virtual void                          initNodes();
+  static const NodeSchemaTable nodeSchema;
+  virtual const NodeSchemaTable &schema() const;
 };
 
 class TBB_SubbandDataset: public Dataset<std::complex < int16_t > > {
@@ -293,7 +324,8 @@ public:
   Attribute< std::vector<Range> >       flagOffsets();
 
 protected:
-  virtual void                          initNodes();
+  static const NodeSchemaTable nodeSchema;
+  virtual const NodeSchemaTable &schema() const;
 };
 
 }
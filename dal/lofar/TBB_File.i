@@ -3,5 +3,24 @@ vector_typemap( dal::TBB_DipoleGroup );
 vector_typemap( dal::TBB_DipoleDataset );
 vector_typemap( dal::TBB_SubbandDataset );
 
+// TBB_DipoleDataset::scanLostFramesParallel() returns a list of lists of Range
+%typemap(out) std::vector< std::vector<dal::Range> > {
+  const size_t size = $1.size();
+
+  $result = PyList_New(size);
+
+  for( size_t i = 0; i < size; i++ ) {
+    const std::vector<dal::Range> &ranges = $1.operator[](i);
+    PyObject *py_list = PyList_New(ranges.size());
+
+    for( size_t j = 0; j < ranges.size(); j++ ) {
+      dal::Range *cpp_obj = new dal::Range(ranges[j]);
+      PyList_SET_ITEM(py_list, j, SWIG_NewPointerObj(cpp_obj, $descriptor( dal::Range* ), 1));
+    }
+
+    PyList_SET_ITEM($result, i, py_list);
+  }
+}
+
 %include dal/lofar/TBB_File.h
 
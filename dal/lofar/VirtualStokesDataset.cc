@@ -0,0 +1,279 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "VirtualStokesDataset.h"
+#include "../hdf5/types/ParallelTasks.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <utility>
+#include <glob.h>
+
+using namespace std;
+
+namespace dal {
+
+/*
+ * Extracts the Stokes and part numbers from a file name containing _S<stokes>_P<part>.
+ * Returns false if the name does not contain them.
+ */
+static bool parseStokesPart( const string &filename, unsigned &stokesNr, unsigned &partNr )
+{
+  const string basename = FileInfo::getBasename(filename);
+
+  // use the last match, in case the observation prefix contains a similar pattern
+  for (size_t i = basename.rfind("_S"); i != string::npos; i = i == 0 ? string::npos : basename.rfind("_S", i - 1)) {
+    char next;
+
+    if (sscanf(basename.c_str() + i, "_S%u_P%u%c", &stokesNr, &partNr, &next) == 3 && next == '_')
+      return true;
+  }
+
+  return false;
+}
+
+VirtualStokesDataset::VirtualStokesDataset( const std::vector<std::string> &filenames, unsigned sapNr, unsigned beamNr,
+                                            const FileAccessOptions &options )
+:
+  _nofSamples(0)
+{
+  if (filenames.empty())
+    throw DALValueError("Cannot create virtual Stokes dataset without files");
+
+  // (stokes, part) -> file name
+  map<pair<unsigned, unsigned>, string> names;
+
+  for (size_t i = 0; i < filenames.size(); i++) {
+    unsigned stokesNr, partNr;
+
+    if (!parseStokesPart(filenames[i], stokesNr, partNr))
+      throw DALValueError("Cannot determine Stokes and part number of file " + filenames[i]);
+
+    if (!names.insert(make_pair(make_pair(stokesNr, partNr), filenames[i])).second)
+      throw DALValueError("Cannot create virtual Stokes dataset from two files with the same Stokes and part numbers: " + filenames[i]);
+
+    stokesNrs.push_back(stokesNr);
+    partNrs.push_back(partNr);
+  }
+
+  sort(stokesNrs.begin(), stokesNrs.end());
+  stokesNrs.erase(unique(stokesNrs.begin(), stokesNrs.end()), stokesNrs.end());
+  sort(partNrs.begin(), partNrs.end());
+  partNrs.erase(unique(partNrs.begin(), partNrs.end()), partNrs.end());
+
+  if (names.size() != stokesNrs.size() * partNrs.size())
+    throw DALValueError("Cannot create virtual Stokes dataset: not every Stokes parameter has the same parts");
+
+  partChannels.resize(partNrs.size() + 1, 0);
+
+  for (size_t s = 0; s < stokesNrs.size(); s++) {
+    for (size_t p = 0; p < partNrs.size(); p++) {
+      const string &filename = names[make_pair(stokesNrs[s], partNrs[p])];
+
+      BF_File file(filename, BF_File::READ, options);
+      BF_SubArrayPointing sap = file.subArrayPointing(sapNr);
+      BF_BeamGroup beam = sap.beam(beamNr);
+      BF_StokesDataset dataset = beam.stokes(stokesNrs[s]);
+
+      if (!dataset.exists())
+        throw DALValueError("Could not find Stokes dataset " + dataset.name() + " in file " + filename);
+
+      const vector<ssize_t> dims = dataset.dims();
+
+      if (dims.size() != 2)
+        throw DALValueError("Cannot use Stokes dataset that is not 2D in file " + filename);
+
+      if (s == 0)
+        partChannels[p + 1] = partChannels[p] + dims[1];
+      else if ((size_t)dims[1] != partChannels[p + 1] - partChannels[p])
+        throw DALValueError("Cannot use Stokes dataset with a different number of channels than the other Stokes parameters in file " + filename);
+
+      if (this->filenames.empty() || (size_t)dims[0] < _nofSamples)
+        _nofSamples = dims[0];
+
+      this->filenames.push_back(filename);
+      files.push_back(file);
+      datasets.push_back(dataset);
+    }
+  }
+}
+
+std::vector<std::string> VirtualStokesDataset::findFiles( const std::string &prefix )
+{
+  const string pattern = prefix + "_S*_P*_bf.h5";
+
+  glob_t matches;
+  vector<string> result;
+
+  const int status = glob(pattern.c_str(), 0, NULL, &matches);
+
+  if (status == GLOB_NOMATCH)
+    return result;
+
+  if (status != 0)
+    throw DALException("Could not search for files " + pattern);
+
+  for (size_t i = 0; i < matches.gl_pathc; i++)
+    result.push_back(matches.gl_pathv[i]);
+
+  globfree(&matches);
+
+  return result;
+}
+
+std::vector<size_t> VirtualStokesDataset::dims() const
+{
+  vector<size_t> result(3);
+  result[0] = nofStokes();
+  result[1] = nofSamples();
+  result[2] = nofChannels();
+
+  return result;
+}
+
+const std::string &VirtualStokesDataset::filename( size_t stokes, size_t part ) const
+{
+  if (stokes >= nofStokes() || part >= nofParts())
+    throw DALIndexError("Stokes or part index out of range for virtual Stokes dataset");
+
+  return filenames[stokes * nofParts() + part];
+}
+
+/*
+ * Copies `nrRows` rows of `rowLength` values from `src` to `dst`. The rows
+ * are `srcStride` resp. `dstStride` values apart.
+ */
+struct RowCopy {
+  const float *src;
+  float *dst;
+  size_t srcStride, dstStride;
+  size_t rowLength;
+  size_t nrRows;
+};
+
+struct RowCopyTasks: public ParallelTasks {
+  RowCopyTasks( const vector<RowCopy> &copies )
+  :
+    copies(copies)
+  {
+  }
+
+  virtual void run( size_t i )
+  {
+    const RowCopy &copy = copies[i];
+
+    // reading from mapped files, this is where the file I/O happens
+    for (size_t r = 0; r < copy.nrRows; r++)
+      memcpy(copy.dst + r * copy.dstStride, copy.src + r * copy.srcStride, copy.rowLength * sizeof(float));
+  }
+
+  const vector<RowCopy> &copies;
+};
+
+void VirtualStokesDataset::getMatrix( const std::vector<size_t> &pos, float *buffer, const std::vector<size_t> &size,
+                                      unsigned nrThreads )
+{
+  if (pos.size() != 3 || size.size() != 3)
+    throw DALValueError("Cannot read from virtual Stokes dataset if position or size is not 3D");
+
+  const vector<size_t> d = dims();
+
+  for (size_t i = 0; i < 3; i++)
+    if (pos[i] > d[i] || size[i] > d[i] - pos[i])
+      throw DALIndexError("Cannot read beyond the dimensions of virtual Stokes dataset");
+
+  if (size[0] == 0 || size[1] == 0 || size[2] == 0)
+    return;
+
+  // each copy is split into pieces of about this size, to spread the work over the threads
+  const size_t pieceBytes = 1024 * 1024;
+
+  vector< MappedRegion<float> > regions;
+  list< vector<float> > readBuffers; // a list, so that the buffers do not move
+  vector<RowCopy> copies;
+
+  const size_t channelBegin = pos[2], channelEnd = pos[2] + size[2];
+
+  for (size_t s = pos[0]; s < pos[0] + size[0]; s++) {
+    for (size_t p = 0; p < nofParts(); p++) {
+      const size_t partBegin = partChannels[p], partEnd = partChannels[p + 1];
+
+      if (partEnd <= channelBegin || partBegin >= channelEnd)
+        continue;
+
+      BF_StokesDataset &dataset = datasets[s * nofParts() + p];
+      const size_t partLength = partEnd - partBegin;
+      const size_t first = max(channelBegin, partBegin), last = min(channelEnd, partEnd);
+
+      RowCopy copy;
+      copy.dst = buffer + ((s - pos[0]) * size[1]) * size[2] + (first - channelBegin);
+      copy.dstStride = size[2];
+      copy.rowLength = last - first;
+
+      try {
+        // map all channels of the samples, and copy the ones requested
+        regions.push_back(dataset.mapRegion(pos[1] * partLength, size[1] * partLength));
+
+        copy.src = regions.back().data() + (first - partBegin);
+        copy.srcStride = partLength;
+      } catch (DALValueError &) {
+        // the data cannot be mapped, so read it through HDF5
+        vector<size_t> blockPos(2), blockSize(2);
+        blockPos[0] = pos[1];
+        blockPos[1] = first - partBegin;
+        blockSize[0] = size[1];
+        blockSize[1] = last - first;
+
+        readBuffers.push_back(vector<float>());
+        readBuffers.back().resize(blockSize[0] * blockSize[1]);
+        dataset.getMatrix(blockPos, &readBuffers.back()[0], blockSize);
+
+        copy.src = &readBuffers.back()[0];
+        copy.srcStride = last - first;
+      }
+
+      const size_t rowsPerPiece = max<size_t>(1, pieceBytes / (copy.srcStride * sizeof(float)));
+
+      for (size_t r = 0; r < size[1]; r += rowsPerPiece) {
+        RowCopy piece(copy);
+        piece.src += r * copy.srcStride;
+        piece.dst += r * copy.dstStride;
+        piece.nrRows = min(rowsPerPiece, size[1] - r);
+
+        copies.push_back(piece);
+      }
+    }
+  }
+
+  RowCopyTasks tasks(copies);
+  runTasks(tasks, copies.size(), nrThreads);
+}
+
+void VirtualStokesDataset::get3D( const std::vector<size_t> &pos, float *outbuffer3, size_t dim1, size_t dim2, size_t dim3 )
+{
+  vector<size_t> size(3);
+  size[0] = dim1;
+  size[1] = dim2;
+  size[2] = dim3;
+
+  getMatrix(pos, outbuffer3, size);
+}
+
+}
+
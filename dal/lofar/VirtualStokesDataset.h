@@ -0,0 +1,129 @@
+/* Copyright 2011-2012  ASTRON, Netherlands Institute for Radio Astronomy
+ * This file is part of the Data Access Library (DAL).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either 
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DAL_VIRTUAL_STOKES_DATASET_H
+#define DAL_VIRTUAL_STOKES_DATASET_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "BF_File.h"
+
+namespace dal {
+
+/*!
+ * \class VirtualStokesDataset
+ *
+ * Presents the Stokes datasets of one beam, stored in files split by Stokes parameter
+ * and by frequency part, as a single read-only array. The files are named as
+ * L<obsid>_SAP<sap>_B<beam>_S<stokes>_P<part>_bf.h5, and each file holds the
+ * dataset STOKES_<stokes> of beam `beamNr` in sub-array pointing `sapNr`.
+ *
+ * The array has dimensions (stokes, time, frequency): a stack of time x frequency
+ * arrays, one per Stokes parameter. The frequency axis concatenates the channels of
+ * the parts, in the order of their part numbers. The time axis is as long as the
+ * shortest file.
+ *
+ * Reads are split over the files. Data stored in external raw files in native byte order
+ * is mapped into memory and copied by several threads at once, so that the files are read
+ * in parallel. Other data is read through HDF5, one file at a time.
+ *
+ * C++ example:
+ * \code
+ *    VirtualStokesDataset stokes(VirtualStokesDataset::findFiles("L12345_SAP000_B000"));
+ *
+ *    // read the first 1024 samples of all channels of Stokes I
+ *    std::vector<size_t> pos(3, 0), size(3);
+ *    size[0] = 1;
+ *    size[1] = 1024;
+ *    size[2] = stokes.nofChannels();
+ *
+ *    std::vector<float> data(size[0] * size[1] * size[2]);
+ *    stokes.getMatrix(pos, &data[0], size);
+ * \endcode
+ */
+class VirtualStokesDataset {
+public:
+  /*!
+   * Opens the files `filenames`, each named with their Stokes parameter and part number
+   * (_S<stokes>_P<part>). Every Stokes parameter must be present for the same parts.
+   * The files are opened with `options`.
+   */
+  VirtualStokesDataset( const std::vector<std::string> &filenames, unsigned sapNr = 0, unsigned beamNr = 0,
+                        const FileAccessOptions &options = FileAccessOptions() );
+
+  /*!
+   * Returns the names of the files <prefix>_S*_P*_bf.h5, for example for prefix
+   * "/data/L12345_SAP000_B000".
+   */
+  static std::vector<std::string> findFiles( const std::string &prefix );
+
+  //! Returns the dimensions: (nofStokes(), nofSamples(), nofChannels()).
+  std::vector<size_t> dims() const;
+
+  size_t nofStokes() const { return stokesNrs.size(); }
+  size_t nofSamples() const { return _nofSamples; }
+  size_t nofChannels() const { return partChannels.back(); }
+  size_t nofParts() const { return partNrs.size(); }
+
+  //! Returns the Stokes number (the S in the file names) of each Stokes index.
+  const std::vector<unsigned> &stokesNumbers() const { return stokesNrs; }
+
+  //! Returns the part number (the P in the file names) of each part index.
+  const std::vector<unsigned> &partNumbers() const { return partNrs; }
+
+  //! Returns the index of the first channel of part index `part`.
+  size_t firstChannel( size_t part ) const { return partChannels.at(part); }
+
+  //! Returns the name of the file holding Stokes index `stokes` and part index `part`.
+  const std::string &filename( size_t stokes, size_t part ) const;
+
+  /*!
+   * Reads the block of sizes `size` at position `pos` (stokes, time, frequency)
+   * into `buffer`, in row-major order, using up to `nrThreads` threads.
+   *
+   * Requires:
+   *    - pos.size() == size.size() == 3
+   *    - pos + size <= dims()
+   */
+  void getMatrix( const std::vector<size_t> &pos, float *buffer, const std::vector<size_t> &size,
+                  unsigned nrThreads = 4 );
+
+  /*!
+   * Reads a block of dim1 x dim2 x dim3 values at position `pos` into `outbuffer3`.
+   * See getMatrix().
+   */
+  void get3D( const std::vector<size_t> &pos, float *outbuffer3, size_t dim1, size_t dim2, size_t dim3 );
+
+private:
+  //! Files and datasets, indexed by stokes * nofParts() + part.
+  std::vector<std::string> filenames;
+  std::vector<BF_File> files;
+  std::vector<BF_StokesDataset> datasets;
+
+  std::vector<unsigned> stokesNrs;
+  std::vector<unsigned> partNrs;
+
+  //! First channel of each part, followed by the total number of channels.
+  std::vector<size_t> partChannels;
+
+  size_t _nofSamples;
+};
+
+}
+
+#endif
+
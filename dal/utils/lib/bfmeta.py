@@ -46,6 +46,7 @@ class bfmeta:
     if self.level < 1:
       print "ROOT"
       return
+    self.fh.loadAttributes()        # read all attributes at once
     print self.fh.groupType().name(), "\t\t=", self.fh.groupType().value
     print self.fh.fileName().name(), "\t\t=", self.fh.fileName().value
     print self.fh.fileDate().name(), "\t\t=", self.fh.fileDate().value
@@ -134,10 +135,12 @@ class bfmeta:
 
         if self.fh.subArrayPointing(nr).exists():
           sap=self.fh.subArrayPointing(nr)
+          sap.loadAttributes()        # read all attributes at once
           self.displayBeam(sap)
         return
       if str(nr) in self.sap or self.sap=="all":
         sap=self.fh.subArrayPointing(nr)
+        sap.loadAttributes()        # read all attributes at once
         print self.prefix + "------------------------------------"
         print self.prefix + "SUB_ARRAY_POINTING_%(nr)03d" %{'nr': nr}
       else:
@@ -208,6 +211,7 @@ class bfmeta:
     # Check if this beam exists in this SAP
     if sap.beam(nr).exists() and (str(nr) == self.beam or self.beam=="all"):
       beam=sap.beam(nr)
+      beam.loadAttributes()        # read all attributes at once
       if self.level < 3:            # display tree
         if self.useColor:
           print bcolors.BEAM + "         |"
@@ -308,6 +312,7 @@ class bfmeta:
 
     if beam.stokes(nr).exists():
       stokes=beam.stokes(nr)
+      stokes.loadAttributes()        # read all attributes at once
       if self.stokes == "all" or stokes.stokesComponent().value == self.stokes:
         if self.level < 4:
           if self.useTabs:
@@ -319,6 +324,7 @@ class bfmeta:
           return
         else:
           stokes=beam.stokes(nr)
+          stokes.loadAttributes()        # read all attributes at once
           print self.prefix + "------------------------------------"
           print self.prefix + stokes.stokesComponent().name() + "\t=", stokes.stokesComponent().value    
           print self.prefix + stokes.dataType().name() + "\t\t=", stokes.dataType().value    
@@ -348,6 +354,7 @@ class bfmeta:
         print bcolors.COORD + "                |"
         print bcolors.COORD + "                COORDINATES"
       coords=beam.coordinates()
+      coords.loadAttributes()        # read all attributes at once
       for c in range(0, coords.nofCoordinates().value):
         self.displayCoordinate(coords, c)
       return
@@ -357,6 +364,7 @@ class bfmeta:
       return
     else:
       coords=beam.coordinates()
+      coords.loadAttributes()        # read all attributes at once
       # This is buggy in the Swig bindings
       print self.prefix + coords.groupType().name() + "\t\t=", coords.groupType().value
       print self.prefix + coords.refLocationValue().name() + "\t=", coords.refLocationValue().value, coords.refLocationUnit().value
@@ -398,6 +406,7 @@ class bfmeta:
       return
     else:
       coord=coords.coordinate(nr)         # pick coordinate
+      coord.loadAttributes()        # read all attributes at once
       # Common coordinate attributes
       print self.prefix + coord.groupType().name() + "\t\t=", coord.groupType().value
       print self.prefix + coord.coordinateType().name() + "\t\t=", coord.coordinateType().value
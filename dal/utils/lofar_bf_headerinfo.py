@@ -40,7 +40,8 @@ def main():
     sys.exit()
   else:
     filename=args[0]
-    fh=dal.BF_File(filename)      # open file
+    fh=dal.BF_File(filename, dal.File.READ, dal.FileAccessOptions.headerScan()) # open file
+    fh.loadIndex()                # serve the headers from a sidecar index, if present and up to date
 
     dal.bfmeta(fh, tabs=options.tabs, color=options.color, sap=options.sap, beam=options.beam, stokes=options.stokes, level=options.level) #verbose=options.verbose)
 
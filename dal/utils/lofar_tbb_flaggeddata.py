@@ -2,6 +2,7 @@
 #
 # lofar_tbb_flaggeddata.py
 # Python script that searches for frame payload sized sequences of zeros in TBB transient data in LOFAR HDF5 files.
+# The scanning is done by TBB_DipoleDataset.scanLostFramesParallel() in the DAL.
 #
 # File:         lofar_tbb_flaggeddata
 # Author:       Alexander S. van Amesfoort (amesfoort_at_astron.nl)
@@ -9,60 +10,59 @@
 # Last change:  2012-08-15
 
 import sys
-import numpy
 import dal
 
-def get_lost_frame_nrs(data, block_len):
+NR_THREADS = 8
+
+def get_lost_frame_nrs(lost_ranges, block_len):
 	lost_frame_nrs = [ ]
 
-	offset = 0
-	nr_zeros_seen = 0
-	while offset < len(data):
-		if data[offset] != 0:
-			offset += block_len - nr_zeros_seen
-			nr_zeros_seen = 0
-		else:
-			nr_zeros_seen += 1
-			if nr_zeros_seen == block_len:
-				lost_frame_nrs.append(offset / block_len)
-				nr_zeros_seen = 0
-			offset += 1
+	for r in lost_ranges:
+		lost_frame_nrs.extend(range(r.begin // block_len, r.end // block_len))
 
 	return lost_frame_nrs
 
 def print_lost_frame_nrs(filename):
 	fh = dal.TBB_File(filename)
 
-	datasets_found = False
+	# (station, dipole) pairs, in file order
+	dipoles = [ ]
+	for st in fh.stations():
+		for dp in st.dipoles():
+			dipoles.append((st, dp))
+
+	# Not always available when this program was written, but will be always there.
+	# Use .get() instead of .value to have an exc raised instead of None returned.
+	block_lens = [ ]
+	for st, dp in dipoles:
+		block_len = dp.samplesPerFrame().value
+		if block_len is None:
+			block_len = 1024 # the TBBs always send 1024 samples/frame for transient data
+		block_lens.append(block_len)
+
+	# scan all dipoles with the same frame size in parallel
+	lost = [ None ] * len(dipoles)
+	for block_len in set(block_lens):
+		idxs = [ i for i in range(len(dipoles)) if block_lens[i] == block_len ]
+		results = dal.TBB_DipoleDataset.scanLostFramesParallel([ dipoles[i][1] for i in idxs ], block_len, NR_THREADS)
+		for i, result in zip(idxs, results):
+			lost[i] = result
+
 	total_frames = 0
 	total_lost = 0
 
-	station_groups = fh.stations();
-	for st in station_groups:
-		dipole_datasets = st.dipoles();
-		for dp in dipole_datasets:
-			datasets_found = True
-			data_len = dp.dims1D() # actual data len; should be equal to dp.dataLength().get()
-			data = numpy.zeros((data_len, ), dtype=dp.dtype)
-			#data = numpy.array(dp, dtype=dp.dtype) # only works if Python binding of TBB_DipoleDataset exposes the array interface, __array__ returns an array or any (nested) sequence.
-			start_idx = 0
-			dp.get1D(start_idx, data)
-
-			# Not always available when this program was written, but will be always there.
-			# Use .get() instead of .value to have an exc raised instead of None returned.
-			block_len = dp.samplesPerFrame().value
-			if block_len is None:
-				block_len = 1024 # the TBBs always send 1024 samples/frame for transient data
-			total_frames += (data_len + block_len-1) // block_len # add rounded up #frames
-			dp_lost_frame_nrs = get_lost_frame_nrs(data, block_len)
-			if dp_lost_frame_nrs: # Does not account for missing frames at the end. We'd have to max(<len(any dipole datasets)>) and even then we could miss the true max.
-				total_lost += len(dp_lost_frame_nrs)
-				print 'Station', st.stationName().value, 'rsp', str(dp.rspID().value), 'rcu', str(dp.rcuID().value) + ':', 'numbers of zeroed frames of', str(block_len), 'values each:'
-				for frame_nr in dp_lost_frame_nrs:
-					print frame_nr,
-				print
-
-	if not datasets_found:
+	for (st, dp), block_len, lost_ranges in zip(dipoles, block_lens, lost):
+		data_len = dp.dims1D() # actual data len; should be equal to dp.dataLength().get()
+		total_frames += (data_len + block_len-1) // block_len # add rounded up #frames
+		dp_lost_frame_nrs = get_lost_frame_nrs(lost_ranges, block_len)
+		if dp_lost_frame_nrs: # Does not account for missing frames at the end. We'd have to max(<len(any dipole datasets)>) and even then we could miss the true max.
+			total_lost += len(dp_lost_frame_nrs)
+			print 'Station', st.stationName().value, 'rsp', str(dp.rspID().value), 'rcu', str(dp.rcuID().value) + ':', 'numbers of zeroed frames of', str(block_len), 'values each:'
+			for frame_nr in dp_lost_frame_nrs:
+				print frame_nr,
+			print
+
+	if not dipoles:
 		print 'Warning: no dipole datasets found in filename', filename
 		print
 
@@ -107,16 +107,15 @@ def print_basic_dipole_info(dp):
 	datalen = dp.dataLength().value
 	print dp.dataLength().name(), '\t\t\t=', datalen
 
-	nflaggedSamp = 0 # i.e. for this dipole
-	for flrange in dp.flagOffsets().value:
-		nflaggedSamp += flrange.end - flrange.begin
+	nflaggedSamp = dal.RangeSet(dp.flagOffsets()).count() # i.e. for this dipole; overlapping ranges count once
 	print dp.flagOffsets().name(), 'summary\t\t=', nflaggedSamp, '(' + str(100.0 * nflaggedSamp / datalen) + '%)'
 
 	print dp.nyquistZone().name(), '\t\t\t=', dp.nyquistZone().value
 	print dp.dispersionMeasure().name(), '\t\t=', dp.dispersionMeasure().value, dp.dispersionMeasureUnit().value
 
 def print_tbb_header(filename):
-	fh = dal.TBB_File(filename)
+	fh = dal.TBB_File(filename, dal.File.READ, dal.FileAccessOptions.headerScan())
+	fh.loadIndex() # serve the headers from a sidecar index, if present and up to date
 	print_cla(fh)
 	print_tbb_root(fh)
 	print
@@ -0,0 +1,146 @@
+/*
+ * Check that attribute writes are staged while write batching is enabled, and committed on flush, reads
+ * and destruction of the last object of the file.
+ * Build: c++ -Wall attribute-batch.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <hdf5.h>
+#include <dal/hdf5/File.h>
+
+using namespace std;
+
+// Returns whether attribute `name` of `group` exists on disk, bypassing DAL.
+static bool onDisk(const char *filename, const char *group, const char *name) {
+	hid_t file = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (file < 0)
+		return false;
+
+	bool result = H5Aexists_by_name(file, group, name, H5P_DEFAULT) > 0;
+	H5Fclose(file);
+	return result;
+}
+
+int main() {
+	int err = 0;
+	const char filename[] = "attribute-batch.h5";
+
+	{
+		dal::File f(filename, dal::File::CREATE);
+		dal::Group g(f, "GROUP");
+		g.create();
+		f.flush();
+
+		f.setWriteBatching(true);
+
+		dal::Attribute<int> i(g, "INT");
+		i.value = 1;
+		i.value = 42; // restaged
+		dal::Attribute<string>(g, "STRING").value = "hello";
+		dal::Attribute< vector<double> >(g, "DOUBLES").value = vector<double>(5, 0.25);
+		dal::Attribute< vector<string> >(g, "STRINGS").value = vector<string>(3, "world");
+		dal::Attribute< vector<int> >(g, "EMPTY").value = vector<int>();
+		dal::Attribute<float>(f, "CREATED").create();
+
+		if (!i.exists()) {
+			cerr << "staged attribute does not exist" << endl;
+			err = 1;
+		}
+		if (onDisk(filename, "GROUP", "INT")) {
+			cerr << "attribute written while batching" << endl;
+			err = 1;
+		}
+
+		f.flush();
+
+		if (!onDisk(filename, "GROUP", "INT") || !onDisk(filename, "/", "CREATED")) {
+			cerr << "attributes not written on flush" << endl;
+			err = 1;
+		}
+
+		// staged writes are committed before they are read back
+		i.value = 43;
+		if (i.get() != 43) {
+			cerr << "wrong INT after commit on read: " << i.get() << endl;
+			err = 1;
+		}
+
+		dal::Attribute<string>(g, "LAST").value = "written on close";
+		f.close();
+	}
+
+	// objects that refer to the same group stage into the same group, and the last write wins
+	{
+		dal::File f(filename, dal::File::READWRITE);
+		f.setWriteBatching(true);
+
+		dal::Group a(f, "GROUP"), b(f, "GROUP");
+		dal::Attribute<int>(a, "SHARED").value = 1;
+
+		if (!dal::Attribute<int>(b, "SHARED").exists()) {
+			cerr << "attribute staged through one group object does not exist through another" << endl;
+			err = 1;
+		}
+
+		dal::Attribute<int>(b, "SHARED").value = 2;
+		dal::Attribute<int>(a, "SHARED").value = 3;
+		f.flush();
+	}
+
+	// staged writes are committed once the last object of the file is gone, even if that is not a File
+	{
+		dal::Group *held;
+		{
+			dal::File f(filename, dal::File::READWRITE);
+			f.setWriteBatching(true);
+			held = new dal::Group(f, "GROUP");
+		}
+
+		dal::Attribute<int>(*held, "HELD").value = 7;
+		delete held;
+	}
+
+	dal::File f(filename, dal::File::READ);
+	dal::Group g(f, "GROUP");
+
+	if (dal::Attribute<int>(g, "INT").get() != 43) {
+		cerr << "wrong INT" << endl;
+		err = 1;
+	}
+	if (dal::Attribute<string>(g, "STRING").get() != "hello") {
+		cerr << "wrong STRING" << endl;
+		err = 1;
+	}
+	if (dal::Attribute< vector<double> >(g, "DOUBLES").get() != vector<double>(5, 0.25)) {
+		cerr << "wrong DOUBLES" << endl;
+		err = 1;
+	}
+	if (dal::Attribute< vector<string> >(g, "STRINGS").get() != vector<string>(3, "world")) {
+		cerr << "wrong STRINGS" << endl;
+		err = 1;
+	}
+	if (!dal::Attribute< vector<int> >(g, "EMPTY").exists() || dal::Attribute< vector<int> >(g, "EMPTY").size() != 0) {
+		cerr << "wrong EMPTY" << endl;
+		err = 1;
+	}
+	if (dal::Attribute<float>(f, "CREATED").get() != 0.0f) {
+		cerr << "wrong CREATED" << endl;
+		err = 1;
+	}
+	if (dal::Attribute<string>(g, "LAST").get() != "written on close") {
+		cerr << "staged attribute not written on close" << endl;
+		err = 1;
+	}
+	if (dal::Attribute<int>(g, "SHARED").get() != 3) {
+		cerr << "wrong SHARED: " << dal::Attribute<int>(g, "SHARED").get() << endl;
+		err = 1;
+	}
+	if (!dal::Attribute<int>(g, "HELD").exists() || dal::Attribute<int>(g, "HELD").get() != 7) {
+		cerr << "staged attribute of a group that outlived its file was lost" << endl;
+		err = 1;
+	}
+
+	return err;
+}
@@ -0,0 +1,111 @@
+/*
+ * Check that attributes are served from memory after Group::loadAttributes(), and that modifications are seen.
+ * Build: c++ -Wall attribute-cache.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dal/hdf5/File.h>
+#include <dal/lofar/Flagging.h>
+
+using namespace std;
+
+int main() {
+	int err = 0;
+	const char filename[] = "attribute-cache.h5";
+
+	{
+		dal::File f(filename, dal::File::CREATE);
+		dal::Group g(f, "GROUP");
+		g.create();
+
+		dal::Attribute<int>(g, "INT").value = 42;
+		dal::Attribute<double>(g, "DOUBLE").value = 0.5;
+		dal::Attribute<string>(g, "STRING").value = "hello";
+		dal::Attribute< vector<float> >(g, "FLOATS").value = vector<float>(3, 1.5f);
+		dal::Attribute< vector<string> >(g, "STRINGS").value = vector<string>(2, "world");
+		dal::Attribute< vector<int> >(g, "EMPTY").value = vector<int>();
+		dal::Attribute<dal::Range>(g, "RANGE").value = dal::Range(3, 7);
+	}
+
+	dal::File f(filename, dal::File::READWRITE);
+	dal::Group g(f, "GROUP");
+	dal::Attribute<int> a(g, "INT");
+
+	g.loadAttributes();
+
+	// the file is modified behind the cache's back through another Group object
+	dal::Group other(f, "GROUP");
+	dal::Attribute<int>(other, "INT").value = 43;
+	dal::Attribute<int>(other, "NEW").value = 1;
+
+	if (a.get() != 42) {
+		cerr << "INT not served from cache: " << a.get() << endl;
+		err = 1;
+	}
+	if (dal::Attribute<int>(g, "NEW").exists()) {
+		cerr << "NEW not served from cache" << endl;
+		err = 1;
+	}
+
+	if (dal::Attribute<double>(g, "DOUBLE").get() != 0.5 || dal::Attribute<float>(g, "DOUBLE").get() != 0.5f) {
+		cerr << "wrong DOUBLE" << endl;
+		err = 1;
+	}
+	if (dal::Attribute<string>(g, "STRING").get() != "hello") {
+		cerr << "wrong STRING" << endl;
+		err = 1;
+	}
+
+	dal::Attribute< vector<float> > floats(g, "FLOATS");
+	if (floats.size() != 3 || floats.get() != vector<float>(3, 1.5f)) {
+		cerr << "wrong FLOATS" << endl;
+		err = 1;
+	}
+	if (dal::Attribute< vector<string> >(g, "STRINGS").get() != vector<string>(2, "world")) {
+		cerr << "wrong STRINGS" << endl;
+		err = 1;
+	}
+	if (!dal::Attribute< vector<int> >(g, "EMPTY").get().empty()) {
+		cerr << "wrong EMPTY" << endl;
+		err = 1;
+	}
+
+	dal::Range range = dal::Attribute<dal::Range>(g, "RANGE").get();
+	if (range.begin != 3 || range.end != 7) {
+		cerr << "wrong RANGE" << endl;
+		err = 1;
+	}
+
+	// type checks behave as without the cache
+	if (dal::Attribute<int>(g, "STRING").valid() || dal::Attribute<string>(g, "INT").valid()) {
+		cerr << "mismatched type reported as valid" << endl;
+		err = 1;
+	}
+	if (!dal::Attribute<string>(g, "STRING").valid() || dal::Attribute<int>(g, "MISSING").valid()) {
+		cerr << "wrong validity" << endl;
+		err = 1;
+	}
+
+	// modifications through the cached group are seen
+	a.value = 44;
+	if (a.get() != 44) {
+		cerr << "INT not updated after set: " << a.get() << endl;
+		err = 1;
+	}
+	dal::Attribute<string>(g, "STRING").remove();
+	if (dal::Attribute<string>(g, "STRING").exists()) {
+		cerr << "STRING still exists after remove" << endl;
+		err = 1;
+	}
+
+	// reloading picks up the other changes
+	g.loadAttributes();
+	if (!dal::Attribute<int>(g, "NEW").exists()) {
+		cerr << "NEW not seen after reload" << endl;
+		err = 1;
+	}
+
+	return err;
+}
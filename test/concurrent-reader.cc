@@ -0,0 +1,147 @@
+/*
+ * Check that ConcurrentReader returns the same data as Dataset, when used from several threads at once.
+ * Build: c++ -Wall concurrent-reader.cc -llofardal -lhdf5 -lpthread
+ */
+#include <iostream>
+#include <vector>
+#include <pthread.h>
+
+#include <dal/hdf5/ConcurrentReader.h>
+#include <dal/lofar/TBB_File.h>
+
+using namespace std;
+
+struct DipoleCheck {
+	dal::ConcurrentReader<short> reader; // per-thread copy
+	vector<short> expected;
+	int err;
+
+	DipoleCheck( const dal::ConcurrentReader<short> &reader ): reader(reader), err(0) {}
+};
+
+static void *checkDipole( void *arg )
+{
+	DipoleCheck &check = *static_cast<DipoleCheck *>(arg);
+
+	// read in pieces to also test unaligned offsets
+	const size_t len = check.expected.size();
+	vector<short> data(len);
+	for (size_t pos = 0; pos < len; pos += 1000)
+		check.reader.get1D(pos, &data[pos], min<size_t>(1000, len - pos));
+
+	if (data != check.expected)
+		check.err = 1;
+
+	return NULL;
+}
+
+static int checkTBB()
+{
+	int err = 0;
+
+	dal::TBB_File f("data/L59640_CS011_D20110719T110541.036Z_tbb.h5");
+
+	vector<DipoleCheck> checks;
+
+	vector<dal::TBB_Station> stations(f.stations());
+	for (size_t i = 0; i < stations.size(); i++) {
+		vector<dal::TBB_DipoleDataset> dipoles(stations[i].dipoleDatasets());
+		for (size_t j = 0; j < dipoles.size(); j++) {
+			checks.push_back(DipoleCheck(dal::ConcurrentReader<short>(dipoles[j])));
+
+			vector<short> &expected = checks.back().expected;
+			expected.resize(dipoles[j].dims1D());
+			dipoles[j].get1D(0, &expected[0], expected.size());
+		}
+	}
+
+	if (checks.empty()) {
+		cerr << "no dipoles found" << endl;
+		return 1;
+	}
+
+	// all HDF5 calls are done, but keep the file open to check that it does not matter
+	vector<pthread_t> threads(checks.size());
+	for (size_t i = 0; i < checks.size(); i++)
+		if (pthread_create(&threads[i], NULL, checkDipole, &checks[i]) != 0)
+			return 1;
+
+	for (size_t i = 0; i < checks.size(); i++) {
+		pthread_join(threads[i], NULL);
+
+		if (checks[i].err) {
+			cerr << "dipole " << i << ": concurrent read differs from get1D()" << endl;
+			err = 1;
+		}
+	}
+
+	return err;
+}
+
+static int checkMatrix()
+{
+	int err = 0;
+
+	dal::File f("concurrent-reader.h5", dal::File::CREATE);
+	dal::Dataset<float> d(f, "DATA");
+
+	vector<ssize_t> dims(3);
+	dims[0] = 3; dims[1] = 5; dims[2] = 7;
+	d.create(dims, dims, "concurrent-reader.raw");
+
+	vector<float> all(3 * 5 * 7);
+	for (size_t i = 0; i < all.size(); i++)
+		all[i] = i;
+
+	const vector<size_t> zero(3, 0);
+	const vector<size_t> full(dims.begin(), dims.end());
+	d.setMatrix(zero, &all[0], full);
+
+	dal::ConcurrentReader<float> reader(d);
+
+	// full, partial in one dimension, and partial in all dimensions
+	const size_t blocks[][6] = {
+		{ 0, 0, 0,  3, 5, 7 },
+		{ 1, 0, 0,  2, 5, 7 },
+		{ 0, 2, 0,  3, 2, 7 },
+		{ 1, 1, 2,  2, 3, 4 },
+		{ 2, 4, 6,  1, 1, 1 },
+	};
+
+	for (size_t b = 0; b < sizeof blocks / sizeof blocks[0]; b++) {
+		const vector<size_t> pos(blocks[b], blocks[b] + 3);
+		const vector<size_t> size(blocks[b] + 3, blocks[b] + 6);
+
+		vector<float> expected(size[0] * size[1] * size[2]);
+		vector<float> data(expected.size());
+
+		d.getMatrix(pos, &expected[0], size);
+		reader.getMatrix(pos, &data[0], size);
+
+		if (data != expected) {
+			cerr << "block " << b << ": getMatrix() differs" << endl;
+			err = 1;
+		}
+	}
+
+	try {
+		const vector<size_t> pos(3, 1);
+		vector<float> data(all.size());
+		reader.getMatrix(pos, &data[0], full);
+
+		cerr << "read beyond the end of the dataset" << endl;
+		err = 1;
+	} catch (dal::DALIndexError &) {
+	}
+
+	return err;
+}
+
+int main() {
+	int err = 0;
+
+	err |= checkTBB();
+	err |= checkMatrix();
+
+	return err;
+}
@@ -0,0 +1,77 @@
+/*
+ * Check that DatasetAppender writes all appended data, trims the dataset on close(),
+ * and keeps the length attribute in sync.
+ * Build: c++ -Wall dataset-appender.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <vector>
+
+#include <dal/lofar/TBB_File.h>
+#include <dal/hdf5/DatasetAppender.h>
+
+using namespace std;
+
+int main() {
+	int err = 0;
+
+	dal::TBB_File f("test-dataset-appender_tbb.h5", dal::TBB_File::CREATE);
+	dal::TBB_Station st(f.station("CS001"));
+	st.create();
+
+	dal::TBB_DipoleDataset dp(st.dipole(1, 2, 3));
+	dp.create1D(0, -1, "test-dataset-appender_tbb.raw");
+
+	vector<short> data(5000);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = i;
+
+	{
+		// buffer of 500 samples
+		dal::DatasetAppender<short> appender(dp, 500 * sizeof(short));
+		appender.syncLength(dp.dataLength());
+
+		size_t pos = 0;
+		for (size_t n = 1; pos + n <= 2000; n += 37) {
+			appender.append(&data[pos], n);
+			pos += n;
+		}
+
+		// larger than the buffer
+		appender.append(&data[pos], 2000);
+		pos += 2000;
+
+		if (appender.length() != pos) {
+			cerr << "appender reports length " << appender.length() << " instead of " << pos << endl;
+			err = 1;
+		}
+
+		appender.flush();
+		if (dp.dataLength().get() != pos || (size_t)dp.dims1D() < pos) {
+			cerr << "after flush: dataLength " << dp.dataLength().get() << " dims " << dp.dims1D() << " for length " << pos << endl;
+			err = 1;
+		}
+
+		appender.append(&data[pos], 7);
+		pos += 7;
+
+		appender.close();
+
+		if ((size_t)dp.dims1D() != pos || dp.dataLength().get() != pos) {
+			cerr << "after close: dataLength " << dp.dataLength().get() << " dims " << dp.dims1D() << " for length " << pos << endl;
+			err = 1;
+		}
+	}
+
+	const size_t len = dp.dims1D();
+	vector<short> readback(len);
+	dp.get1D(0, &readback[0], len);
+
+	for (size_t i = 0; i < len; i++)
+		if (readback[i] != data[i]) {
+			cerr << "wrong value at " << i << ": " << readback[i] << endl;
+			err = 1;
+			break;
+		}
+
+	return err;
+}
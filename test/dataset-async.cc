@@ -0,0 +1,111 @@
+/*
+ * Check Dataset::getMatrixAsync(), setMatrixAsync() and get1DAsync(), through HDF5 and
+ * from external raw files, with several requests in flight.
+ * Build: c++ -Wall dataset-async.cc -llofardal -lhdf5 -lpthread
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/Dataset.h>
+
+using namespace std;
+
+static const size_t nrBlocks = 8, blockSize = 16, width = 5;
+
+static int checkDataset( dal::Dataset<float> &d, dal::IOExecutor &executor )
+{
+	int err = 0;
+
+	vector<size_t> pos(2, 0), size(2);
+	size[0] = blockSize;
+	size[1] = width;
+
+	// write all blocks at once
+	vector< vector<float> > blocks(nrBlocks, vector<float>(blockSize * width));
+	vector<dal::IOFuture> futures;
+
+	for (size_t b = 0; b < nrBlocks; b++) {
+		for (size_t i = 0; i < blocks[b].size(); i++)
+			blocks[b][i] = b * blocks[b].size() + i;
+
+		pos[0] = b * blockSize;
+		futures.push_back(d.setMatrixAsync(pos, &blocks[b][0], size, executor));
+	}
+
+	for (size_t b = 0; b < nrBlocks; b++)
+		futures[b].wait();
+
+	// read them back, all in flight at once
+	vector< vector<float> > data(nrBlocks, vector<float>(blockSize * width));
+	futures.clear();
+
+	for (size_t b = 0; b < nrBlocks; b++) {
+		dal::HDF5Lock lock; // the executor may be using HDF5
+		pos[0] = b * blockSize;
+		futures.push_back(d.getMatrixAsync(pos, &data[b][0], size, executor));
+	}
+
+	for (size_t b = 0; b < nrBlocks; b++) {
+		futures[b].wait();
+
+		if (data[b] != blocks[b]) {
+			cerr << d.name() << ": wrong data in block " << b << endl;
+			err = 1;
+		}
+	}
+
+	// a column, using the global executor
+	vector<float> column(nrBlocks * blockSize);
+	dal::IOFuture future = d.get1DAsync(0, &column[0], column.size());
+	future.wait();
+
+	if (!future.ready() || column[1] != width) {
+		cerr << d.name() << ": wrong data from get1DAsync()" << endl;
+		err = 1;
+	}
+
+	// failures are reported by wait()
+	pos[0] = nrBlocks * blockSize;
+	future = d.getMatrixAsync(pos, &data[0][0], size, executor);
+	try {
+		future.wait();
+
+		cerr << d.name() << ": read beyond the end of the dataset" << endl;
+		err = 1;
+	} catch (dal::DALException &) {
+	}
+
+	executor.waitAll();
+	if (executor.pending() != 0) {
+		cerr << d.name() << ": requests pending after waitAll()" << endl;
+		err = 1;
+	}
+
+	return err;
+}
+
+int main() {
+	int err = 0;
+
+	dal::File f("dataset-async.h5", dal::File::CREATE);
+
+	vector<ssize_t> dims(2);
+	dims[0] = nrBlocks * blockSize;
+	dims[1] = width;
+
+	dal::IOExecutor executor(2);
+
+	// read from the raw file
+	dal::Dataset<float> external(f, "EXTERNAL");
+	external.create(dims, dims, "dataset-async.raw");
+	err |= checkDataset(external, executor);
+
+	// read through HDF5
+	dal::Dataset<float> internal(f, "INTERNAL");
+	internal.create(dims, dims);
+	err |= checkDataset(internal, executor);
+
+	return err;
+}
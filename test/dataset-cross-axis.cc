@@ -0,0 +1,90 @@
+/*
+ * Check reading columns and transposed blocks through get1D() and get2D().
+ * Build: c++ -Wall dataset-cross-axis.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <vector>
+
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/Dataset.h>
+
+using namespace std;
+
+static const size_t nrRows = 2000;
+static const size_t nrCols = 600;
+
+static float value(size_t row, size_t col) {
+	return row * 1000.0f + col;
+}
+
+int main() {
+	int err = 0;
+
+	dal::File f("test-dataset-cross-axis.h5", dal::File::CREATE);
+	dal::Dataset<float> d(f, "DATA");
+
+	vector<ssize_t> dims(2);
+	dims[0] = nrRows;
+	dims[1] = nrCols;
+	d.create(dims);
+
+	vector<float> data(nrRows * nrCols);
+	for (size_t r = 0; r < nrRows; r++)
+		for (size_t c = 0; c < nrCols; c++)
+			data[r * nrCols + c] = value(r, c);
+
+	vector<size_t> pos(2, 0);
+	d.set2D(pos, &data[0], nrRows, nrCols);
+
+	// full transpose, spanning several row-blocks
+	vector<float> t(nrRows * nrCols);
+	d.get2D(pos, &t[0], nrCols, nrRows, 1, 0);
+	for (size_t c = 0; c < nrCols && !err; c++)
+		for (size_t r = 0; r < nrRows; r++)
+			if (t[c * nrRows + r] != value(r, c)) {
+				cerr << "transposed read: wrong value at channel " << c << " row " << r << endl;
+				err = 1;
+				break;
+			}
+
+	// transposed sub-block with odd sizes
+	pos[0] = 10;
+	pos[1] = 21;
+	vector<float> b(37 * 53);
+	d.get2D(pos, &b[0], 37, 53, 1, 0);
+	for (size_t c = 0; c < 37; c++)
+		for (size_t r = 0; r < 53; r++)
+			if (b[c * 53 + r] != value(pos[0] + r, pos[1] + c)) {
+				cerr << "transposed sub-block: wrong value at " << c << "," << r << endl;
+				err = 1;
+			}
+
+	// a single column
+	pos[0] = 5;
+	pos[1] = 17;
+	vector<float> col(1500);
+	d.get2D(pos, &col[0], col.size(), 1, 0, 1);
+	for (size_t r = 0; r < col.size(); r++)
+		if (col[r] != value(pos[0] + r, pos[1])) {
+			cerr << "column read: wrong value at row " << r << endl;
+			err = 1;
+		}
+
+	// get1D along either dimension
+	vector<float> v(100);
+	d.get1D(5, &v[0], v.size(), 0);
+	for (size_t i = 0; i < v.size(); i++)
+		if (v[i] != value(5 + i, 0)) {
+			cerr << "get1D along dim 0: wrong value at " << i << endl;
+			err = 1;
+		}
+
+	d.get1D(3, &v[0], 50, 1);
+	for (size_t i = 0; i < 50; i++)
+		if (v[i] != value(0, 3 + i)) {
+			cerr << "get1D along dim 1: wrong value at " << i << endl;
+			err = 1;
+		}
+
+	return err;
+}
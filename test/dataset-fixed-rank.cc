@@ -0,0 +1,129 @@
+/*
+ * Check that small, repeated reads through the fixed-rank getMatrix() and getScalar(),
+ * as well as getScalar() and in-order get2D(), do not allocate memory once warmed up.
+ * Build: c++ -Wall dataset-fixed-rank.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <new>
+
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/Dataset.h>
+
+using namespace std;
+
+static size_t nrAllocations = 0;
+
+// the exception specifications of the replaced operators differ between C++98 and C++11
+#if __cplusplus >= 201103L
+#define THROWS_BAD_ALLOC
+#define THROWS_NOTHING noexcept
+#else
+#define THROWS_BAD_ALLOC throw(std::bad_alloc)
+#define THROWS_NOTHING throw()
+#endif
+
+// keep GCC from inlining malloc() or free() into callers, where it warns that they mismatch
+// the operator used on the other side
+#ifdef __GNUC__
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
+NOINLINE void *operator new(size_t size) THROWS_BAD_ALLOC {
+	nrAllocations++;
+
+	void *ptr = malloc(size ? size : 1);
+	if (!ptr)
+		throw bad_alloc();
+
+	return ptr;
+}
+
+NOINLINE void operator delete(void *ptr) THROWS_NOTHING {
+	free(ptr);
+}
+
+// used instead of the above by C++14 when the size is known
+NOINLINE void operator delete(void *ptr, size_t) THROWS_NOTHING {
+	free(ptr);
+}
+
+static const size_t nrRows = 64;
+static const size_t nrCols = 32;
+
+int main() {
+	int err = 0;
+
+	dal::File f("test-dataset-fixed-rank.h5", dal::File::CREATE);
+	dal::Dataset<float> d(f, "DATA");
+
+	vector<ssize_t> dims(2);
+	dims[0] = nrRows;
+	dims[1] = nrCols;
+	d.create(dims);
+
+	vector<float> data(nrRows * nrCols);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = i;
+
+	const size_t origin[2] = { 0, 0 };
+	const size_t all[2] = { nrRows, nrCols };
+	d.setMatrix(origin, &data[0], all);
+
+	vector<size_t> vpos(2, 0);
+	float row[4];
+
+	// warm up the dataspace caches
+	const size_t warmup[2] = { 1, 4 };
+	d.getScalar(origin);
+	d.getMatrix(origin, row, warmup);
+
+	const size_t before = nrAllocations;
+
+	for (size_t i = 0; i < 1000; i++) {
+		const size_t r = (i * 7) % nrRows;
+		const size_t c = (i * 13) % (nrCols - 4);
+
+		const size_t pos[2] = { r, c };
+		if (d.getScalar(pos) != data[r * nrCols + c])
+			err = 1;
+
+		const size_t size[2] = { 1, 4 };
+		d.getMatrix(pos, row, size);
+		if (row[3] != data[r * nrCols + c + 3])
+			err = 1;
+
+		vpos[0] = r;
+		vpos[1] = c;
+		if (d.getScalar(vpos) != data[r * nrCols + c])
+			err = 1;
+
+		d.get2D(vpos, row, 1, 4);
+		if (row[1] != data[r * nrCols + c + 1])
+			err = 1;
+	}
+
+	const size_t allocations = nrAllocations - before;
+
+	if (err)
+		cerr << "read wrong values" << endl;
+
+	if (allocations > 0) {
+		cerr << "small reads performed " << allocations << " allocations" << endl;
+		err = 1;
+	}
+
+	// a different block size must still work
+	const size_t pos[2] = { 1, 2 }, size[2] = { 2, 2 };
+	float block[4];
+	d.getMatrix(pos, block, size);
+	if (block[0] != data[nrCols + 2] || block[3] != data[2 * nrCols + 3]) {
+		cerr << "wrong values after changing block size" << endl;
+		err = 1;
+	}
+
+	return err;
+}
@@ -0,0 +1,101 @@
+/*
+ * Check gathering and scattering of multiple blocks and points in one transfer.
+ * Build: c++ -Wall dataset-gather.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <vector>
+
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/Dataset.h>
+
+using namespace std;
+
+static const size_t nrRows = 100;
+static const size_t nrCols = 50;
+
+static vector<size_t> vec(size_t a, size_t b) {
+	vector<size_t> v(2);
+	v[0] = a;
+	v[1] = b;
+	return v;
+}
+
+int main() {
+	int err = 0;
+
+	dal::File f("test-dataset-gather.h5", dal::File::CREATE);
+	dal::Dataset<float> d(f, "DATA");
+
+	vector<ssize_t> dims(2);
+	dims[0] = nrRows;
+	dims[1] = nrCols;
+	d.create(dims);
+
+	vector<float> data(nrRows * nrCols);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = i;
+
+	d.set2D(vec(0, 0), &data[0], nrRows, nrCols);
+
+	// two channel ranges over all rows: results in a matrix of nrRows x 7
+	vector< vector<size_t> > positions, sizes;
+	positions.push_back(vec(0, 20)); sizes.push_back(vec(nrRows, 4));
+	positions.push_back(vec(0, 5));  sizes.push_back(vec(nrRows, 3));
+
+	vector<float> blocks(nrRows * 7);
+	d.gather(positions, sizes, &blocks[0]);
+
+	for (size_t r = 0; r < nrRows; r++) {
+		const size_t cols[] = { 5, 6, 7, 20, 21, 22, 23 };
+
+		for (size_t c = 0; c < 7; c++)
+			if (blocks[r * 7 + c] != data[r * nrCols + cols[c]]) {
+				cerr << "gather blocks: wrong value at row " << r << " column " << cols[c] << endl;
+				err = 1;
+			}
+	}
+
+	// overlapping blocks are refused
+	positions.push_back(vec(10, 6)); sizes.push_back(vec(1, 1));
+	try {
+		d.gather(positions, sizes, &blocks[0]);
+		cerr << "gather of overlapping blocks did not throw" << endl;
+		err = 1;
+	} catch (dal::DALValueError &) {
+	}
+
+	// points, in the given order
+	vector< vector<size_t> > points;
+	points.push_back(vec(99, 49));
+	points.push_back(vec(0, 0));
+	points.push_back(vec(42, 7));
+
+	vector<float> values(points.size());
+	d.gather(points, &values[0]);
+	for (size_t p = 0; p < points.size(); p++)
+		if (values[p] != data[points[p][0] * nrCols + points[p][1]]) {
+			cerr << "gather points: wrong value for point " << p << endl;
+			err = 1;
+		}
+
+	const float newValues[] = { -1.0f, -2.0f, -3.0f };
+	d.scatter(points, newValues);
+	for (size_t p = 0; p < points.size(); p++)
+		if (d.getScalar(points[p]) != newValues[p]) {
+			cerr << "scatter points: wrong value for point " << p << endl;
+			err = 1;
+		}
+
+	// points along the second dimension of the first row
+	vector<size_t> indices;
+	indices.push_back(3);
+	indices.push_back(1);
+	vector<float> row(indices.size());
+	d.gather1D(indices, &row[0], 1);
+	if (row[0] != data[3] || row[1] != data[1]) {
+		cerr << "gather1D: wrong values" << endl;
+		err = 1;
+	}
+
+	return err;
+}
@@ -0,0 +1,45 @@
+/*
+ * Check that Dataset::mapRegion() returns the same data as get1D() on the
+ * (external, little-endian) TBB example data.
+ * Build: c++ -Wall dataset-map-region.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <vector>
+
+#include <dal/lofar/TBB_File.h>
+
+using namespace std;
+
+int main() {
+	int err = 0;
+
+	dal::TBB_File f("data/L59640_CS011_D20110719T110541.036Z_tbb.h5");
+
+	vector<dal::TBB_Station> stations(f.stations());
+	for (size_t i = 0; i < stations.size(); i++) {
+		vector<dal::TBB_DipoleDataset> dipoles(stations[i].dipoleDatasets());
+		for (size_t j = 0; j < dipoles.size(); j++) {
+			size_t len = dipoles[j].dims1D();
+			vector<short> data(len);
+			dipoles[j].get1D(0, &data[0], len);
+
+			// map all but the first sample to also test unaligned offsets
+			dal::MappedRegion<short> region(dipoles[j].mapRegion(1, len - 1));
+			if (region.size() != len - 1) {
+				cerr << "mapped region has wrong size " << region.size() << endl;
+				err = 1;
+				continue;
+			}
+
+			for (size_t k = 1; k < len; k++) {
+				if (region[k - 1] != data[k]) {
+					cerr << "mapped data differs at index " << k << endl;
+					err = 1;
+					break;
+				}
+			}
+		}
+	}
+
+	return err;
+}
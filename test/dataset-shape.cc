@@ -0,0 +1,42 @@
+/*
+ * Check that dataset shape info is shared between Dataset objects referring to
+ * the same dataset, kept up to date by resize(), and can be refreshed.
+ * Build: c++ -Wall dataset-shape.cc -llofardal -lhdf5
+ */
+#include <iostream>
+
+#include <dal/lofar/TBB_File.h>
+
+using namespace std;
+
+int main() {
+	int err = 0;
+
+	dal::TBB_File f("test-dataset-shape_tbb.h5", dal::TBB_File::CREATE);
+	dal::TBB_Station st(f.station("CS001"));
+	st.create();
+
+	dal::TBB_DipoleDataset dp0(st.dipole(1, 2, 3));
+	dp0.create1D(100, -1, "test-dataset-shape_tbb.raw");
+
+	// a second handle to the same dataset
+	dal::TBB_DipoleDataset dp1(st.dipole(1, 2, 3));
+	if (dp1.ndims() != 1 || dp1.dims1D() != 100 || dp1.maxdims1D() != -1) {
+		cerr << "second handle does not see created shape" << endl;
+		err = 1;
+	}
+
+	dp0.resize1D(150);
+	if (dp0.dims1D() != 150 || dp1.dims1D() != 150) {
+		cerr << "resize not visible through all handles: " << dp0.dims1D() << " " << dp1.dims1D() << endl;
+		err = 1;
+	}
+
+	dp1.refreshShape();
+	if (dp1.dims1D() != 150) {
+		cerr << "refreshShape() returned wrong length " << dp1.dims1D() << endl;
+		err = 1;
+	}
+
+	return err;
+}
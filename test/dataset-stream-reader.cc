@@ -0,0 +1,110 @@
+/*
+ * Check that DatasetStreamReader returns all slices of a dataset in order, including a shorter last slice,
+ * both for a dataset read through HDF5 and for one read from its external raw file, while the caller
+ * uses DAL under the HDF5Lock.
+ * Build: c++ -Wall dataset-stream-reader.cc -llofardal -lhdf5 -lpthread
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/DatasetStreamReader.h>
+#include <dal/hdf5/types/HDF5Lock.h>
+
+using namespace std;
+
+static const size_t nrRows = 1000;
+static const size_t nrCols = 16;
+static const size_t sliceRows = 64;
+
+static int checkStream( dal::File &f, const string &name, const string &filename )
+{
+	int err = 0;
+
+	dal::Dataset<float> d(f, name);
+
+	vector<ssize_t> dims(2);
+	dims[0] = nrRows;
+	dims[1] = nrCols;
+	d.create(dims, dims, filename);
+
+	vector<float> data(nrRows * nrCols);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = i;
+
+	vector<size_t> pos(2, 0);
+	d.set2D(pos, &data[0], nrRows, nrCols);
+
+	vector<size_t> size(2);
+	size[0] = sliceRows;
+	size[1] = nrCols;
+
+	dal::DatasetStreamReader<float> reader(d, pos, size, 0, 3);
+
+	if (reader.nrSlices() != (nrRows + sliceRows - 1) / sliceRows) {
+		cerr << "wrong number of slices: " << reader.nrSlices() << endl;
+		err = 1;
+	}
+
+	size_t row = 0;
+	size_t nrSlices = 0;
+
+	while (const float *slice = reader.next()) {
+		if (reader.queueDepth() > 3) {
+			cerr << "queue depth exceeds queue length: " << reader.queueDepth() << endl;
+			err = 1;
+		}
+
+		if (reader.slicePos()[0] != row) {
+			cerr << name << ": slice " << nrSlices << " starts at row " << reader.slicePos()[0] << " instead of " << row << endl;
+			err = 1;
+		}
+
+		const size_t rows = reader.sliceSize()[0];
+		for (size_t i = 0; i < rows * nrCols; i++)
+			if (slice[i] != data[row * nrCols + i]) {
+				cerr << name << ": slice " << nrSlices << ": wrong value at " << i << endl;
+				err = 1;
+				break;
+			}
+
+		row += rows;
+		nrSlices++;
+
+		// DAL can be used meanwhile, under the HDF5Lock
+		dal::HDF5Lock lock;
+		if (d.dims() != dims) {
+			cerr << "wrong dimensions while streaming" << endl;
+			err = 1;
+		}
+	}
+
+	if (row != nrRows || nrSlices != reader.nrSlices()) {
+		cerr << "read " << row << " rows in " << nrSlices << " slices" << endl;
+		err = 1;
+	}
+
+	if (reader.next() != NULL) {
+		cerr << "next() did not keep returning NULL at the end" << endl;
+		err = 1;
+	}
+
+	if (reader.stallTime() < 0.0) {
+		cerr << "negative stall time" << endl;
+		err = 1;
+	}
+
+	return err;
+}
+
+int main() {
+	int err = 0;
+
+	dal::File f("test-dataset-stream-reader.h5", dal::File::CREATE);
+
+	err |= checkStream(f, "DATA", "");
+	err |= checkStream(f, "RAW_DATA", "test-dataset-stream-reader.raw");
+
+	return err;
+}
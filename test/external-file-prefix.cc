@@ -0,0 +1,143 @@
+/*
+ * Check that external data files of a HDF5 file in another directory are found,
+ * also after the cwd changed, and that DAL leaves the cwd alone while doing I/O.
+ * Also check that they are still found after HDF5 reopened the dataset, which
+ * Dataset::refresh() and File::startSWMRWrite() make it do.
+ * Build: c++ -Wall external-file-prefix.cc -llofardal -lhdf5
+ */
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/Dataset.h>
+
+using namespace std;
+
+static string currentDir()
+{
+	char cwd[1024];
+	return getcwd(cwd, sizeof cwd) ? cwd : "";
+}
+
+int main() {
+	int err = 0;
+
+	if (system("rm -rf external-file-prefix-dir") != 0)
+		return 1;
+	mkdir("external-file-prefix-dir", 0777);
+	mkdir("external-file-prefix-dir/elsewhere", 0777);
+
+	const string topDir(currentDir());
+
+	{
+		dal::File f("external-file-prefix-dir/external-file-prefix.h5", dal::File::CREATE);
+		dal::Dataset<float> d(f, "DATA");
+		d.create1D(16, 16, "external-file-prefix.raw");
+
+		// move away from both the HDF5 file and its external data file
+		if (chdir("external-file-prefix-dir/elsewhere") != 0)
+			return 1;
+		const string cwd(currentDir());
+
+		vector<float> data(16);
+		for (size_t i = 0; i < data.size(); i++)
+			data[i] = i;
+		d.set1D(0, &data[0], data.size());
+
+		if (currentDir() != cwd) {
+			cerr << "cwd changed by write: " << currentDir() << endl;
+			err = 1;
+		}
+
+		if (chdir(topDir.c_str()) != 0)
+			return 1;
+	}
+
+	if (access("external-file-prefix-dir/external-file-prefix.raw", F_OK) != 0) {
+		cerr << "external data file not created next to the HDF5 file" << endl;
+		err = 1;
+	}
+
+	dal::File f("external-file-prefix-dir/external-file-prefix.h5", dal::File::READ);
+	dal::Dataset<float> d(f, "DATA");
+
+	if (chdir("/") != 0)
+		return 1;
+
+	vector<float> data(16);
+	d.get1D(0, &data[0], data.size());
+
+	for (size_t i = 0; i < data.size(); i++)
+		if (data[i] != i) {
+			cerr << "wrong data at " << i << endl;
+			err = 1;
+			break;
+		}
+
+	if (currentDir() != "/") {
+		cerr << "cwd changed by read: " << currentDir() << endl;
+		err = 1;
+	}
+
+	// HDF5 reopens the dataset on refresh
+	d.refresh();
+	std::fill(data.begin(), data.end(), -1.0f);
+	d.get1D(0, &data[0], data.size());
+
+	dal::Dataset<float> d2(f, "DATA");
+	vector<float> data2(16, -1.0f);
+	d2.get1D(0, &data2[0], data2.size());
+
+	for (size_t i = 0; i < data.size(); i++)
+		if (data[i] != i || data2[i] != i) {
+			cerr << "wrong data after refresh at " << i << endl;
+			err = 1;
+			break;
+		}
+
+	// the open dataset can still be described
+	vector<dal::MemberInfo> members(f.members(true));
+	if (members.size() != 1 || members[0].type != dal::MemberInfo::DATASET || members[0].dims != vector<ssize_t>(1, 16)) {
+		cerr << "open dataset not listed as member" << endl;
+		err = 1;
+	}
+
+	if (chdir(topDir.c_str()) != 0)
+		return 1;
+
+#if defined(H5_VERSION_GE) && H5_VERSION_GE(1, 10, 0)
+	// HDF5 reopens the open datasets when starting SWMR writing
+	{
+		dal::File f("external-file-prefix-dir/external-file-prefix-swmr.h5", dal::File::CREATE);
+		dal::Dataset<float> d(f, "DATA");
+		d.create1D(16, 16, "external-file-prefix-swmr.raw");
+		f.startSWMRWrite();
+
+		if (chdir("external-file-prefix-dir/elsewhere") != 0)
+			return 1;
+
+		vector<float> data(16, 1.0f);
+		d.set1D(0, &data[0], data.size());
+
+		if (access("external-file-prefix-swmr.raw", F_OK) == 0) {
+			cerr << "external data file written to the cwd after starting SWMR write access" << endl;
+			err = 1;
+		}
+
+		if (chdir(topDir.c_str()) != 0)
+			return 1;
+	}
+
+	if (access("external-file-prefix-dir/external-file-prefix-swmr.raw", F_OK) != 0) {
+		cerr << "external data file not written next to the HDF5 file after starting SWMR write access" << endl;
+		err = 1;
+	}
+#endif
+
+	return err;
+}
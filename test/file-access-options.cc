@@ -0,0 +1,72 @@
+/*
+ * Check that files can be created and opened with FileAccessOptions.
+ * Build: c++ -Wall file-access-options.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <string>
+
+#include <dal/hdf5/File.h>
+#include <dal/lofar/TBB_File.h>
+
+using namespace std;
+
+int main() {
+	int err = 0;
+	const char filename[] = "file-access-options.h5";
+
+	dal::FileAccessOptions options;
+	options.metadataCacheSize = 8 * 1024 * 1024;
+	options.sieveBufferSize = 256 * 1024;
+	options.smallDataBlockSize = 64 * 1024;
+	options.metadataBlockSize = 64 * 1024;
+
+	{
+		dal::TBB_File f(filename, dal::TBB_File::CREATE, options);
+		f.observationID().value = "L12345";
+	}
+
+	const dal::FileAccessOptions profiles[] = {
+		dal::FileAccessOptions(),
+		dal::FileAccessOptions::headerScan(),
+		dal::FileAccessOptions::bulkRead(),
+		options
+	};
+
+	for (size_t i = 0; i < sizeof profiles / sizeof profiles[0]; i++) {
+		dal::TBB_File f(filename, dal::TBB_File::READ, profiles[i]);
+
+		if (f.observationID().get() != "L12345") {
+			cerr << "wrong OBSERVATION_ID with profile " << i << endl;
+			err = 1;
+		}
+	}
+
+#if defined(H5_VERSION_GE) && H5_VERSION_GE(1, 10, 1)
+	// page buffering requires a file that stores its data in pages
+	dal::FileAccessOptions paged;
+	paged.pageBufferSize = 1024 * 1024;
+
+	{
+		dal::File f("file-access-options-paged.h5", dal::File::CREATE, "", paged);
+		dal::Attribute<int>(f, "INT").value = 42;
+	}
+
+	{
+		dal::File f("file-access-options-paged.h5", dal::File::READ, "", paged);
+		if (dal::Attribute<int>(f, "INT").get() != 42) {
+			cerr << "wrong INT in paged file" << endl;
+			err = 1;
+		}
+	}
+#endif
+
+	// the previously opened file is closed when another file is opened
+	dal::File f;
+	f.open(filename, dal::File::READWRITE, "", dal::FileAccessOptions::bulkRead());
+	if (dal::Attribute<string>(f, "OBSERVATION_ID").get() != "L12345") {
+		cerr << "wrong OBSERVATION_ID after open()" << endl;
+		err = 1;
+	}
+
+	return err;
+}
@@ -0,0 +1,157 @@
+/*
+ * Check File::copyTo(), including the copying and renaming of external data files, also of hard linked datasets.
+ * Build: c++ -Wall file-copy.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/Dataset.h>
+
+using namespace std;
+
+static int checkCopy( const string &dir )
+{
+	int err = 0;
+
+	dal::File f(dir + "/file-copy.h5", dal::File::READ);
+
+	if (dal::Attribute< vector<string> >(f, "STRINGS").get() != vector<string>(2, "hello")) {
+		cerr << dir << ": wrong STRINGS" << endl;
+		err = 1;
+	}
+	dal::Group g(f, "GROUP");
+	if (dal::Attribute<int>(g, "INT").get() != 42) {
+		cerr << dir << ": wrong INT" << endl;
+		err = 1;
+	}
+
+	const char *names[] = { "DATA", "ABS" };
+	for (unsigned n = 0; n < 2; n++) {
+		dal::Dataset<float> d(f, names[n]);
+
+		vector<float> data(16);
+		d.get1D(0, &data[0], data.size());
+
+		for (size_t i = 0; i < data.size(); i++)
+			if (data[i] != i + n) {
+				cerr << dir << ": wrong data in " << names[n] << endl;
+				err = 1;
+				break;
+			}
+
+		if (d.externalFiles() != vector<string>(1, n == 0 ? "file-copy.raw" : "file-copy-abs.raw")) {
+			cerr << dir << ": wrong external file of " << names[n] << ": " << d.externalFiles()[0] << endl;
+			err = 1;
+		}
+	}
+
+	dal::Dataset<float> abs(f, "ABS");
+	if (dal::Attribute<string>(abs, "UNIT").get() != "m") {
+		cerr << dir << ": attribute of recreated dataset lost" << endl;
+		err = 1;
+	}
+
+	// other hard links refer to the recreated dataset
+	dal::Dataset<float> link(g, "ABS_LINK");
+	if (link.externalFiles() != vector<string>(1, "file-copy-abs.raw") || dal::Attribute<string>(link, "UNIT").get() != "m") {
+		cerr << dir << ": hard link to recreated dataset not updated" << endl;
+		err = 1;
+	}
+
+	return err;
+}
+
+int main() {
+	int err = 0;
+
+	if (system("rm -rf file-copy-dst file-copy-link file-copy-fail file-copy*.raw") != 0)
+		return 1;
+	mkdir("file-copy-dst", 0777);
+	mkdir("file-copy-link", 0777);
+	mkdir("file-copy-fail", 0777);
+
+	char cwd[1024];
+	if (!getcwd(cwd, sizeof cwd))
+		return 1;
+
+	dal::File f("file-copy.h5", dal::File::CREATE);
+	dal::Attribute< vector<string> >(f, "STRINGS").value = vector<string>(2, "hello");
+
+	dal::Group g(f, "GROUP");
+	g.create();
+	dal::Attribute<int>(g, "INT").value = 42;
+
+	vector<float> data(16);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = i;
+
+	dal::Dataset<float> d(f, "DATA");
+	d.create1D(data.size(), data.size(), "file-copy.raw");
+	d.set1D(0, &data[0], data.size());
+
+	// absolute paths are rewritten in the copy
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = i + 1;
+
+	dal::Dataset<float> abs(f, "ABS");
+	abs.create1D(data.size(), data.size(), string(cwd) + "/file-copy-abs.raw");
+	abs.set1D(0, &data[0], data.size());
+	dal::Attribute<string>(abs, "UNIT").value = "m";
+
+	// datasets with several paths are recreated once, and linked again under all of them
+	f.flush();
+	hid_t file = H5Fopen("file-copy.h5", H5F_ACC_RDWR, H5P_DEFAULT);
+	if (file < 0 || H5Lcreate_hard(file, "ABS", file, "GROUP/ABS_LINK", H5P_DEFAULT, H5P_DEFAULT) < 0)
+		return 1;
+	H5Fclose(file);
+
+	// external files that were never written are skipped
+	dal::Dataset<float>(f, "EMPTY").create1D(data.size(), data.size(), "file-copy-empty.raw");
+
+	f.copyTo("file-copy-dst/file-copy.h5");
+	f.copyTo("file-copy-link/file-copy.h5", dal::File::HARDLINK, 1);
+
+	err |= checkCopy("file-copy-dst");
+	err |= checkCopy("file-copy-link");
+
+	struct stat st;
+	if (stat("file-copy-link/file-copy.raw", &st) != 0 || st.st_nlink < 2) {
+		cerr << "external file was not hard linked" << endl;
+		err = 1;
+	}
+
+	// the destination must not exist
+	try {
+		f.copyTo("file-copy-dst/file-copy.h5");
+		cerr << "copyTo() overwrote an existing copy" << endl;
+		err = 1;
+	} catch (dal::DALException &) {
+	}
+
+	// a failed copy removes the files it created, but not the ones that were already there
+	if (system("touch file-copy-fail/file-copy.raw") != 0)
+		return 1;
+
+	try {
+		f.copyTo("file-copy-fail/file-copy.h5");
+		cerr << "copyTo() overwrote an existing external file" << endl;
+		err = 1;
+	} catch (dal::DALException &) {
+	}
+
+	if (stat("file-copy-fail/file-copy.h5", &st) == 0 || stat("file-copy-fail/file-copy-abs.raw", &st) == 0) {
+		cerr << "failed copy was not removed" << endl;
+		err = 1;
+	}
+	if (stat("file-copy-fail/file-copy.raw", &st) != 0) {
+		cerr << "existing external file was removed" << endl;
+		err = 1;
+	}
+
+	return err;
+}
@@ -0,0 +1,198 @@
+/*
+ * Check that FilePool reuses open files, that files pooled for reading can be requested for writing,
+ * and that files can be opened with deferred checks.
+ * Build: c++ -Wall file-pool.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <string>
+#include <cerrno>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/FilePool.h>
+#include <dal/lofar/TBB_File.h>
+
+using namespace std;
+
+static const char dirname[] = "file-pool.d";
+static const size_t nrFiles = 3;
+
+static string filename( size_t i )
+{
+	return string(dirname) + "/file" + char('0' + i) + ".h5";
+}
+
+// Returns the number of open file descriptors, or -1 if unknown.
+static int nrOpenFds()
+{
+	DIR *dir = opendir("/proc/self/fd");
+	if (!dir)
+		return -1;
+
+	int n = 0;
+	while (readdir(dir))
+		n++;
+
+	closedir(dir);
+	return n;
+}
+
+int main() {
+	int err = 0;
+
+	if (mkdir(dirname, 0777) != 0 && errno != EEXIST) {
+		cerr << "Could not create " << dirname << endl;
+		return 1;
+	}
+
+	for (size_t i = 0; i < nrFiles; i++) {
+		dal::TBB_File f(filename(i), dal::TBB_File::CREATE);
+		f.observationID().value = filename(i);
+	}
+
+	{
+		dal::File notTbb(string(dirname) + "/other.h5", dal::File::CREATE);
+	}
+
+	{
+		dal::FilePool pool(2);
+
+		dal::TBB_File f0 = pool.get<dal::TBB_File>(filename(0));
+		dal::TBB_File f0again = pool.get<dal::TBB_File>(filename(0));
+
+		if (pool.hits() != 1 || pool.misses() != 1 || pool.size() != 1) {
+			cerr << "second get() not served from the pool" << endl;
+			err = 1;
+		}
+
+		if (f0again.observationID().get() != filename(0)) {
+			cerr << "wrong file from pool" << endl;
+			err = 1;
+		}
+
+		// evicts the least recently used file
+		pool.get<dal::TBB_File>(filename(1));
+		pool.get<dal::TBB_File>(filename(2));
+		pool.get<dal::TBB_File>(filename(0));
+
+		if (pool.size() != 2 || pool.misses() != 4) {
+			cerr << "least recently used file not evicted" << endl;
+			err = 1;
+		}
+
+		// other classes and modes are pooled separately
+		dal::File plain = pool.get<dal::File>(filename(0));
+		if (pool.misses() != 5) {
+			cerr << "File and TBB_File share a pool entry" << endl;
+			err = 1;
+		}
+
+		pool.evict(filename(0));
+		if (pool.size() != 0) {
+			cerr << "evict() left " << pool.size() << " files" << endl;
+			err = 1;
+		}
+
+		try {
+			pool.get<dal::TBB_File>(filename(0), dal::File::CREATE);
+			cerr << "pool accepted CREATE" << endl;
+			err = 1;
+		} catch (dal::DALValueError &) {
+		}
+	}
+
+	// a file pooled for reading can be requested for writing, which then also serves reads
+	{
+		dal::FilePool pool;
+
+		pool.get<dal::File>(filename(1), dal::File::READ);
+
+		dal::File rw = pool.get<dal::File>(filename(1), dal::File::READWRITE);
+		dal::Attribute<int>(rw, "WRITTEN").value = 1;
+
+		dal::File ro = pool.get<dal::File>(filename(1), dal::File::READ);
+		if (pool.size() != 1 || pool.hits() != 1) {
+			cerr << "read not served from the file pooled for writing" << endl;
+			err = 1;
+		}
+		if (dal::Attribute<int>(ro, "WRITTEN").get() != 1) {
+			cerr << "wrong attribute read from the file pooled for writing" << endl;
+			err = 1;
+		}
+	}
+
+	// but not while copies opened for reading are in use
+	{
+		dal::FilePool pool;
+
+		dal::File held = pool.get<dal::File>(filename(2), dal::File::READ);
+
+		try {
+			pool.get<dal::File>(filename(2), dal::File::READWRITE);
+			cerr << "file opened for writing while copies opened for reading are in use" << endl;
+			err = 1;
+		} catch (dal::DALException &) {
+		}
+	}
+
+	// files in the same directory share a directory descriptor
+	const int fdsBefore = nrOpenFds();
+	if (fdsBefore >= 0) {
+		dal::FilePool pool;
+
+		for (size_t i = 0; i < nrFiles; i++)
+			pool.get<dal::TBB_File>(filename(i));
+
+		const int fdsUsed = nrOpenFds() - fdsBefore;
+		if (fdsUsed != (int)nrFiles + 1) {
+			cerr << "expected " << nrFiles + 1 << " descriptors for " << nrFiles << " files, got " << fdsUsed << endl;
+			err = 1;
+		}
+	}
+
+	// deferred checks
+	{
+		dal::FileAccessOptions options;
+		options.deferChecks = true;
+
+		dal::TBB_File f(filename(0), dal::TBB_File::READ, options);
+		if (f.docVersion().get() != dal::VersionType(3, 3)) {
+			cerr << "wrong deferred version " << f.docVersion().get().to_string() << endl;
+			err = 1;
+		}
+
+		f.checkFileType();
+
+		// a file that is not a TBB file opens, but does not pass the check
+		dal::TBB_File other(string(dirname) + "/other.h5", dal::TBB_File::READ, options);
+
+		try {
+			other.checkFileType();
+			cerr << "checkFileType() accepted a non-TBB file" << endl;
+			err = 1;
+		} catch (dal::DALException &) {
+		}
+
+		try {
+			other.docVersion().get();
+			cerr << "missing version attribute not reported" << endl;
+			err = 1;
+		} catch (dal::DALException &) {
+		}
+
+		// a pooled file opened without checks is not handed out to callers that want them
+		dal::FilePool pool;
+		pool.get<dal::TBB_File>(string(dirname) + "/other.h5", dal::TBB_File::READ, options);
+
+		try {
+			pool.get<dal::TBB_File>(string(dirname) + "/other.h5");
+			cerr << "pool handed out an unchecked file" << endl;
+			err = 1;
+		} catch (dal::DALException &) {
+		}
+	}
+
+	return err;
+}
@@ -0,0 +1,109 @@
+/*
+ * Check Group::members() and MemberIterator, also for many members, long names and dangling links.
+ * Build: c++ -Wall group-members.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <hdf5.h>
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/Dataset.h>
+#include <dal/lofar/TBB_File.h>
+
+using namespace std;
+
+int main() {
+	int err = 0;
+	const char filename[] = "group-members.h5";
+
+	dal::File f(filename, dal::File::CREATE);
+	dal::Group g(f, "GROUP");
+	g.create();
+
+	// more members than fit in a single batch of MemberIterator
+	const unsigned nrDatasets = 150;
+	for (unsigned i = 0; i < nrDatasets; i++) {
+		ostringstream name;
+		name << "DATA_" << 1000 + i;
+
+		dal::Dataset<float> d(g, name.str());
+		d.create(vector<ssize_t>(2, i + 1));
+	}
+
+	const string longName(200, 'X'); // longer than the 128 byte buffer that used to truncate names
+	dal::Group(g, longName).create();
+
+	f.flush();
+	hid_t fid = H5Fopen(filename, H5F_ACC_RDWR, H5P_DEFAULT);
+	H5Lcreate_soft("/DOES_NOT_EXIST", fid, "/GROUP/ZZ_DANGLING", H5P_DEFAULT, H5P_DEFAULT);
+	H5Fclose(fid);
+
+	const vector<dal::MemberInfo> members = g.members(true);
+	if (members.size() != nrDatasets + 2) {
+		cerr << "wrong number of members: " << members.size() << endl;
+		return 1;
+	}
+
+	for (unsigned i = 0; i < nrDatasets; i++) {
+		const dal::MemberInfo &m = members[i];
+
+		if (m.type != dal::MemberInfo::DATASET || m.dims != vector<ssize_t>(2, i + 1) || m.elementSize != sizeof(float)) {
+			cerr << "wrong member " << m.name << endl;
+			err = 1;
+		}
+	}
+
+	if (members[nrDatasets].name != longName || members[nrDatasets].type != dal::MemberInfo::GROUP) {
+		cerr << "wrong long named group: " << members[nrDatasets].name << endl;
+		err = 1;
+	}
+	if (members[nrDatasets + 1].name != "ZZ_DANGLING" || members[nrDatasets + 1].type != dal::MemberInfo::UNKNOWN) {
+		cerr << "wrong dangling link" << endl;
+		err = 1;
+	}
+
+	// the lazy iterator returns the same members
+	dal::MemberIterator it(g);
+	size_t nr = 0;
+	while (it.hasNext()) {
+		const dal::MemberInfo m = it.next();
+
+		if (nr >= members.size() || m.name != members[nr].name || m.type != members[nr].type) {
+			cerr << "iterator returned wrong member " << m.name << endl;
+			err = 1;
+		}
+
+		nr++;
+	}
+	if (nr != members.size()) {
+		cerr << "iterator returned " << nr << " members" << endl;
+		err = 1;
+	}
+
+	try {
+		it.next();
+		cerr << "iterator did not throw at the end" << endl;
+		err = 1;
+	} catch (dal::DALIndexError &) {
+	}
+
+	// typed accessors in TBB files
+	{
+		dal::TBB_File tf("group-members-tbb.h5", dal::TBB_File::CREATE);
+		dal::TBB_Station station = tf.station("CS001");
+		station.create();
+
+		station.dipole(1, 2, 3).create(vector<ssize_t>(1, 16));
+		station.dipole(1, 2, 4).create(vector<ssize_t>(1, 16));
+		dal::Group(station, "DIPOLE_NOT_A_DATASET").create();
+
+		if (tf.stations().size() != 1 || station.dipoleDatasets().size() != 2 || station.dipoleGroups().size() != 1) {
+			cerr << "wrong TBB members" << endl;
+			err = 1;
+		}
+	}
+
+	return err;
+}
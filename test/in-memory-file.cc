@@ -0,0 +1,111 @@
+/*
+ * Check IN_MEMORY files: nothing is written to disk unless persistOnClose is set, and file images can be reopened.
+ * Build: c++ -Wall in-memory-file.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include <dal/hdf5/File.h>
+#include <dal/lofar/TBB_File.h>
+
+using namespace std;
+
+static bool fileExists( const char *filename )
+{
+	return access(filename, F_OK) == 0;
+}
+
+static int checkContents( dal::TBB_File &f )
+{
+	int err = 0;
+
+	if (f.observationID().get() != "L12345") {
+		cerr << "wrong OBSERVATION_ID" << endl;
+		err = 1;
+	}
+
+	dal::TBB_DipoleDataset dipole = f.station("CS001").dipole(1, 2, 3);
+	vector<short> data(100);
+	dipole.get1D(0, &data[0], data.size());
+
+	for (size_t i = 0; i < data.size(); i++)
+		if (data[i] != (short)i) {
+			cerr << "wrong data at " << i << endl;
+			err = 1;
+			break;
+		}
+
+	return err;
+}
+
+int main() {
+	int err = 0;
+	const char filename[] = "in-memory-file.h5";
+	const char rawFilename[] = "in-memory-file.raw";
+
+	unlink(filename);
+	unlink(rawFilename);
+
+	vector<char> image;
+
+	{
+		dal::TBB_File f(filename, dal::File::IN_MEMORY);
+		f.observationID().value = "L12345";
+
+		dal::TBB_Station station = f.station("CS001");
+		station.create();
+
+		// data for external files is kept in memory, and can grow
+		dal::TBB_DipoleDataset dipole = station.dipole(1, 2, 3);
+		dipole.create1D(0, -1, rawFilename);
+		dipole.resize1D(100);
+
+		vector<short> data(100);
+		for (size_t i = 0; i < data.size(); i++)
+			data[i] = i;
+		dipole.set1D(0, &data[0], data.size());
+
+		err |= checkContents(f);
+
+		image = f.image();
+	}
+
+	if (fileExists(filename) || fileExists(rawFilename)) {
+		cerr << "IN_MEMORY file was written to disk" << endl;
+		err = 1;
+	}
+
+	{
+		dal::TBB_File f;
+		f.openImage(filename, &image[0], image.size());
+		err |= checkContents(f);
+
+		try {
+			f.openImage(filename, &image[0], image.size(), dal::File::CREATE);
+			cerr << "openImage() accepted CREATE" << endl;
+			err = 1;
+		} catch (dal::DALValueError &) {
+		}
+	}
+
+	// persistOnClose writes the file to disk when it is closed
+	{
+		dal::FileAccessOptions options;
+		options.persistOnClose = true;
+
+		dal::TBB_File f(filename, dal::File::IN_MEMORY, options);
+		f.observationID().value = "L12345";
+	}
+
+	{
+		dal::TBB_File f(filename, dal::File::READ);
+		if (f.observationID().get() != "L12345") {
+			cerr << "wrong OBSERVATION_ID in persisted file" << endl;
+			err = 1;
+		}
+	}
+
+	return err;
+}
@@ -0,0 +1,144 @@
+/*
+ * Check File::writeIndex() and File::loadIndex(), including the detection of stale and corrupt indices.
+ * Build: c++ -Wall metadata-index.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/Dataset.h>
+
+using namespace std;
+
+static int checkContents( dal::File &f )
+{
+	int err = 0;
+
+	if (dal::Attribute<string>(f, "ROOT_ATTR").get() != "root") {
+		cerr << "wrong ROOT_ATTR" << endl;
+		err = 1;
+	}
+
+	dal::Group g(f, "GROUP");
+	if (dal::Attribute<int>(g, "INT").get() != 42 || dal::Attribute<double>(g, "INT").get() != 42.0) {
+		cerr << "wrong INT" << endl;
+		err = 1;
+	}
+	if (dal::Attribute< vector<string> >(g, "STRINGS").get() != vector<string>(2, "world")) {
+		cerr << "wrong STRINGS" << endl;
+		err = 1;
+	}
+	if (dal::Attribute<int>(g, "MISSING").exists()) {
+		cerr << "MISSING exists" << endl;
+		err = 1;
+	}
+
+	const vector<dal::MemberInfo> members = g.members(true);
+	if (members.size() != 2 || members[0].name != "DATA" || members[0].type != dal::MemberInfo::DATASET
+	 || members[0].dims != vector<ssize_t>(2, 4) || members[0].elementSize != sizeof(float)
+	 || members[1].name != "SUBGROUP" || members[1].type != dal::MemberInfo::GROUP) {
+		cerr << "wrong members of GROUP" << endl;
+		err = 1;
+	}
+
+	dal::Dataset<float> d(g, "DATA");
+	if (d.dims() != vector<ssize_t>(2, 4) || dal::Attribute<float>(d, "SCALE").get() != 2.5f) {
+		cerr << "wrong DATA" << endl;
+		err = 1;
+	}
+	if (d.externalFiles() != vector<string>(1, "metadata-index.raw")) {
+		cerr << "wrong external files of DATA" << endl;
+		err = 1;
+	}
+
+	return err;
+}
+
+int main() {
+	int err = 0;
+	const char filename[] = "metadata-index.h5";
+	const string indexFilename = string(filename) + ".dalidx";
+
+	unlink(indexFilename.c_str());
+
+	{
+		dal::File f(filename, dal::File::CREATE);
+		dal::Attribute<string>(f, "ROOT_ATTR").value = "root";
+
+		dal::Group g(f, "GROUP");
+		g.create();
+		dal::Attribute<int>(g, "INT").value = 42;
+		dal::Attribute< vector<string> >(g, "STRINGS").value = vector<string>(2, "world");
+		dal::Group(g, "SUBGROUP").create();
+
+		dal::Dataset<float> d(g, "DATA");
+		d.create(vector<ssize_t>(2, 4), vector<ssize_t>(), "metadata-index.raw");
+		dal::Attribute<float>(d, "SCALE").value = 2.5f;
+
+		// the index of a writable file would be invalidated by closing it
+		try {
+			f.writeIndex();
+			cerr << "writeIndex() did not throw on a writable file" << endl;
+			err = 1;
+		} catch (dal::DALException &) {
+		}
+	}
+
+	{
+		dal::File f(filename, dal::File::READ);
+		if (f.loadIndex()) {
+			cerr << "loaded a non-existing index" << endl;
+			err = 1;
+		}
+
+		f.writeIndex();
+	}
+
+	{
+		dal::File f(filename, dal::File::READ);
+		if (!f.loadIndex()) {
+			cerr << "could not load index" << endl;
+			return 1;
+		}
+
+		err |= checkContents(f);
+	}
+
+	// a corrupt index is ignored
+	{
+		fstream idx(indexFilename.c_str(), ios::in | ios::out | ios::binary);
+		idx.seekp(40);
+		idx.put('X');
+	}
+
+	{
+		dal::File f(filename, dal::File::READ);
+		if (f.loadIndex()) {
+			cerr << "loaded a corrupt index" << endl;
+			err = 1;
+		}
+
+		err |= checkContents(f);
+		f.writeIndex();
+	}
+
+	// a stale index is ignored
+	sleep(1); // make sure the modification time changes, even with coarse timestamps
+	{
+		dal::File f(filename, dal::File::READWRITE);
+		dal::Attribute<string>(f, "ROOT_ATTR").value = "changed";
+	}
+
+	{
+		dal::File f(filename, dal::File::READ);
+		if (f.loadIndex()) {
+			cerr << "loaded a stale index" << endl;
+			err = 1;
+		}
+	}
+
+	return err;
+}
@@ -0,0 +1,78 @@
+/*
+ * Check introspection through the static node schema tables, also on copied groups.
+ * Build: c++ -Wall node-schema.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <dal/lofar/BF_File.h>
+
+using namespace std;
+
+static bool contains(const vector<string> &names, const string &name) {
+	return find(names.begin(), names.end(), name) != names.end();
+}
+
+int main() {
+	int err = 0;
+	const char filename[] = "node-schema.h5";
+
+	dal::BF_File f(filename, dal::BF_File::CREATE);
+
+	// registered by Group, File (version attribute), CLA_File and BF_File respectively
+	const vector<string> names = f.nodeNames();
+	const char *expected[] = { "GROUPTYPE", "DOC_VERSION", "OBSERVATION_ID", "BF_FORMAT" };
+	for (size_t i = 0; i < sizeof expected / sizeof expected[0]; i++)
+		if (!contains(names, expected[i])) {
+			cerr << "node " << expected[i] << " not registered" << endl;
+			err = 1;
+		}
+
+	if (!is_sorted(names.begin(), names.end())) {
+		cerr << "node names are not sorted" << endl;
+		err = 1;
+	}
+
+	f.observationID().value = "12345";
+
+	dal::Attribute<string> &id = f.getNode("OBSERVATION_ID");
+	if (id.get() != "12345" || &id != &static_cast<dal::Attribute<string>&>(f.getNode("OBSERVATION_ID"))) {
+		cerr << "wrong OBSERVATION_ID node" << endl;
+		err = 1;
+	}
+
+	try {
+		f.getNode("NOT_REGISTERED");
+		cerr << "unregistered node found" << endl;
+		err = 1;
+	} catch (dal::DALValueError &) {
+	}
+
+	dal::BF_SubArrayPointing sap = f.subArrayPointing(0);
+	sap.create();
+	sap.pointRA().value = 1.0;
+
+	{
+		// copies construct their own nodes
+		dal::BF_SubArrayPointing copy(sap);
+		dal::Attribute<double> &ra = copy.getNode("POINT_RA");
+		if (ra.get() != 1.0) {
+			cerr << "wrong POINT_RA through copy" << endl;
+			err = 1;
+		}
+		if (copy.nodeNames() != sap.nodeNames()) {
+			cerr << "copy has different node names" << endl;
+			err = 1;
+		}
+	}
+
+	dal::Attribute<double> &ra = sap.getNode("POINT_RA");
+	if (ra.get() != 1.0) {
+		cerr << "wrong POINT_RA" << endl;
+		err = 1;
+	}
+
+	return err;
+}
@@ -0,0 +1,94 @@
+/*
+ * Check that runTasks() runs all tasks, and rethrows the errors of tasks with their original type.
+ * Build: c++ -Wall parallel-tasks.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <vector>
+#include <pthread.h>
+
+#include <dal/hdf5/types/ParallelTasks.h>
+#include <dal/hdf5/exceptions/exceptions.h>
+
+using namespace std;
+
+enum Failure { NONE, VALUE_ERROR, HDF5_ERROR, BAD_ALLOC, STD_ERROR, OTHER };
+
+class CountTasks: public dal::ParallelTasks {
+public:
+	CountTasks( size_t nrTasks, Failure failure ): done(nrTasks, 0), failure(failure) {
+		pthread_mutex_init(&mutex, NULL);
+	}
+
+	~CountTasks() {
+		pthread_mutex_destroy(&mutex);
+	}
+
+	virtual void run( size_t i ) {
+		pthread_mutex_lock(&mutex);
+		done[i]++;
+		pthread_mutex_unlock(&mutex);
+
+		if (i != 3)
+			return;
+
+		switch (failure) {
+			case NONE:        break;
+			case VALUE_ERROR: throw dal::DALValueError("value error");
+			case HDF5_ERROR:  throw dal::HDF5Exception("HDF5 error");
+			case BAD_ALLOC:   throw std::bad_alloc();
+			case STD_ERROR:   throw std::logic_error("logic error");
+			case OTHER:       throw 42;
+		}
+	}
+
+	vector<int> done;
+
+private:
+	const Failure failure;
+	pthread_mutex_t mutex;
+};
+
+int main() {
+	int err = 0;
+
+	{
+		CountTasks tasks(100, NONE);
+		dal::runTasks(tasks, tasks.done.size(), 4);
+
+		for (size_t i = 0; i < tasks.done.size(); i++)
+			if (tasks.done[i] != 1) {
+				cerr << "task " << i << " ran " << tasks.done[i] << " times" << endl;
+				err = 1;
+				break;
+			}
+	}
+
+	const Failure failures[] = { VALUE_ERROR, HDF5_ERROR, BAD_ALLOC, STD_ERROR, OTHER };
+
+	for (size_t f = 0; f < sizeof failures / sizeof failures[0]; f++) {
+		CountTasks tasks(100, failures[f]);
+		Failure caught = NONE;
+
+		try {
+			dal::runTasks(tasks, tasks.done.size(), 4);
+		} catch (dal::HDF5Exception &) {
+			caught = HDF5_ERROR;
+		} catch (dal::DALValueError &) {
+			caught = VALUE_ERROR;
+		} catch (std::bad_alloc &) {
+			caught = BAD_ALLOC;
+		} catch (dal::DALException &) {
+			// other exceptions become a DALException
+			caught = failures[f] == STD_ERROR || failures[f] == OTHER ? failures[f] : NONE;
+		}
+
+		if (caught != failures[f]) {
+			cerr << "failure " << failures[f] << " caught as " << caught << endl;
+			err = 1;
+		}
+	}
+
+	return err;
+}
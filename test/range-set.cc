@@ -0,0 +1,241 @@
+/*
+ * Check RangeSet against a plain bitmap of flags, and getMasked() against get1D(), also for complex data.
+ * Build: c++ -Wall range-set.cc -llofardal -lhdf5
+ */
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <dal/lofar/TBB_File.h>
+
+using namespace std;
+
+static const unsigned long long domainSize = 200;
+
+static vector<bool> toBitmap( const dal::RangeSet &set )
+{
+	vector<bool> bitmap(domainSize, false);
+	const vector<dal::Range> ranges(set.ranges());
+
+	for (size_t i = 0; i < ranges.size(); i++)
+		for (unsigned long long pos = ranges[i].begin; pos < ranges[i].end; pos++)
+			bitmap[pos] = true;
+
+	return bitmap;
+}
+
+//! Returns whether the ranges of `set` are sorted, non-empty, disjoint and non-adjacent.
+static bool isNormal( const dal::RangeSet &set )
+{
+	const vector<dal::Range> ranges(set.ranges());
+
+	for (size_t i = 0; i < ranges.size(); i++) {
+		if (ranges[i].begin >= ranges[i].end)
+			return false;
+
+		if (i > 0 && ranges[i - 1].end >= ranges[i].begin)
+			return false;
+	}
+
+	return true;
+}
+
+static vector<dal::Range> randomRanges( size_t n )
+{
+	vector<dal::Range> ranges;
+
+	for (size_t i = 0; i < n; i++) {
+		const unsigned long long begin = rand() % domainSize;
+		const unsigned long long end = min(domainSize, begin + rand() % 20);
+
+		ranges.push_back(dal::Range(begin, end));
+	}
+
+	return ranges;
+}
+
+static int checkRangeSet()
+{
+	int err = 0;
+
+	srand(1);
+
+	for (unsigned iter = 0; iter < 100; iter++) {
+		const vector<dal::Range> ra(randomRanges(iter % 10));
+		const vector<dal::Range> rb(randomRanges(iter % 7));
+
+		const dal::RangeSet a(ra), b(rb);
+		dal::RangeSet inserted;
+
+		vector<bool> bitmapA(domainSize, false), bitmapB(domainSize, false);
+
+		for (size_t i = 0; i < ra.size(); i++) {
+			inserted.insert(ra[i]);
+
+			for (unsigned long long pos = ra[i].begin; pos < ra[i].end; pos++)
+				bitmapA[pos] = true;
+		}
+
+		for (size_t i = 0; i < rb.size(); i++)
+			for (unsigned long long pos = rb[i].begin; pos < rb[i].end; pos++)
+				bitmapB[pos] = true;
+
+		const dal::Range domain(10, 150);
+		const dal::RangeSet united(a.unite(b)), intersected(a.intersect(b)), complemented(a.complement(domain));
+
+		if (!isNormal(a) || !isNormal(inserted) || !isNormal(united) || !isNormal(intersected) || !isNormal(complemented)) {
+			cerr << "iteration " << iter << ": ranges not normalised" << endl;
+			err = 1;
+		}
+
+		const vector<bool> bitmapInserted(toBitmap(inserted)), bitmapUnited(toBitmap(united)),
+		                   bitmapIntersected(toBitmap(intersected)), bitmapComplemented(toBitmap(complemented));
+		unsigned long long count = 0;
+
+		for (unsigned long long pos = 0; pos < domainSize; pos++) {
+			const bool inDomain = pos >= domain.begin && pos < domain.end;
+
+			if (a.contains(pos) != bitmapA[pos] || bitmapInserted[pos] != bitmapA[pos]
+			 || bitmapUnited[pos] != (bitmapA[pos] || bitmapB[pos])
+			 || bitmapIntersected[pos] != (bitmapA[pos] && bitmapB[pos])
+			 || bitmapComplemented[pos] != (inDomain && !bitmapA[pos])) {
+				cerr << "iteration " << iter << ": wrong result at position " << pos << endl;
+				err = 1;
+			}
+
+			if (a.overlaps(dal::Range(pos, pos + 3)) != (bitmapA[pos] || (pos + 1 < domainSize && bitmapA[pos + 1]) || (pos + 2 < domainSize && bitmapA[pos + 2]))) {
+				cerr << "iteration " << iter << ": wrong overlap at position " << pos << endl;
+				err = 1;
+			}
+
+			count += bitmapA[pos];
+		}
+
+		if (a.count() != count) {
+			cerr << "iteration " << iter << ": count() returned " << a.count() << " instead of " << count << endl;
+			err = 1;
+		}
+	}
+
+	return err;
+}
+
+static int checkMasked()
+{
+	int err = 0;
+
+	const size_t len = 100;
+
+	dal::TBB_File f("range-set.h5", dal::File::CREATE);
+	dal::TBB_Station station = f.station("CS001");
+	station.create();
+	dal::TBB_DipoleDataset dipole = station.dipole(1, 2, 3);
+	dipole.create1D(len, len);
+
+	vector<short> data(len);
+	for (size_t i = 0; i < len; i++)
+		data[i] = i + 1;
+	dipole.set1D(0, &data[0], len);
+
+	// overlapping and unsorted flags, stored and reloaded through the flag list
+	vector<dal::Range> flagList;
+	flagList.push_back(dal::Range(50, 60));
+	flagList.push_back(dal::Range(0, 5));
+	flagList.push_back(dal::Range(55, 70));
+	flagList.push_back(dal::Range(95, 120));
+	dal::RangeSet(flagList).store(dipole.flagOffsets());
+
+	const dal::RangeSet flags(dipole.flagOffsets());
+	if (dipole.flagOffsets().get().size() != 3 || flags.count() != 5 + 20 + 25) {
+		cerr << "wrong flags stored: " << dipole.flagOffsets().get().size() << " ranges, count " << flags.count() << endl;
+		err = 1;
+	}
+
+	const size_t pos = 2, readLen = 96;
+	vector<short> skipped(readLen, -1), zeroed(readLen, -1);
+
+	const size_t nrSkipped = dal::getMasked(dipole, pos, &skipped[0], readLen, flags, dal::MASK_SKIP);
+	const size_t nrZeroed = dal::getMasked(dipole, pos, &zeroed[0], readLen, flags, dal::MASK_ZERO);
+
+	if (nrSkipped != readLen - flags.intersect(vector<dal::Range>(1, dal::Range(pos, pos + readLen))).count() || nrZeroed != readLen) {
+		cerr << "getMasked() returned " << nrSkipped << " and " << nrZeroed << endl;
+		err = 1;
+	}
+
+	size_t next = 0;
+	for (size_t i = 0; i < readLen; i++) {
+		const bool flagged = flags.contains(pos + i);
+
+		if (zeroed[i] != (flagged ? 0 : data[pos + i])) {
+			cerr << "MASK_ZERO: wrong value at position " << pos + i << ": " << zeroed[i] << endl;
+			err = 1;
+		}
+
+		if (!flagged && (next >= nrSkipped || skipped[next++] != data[pos + i])) {
+			cerr << "MASK_SKIP: wrong value for position " << pos + i << endl;
+			err = 1;
+		}
+	}
+
+	// NaN requires a floating-point type
+	try {
+		dal::getMasked(dipole, 0, &zeroed[0], len, flags, dal::MASK_NAN);
+
+		cerr << "MASK_NAN on short data did not throw" << endl;
+		err = 1;
+	} catch (dal::DALValueError &) {
+	}
+
+	// a long flagged region is skipped rather than read
+	const size_t floatLen = 200 * 1000;
+	const dal::RangeSet floatFlags(flags.unite(vector<dal::Range>(1, dal::Range(1000, 150 * 1000))));
+
+	dal::Dataset<float> floats(f, "FLOATS");
+	floats.create1D(floatLen, floatLen);
+	vector<float> floatData(floatLen);
+	for (size_t i = 0; i < floatLen; i++)
+		floatData[i] = i + 1;
+	floats.set1D(0, &floatData[0], floatLen);
+
+	vector<float> nans(floatLen);
+	dal::getMasked(floats, 0, &nans[0], floatLen, floatFlags, dal::MASK_NAN);
+
+	for (size_t i = 0; i < floatLen; i++)
+		if (floatFlags.contains(i) ? !std::isnan(nans[i]) : nans[i] != floatData[i]) {
+			cerr << "MASK_NAN: wrong value at position " << i << ": " << nans[i] << endl;
+			err = 1;
+			break;
+		}
+
+	// complex values are masked with NaN in both parts
+	const size_t complexLen = 100;
+	dal::Dataset< complex<float> > complexes(f, "COMPLEXES");
+	complexes.create1D(complexLen, complexLen);
+	vector< complex<float> > complexData(complexLen);
+	for (size_t i = 0; i < complexLen; i++)
+		complexData[i] = complex<float>(i + 1, -(float)i);
+	complexes.set1D(0, &complexData[0], complexLen);
+
+	vector< complex<float> > complexNans(complexLen);
+	dal::getMasked(complexes, 0, &complexNans[0], complexLen, flags, dal::MASK_NAN);
+
+	for (size_t i = 0; i < complexLen; i++)
+		if (flags.contains(i) ? !std::isnan(complexNans[i].real()) || !std::isnan(complexNans[i].imag()) : complexNans[i] != complexData[i]) {
+			cerr << "MASK_NAN: wrong complex value at position " << i << ": " << complexNans[i] << endl;
+			err = 1;
+			break;
+		}
+
+	return err;
+}
+
+int main() {
+	int err = 0;
+
+	err |= checkRangeSet();
+	err |= checkMasked();
+
+	return err;
+}
@@ -0,0 +1,155 @@
+/*
+ * Check following a dataset with SWMR while another process appends to it.
+ * Build: c++ -Wall swmr-follow.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/Dataset.h>
+#include <dal/hdf5/DatasetFollower.h>
+
+using namespace std;
+
+static const char filename[] = "swmr-follow.h5";
+static const size_t nrBlocks = 10;
+static const size_t blockSize = 100;
+
+static void append( dal::File &f, dal::Dataset<short> &d, size_t block )
+{
+	vector<short> data(blockSize);
+	for (size_t i = 0; i < blockSize; i++)
+		data[i] = block * blockSize + i;
+
+	d.resize1D((block + 1) * blockSize);
+	d.set1D(block * blockSize, &data[0], data.size());
+	f.flush();
+
+	usleep(10000);
+}
+
+// Reopens the file, signals `ready`, and appends the remaining data.
+static int writer( int ready )
+{
+	try {
+		// SWMR writers have to open the file before the readers
+		dal::File f(filename, dal::File::SWMR_WRITE);
+		dal::Dataset<short> d(f, "DATA");
+
+		if (write(ready, "x", 1) != 1)
+			return 1;
+
+		for (size_t b = 1; b < nrBlocks; b++)
+			append(f, d, b);
+	} catch (exception &e) {
+		cerr << "writer: " << e.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+int main() {
+	int err = 0;
+
+#if defined(H5_VERSION_GE) && H5_VERSION_GE(1, 10, 0)
+	// create the file and write the first block in SWMR mode
+	{
+		dal::File f(filename, dal::File::CREATE);
+		dal::Dataset<short> d(f, "DATA");
+		d.create1D(0, -1, "swmr-follow.raw");
+
+		f.startSWMRWrite();
+		append(f, d, 0);
+	}
+
+	int fds[2];
+	if (pipe(fds) != 0)
+		return 1;
+
+	pid_t pid = fork();
+	if (pid == 0) {
+		close(fds[0]);
+		_exit(writer(fds[1]));
+	}
+
+	close(fds[1]);
+
+	char c;
+	if (read(fds[0], &c, 1) != 1) {
+		cerr << "writer did not create the file" << endl;
+		return 1;
+	}
+
+	{
+		dal::File f(filename, dal::File::SWMR_READ);
+		dal::Dataset<short> d(f, "DATA");
+
+		if (d.canWrite()) {
+			cerr << "SWMR_READ file is writable" << endl;
+			err = 1;
+		}
+
+		// HDF5 reopens the dataset on refresh, which other Dataset objects would not survive
+		d.ndims();
+		{
+			dal::Dataset<short> copy(d);
+
+			try {
+				d.refresh();
+				cerr << "refreshed a dataset with copies" << endl;
+				err = 1;
+			} catch (dal::DALException &) {
+			}
+		}
+		{
+			dal::Dataset<short> other(f, "DATA");
+			other.ndims();
+
+			try {
+				d.refresh();
+				cerr << "refreshed a dataset open elsewhere" << endl;
+				err = 1;
+			} catch (dal::DALException &) {
+			}
+		}
+
+		dal::DatasetFollower<short> follower(d, 0, 0, 0.005);
+		vector<short> samples(nrBlocks * blockSize);
+
+		while (follower.position() < samples.size()) {
+			if (follower.wait(1, 10.0) == 0) {
+				cerr << "timed out waiting for samples at " << follower.position() << endl;
+				err = 1;
+				break;
+			}
+
+			follower.next(&samples[follower.position()], samples.size() - follower.position());
+		}
+
+		for (size_t i = 0; i < follower.position(); i++)
+			if (samples[i] != (short)i) {
+				cerr << "wrong sample at " << i << ": " << samples[i] << endl;
+				err = 1;
+				break;
+			}
+
+		// no more data
+		if (follower.wait(1, 0.0) != 0) {
+			cerr << "samples beyond the end" << endl;
+			err = 1;
+		}
+	}
+
+	int status;
+	if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		cerr << "writer failed" << endl;
+		err = 1;
+	}
+#endif
+
+	return err;
+}
@@ -0,0 +1,146 @@
+/*
+ * Check TBB_DipoleDataset::scanLostFrames() and scanLostFramesParallel() against a plain scan,
+ * on generated data, both in external raw files and stored through HDF5, and on the example data.
+ * Build: c++ -Wall tbb-lost-frames.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dal/lofar/TBB_File.h>
+
+using namespace std;
+
+//! Returns the all-zero frames of `data`, merged into ranges.
+static vector<dal::Range> plainScan( const vector<short> &data, unsigned samplesPerFrame )
+{
+	vector<dal::Range> lost;
+
+	for (size_t begin = 0; begin + samplesPerFrame <= data.size(); begin += samplesPerFrame) {
+		bool zero = true;
+		for (size_t i = begin; i < begin + samplesPerFrame; i++)
+			if (data[i] != 0)
+				zero = false;
+
+		if (!zero)
+			continue;
+
+		if (!lost.empty() && lost.back().end == begin)
+			lost.back().end = begin + samplesPerFrame;
+		else
+			lost.push_back(dal::Range(begin, begin + samplesPerFrame));
+	}
+
+	return lost;
+}
+
+static bool equal( const vector<dal::Range> &a, const vector<dal::Range> &b )
+{
+	if (a.size() != b.size())
+		return false;
+
+	for (size_t i = 0; i < a.size(); i++)
+		if (a[i].begin != b[i].begin || a[i].end != b[i].end)
+			return false;
+
+	return true;
+}
+
+static int checkGenerated()
+{
+	int err = 0;
+
+	const unsigned samplesPerFrame = 64;
+	const size_t nrFrames = 100;
+
+	// lost frames 0, 5-7 and 99, a frame with a single non-zero value at the end, and a zero partial frame
+	vector<short> data(nrFrames * samplesPerFrame + samplesPerFrame / 2, 1);
+	const size_t lostFrames[] = { 0, 5, 6, 7, 50, 99 };
+	for (size_t f = 0; f < sizeof lostFrames / sizeof lostFrames[0]; f++)
+		std::fill(&data[lostFrames[f] * samplesPerFrame], &data[(lostFrames[f] + 1) * samplesPerFrame], 0);
+	data[51 * samplesPerFrame - 1] = -1;
+	std::fill(&data[nrFrames * samplesPerFrame], &data[0] + data.size(), 0);
+
+	const vector<dal::Range> expected(plainScan(data, samplesPerFrame));
+	if (expected.size() != 3) {
+		cerr << "test data has wrong number of lost ranges: " << expected.size() << endl;
+		return 1;
+	}
+
+	dal::TBB_File f("tbb-lost-frames.h5", dal::File::CREATE);
+	dal::TBB_Station station = f.station("CS001");
+	station.create();
+
+	vector<dal::TBB_DipoleDataset> dipoles;
+
+	for (unsigned rcu = 0; rcu < 4; rcu++) {
+		dal::TBB_DipoleDataset dipole = station.dipole(1, 2, rcu);
+
+		// odd RCUs are stored inside the HDF5 file, and are read through HDF5
+		if (rcu % 2 == 0)
+			dipole.create1D(data.size(), data.size(), "tbb-lost-frames-" + string(1, '0' + rcu) + ".raw");
+		else
+			dipole.create1D(data.size(), data.size());
+
+		dipole.set1D(0, &data[0], data.size());
+		dipoles.push_back(dipole);
+
+		if (!equal(dipole.scanLostFrames(samplesPerFrame), expected)) {
+			cerr << "rcu " << rcu << ": scanLostFrames() differs from plain scan" << endl;
+			err = 1;
+		}
+	}
+
+	const vector< vector<dal::Range> > results(dal::TBB_DipoleDataset::scanLostFramesParallel(dipoles, samplesPerFrame, 3));
+	for (size_t i = 0; i < results.size(); i++)
+		if (!equal(results[i], expected)) {
+			cerr << "rcu " << i << ": scanLostFramesParallel() differs from plain scan" << endl;
+			err = 1;
+		}
+
+	// the result can be stored as flags
+	dipoles[0].flagOffsets().value = results[0];
+	if (!equal(dipoles[0].flagOffsets().get(), expected)) {
+		cerr << "flagOffsets() differ from scan result" << endl;
+		err = 1;
+	}
+
+	return err;
+}
+
+static int checkExample()
+{
+	int err = 0;
+
+	dal::TBB_File f("data/L59640_RS106_D20111121T130145.049Z_tbb.h5");
+
+	vector<dal::TBB_DipoleDataset> dipoles;
+	vector<dal::TBB_Station> stations(f.stations());
+	for (size_t i = 0; i < stations.size(); i++) {
+		vector<dal::TBB_DipoleDataset> d(stations[i].dipoleDatasets());
+		dipoles.insert(dipoles.end(), d.begin(), d.end());
+	}
+
+	const vector< vector<dal::Range> > results(dal::TBB_DipoleDataset::scanLostFramesParallel(dipoles));
+
+	for (size_t i = 0; i < dipoles.size(); i++) {
+		vector<short> data(dipoles[i].dims1D());
+		dipoles[i].get1D(0, &data[0], data.size());
+
+		if (!equal(results[i], plainScan(data, 1024))) {
+			cerr << dipoles[i].name() << ": scan differs from plain scan" << endl;
+			err = 1;
+		}
+	}
+
+	return err;
+}
+
+int main() {
+	int err = 0;
+
+	err |= checkGenerated();
+	err |= checkExample();
+
+	return err;
+}
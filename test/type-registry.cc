@@ -0,0 +1,73 @@
+/*
+ * Check that complex and tuple datatypes are created once and survive closing and reopening the HDF5 library.
+ * Build: c++ -Wall type-registry.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <complex>
+#include <vector>
+
+#include <dal/hdf5/File.h>
+#include <dal/hdf5/Dataset.h>
+#include <dal/lofar/Flagging.h>
+
+using namespace std;
+
+static int roundTrip(const char *filename) {
+	dal::File f(filename, dal::File::CREATE);
+	dal::Dataset< complex<float> > d(f, "DATA");
+
+	vector<ssize_t> dims(1, 4);
+	d.create(dims);
+
+	const complex<float> in[4] = { complex<float>(1, 2), complex<float>(3, 4), complex<float>(5, 6), complex<float>(7, 8) };
+	complex<float> out[4];
+
+	d.set1D(0, in, 4);
+	d.get1D(0, out, 4);
+
+	for (size_t i = 0; i < 4; i++)
+		if (out[i] != in[i]) {
+			cerr << "wrong complex value at " << i << endl;
+			return 1;
+		}
+
+	return 0;
+}
+
+int main() {
+	int err = 0;
+
+	const hid_t c1 = dal::h5typemap< complex<float> >::memoryType();
+	const hid_t c2 = dal::h5typemap< complex<float> >::memoryType();
+	if (c1 != c2) {
+		cerr << "complex type created twice" << endl;
+		err = 1;
+	}
+
+	dal::hid_gc fresh(dal::h5complexType(H5T_NATIVE_FLOAT), H5Tclose);
+	if (H5Tequal(c1, fresh) <= 0) {
+		cerr << "cached complex type differs from a fresh one" << endl;
+		err = 1;
+	}
+
+	const hid_t r1 = dal::h5typemap<dal::Range>::memoryType();
+	if (r1 != dal::h5typemap<dal::Range>::memoryType() || H5Tget_size(r1) != sizeof(dal::Range)) {
+		cerr << "tuple type not cached or of wrong size" << endl;
+		err = 1;
+	}
+
+	err |= roundTrip("test-type-registry1.h5");
+
+	// all identifiers become invalid when the library is closed
+	H5close();
+	H5open();
+
+	if (H5Iis_valid(dal::h5typemap< complex<float> >::memoryType()) <= 0) {
+		cerr << "complex type not recreated after reopening the library" << endl;
+		err = 1;
+	}
+
+	err |= roundTrip("test-type-registry2.h5");
+
+	return err;
+}
@@ -0,0 +1,124 @@
+/*
+ * Check reading a beam split over files per Stokes parameter and part as a single array.
+ * Build: c++ -Wall virtual-stokes-dataset.cc -llofardal -lhdf5
+ */
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dal/lofar/BF_File.h>
+#include <dal/lofar/VirtualStokesDataset.h>
+
+using namespace std;
+
+static const char prefix[] = "L12345_SAP000_B000";
+static const size_t nrStokes = 2;
+static const size_t nrParts = 3;
+static const size_t partChannels[nrParts] = { 4, 2, 3 };
+static const size_t firstChannels[nrParts] = { 0, 4, 6 };
+static const size_t nrChannels = 9;
+static const size_t nrSamples = 50;
+
+static float value( size_t stokes, size_t sample, size_t channel )
+{
+	return stokes * 10000 + sample * 100 + channel;
+}
+
+static void createFile( size_t stokes, size_t part )
+{
+	char filename[128];
+	snprintf(filename, sizeof filename, "%s_S%u_P%03u_bf.h5", prefix, (unsigned)stokes, (unsigned)part);
+
+	dal::BF_File f(filename, dal::BF_File::CREATE);
+	dal::BF_SubArrayPointing sap = f.subArrayPointing(0);
+	sap.create();
+	dal::BF_BeamGroup beam = sap.beam(0);
+	beam.create();
+
+	// the last file is longer, which is ignored
+	const size_t samples = stokes == nrStokes - 1 && part == nrParts - 1 ? nrSamples + 10 : nrSamples;
+
+	vector<ssize_t> dims(2);
+	dims[0] = samples;
+	dims[1] = partChannels[part];
+
+	// the middle part is stored inside the HDF5 file, so it cannot be mapped
+	const string rawFilename = part == 1 ? "" : string(filename, strlen(filename) - 3) + ".raw";
+
+	dal::BF_StokesDataset d = beam.stokes(stokes);
+	d.create(dims, dims, rawFilename);
+
+	vector<float> data(dims[0] * dims[1]);
+	for (size_t t = 0; t < samples; t++)
+		for (size_t c = 0; c < partChannels[part]; c++)
+			data[t * dims[1] + c] = value(stokes, t, firstChannels[part] + c);
+
+	vector<size_t> pos(2, 0), size(dims.begin(), dims.end());
+	d.setMatrix(pos, &data[0], size);
+}
+
+static int check( dal::VirtualStokesDataset &v, const vector<size_t> &pos, const vector<size_t> &size, unsigned nrThreads )
+{
+	vector<float> data(size[0] * size[1] * size[2], -1.0f);
+	v.getMatrix(pos, &data[0], size, nrThreads);
+
+	for (size_t s = 0; s < size[0]; s++)
+		for (size_t t = 0; t < size[1]; t++)
+			for (size_t c = 0; c < size[2]; c++)
+				if (data[(s * size[1] + t) * size[2] + c] != value(pos[0] + s, pos[1] + t, pos[2] + c)) {
+					cerr << "wrong value at " << pos[0] + s << ", " << pos[1] + t << ", " << pos[2] + c << endl;
+					return 1;
+				}
+
+	return 0;
+}
+
+int main() {
+	int err = 0;
+
+	for (size_t s = 0; s < nrStokes; s++)
+		for (size_t p = 0; p < nrParts; p++)
+			createFile(s, p);
+
+	const vector<string> filenames = dal::VirtualStokesDataset::findFiles(prefix);
+	if (filenames.size() != nrStokes * nrParts) {
+		cerr << "found " << filenames.size() << " files" << endl;
+		return 1;
+	}
+
+	dal::VirtualStokesDataset v(filenames);
+
+	const vector<size_t> dims = v.dims();
+	if (dims.size() != 3 || dims[0] != nrStokes || dims[1] != nrSamples || dims[2] != nrChannels) {
+		cerr << "wrong dimensions" << endl;
+		return 1;
+	}
+
+	if (v.nofParts() != nrParts || v.firstChannel(2) != firstChannels[2]) {
+		cerr << "wrong parts" << endl;
+		err = 1;
+	}
+
+	vector<size_t> pos(3, 0);
+	err |= check(v, pos, dims, 1);
+	err |= check(v, pos, dims, 4);
+
+	// a block crossing all parts
+	vector<size_t> size(3);
+	pos[0] = 1; pos[1] = 5; pos[2] = 3;
+	size[0] = 1; size[1] = 10; size[2] = 5;
+	err |= check(v, pos, size, 4);
+
+	try {
+		pos[1] = nrSamples;
+		size[1] = 1;
+		check(v, pos, size, 1);
+		cerr << "read beyond the end" << endl;
+		err = 1;
+	} catch (dal::DALIndexError &) {
+	}
+
+	return err;
+}